@@ -0,0 +1,510 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "ArchiveOutputSink.h"
+    #include "Probes.h"
+
+    // System headers...
+    #include <cassert>
+    #include <cstdio>
+    #include <cstring>
+
+    // POSIX headers...
+    #include <fcntl.h>
+    #include <unistd.h>
+
+    // Compression and checksum API...
+    #include <zlib.h>
+
+// Size of a tar block, which headers and member data are padded out to...
+#define TAR_BLOCK_SIZE      512
+
+// Largest value a zip field of the given width can hold before zip64 records
+//  are needed instead...
+#define ZIP_MAXIMUM_16      0xffffULL
+#define ZIP_MAXIMUM_32      0xffffffffULL
+
+// Using the standard namespace...
+using namespace std;
+
+// Constructor creates the archive, or throws an error...
+ArchiveOutputSink::ArchiveOutputSink(
+    const string &OutputRootDirectory,
+    const string &ArchiveFileName,
+    const FormatType Format,
+    const bool Overwrite,
+    const OutputWriter::FsyncPolicyType FsyncPolicy)
+    : OutputSink(OutputRootDirectory),
+      m_ArchiveFileName(ArchiveFileName),
+      m_ArchiveOffset(0),
+      m_Format(Format),
+      m_Closed(false),
+      m_FsyncPolicy(FsyncPolicy),
+      m_ModificationTime(time(NULL))
+{
+    // Overwrite not enabled and archive already existed, don't overwrite...
+    if(!Overwrite &&
+       (access(ArchiveFileName.c_str(), F_OK) == 0))
+        throw string(_("output archive already exists, not overwriting (use --overwrite to override)"));
+
+    // Create the archive...
+    m_ArchiveStream.open(ArchiveFileName.c_str(), ios::out | ios::binary | ios::trunc);
+
+        // Failed...
+        if(!m_ArchiveStream.is_open())
+            throw string(_("could not create output archive: ")) + ArchiveFileName;
+}
+
+// Abandon the member currently being written, if any, without adding it...
+void ArchiveOutputSink::AbortFile()
+{
+    // Nothing being written...
+    if(m_MemberName.empty())
+        return;
+
+    // Forget about it and clear the buffer for the next member...
+    m_MemberNames.erase(m_MemberName);
+    m_MemberName.clear();
+    m_MemberStream.str(string());
+    m_MemberStream.clear();
+}
+
+// Append bytes to the archive, or throw an error...
+void ArchiveOutputSink::Append(const void *Data, const size_t Size)
+{
+    // Write and check for error...
+    m_ArchiveStream.write(static_cast<const char *>(Data), Size);
+    if(!m_ArchiveStream.good())
+        throw string(_("could not write to output archive"));
+
+    // Keep track of where we are...
+    m_ArchiveOffset += Size;
+}
+
+// Append the member just written as a tar entry, or throw an error...
+void ArchiveOutputSink::AppendTarMember(const string &Contents)
+{
+    // Header block, with unused fields left as zeros...
+    char Header[TAR_BLOCK_SIZE];
+    memset(Header, 0, sizeof(Header));
+
+    // Member path fits in the name field alone...
+    if(m_MemberName.length() <= 100)
+        memcpy(Header, m_MemberName.data(), m_MemberName.length());
+
+    // Otherwise split it at a separator into the ustar prefix and name...
+    else
+    {
+        // Find the last separator leaving a prefix that fits...
+        size_t Separator = m_MemberName.rfind('/', 155);
+        if(Separator == string::npos || Separator == 0 ||
+           m_MemberName.length() - Separator - 1 > 100)
+            throw string(_("output file name too long for tar archive: ")) + m_MemberName;
+
+        // Store each half...
+        memcpy(Header, m_MemberName.data() + Separator + 1, m_MemberName.length() - Separator - 1);
+        memcpy(Header + 345, m_MemberName.data(), Separator);
+    }
+
+    // Numeric fields are zero padded octal, terminated...
+    snprintf(Header + 100, 8, "%07o", 0644);
+    snprintf(Header + 108, 8, "%07o", 0);
+    snprintf(Header + 116, 8, "%07o", 0);
+    snprintf(Header + 124, 12, "%011llo", static_cast<unsigned long long>(Contents.size()));
+    snprintf(Header + 136, 12, "%011llo", static_cast<unsigned long long>(m_ModificationTime));
+
+    // Regular file in ustar format...
+    Header[156] = '0';
+    memcpy(Header + 257, "ustar", 6);
+    memcpy(Header + 263, "00", 2);
+
+    // Checksum is the sum of the header's bytes with its own field as
+    //  spaces...
+    memset(Header + 148, ' ', 8);
+    unsigned int Checksum = 0;
+    for(size_t Index = 0; Index < sizeof(Header); ++Index)
+        Checksum += static_cast<unsigned char>(Header[Index]);
+    snprintf(Header + 148, 8, "%06o", Checksum);
+    Header[155] = ' ';
+
+    // Write the header and the data, padded out to a whole block...
+    Append(Header, sizeof(Header));
+    Append(Contents);
+    const size_t Padding = (TAR_BLOCK_SIZE - Contents.size() % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+    if(Padding)
+    {
+        const char Zeros[TAR_BLOCK_SIZE] = {0};
+        Append(Zeros, Padding);
+    }
+}
+
+// Append the member just written as a zip entry, or throw an error...
+void ArchiveOutputSink::AppendZipMember(const string &Contents)
+{
+    // Members larger than a plain zip record can describe aren't supported...
+    if(Contents.size() >= ZIP_MAXIMUM_32)
+        throw string(_("output file too large for zip archive: ")) + m_MemberName;
+
+    // Checksum of the uncompressed data...
+    const uint32_t Crc32 = crc32(
+        crc32(0L, Z_NULL, 0),
+        reinterpret_cast<const Bytef *>(Contents.data()),
+        Contents.size());
+
+    // PNGs are already deflated, but everything else is worth trying to
+    //  compress. Only keep the result if it came out smaller...
+    string Compressed;
+    const bool Deflated =
+        (m_MemberName.length() < 4 ||
+         m_MemberName.compare(m_MemberName.length() - 4, 4, ".png") != 0) &&
+        Deflate(Contents, Compressed);
+    const string &Stored = Deflated ? Compressed : Contents;
+    const uint16_t Method = Deflated ? Z_DEFLATED : 0;
+
+    // Remember what the central directory will need...
+    m_ZipMembers.push_back(ZipMemberType(
+        m_MemberName, Method, Crc32, Stored.size(), Contents.size(), m_ArchiveOffset));
+
+    // Modification time and date in MS-DOS format...
+    uint16_t DosDate = 0;
+    uint16_t DosTime = 0;
+    GetDosDateTime(DosDate, DosTime);
+
+    // Local file header. Names are flagged as UTF-8 since some directories
+    //  are named by translated strings...
+    string Header;
+    PutLittleEndian(Header, 0x04034b50, 4);
+    PutLittleEndian(Header, 20, 2);
+    PutLittleEndian(Header, 0x0800, 2);
+    PutLittleEndian(Header, Method, 2);
+    PutLittleEndian(Header, DosTime, 2);
+    PutLittleEndian(Header, DosDate, 2);
+    PutLittleEndian(Header, Crc32, 4);
+    PutLittleEndian(Header, Stored.size(), 4);
+    PutLittleEndian(Header, Contents.size(), 4);
+    PutLittleEndian(Header, m_MemberName.length(), 2);
+    PutLittleEndian(Header, 0, 2);
+    Header += m_MemberName;
+
+    // Write the header and the data...
+    Append(Header);
+    Append(Stored);
+}
+
+// Append the zip central directory and end records, or throw an error...
+void ArchiveOutputSink::AppendZipTrailer()
+{
+    // Variables...
+    string Trailer;
+
+    // Central directory begins here...
+    const uint64_t CentralDirectoryOffset = m_ArchiveOffset;
+
+    // Modification time and date in MS-DOS format...
+    uint16_t DosDate = 0;
+    uint16_t DosTime = 0;
+    GetDosDateTime(DosDate, DosTime);
+
+    // Central directory header for each member...
+    for(vector<ZipMemberType>::const_iterator Iterator = m_ZipMembers.begin();
+        Iterator != m_ZipMembers.end();
+      ++Iterator)
+    {
+        // Members past the first four gigabytes need their offset in a zip64
+        //  extra field...
+        const ZipMemberType &Member = *Iterator;
+        const bool Zip64 = (Member.m_Offset >= ZIP_MAXIMUM_32);
+
+        // Header...
+        PutLittleEndian(Trailer, 0x02014b50, 4);
+        PutLittleEndian(Trailer, (3 << 8) | 45, 2);
+        PutLittleEndian(Trailer, Zip64 ? 45 : 20, 2);
+        PutLittleEndian(Trailer, 0x0800, 2);
+        PutLittleEndian(Trailer, Member.m_Method, 2);
+        PutLittleEndian(Trailer, DosTime, 2);
+        PutLittleEndian(Trailer, DosDate, 2);
+        PutLittleEndian(Trailer, Member.m_Crc32, 4);
+        PutLittleEndian(Trailer, Member.m_CompressedSize, 4);
+        PutLittleEndian(Trailer, Member.m_UncompressedSize, 4);
+        PutLittleEndian(Trailer, Member.m_Name.length(), 2);
+        PutLittleEndian(Trailer, Zip64 ? 12 : 0, 2);
+        PutLittleEndian(Trailer, 0, 2);
+        PutLittleEndian(Trailer, 0, 2);
+        PutLittleEndian(Trailer, 0, 2);
+        PutLittleEndian(Trailer, 0100644UL << 16, 4);
+        PutLittleEndian(Trailer, Zip64 ? ZIP_MAXIMUM_32 : Member.m_Offset, 4);
+        Trailer += Member.m_Name;
+
+        // Zip64 extended information holding just the offset...
+        if(Zip64)
+        {
+            PutLittleEndian(Trailer, 0x0001, 2);
+            PutLittleEndian(Trailer, 8, 2);
+            PutLittleEndian(Trailer, Member.m_Offset, 8);
+        }
+    }
+
+    // Size of the central directory...
+    const uint64_t CentralDirectorySize = Trailer.size();
+
+    // Too many members or too large for the end of central directory record
+    //  alone, so precede it with the zip64 record and its locator...
+    const bool Zip64 =
+        (m_ZipMembers.size() >= ZIP_MAXIMUM_16) ||
+        (CentralDirectoryOffset >= ZIP_MAXIMUM_32) ||
+        (CentralDirectorySize >= ZIP_MAXIMUM_32);
+    if(Zip64)
+    {
+        // Zip64 end of central directory record...
+        const uint64_t Zip64EndOffset = CentralDirectoryOffset + CentralDirectorySize;
+        PutLittleEndian(Trailer, 0x06064b50, 4);
+        PutLittleEndian(Trailer, 44, 8);
+        PutLittleEndian(Trailer, (3 << 8) | 45, 2);
+        PutLittleEndian(Trailer, 45, 2);
+        PutLittleEndian(Trailer, 0, 4);
+        PutLittleEndian(Trailer, 0, 4);
+        PutLittleEndian(Trailer, m_ZipMembers.size(), 8);
+        PutLittleEndian(Trailer, m_ZipMembers.size(), 8);
+        PutLittleEndian(Trailer, CentralDirectorySize, 8);
+        PutLittleEndian(Trailer, CentralDirectoryOffset, 8);
+
+        // Locator...
+        PutLittleEndian(Trailer, 0x07064b50, 4);
+        PutLittleEndian(Trailer, 0, 4);
+        PutLittleEndian(Trailer, Zip64EndOffset, 8);
+        PutLittleEndian(Trailer, 1, 4);
+    }
+
+    // End of central directory record...
+    PutLittleEndian(Trailer, 0x06054b50, 4);
+    PutLittleEndian(Trailer, 0, 2);
+    PutLittleEndian(Trailer, 0, 2);
+    PutLittleEndian(Trailer, Zip64 ? ZIP_MAXIMUM_16 : m_ZipMembers.size(), 2);
+    PutLittleEndian(Trailer, Zip64 ? ZIP_MAXIMUM_16 : m_ZipMembers.size(), 2);
+    PutLittleEndian(Trailer, Zip64 ? ZIP_MAXIMUM_32 : CentralDirectorySize, 4);
+    PutLittleEndian(Trailer, Zip64 ? ZIP_MAXIMUM_32 : CentralDirectoryOffset, 4);
+    PutLittleEndian(Trailer, 0, 2);
+
+    // Write it all out...
+    Append(Trailer);
+}
+
+// Write out the archive's trailer and close it, or throw an error...
+void ArchiveOutputSink::Close()
+{
+    // Already done...
+    if(m_Closed)
+        return;
+
+    // No member should still be being written...
+    assert(m_MemberName.empty());
+
+    // Don't try again, even if this fails...
+    m_Closed = true;
+
+    // Which format?
+    switch(m_Format)
+    {
+        // Tar ends with two empty blocks...
+        case FormatTar:
+        {
+            const char Zeros[TAR_BLOCK_SIZE * 2] = {0};
+            Append(Zeros, sizeof(Zeros));
+            break;
+        }
+
+        // Zip ends with its central directory...
+        case FormatZip:
+            AppendZipTrailer();
+            break;
+    }
+
+    // Close and check for error...
+    m_ArchiveStream.close();
+    if(m_ArchiveStream.fail())
+        throw string(_("could not write to output archive"));
+
+    // Flush the finished archive to stable storage if the fsync policy asks
+    //  for it. It's one file, so both policies mean the same here...
+    if(m_FsyncPolicy != OutputWriter::FsyncNone)
+    {
+        // Reopen just to flush it...
+        const int FileDescriptor = open(m_ArchiveFileName.c_str(), O_RDONLY);
+        const bool Synced = (FileDescriptor >= 0) && (fsync(FileDescriptor) == 0);
+        if(FileDescriptor >= 0)
+            close(FileDescriptor);
+
+        // Failed...
+        if(!Synced)
+            throw string(_("could not flush output archive"));
+    }
+}
+
+// Append the member currently being written to the archive, or throw an
+//  error...
+void ArchiveOutputSink::CloseFile()
+{
+    // A member should have been being written...
+    assert(!m_MemberName.empty());
+
+    // Take the buffered contents and clear the buffer for the next member...
+    const string Contents = m_MemberStream.str();
+    m_MemberStream.str(string());
+    m_MemberStream.clear();
+
+    // Time it, if anything is attached to its probe...
+    const uint64_t ProbeStart = PROBE_TIMESTAMP(output_write);
+
+    // Append in the archive's format...
+    try
+    {
+        if(m_Format == FormatTar)
+            AppendTarMember(Contents);
+        else
+            AppendZipMember(Contents);
+    }
+
+        // Failed...
+        catch(const string &)
+        {
+            // Clear the member and propagate up the chain...
+            m_MemberName.clear();
+            throw;
+        }
+
+    // Fire the probe with the member's path within the archive...
+    PROBE3(output_write,
+        m_MemberName.c_str(), Contents.size(), PROBE_ELAPSED(ProbeStart));
+
+    // No longer writing a member...
+    m_MemberName.clear();
+}
+
+// Deflate the given data as a raw deflate stream, returning false if it
+//  didn't come out any smaller...
+bool ArchiveOutputSink::Deflate(const string &Data, string &Compressed)
+{
+    // Nothing to gain from empty members...
+    if(Data.empty())
+        return false;
+
+    // Initialize a raw deflate stream...
+    z_stream Stream;
+    memset(&Stream, 0, sizeof(Stream));
+    if(deflateInit2(&Stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    // Room for the worst case, then deflate in one go...
+    Compressed.resize(deflateBound(&Stream, Data.size()));
+    Stream.next_in      = reinterpret_cast<Bytef *>(const_cast<char *>(Data.data()));
+    Stream.avail_in     = Data.size();
+    Stream.next_out     = reinterpret_cast<Bytef *>(&Compressed[0]);
+    Stream.avail_out    = Compressed.size();
+    const int Result    = deflate(&Stream, Z_FINISH);
+    Compressed.resize(Stream.total_out);
+    deflateEnd(&Stream);
+
+    // Only worth it if it finished and came out smaller...
+    return (Result == Z_STREAM_END) && (Compressed.size() < Data.size());
+}
+
+// Check whether the given output file was already added as a member...
+bool ArchiveOutputSink::Exists(const string &FileName) const
+{
+    return (m_MemberNames.find(GetRelativePath(FileName)) != m_MemberNames.end());
+}
+
+// Push every member appended so far out to the archive file, or throw an
+//  error...
+void ArchiveOutputSink::Flush()
+{
+    // Flush and check for error...
+    m_ArchiveStream.flush();
+    if(m_ArchiveStream.fail())
+        throw string(_("could not write to output archive"));
+}
+
+// Get the modification time given to every member in MS-DOS format...
+void ArchiveOutputSink::GetDosDateTime(uint16_t &DosDate, uint16_t &DosTime) const
+{
+    // Break down into local time...
+    struct tm LocalTime;
+    localtime_r(&m_ModificationTime, &LocalTime);
+
+    // Seconds are stored halved, and nothing before 1980 is representable...
+    DosTime = (LocalTime.tm_hour << 11) | (LocalTime.tm_min << 5) | (LocalTime.tm_sec / 2);
+    DosDate = (LocalTime.tm_year < 80) ? ((1 << 5) | 1) :
+        (((LocalTime.tm_year - 80) << 9) | ((LocalTime.tm_mon + 1) << 5) | LocalTime.tm_mday);
+}
+
+// Begin writing the given output file as a new member and return the stream
+//  its contents are to be written to, or throw an error...
+ostream &ArchiveOutputSink::OpenFile(const string &FileName)
+{
+    // Only one member may be written at a time, and never after the trailer...
+    assert(m_MemberName.empty());
+    assert(!m_Closed);
+
+    // Archives can't replace a member already appended...
+    const string MemberName = GetRelativePath(FileName);
+    if(!m_MemberNames.insert(MemberName).second)
+        throw string(_("output archive already contains ")) + MemberName;
+
+    // Begin buffering the member...
+    m_MemberName = MemberName;
+    return m_MemberStream;
+}
+
+// Append an integer of the given width in bytes to a buffer in little endian
+//  order, as zip records are laid out...
+void ArchiveOutputSink::PutLittleEndian(
+    string &Buffer,
+    const uint64_t Value,
+    const size_t Bytes)
+{
+    for(size_t Index = 0; Index < Bytes; ++Index)
+        Buffer += static_cast<char>((Value >> (Index * 8)) & 0xff);
+}
+
+// Deconstructor finishes the archive if it wasn't already...
+ArchiveOutputSink::~ArchiveOutputSink()
+{
+    // Whatever was written so far is still worth keeping as a valid
+    //  archive, so write the trailer, but there's no one left to tell if
+    //  that fails. A member left half written is dropped...
+    try
+    {
+        AbortFile();
+        Close();
+    }
+
+        // Failed...
+        catch(const string &)
+        {
+        }
+}
+
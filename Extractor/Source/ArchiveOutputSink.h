@@ -0,0 +1,225 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _ARCHIVE_OUTPUT_SINK_H_
+#define _ARCHIVE_OUTPUT_SINK_H_
+
+// Includes...
+
+    // Our headers...
+    #include "OutputSink.h"
+    #include "OutputWriter.h"
+
+    // System headers...
+    #include <ctime>
+    #include <fstream>
+    #include <set>
+    #include <sstream>
+    #include <string>
+    #include <vector>
+    #include <stdint.h>
+    #include <clocale>
+
+    // i18n...
+    #include "gettext.h"
+    #define _(str) gettext (str)
+    #define N_(str) gettext_noop (str)
+
+// Streams every output file into a single zip or tar archive, preserving the
+//  directory layout beneath the output root directory as member paths. The
+//  archive is only ever appended to, and no directories are created...
+class ArchiveOutputSink : public OutputSink
+{
+    // Public types...
+    public:
+
+        // Archive format...
+        typedef enum
+        {
+            // POSIX ustar...
+            FormatTar,
+
+            // PKWARE zip, with zip64 records if it grows large enough...
+            FormatZip
+
+        }FormatType;
+
+    // Public methods...
+    public:
+
+        // Constructor creates the archive, replacing one already there only
+        //  if allowed to overwrite, or throws an error. The fsync policy
+        //  decides whether it is flushed to stable storage once closed...
+        ArchiveOutputSink(
+            const std::string &OutputRootDirectory,
+            const std::string &ArchiveFileName,
+            const FormatType Format,
+            const bool Overwrite,
+            const OutputWriter::FsyncPolicyType FsyncPolicy);
+
+        // Abandon the member currently being written, if any, without adding
+        //  it...
+        void AbortFile();
+
+        // Write out the archive's trailer and close it, or throw an error...
+        void Close();
+
+        // Append the member currently being written to the archive, or throw
+        //  an error...
+        void CloseFile();
+
+        // Check whether the given output file was already added as a member...
+        bool Exists(const std::string &FileName) const;
+
+        // Push every member appended so far out to the archive file, or
+        //  throw an error...
+        void Flush();
+
+        // Members are appended as soon as they are closed, so never...
+        bool IsPending(const std::string &) const { return false; }
+
+        // Begin writing the given output file as a new member and return the
+        //  stream its contents are to be written to, or throw an error...
+        std::ostream &OpenFile(const std::string &FileName);
+
+        // Nothing to prepare since member paths carry their directories...
+        void PrepareDirectory(const std::string &) { }
+
+        // Deconstructor finishes the archive if it wasn't already...
+       ~ArchiveOutputSink();
+
+    // Protected types...
+    protected:
+
+        // What the zip central directory needs to know of each member...
+        struct ZipMemberType
+        {
+            // Constructor initializer...
+            ZipMemberType(
+                const std::string &Name,
+                const uint16_t Method,
+                const uint32_t Crc32,
+                const uint32_t CompressedSize,
+                const uint32_t UncompressedSize,
+                const uint64_t Offset)
+                : m_CompressedSize(CompressedSize),
+                  m_Crc32(Crc32),
+                  m_Method(Method),
+                  m_Name(Name),
+                  m_Offset(Offset),
+                  m_UncompressedSize(UncompressedSize)
+            { }
+
+            // Size of the member's data as stored...
+            uint32_t            m_CompressedSize;
+
+            // CRC-32 of the uncompressed data...
+            uint32_t            m_Crc32;
+
+            // Compression method, stored or deflated...
+            uint16_t            m_Method;
+
+            // Member path...
+            std::string         m_Name;
+
+            // Offset of the member's local header from start of archive...
+            uint64_t            m_Offset;
+
+            // Size of the member's data before compression...
+            uint32_t            m_UncompressedSize;
+        };
+
+    // Protected methods...
+    protected:
+
+        // Append bytes to the archive, or throw an error...
+        void Append(const void *Data, const size_t Size);
+        void Append(const std::string &Data) { Append(Data.data(), Data.size()); }
+
+        // Append the member just written as a tar entry, or throw an error...
+        void AppendTarMember(const std::string &Contents);
+
+        // Append the member just written as a zip entry, or throw an error...
+        void AppendZipMember(const std::string &Contents);
+
+        // Append the zip central directory and end records, or throw an
+        //  error...
+        void AppendZipTrailer();
+
+        // Get the modification time given to every member in MS-DOS
+        //  format...
+        void GetDosDateTime(uint16_t &DosDate, uint16_t &DosTime) const;
+
+        // Deflate the given data as a raw deflate stream, returning false if
+        //  it didn't come out any smaller...
+        static bool Deflate(const std::string &Data, std::string &Compressed);
+
+        // Append an integer of the given width in bytes to a buffer in
+        //  little endian order, as zip records are laid out...
+        static void PutLittleEndian(
+            std::string &Buffer,
+            const uint64_t Value,
+            const size_t Bytes);
+
+    // Protected data...
+    protected:
+
+        // Name of the archive...
+        std::string         m_ArchiveFileName;
+
+        // Current offset into the archive...
+        uint64_t            m_ArchiveOffset;
+
+        // Archive being written...
+        std::ofstream       m_ArchiveStream;
+
+        // Format of the archive...
+        FormatType          m_Format;
+
+        // True once the trailer has been written...
+        bool                m_Closed;
+
+        // Fsync policy...
+        OutputWriter::FsyncPolicyType m_FsyncPolicy;
+
+        // Name of the member currently being written, if any...
+        std::string         m_MemberName;
+
+        // Names of all members added so far...
+        std::set<std::string> m_MemberNames;
+
+        // Contents of the member currently being written. Members are
+        //  buffered whole so their sizes and checksum are known before their
+        //  header is written...
+        std::ostringstream  m_MemberStream;
+
+        // Modification time given to every member, being when the archive
+        //  was created...
+        time_t              m_ModificationTime;
+
+        // Zip members written so far, for the central directory...
+        std::vector<ZipMemberType> m_ZipMembers;
+};
+
+// Multiple include protection...
+#endif
+
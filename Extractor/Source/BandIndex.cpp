@@ -0,0 +1,434 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "BandIndex.h"
+    #include "Console.h"
+    #include "Miscellaneous.h"
+    #include "OutputWriter.h"
+
+    // System headers...
+    #include <cstring>
+    #include <vector>
+
+    // POSIX headers...
+    #include <fcntl.h>
+    #include <fnmatch.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+// Using the standard namespace...
+using namespace std;
+
+// Byte order marker, read back differently on a host of the other
+//  endianness...
+#define BAND_INDEX_BYTE_ORDER   0x01020304
+
+// Constructor maps the given index file, if it exists. One that is unreadable
+//  or was written by a different version is ignored and will be replaced when
+//  saved...
+BandIndex::BandIndex(const string &IndexFile)
+    : m_FoundEntries(0),
+      m_IndexFile(IndexFile),
+      m_Mapping(NULL),
+      m_MappingSize(0),
+      m_Records(NULL),
+      m_RecordCount(0),
+      m_StringTable(NULL),
+      m_StringTableSize(0)
+{
+    // Map it...
+    Map();
+}
+
+// Append a string to the string table and refer to it...
+void BandIndex::AppendString(
+    const string &String,
+    StringReferenceType &Reference,
+    string &StringTable)
+{
+    Reference.m_Offset = StringTable.size();
+    Reference.m_Length = String.size();
+    StringTable += String;
+}
+
+// Decode a mapped record into an entry, returning false if it refers outside
+//  of the string table...
+bool BandIndex::DecodeRecord(const RecordType &Record, EntryType &Entry) const
+{
+    // Strings...
+    if(!GetString(Record.m_AzimuthElevation, Entry.m_AzimuthElevation) ||
+       !GetString(Record.m_CameraEventLabel, Entry.m_CameraEventLabel) ||
+       !GetString(Record.m_CameraEventLabelNoSol, Entry.m_CameraEventLabelNoSol) ||
+       !GetString(Record.m_ErrorMessage, Entry.m_ErrorMessage) ||
+       !GetString(Record.m_OCRBuffer, Entry.m_OCRBuffer))
+        return false;
+
+    // Everything else...
+    Entry.m_AxisPresent                     = (Record.m_AxisPresent != 0);
+    Entry.m_Bands                           = Record.m_Bands;
+    Entry.m_BasicMetadataParserHeuristic    = Record.m_BasicMetadataParserHeuristic;
+    Entry.m_BytesPerColour                  = Record.m_BytesPerColour;
+    Entry.m_DiodeBandType                   = Record.m_DiodeBandType;
+    Entry.m_DropoutRows                     = Record.m_DropoutRows;
+    Entry.m_FileOrdinalOnMagneticTape       = Record.m_FileOrdinalOnMagneticTape;
+    Entry.m_FullHistogramPresent            = (Record.m_FullHistogramPresent != 0);
+    memcpy(Entry.m_Histogram, Record.m_Histogram, sizeof(Entry.m_Histogram));
+    Entry.m_LanderNumber                    = Record.m_LanderNumber;
+    Entry.m_MagneticTapeNumber              = Record.m_MagneticTapeNumber;
+    Entry.m_Mean                            = Record.m_Mean;
+    Entry.m_Ok                              = (Record.m_Ok != 0);
+    Entry.m_OriginalHeight                  = Record.m_OriginalHeight;
+    Entry.m_OriginalWidth                   = Record.m_OriginalWidth;
+    Entry.m_PhaseOffsetRequired             = Record.m_PhaseOffsetRequired;
+    Entry.m_PhysicalRecordPadding           = Record.m_PhysicalRecordPadding;
+    Entry.m_PhysicalRecordSize              = Record.m_PhysicalRecordSize;
+    Entry.m_PixelFormat                     = Record.m_PixelFormat;
+    Entry.m_RawImageOffset                  = Record.m_RawImageOffset;
+    Entry.m_Rotation                        = Record.m_Rotation;
+    Entry.m_SolarDay                        = Record.m_SolarDay;
+    Entry.m_Variance                        = Record.m_Variance;
+
+    // Done...
+    return true;
+}
+
+// Encode an entry into a record, appending its strings to the string table...
+void BandIndex::EncodeRecord(
+    const string &InputFile,
+    const KeyedEntryType &KeyedEntry,
+    RecordType &Record,
+    string &StringTable)
+{
+    // Alias the entry...
+    const EntryType &Entry = KeyedEntry.m_Entry;
+
+    // Start from nothing so reserved bytes are zero...
+    memset(&Record, 0, sizeof(Record));
+
+    // Key...
+    Record.m_KeySize        = KeyedEntry.m_KeySize;
+    Record.m_KeyModified    = KeyedEntry.m_KeyModified;
+
+    // Strings...
+    AppendString(InputFile, Record.m_InputFile, StringTable);
+    AppendString(Entry.m_AzimuthElevation, Record.m_AzimuthElevation, StringTable);
+    AppendString(Entry.m_CameraEventLabel, Record.m_CameraEventLabel, StringTable);
+    AppendString(Entry.m_CameraEventLabelNoSol, Record.m_CameraEventLabelNoSol, StringTable);
+    AppendString(Entry.m_ErrorMessage, Record.m_ErrorMessage, StringTable);
+    AppendString(Entry.m_OCRBuffer, Record.m_OCRBuffer, StringTable);
+
+    // Everything else...
+    Record.m_AxisPresent                    = Entry.m_AxisPresent;
+    Record.m_Bands                          = Entry.m_Bands;
+    Record.m_BasicMetadataParserHeuristic   = Entry.m_BasicMetadataParserHeuristic;
+    Record.m_BytesPerColour                 = Entry.m_BytesPerColour;
+    Record.m_DiodeBandType                  = Entry.m_DiodeBandType;
+    Record.m_DropoutRows                    = Entry.m_DropoutRows;
+    Record.m_FileOrdinalOnMagneticTape      = Entry.m_FileOrdinalOnMagneticTape;
+    Record.m_FullHistogramPresent           = Entry.m_FullHistogramPresent;
+    memcpy(Record.m_Histogram, Entry.m_Histogram, sizeof(Record.m_Histogram));
+    Record.m_LanderNumber                   = Entry.m_LanderNumber;
+    Record.m_MagneticTapeNumber             = Entry.m_MagneticTapeNumber;
+    Record.m_Mean                           = Entry.m_Mean;
+    Record.m_Ok                             = Entry.m_Ok;
+    Record.m_OriginalHeight                 = Entry.m_OriginalHeight;
+    Record.m_OriginalWidth                  = Entry.m_OriginalWidth;
+    Record.m_PhaseOffsetRequired            = Entry.m_PhaseOffsetRequired;
+    Record.m_PhysicalRecordPadding          = Entry.m_PhysicalRecordPadding;
+    Record.m_PhysicalRecordSize             = Entry.m_PhysicalRecordSize;
+    Record.m_PixelFormat                    = Entry.m_PixelFormat;
+    Record.m_RawImageOffset                 = Entry.m_RawImageOffset;
+    Record.m_Rotation                       = Entry.m_Rotation;
+    Record.m_SolarDay                       = Entry.m_SolarDay;
+    Record.m_Variance                       = Entry.m_Variance;
+}
+
+// Find a current entry for the given input file, returning false if there
+//  isn't one...
+bool BandIndex::Find(const string &InputFile, EntryType &Entry) const
+{
+    // Look it up...
+    const RecordType *Record = FindRecord(InputFile);
+
+        // Not indexed...
+        if(!Record)
+            return false;
+
+    // Check the file hasn't changed since...
+    uint64_t    Size        = 0;
+    int64_t     Modified    = 0;
+    if(!GetKey(InputFile, Size, Modified) ||
+       Size != Record->m_KeySize ||
+       Modified != Record->m_KeyModified)
+        return false;
+
+    // Decode it...
+    if(!DecodeRecord(*Record, Entry))
+        return false;
+
+    // Done...
+  ++m_FoundEntries;
+    return true;
+}
+
+// Binary search the mapped records for the given input file, or return NULL
+//  if it isn't there...
+const BandIndex::RecordType *BandIndex::FindRecord(const string &InputFile) const
+{
+    // Variables...
+    size_t  Low     = 0;
+    size_t  High    = m_RecordCount;
+    string  Candidate;
+
+    // Narrow down...
+    while(Low < High)
+    {
+        // Check the middle record's name...
+        const size_t Middle = Low + (High - Low) / 2;
+        if(!GetString(m_Records[Middle].m_InputFile, Candidate))
+            return NULL;
+
+        // Found...
+        if(Candidate == InputFile)
+            return &m_Records[Middle];
+
+        // Keep looking in whichever half it would be in...
+        if(Candidate < InputFile)
+            Low = Middle + 1;
+        else
+            High = Middle;
+    }
+
+    // Not found...
+    return NULL;
+}
+
+// Get the size and modification time of the given input file, or of the zip
+//  archive holding it, returning false on error...
+bool BandIndex::GetKey(const string &InputFile, uint64_t &Size, int64_t &Modified)
+{
+    // Members of an archive change only when the archive does...
+    string FileName = InputFile;
+    if(fnmatch(FNMATCH_ANY_ZIP ":/*", InputFile.c_str(), 0) == 0)
+        FileName.erase(InputFile.find(":/"));
+
+    // Fetch attributes...
+    struct stat FileAttributes;
+    if(stat(FileName.c_str(), &FileAttributes) != 0)
+        return false;
+
+    // Store for caller...
+    Size        = FileAttributes.st_size;
+    Modified    = FileAttributes.st_mtime;
+
+    // Done...
+    return true;
+}
+
+// Get a string out of the string table, returning false if it refers outside
+//  of it...
+bool BandIndex::GetString(const StringReferenceType &Reference, string &String) const
+{
+    // Check bounds...
+    if(Reference.m_Offset > m_StringTableSize ||
+       Reference.m_Length > m_StringTableSize - Reference.m_Offset)
+        return false;
+
+    // Extract...
+    String.assign(m_StringTable + Reference.m_Offset, Reference.m_Length);
+    return true;
+}
+
+// Insert or replace the entry for the given input file, keyed by its current
+//  size and modification time...
+void BandIndex::Insert(const string &InputFile, const EntryType &Entry)
+{
+    // Key it, or don't bother if the file can't even be examined...
+    KeyedEntryType KeyedEntry;
+    if(!GetKey(InputFile, KeyedEntry.m_KeySize, KeyedEntry.m_KeyModified))
+        return;
+
+    // Store...
+    KeyedEntry.m_Entry = Entry;
+    m_Entries[InputFile] = KeyedEntry;
+}
+
+// Map the index file, if it exists, checking it describes this version's
+//  layout...
+void BandIndex::Map()
+{
+    // Open the index, if there is one yet...
+    const int FileDescriptor = open(m_IndexFile.c_str(), O_RDONLY);
+
+        // None, so it will be created when saved...
+        if(FileDescriptor < 0)
+            return;
+
+    // Map the whole thing, unless it is too small to even be an index...
+    struct stat FileAttributes;
+    if(fstat(FileDescriptor, &FileAttributes) == 0 &&
+       static_cast<size_t>(FileAttributes.st_size) >= sizeof(HeaderType))
+    {
+        // Map...
+        void *Mapping = mmap(
+            NULL, FileAttributes.st_size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+
+        // Remember it, if it worked...
+        if(Mapping != MAP_FAILED)
+        {
+            m_Mapping       = static_cast<const uint8_t *>(Mapping);
+            m_MappingSize   = FileAttributes.st_size;
+        }
+    }
+
+    // The mapping outlives the descriptor...
+    close(FileDescriptor);
+
+    // Check the header describes this version's layout in this host's byte
+    //  order, and that everything it describes fits in the file...
+    const HeaderType *Header = reinterpret_cast<const HeaderType *>(m_Mapping);
+    if(!m_Mapping ||
+       memcmp(Header->m_Magic, BAND_INDEX_MAGIC, sizeof(Header->m_Magic)) != 0 ||
+       Header->m_Version != BAND_INDEX_VERSION ||
+       Header->m_ByteOrder != BAND_INDEX_BYTE_ORDER ||
+       Header->m_RecordSize != sizeof(RecordType) ||
+       Header->m_Records > (m_MappingSize - sizeof(HeaderType)) / sizeof(RecordType) ||
+       Header->m_StringTableOffset < sizeof(HeaderType) + Header->m_Records * sizeof(RecordType) ||
+       Header->m_StringTableOffset > m_MappingSize ||
+       Header->m_StringTableSize > m_MappingSize - Header->m_StringTableOffset)
+    {
+        // Alert and start over...
+        Message(Console::Warning)
+            << _("band index is unreadable or from a different version, rebuilding: ")
+            << m_IndexFile
+            << endl;
+        Unmap();
+        return;
+    }
+
+    // Locate the records and string table...
+    m_Records           = reinterpret_cast<const RecordType *>(m_Mapping + sizeof(HeaderType));
+    m_RecordCount       = Header->m_Records;
+    m_StringTable       = reinterpret_cast<const char *>(m_Mapping + Header->m_StringTableOffset);
+    m_StringTableSize   = Header->m_StringTableSize;
+}
+
+// Write the index back out with any entries inserted since it was mapped, then
+//  map it again, or throw an error. Nothing is written if none were
+//  inserted...
+void BandIndex::Save()
+{
+    // Nothing changed...
+    if(m_Entries.empty())
+        return;
+
+    // Merge every mapped record that wasn't replaced into the inserted ones,
+    //  keeping the whole lot sorted by input file name...
+    EntryMapType Merged = m_Entries;
+    string InputFile;
+    for(size_t Index = 0; Index < m_RecordCount; ++Index)
+    {
+        // Skip anything damaged or replaced...
+        KeyedEntryType KeyedEntry;
+        if(!GetString(m_Records[Index].m_InputFile, InputFile) ||
+           Merged.find(InputFile) != Merged.end() ||
+           !DecodeRecord(m_Records[Index], KeyedEntry.m_Entry))
+            continue;
+
+        // Keep...
+        KeyedEntry.m_KeySize        = m_Records[Index].m_KeySize;
+        KeyedEntry.m_KeyModified    = m_Records[Index].m_KeyModified;
+        Merged[InputFile]           = KeyedEntry;
+    }
+
+    // Encode the records and gather their strings...
+    vector<RecordType> Records(Merged.size());
+    string StringTable;
+    size_t RecordIndex = 0;
+    for(EntryMapType::const_iterator Iterator = Merged.begin();
+        Iterator != Merged.end();
+      ++Iterator, ++RecordIndex)
+        EncodeRecord(Iterator->first, Iterator->second, Records[RecordIndex], StringTable);
+
+    // Fill out the header...
+    HeaderType Header;
+    memset(&Header, 0, sizeof(Header));
+    memcpy(Header.m_Magic, BAND_INDEX_MAGIC, sizeof(Header.m_Magic));
+    Header.m_Version            = BAND_INDEX_VERSION;
+    Header.m_ByteOrder          = BAND_INDEX_BYTE_ORDER;
+    Header.m_RecordSize         = sizeof(RecordType);
+    Header.m_Records            = Records.size();
+    Header.m_StringTableOffset  = sizeof(HeaderType) + Records.size() * sizeof(RecordType);
+    Header.m_StringTableSize    = StringTable.size();
+
+    // Lay out the whole file...
+    string Contents;
+    Contents.reserve(Header.m_StringTableOffset + StringTable.size());
+    Contents.append(reinterpret_cast<const char *>(&Header), sizeof(Header));
+    if(!Records.empty())
+        Contents.append(reinterpret_cast<const char *>(&Records[0]), Records.size() * sizeof(RecordType));
+    Contents.append(StringTable);
+
+    // Done with the old one...
+    Unmap();
+
+    // Replace it atomically so a run interrupted while saving, or another
+    //  one reading it at the same time, never sees half an index...
+    OutputWriter Writer(0, OutputWriter::FsyncNone);
+    Writer.Submit(m_IndexFile, Contents);
+    Writer.Flush();
+
+    // Everything is in the file now, so map it in place of the old one for
+    //  anything looked up from here on...
+    m_Entries.clear();
+    Map();
+}
+
+// Unmap the index file, if mapped...
+void BandIndex::Unmap()
+{
+    // Unmap...
+    if(m_Mapping)
+        munmap(const_cast<uint8_t *>(m_Mapping), m_MappingSize);
+
+    // Forget it...
+    m_Mapping           = NULL;
+    m_MappingSize       = 0;
+    m_Records           = NULL;
+    m_RecordCount       = 0;
+    m_StringTable       = NULL;
+    m_StringTableSize   = 0;
+}
+
+// Deconstructor...
+BandIndex::~BandIndex()
+{
+    // Release the mapping...
+    Unmap();
+}
+
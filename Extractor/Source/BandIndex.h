@@ -0,0 +1,342 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _BAND_INDEX_H_
+#define _BAND_INDEX_H_
+
+// Includes...
+
+    // Our headers...
+    #include "BandStatistics.h"
+
+    // System headers...
+    #include <cstddef>
+    #include <map>
+    #include <string>
+    #include <stdint.h>
+    #include <clocale>
+
+    // i18n...
+    #include "gettext.h"
+    #define _(str) gettext (str)
+    #define N_(str) gettext_noop (str)
+
+// Identifies a band index file and the layout of its records...
+#define BAND_INDEX_MAGIC        "VKBIDX\r\n"
+#define BAND_INDEX_VERSION      2
+
+// Persistent index of everything loading each input band found out about it,
+//  so a later run over the same inputs can answer filters and plan its
+//  reconstructions without opening any file it doesn't need pixels from. The
+//  file is a header, then fixed size records sorted by input file name, then
+//  a table of the strings they refer to, all in native byte order so that it
+//  can be mapped and searched in place. An entry is current only so long as
+//  the size and modification time of the file it came from, or of the zip
+//  archive holding it, are unchanged...
+class BandIndex
+{
+    // Public types...
+    public:
+
+        // Everything loading a band found out about it...
+        struct EntryType
+        {
+            // Constructor initializer...
+            EntryType()
+                : m_AxisPresent(false),
+                  m_Bands(0),
+                  m_BasicMetadataParserHeuristic(0),
+                  m_BytesPerColour(0),
+                  m_DiodeBandType(0),
+                  m_DropoutRows(0),
+                  m_FileOrdinalOnMagneticTape(0),
+                  m_FullHistogramPresent(false),
+                  m_Histogram(),
+                  m_LanderNumber(0),
+                  m_MagneticTapeNumber(0),
+                  m_Mean(0.0f),
+                  m_Ok(false),
+                  m_OriginalHeight(0),
+                  m_OriginalWidth(0),
+                  m_PhaseOffsetRequired(0),
+                  m_PhysicalRecordPadding(0),
+                  m_PhysicalRecordSize(0),
+                  m_PixelFormat(0),
+                  m_RawImageOffset(0),
+                  m_Rotation(0),
+                  m_SolarDay(0),
+                  m_Variance(0.0)
+            { }
+
+            // Overlays detected...
+            bool                m_AxisPresent;
+
+            // Azimuth / elevation string...
+            std::string         m_AzimuthElevation;
+
+            // Number of bands in the file...
+            size_t              m_Bands;
+
+            // Heuristic selected to parse the basic metadata...
+            int                 m_BasicMetadataParserHeuristic;
+
+            // Bytes per pixel...
+            int                 m_BytesPerColour;
+
+            // Camera event label with and without the solar day...
+            std::string         m_CameraEventLabel;
+            std::string         m_CameraEventLabelNoSol;
+
+            // Photosensor array diode band type...
+            int                 m_DiodeBandType;
+
+            // Dropout scanlines found while examining the band visually...
+            size_t              m_DropoutRows;
+
+            // Error loading set, if any...
+            std::string         m_ErrorMessage;
+
+            // File ordinal on magnetic tape...
+            size_t              m_FileOrdinalOnMagneticTape;
+
+            // Full histogram overlay detected...
+            bool                m_FullHistogramPresent;
+
+            // Pixel value histogram of the whole band...
+            uint32_t            m_Histogram[BAND_STATISTICS_HISTOGRAM_BINS];
+
+            // Lander number...
+            size_t              m_LanderNumber;
+
+            // Magnetic tape number...
+            size_t              m_MagneticTapeNumber;
+
+            // Mean pixel value of the centre rectangle...
+            float               m_Mean;
+
+            // Any OCR text that happened to be extracted...
+            std::string         m_OCRBuffer;
+
+            // True if the band loaded ok...
+            bool                m_Ok;
+
+            // Image height and width in pixels before being rotated...
+            size_t              m_OriginalHeight;
+            size_t              m_OriginalWidth;
+
+            // Phase offset required to decode the file...
+            size_t              m_PhaseOffsetRequired;
+
+            // Size of a padding between physical records and their size...
+            size_t              m_PhysicalRecordPadding;
+            size_t              m_PhysicalRecordSize;
+
+            // Pixel format...
+            char                m_PixelFormat;
+
+            // Raw image offset...
+            size_t              m_RawImageOffset;
+
+            // Counterclockwise rotation detected to orient image properly...
+            int                 m_Rotation;
+
+            // Solar day image was taken on...
+            size_t              m_SolarDay;
+
+            // Pixel value variance within the centre rectangle...
+            double              m_Variance;
+        };
+
+    // Public methods...
+    public:
+
+        // Constructor maps the given index file, if it exists. One that is
+        //  unreadable or was written by a different version is ignored and
+        //  will be replaced when saved...
+        BandIndex(const std::string &IndexFile);
+
+        // Find a current entry for the given input file, returning false if
+        //  there isn't one...
+        bool Find(const std::string &InputFile, EntryType &Entry) const;
+
+        // Get the size and modification time of the given input file, or of
+        //  the zip archive holding it, which an entry is current only so long
+        //  as they are unchanged, returning false on error...
+        static bool GetKey(
+            const std::string &InputFile,
+            uint64_t &Size,
+            int64_t &Modified);
+
+        // Get the number of entries found and inserted this run...
+        size_t GetFoundEntries() const { return m_FoundEntries; }
+        size_t GetInsertedEntries() const { return m_Entries.size(); }
+
+        // Insert or replace the entry for the given input file, keyed by its
+        //  current size and modification time...
+        void Insert(const std::string &InputFile, const EntryType &Entry);
+
+        // Start counting entries found afresh, such as for each of a
+        //  daemon's jobs...
+        void ResetFoundEntries() { m_FoundEntries = 0; }
+
+        // Write the index back out with any entries inserted since it was
+        //  mapped, then map it again, or throw an error. Nothing is written
+        //  if none were inserted...
+        void Save();
+
+        // Deconstructor...
+       ~BandIndex();
+
+    // Protected types...
+    protected:
+
+        // Location of a string within the string table...
+        struct StringReferenceType
+        {
+            uint32_t            m_Offset;
+            uint32_t            m_Length;
+        };
+
+        // File header...
+        struct HeaderType
+        {
+            char                m_Magic[8];
+            uint32_t            m_Version;
+            uint32_t            m_ByteOrder;
+            uint32_t            m_RecordSize;
+            uint32_t            m_Records;
+            uint64_t            m_StringTableOffset;
+            uint64_t            m_StringTableSize;
+        };
+
+        // A record, widest fields first so it packs the same everywhere...
+        struct RecordType
+        {
+            uint64_t            m_KeySize;
+            int64_t             m_KeyModified;
+            uint64_t            m_RawImageOffset;
+            double              m_Variance;
+            StringReferenceType m_InputFile;
+            StringReferenceType m_AzimuthElevation;
+            StringReferenceType m_CameraEventLabel;
+            StringReferenceType m_CameraEventLabelNoSol;
+            StringReferenceType m_ErrorMessage;
+            StringReferenceType m_OCRBuffer;
+            uint32_t            m_Bands;
+            uint32_t            m_DropoutRows;
+            uint32_t            m_FileOrdinalOnMagneticTape;
+            uint32_t            m_LanderNumber;
+            uint32_t            m_MagneticTapeNumber;
+            uint32_t            m_OriginalHeight;
+            uint32_t            m_OriginalWidth;
+            uint32_t            m_PhaseOffsetRequired;
+            uint32_t            m_PhysicalRecordPadding;
+            uint32_t            m_PhysicalRecordSize;
+            uint32_t            m_SolarDay;
+            uint32_t            m_Histogram[BAND_STATISTICS_HISTOGRAM_BINS];
+            int32_t             m_BasicMetadataParserHeuristic;
+            int32_t             m_BytesPerColour;
+            float               m_Mean;
+            uint8_t             m_AxisPresent;
+            uint8_t             m_DiodeBandType;
+            uint8_t             m_FullHistogramPresent;
+            uint8_t             m_Ok;
+            int8_t              m_PixelFormat;
+            uint8_t             m_Rotation;
+            uint8_t             m_Reserved[2];
+        };
+
+        // An entry along with the key it was inserted under...
+        struct KeyedEntryType
+        {
+            EntryType           m_Entry;
+            uint64_t            m_KeySize;
+            int64_t             m_KeyModified;
+        };
+
+        // Entries inserted this run by input file name...
+        typedef std::map<std::string, KeyedEntryType> EntryMapType;
+
+    // Protected methods...
+    protected:
+
+        // Append a string to the string table and refer to it...
+        static void AppendString(
+            const std::string &String,
+            StringReferenceType &Reference,
+            std::string &StringTable);
+
+        // Decode a mapped record into an entry, returning false if it refers
+        //  outside of the string table...
+        bool DecodeRecord(const RecordType &Record, EntryType &Entry) const;
+
+        // Encode an entry into a record, appending its strings to the string
+        //  table...
+        static void EncodeRecord(
+            const std::string &InputFile,
+            const KeyedEntryType &KeyedEntry,
+            RecordType &Record,
+            std::string &StringTable);
+
+        // Binary search the mapped records for the given input file, or
+        //  return NULL if it isn't there...
+        const RecordType *FindRecord(const std::string &InputFile) const;
+
+        // Get a string out of the string table, returning false if it refers
+        //  outside of it...
+        bool GetString(
+            const StringReferenceType &Reference,
+            std::string &String) const;
+
+        // Map the index file, if it exists, checking it describes this
+        //  version's layout...
+        void Map();
+
+        // Unmap the index file, if mapped...
+        void Unmap();
+
+    // Protected data...
+    protected:
+
+        // Entries inserted this run...
+        EntryMapType            m_Entries;
+
+        // Number of current entries found this run...
+        mutable size_t          m_FoundEntries;
+
+        // Index file name...
+        std::string             m_IndexFile;
+
+        // Mapped index file and its size, or NULL if none...
+        const uint8_t          *m_Mapping;
+        size_t                  m_MappingSize;
+
+        // Records and string table within the mapping...
+        const RecordType       *m_Records;
+        size_t                  m_RecordCount;
+        const char             *m_StringTable;
+        size_t                  m_StringTableSize;
+};
+
+// Multiple include protection...
+#endif
+
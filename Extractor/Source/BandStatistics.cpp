@@ -0,0 +1,312 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "BandStatistics.h"
+
+    // System headers...
+    #include <algorithm>
+    #include <cassert>
+    #include <cstring>
+
+    // SSE2 intrinsics, when the target has them...
+    #ifdef __SSE2__
+        #include <emmintrin.h>
+    #endif
+
+// Using the standard namespace...
+using namespace std;
+
+// Default constructor...
+BandStatistics::BandStatistics()
+{
+    // Start with an empty band...
+    Reset(0, 0);
+}
+
+// Accumulate the statistics of the next scanline. Rows must be provided in
+//  order, top to bottom, and be exactly the width the statistics were reset
+//  with...
+void BandStatistics::AccumulateRow(const uint8_t *Row, const size_t Y)
+{
+    // Variables...
+    uint8_t RowMinimum = 0xff;
+    uint8_t RowMaximum = 0x00;
+
+    // Nothing to do for an empty row...
+    if(m_Width == 0)
+        return;
+
+    // Find the extremes of this scanline and fold them into the band's...
+    RowMinimumMaximum(Row, m_Width, RowMinimum, RowMaximum);
+    m_Minimum = min(m_Minimum, RowMinimum);
+    m_Maximum = max(m_Maximum, RowMaximum);
+
+    // A scanline that is a single constant value might be a dropout, but
+    //  only if it turns out to be a short run between scanlines of actual
+    //  image since unscanned azimuths leave long constant runs too...
+    if(RowMinimum == RowMaximum)
+        ++m_ConstantRowRun;
+
+    // Otherwise this scanline has image content...
+    else
+    {
+        // Closed a short run of constant scanlines following image content...
+        if(m_ContentRowSeen && m_ConstantRowRun <= BAND_STATISTICS_DROPOUT_MAXIMUM_RUN)
+            m_DropoutRows += m_ConstantRowRun;
+
+        // Reset the run...
+        m_ConstantRowRun = 0;
+        m_ContentRowSeen = true;
+    }
+
+    // Within the rows of the sample region, so sum its columns in one span
+    //  rather than testing each pixel...
+    if(Y >= m_SampleRegionTop && Y <= m_SampleRegionBottom)
+    {
+        // Length of the span, being inclusive of the right edge...
+        const size_t SpanLength = m_SampleRegionRight - m_SampleRegionLeft + 1;
+
+        // Sum the span...
+        SpanSumAndSquares(
+            Row + m_SampleRegionLeft,
+            SpanLength,
+            m_SampleRegionSum,
+            m_SampleRegionSumOfSquares);
+
+        // Remember how many pixels were sampled...
+        m_SampleRegionSize += SpanLength;
+    }
+
+    // Update the histogram of the whole band...
+    for(size_t X = 0; X < m_Width; ++X)
+        ++m_Histogram[Row[X]];
+}
+
+// Finish accumulating after the last scanline so derived statistics like the
+//  mean and variance become available...
+void BandStatistics::Finalize()
+{
+    // Nothing was sampled...
+    if(m_SampleRegionSize == 0)
+    {
+        m_Mean      = 0.0f;
+        m_Variance  = 0.0;
+        return;
+    }
+
+    // Calculate the mean pixel value by dividing accumulator with total
+    //  rectangle size...
+    m_Mean = static_cast<float>(m_SampleRegionSum) / m_SampleRegionSize;
+
+    // Variance is the mean of the squares less the square of the mean...
+    const double Mean = static_cast<double>(m_SampleRegionSum) / m_SampleRegionSize;
+    m_Variance =
+        static_cast<double>(m_SampleRegionSumOfSquares) / m_SampleRegionSize -
+        Mean * Mean;
+
+    // Guard against rounding pushing a flat region slightly negative...
+    if(m_Variance < 0.0)
+        m_Variance = 0.0;
+}
+
+// Clear all statistics and prepare to accumulate a band of the given
+//  dimensions...
+void BandStatistics::Reset(const size_t Width, const size_t Height)
+{
+    // Clear accumulators...
+    m_ConstantRowRun            = 0;
+    m_ContentRowSeen            = false;
+    m_DropoutRows               = 0;
+    m_Maximum                   = 0x00;
+    m_Minimum                   = 0xff;
+    m_Mean                      = 0.0f;
+    m_SampleRegionSize          = 0;
+    m_SampleRegionSum           = 0;
+    m_SampleRegionSumOfSquares  = 0;
+    m_Variance                  = 0.0;
+    memset(m_Histogram, 0, sizeof(m_Histogram));
+
+    // Remember the scanline width...
+    m_Width = Width;
+
+    // Calculate inner bounding rectangle 1/3 image width and height to
+    //  sample mean pixel value. We do this to prevent sampling from outside
+    //  in the image overlay and histogram region...
+    m_SampleRegionTop       = Height / 3;
+    m_SampleRegionLeft      = Width / 3;
+    m_SampleRegionRight     = (Width / 3) * 2;
+    m_SampleRegionBottom    = (Height / 3) * 2;
+}
+
+// Restore the statistics a band index or run journal remembered of a band,
+//  without its pixels. The extremes and saturated pixels follow from the
+//  histogram, which covers the whole band...
+void BandStatistics::Restore(
+    const float Mean,
+    const double Variance,
+    const size_t DropoutRows,
+    const uint32_t *Histogram)
+{
+    // Only the sample region's sums are left unknown...
+    Reset(0, 0);
+
+    // Restore...
+    m_DropoutRows   = DropoutRows;
+    m_Mean          = Mean;
+    m_Variance      = Variance;
+    memcpy(m_Histogram, Histogram, sizeof(m_Histogram));
+
+    // Find the extremes as the first and last bins with any pixels...
+    for(size_t Bin = 0; Bin < BAND_STATISTICS_HISTOGRAM_BINS; ++Bin)
+    {
+        if(m_Histogram[Bin] == 0)
+            continue;
+        m_Minimum = min<uint8_t>(m_Minimum, Bin);
+        m_Maximum = max<uint8_t>(m_Maximum, Bin);
+    }
+}
+
+// Find the smallest and largest value within a scanline...
+void BandStatistics::RowMinimumMaximum(
+    const uint8_t *Row,
+    const size_t Width,
+    uint8_t &Minimum,
+    uint8_t &Maximum)
+{
+    // Variables...
+    size_t  X               = 0;
+    uint8_t LocalMinimum    = 0xff;
+    uint8_t LocalMaximum    = 0x00;
+
+#ifdef __SSE2__
+
+    // Sixteen pixels at a time while there are at least that many...
+    if(Width >= 16)
+    {
+        // Running extremes of each lane...
+        __m128i MinimumVector = _mm_set1_epi8(static_cast<char>(0xff));
+        __m128i MaximumVector = _mm_setzero_si128();
+
+        // Fold each block into the lanes...
+        for(; X + 16 <= Width; X += 16)
+        {
+            const __m128i Block =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(Row + X));
+            MinimumVector = _mm_min_epu8(MinimumVector, Block);
+            MaximumVector = _mm_max_epu8(MaximumVector, Block);
+        }
+
+        // Reduce the lanes...
+        uint8_t MinimumLanes[16];
+        uint8_t MaximumLanes[16];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(MinimumLanes), MinimumVector);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(MaximumLanes), MaximumVector);
+        LocalMinimum = *min_element(MinimumLanes, MinimumLanes + 16);
+        LocalMaximum = *max_element(MaximumLanes, MaximumLanes + 16);
+    }
+
+#endif
+
+    // Remaining pixels, or all of them without SSE2...
+    for(; X < Width; ++X)
+    {
+        LocalMinimum = min(LocalMinimum, Row[X]);
+        LocalMaximum = max(LocalMaximum, Row[X]);
+    }
+
+    // Store for caller...
+    Minimum = LocalMinimum;
+    Maximum = LocalMaximum;
+}
+
+// Sum the values and their squares within a span of a scanline...
+void BandStatistics::SpanSumAndSquares(
+    const uint8_t *Span,
+    const size_t Length,
+    uint64_t &Sum,
+    uint64_t &SumOfSquares)
+{
+    // Variables...
+    size_t      X                   = 0;
+    uint64_t    LocalSum            = 0;
+    uint64_t    LocalSumOfSquares   = 0;
+
+#ifdef __SSE2__
+
+    // Sixteen pixels at a time while there are at least that many...
+    if(Length >= 16)
+    {
+        // Accumulators. Sums of absolute differences against zero yield two
+        //  64-bit partial sums, while squares are accumulated as four 32-bit
+        //  lanes which cannot overflow for any scanline narrower than
+        //  roughly 260 thousand pixels...
+        const __m128i Zero              = _mm_setzero_si128();
+        __m128i       SumVector         = _mm_setzero_si128();
+        __m128i       SquaresVector     = _mm_setzero_si128();
+
+        // Accumulate each block...
+        for(; X + 16 <= Length; X += 16)
+        {
+            // Load the block...
+            const __m128i Block =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(Span + X));
+
+            // Sum...
+            SumVector = _mm_add_epi64(SumVector, _mm_sad_epu8(Block, Zero));
+
+            // Widen to 16-bit and multiply add pairs of squares...
+            const __m128i Low   = _mm_unpacklo_epi8(Block, Zero);
+            const __m128i High  = _mm_unpackhi_epi8(Block, Zero);
+            SquaresVector = _mm_add_epi32(SquaresVector, _mm_madd_epi16(Low, Low));
+            SquaresVector = _mm_add_epi32(SquaresVector, _mm_madd_epi16(High, High));
+        }
+
+        // Reduce the lanes...
+        uint64_t SumLanes[2];
+        uint32_t SquaresLanes[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(SumLanes), SumVector);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(SquaresLanes), SquaresVector);
+        LocalSum = SumLanes[0] + SumLanes[1];
+        LocalSumOfSquares =
+            static_cast<uint64_t>(SquaresLanes[0]) + SquaresLanes[1] +
+            SquaresLanes[2] + SquaresLanes[3];
+    }
+
+#endif
+
+    // Remaining pixels, or all of them without SSE2...
+    for(; X < Length; ++X)
+    {
+        LocalSum            += Span[X];
+        LocalSumOfSquares   += static_cast<uint32_t>(Span[X]) * Span[X];
+    }
+
+    // Accumulate for caller...
+    Sum          += LocalSum;
+    SumOfSquares += LocalSumOfSquares;
+}
+
@@ -0,0 +1,158 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _BAND_STATISTICS_H_
+#define _BAND_STATISTICS_H_
+
+// Includes...
+
+    // System headers...
+    #include <cstddef>
+    #include <stdint.h>
+
+// Size of the pixel value histogram, one bin per possible byte value...
+#define BAND_STATISTICS_HISTOGRAM_BINS 256
+
+// Longest run of constant scanlines between image content still considered a
+//  dropout rather than an unscanned region...
+#define BAND_STATISTICS_DROPOUT_MAXIMUM_RUN 4
+
+// Quality statistics of a single image band, accumulated one scanline at a
+//  time in the same pass the band is read off of the media...
+class BandStatistics
+{
+    // Public methods...
+    public:
+
+        // Default constructor...
+        BandStatistics();
+
+        // Accumulate the statistics of the next scanline. Rows must be
+        //  provided in order, top to bottom, and be exactly the width the
+        //  statistics were reset with...
+        void AccumulateRow(const uint8_t *Row, const size_t Y);
+
+        // Finish accumulating after the last scanline so derived statistics
+        //  like the mean and variance become available...
+        void Finalize();
+
+        // Get the number of scanlines that were a single constant value in a
+        //  short run between scanlines of image content, usually a telemetry
+        //  dropout or a missing scanline...
+        size_t GetDropoutRows() const { return m_DropoutRows; }
+
+        // Get the number of pixels in a given histogram bin...
+        uint32_t GetHistogramBin(const uint8_t Bin) const { return m_Histogram[Bin]; }
+
+        // Get the smallest and largest pixel value of the whole band...
+        uint8_t GetMaximum() const { return m_Maximum; }
+        uint8_t GetMinimum() const { return m_Minimum; }
+
+        // Get the mean pixel value within the sample region...
+        float GetMean() const { return m_Mean; }
+
+        // Get the number of pixels and their sum within the sample region...
+        size_t GetSampleRegionSize() const { return m_SampleRegionSize; }
+        uint64_t GetSampleRegionSum() const { return m_SampleRegionSum; }
+
+        // Get the number of pixels that were fully saturated...
+        size_t GetSaturatedPixels() const { return m_Histogram[BAND_STATISTICS_HISTOGRAM_BINS - 1]; }
+
+        // Get the pixel value variance within the sample region...
+        double GetVariance() const { return m_Variance; }
+
+        // Clear all statistics and prepare to accumulate a band of the given
+        //  dimensions...
+        void Reset(const size_t Width, const size_t Height);
+
+        // Restore the statistics a band index or run journal remembered of a
+        //  band, without its pixels. The extremes and saturated pixels follow
+        //  from the histogram, which covers the whole band...
+        void Restore(
+            const float Mean,
+            const double Variance,
+            const size_t DropoutRows,
+            const uint32_t *Histogram);
+
+    // Protected methods...
+    protected:
+
+        // Find the smallest and largest value within a scanline...
+        static void RowMinimumMaximum(
+            const uint8_t *Row,
+            const size_t Width,
+            uint8_t &Minimum,
+            uint8_t &Maximum);
+
+        // Sum the values and their squares within a span of a scanline...
+        static void SpanSumAndSquares(
+            const uint8_t *Span,
+            const size_t Length,
+            uint64_t &Sum,
+            uint64_t &SumOfSquares);
+
+    // Protected data...
+    protected:
+
+        // Length of the current run of constant scanlines...
+        size_t                  m_ConstantRowRun;
+
+        // True once a scanline with image content has been seen...
+        bool                    m_ContentRowSeen;
+
+        // Constant scanlines in short runs between image content...
+        size_t                  m_DropoutRows;
+
+        // Pixel value histogram of the whole band...
+        uint32_t                m_Histogram[BAND_STATISTICS_HISTOGRAM_BINS];
+
+        // Smallest and largest pixel value of the whole band...
+        uint8_t                 m_Maximum;
+        uint8_t                 m_Minimum;
+
+        // Pixel mean value of centre rectangle which is 1/3 length and width
+        //  of image. We do this to prevent sampling from outside in the image
+        //  overlay and histogram region...
+        float                   m_Mean;
+
+        // Inclusive bounds of the centre sample rectangle...
+        size_t                  m_SampleRegionBottom;
+        size_t                  m_SampleRegionLeft;
+        size_t                  m_SampleRegionRight;
+        size_t                  m_SampleRegionTop;
+
+        // Number of pixels within the sample region, and the sum of them and
+        //  of their squares...
+        size_t                  m_SampleRegionSize;
+        uint64_t                m_SampleRegionSum;
+        uint64_t                m_SampleRegionSumOfSquares;
+
+        // Pixel value variance within the sample region...
+        double                  m_Variance;
+
+        // Width of each scanline...
+        size_t                  m_Width;
+};
+
+// Multiple include protection...
+#endif
+
@@ -0,0 +1,618 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "Console.h"
+    #include "ExtractionContext.h"
+    #include "LogicalRecord.h"
+    #include "Options.h"
+    #include "PngEncoder.h"
+    #include "SyntheticCorpus.h"
+    #include "VicarImageBand.h"
+    #include "ZZipFileDescriptor.h"
+
+    // Standard C++ / POSIX system headers...
+    #include <algorithm>
+    #include <atomic>
+    #include <cassert>
+    #include <chrono>
+    #include <cstdio>
+    #include <cstdlib>
+    #include <functional>
+    #include <iomanip>
+    #include <iostream>
+    #include <new>
+    #include <streambuf>
+    #include <string>
+    #include <vector>
+    #include <dirent.h>
+    #include <getopt.h>
+    #include <unistd.h>
+
+// Using the standard namespace...
+using namespace std;
+
+// Number of heap allocations made by the whole process so far, counted by the
+//  replacement global allocation functions below...
+static atomic<size_t> AllocationCount(0);
+
+// Replacement global allocation functions to count allocations with...
+void *operator new(size_t Size)
+{
+    // Count it...
+    AllocationCount.fetch_add(1, memory_order_relaxed);
+
+    // Allocate, and at least one byte so every allocation is unique...
+    void *Pointer = malloc(Size ? Size : 1);
+    if(!Pointer)
+        throw bad_alloc();
+
+    // Done...
+    return Pointer;
+}
+void *operator new[](size_t Size) { return operator new(Size); }
+void *operator new(size_t Size, const nothrow_t &) noexcept
+{
+    // Count it...
+    AllocationCount.fetch_add(1, memory_order_relaxed);
+
+    // Allocate...
+    return malloc(Size ? Size : 1);
+}
+void *operator new[](size_t Size, const nothrow_t &Tag) noexcept { return operator new(Size, Tag); }
+
+// Release an allocation made by the replacements above. Kept out of line so
+//  GCC doesn't inline free() into callers and mistake it for a mismatched
+//  deallocation of operator new's memory...
+static void __attribute__((noinline)) ReleaseAllocation(void *Pointer) noexcept
+{
+    free(Pointer);
+}
+
+// Replacement global deallocation functions, sized or not...
+void operator delete(void *Pointer) noexcept { ReleaseAllocation(Pointer); }
+void operator delete[](void *Pointer) noexcept { ReleaseAllocation(Pointer); }
+void operator delete(void *Pointer, size_t) noexcept { ReleaseAllocation(Pointer); }
+void operator delete[](void *Pointer, size_t) noexcept { ReleaseAllocation(Pointer); }
+void operator delete(void *Pointer, const nothrow_t &) noexcept { ReleaseAllocation(Pointer); }
+void operator delete[](void *Pointer, const nothrow_t &) noexcept { ReleaseAllocation(Pointer); }
+
+// Stream buffer discarding everything written to it, so encoders can be timed
+//  without the cost of storing what they produce...
+class NullStreamBuffer : public streambuf
+{
+    // Protected methods...
+    protected:
+
+        // Discard a character or a block of them...
+        int overflow(int Character) { return traits_type::not_eof(Character); }
+        streamsize xsputn(const char *, streamsize Size) { return Size; }
+};
+
+// Image band with the protected routines of the extractor's hot paths exposed
+//  so they can be timed in isolation...
+class BenchmarkBand : public VicarImageBand
+{
+    // Public methods...
+    public:
+
+        // Constructor...
+        BenchmarkBand(const ExtractionContext &Context, const string &InputFile)
+            : VicarImageBand(Context, InputFile)
+        { }
+
+        // Forget previous OCR results so every pass is performed in full...
+        void ClearOCRCache() { m_RotationOCRCache.clear(); }
+
+        // Protected routines to be timed...
+        using VicarImageBand::ExtractOCR;
+        using VicarImageBand::MirrorDiagonal;
+        using VicarImageBand::MirrorLeftRight;
+        using VicarImageBand::MirrorTopBottom;
+        using VicarImageBand::Open;
+        using VicarImageBand::ParseBasicMetadata;
+        using VicarImageBand::ParseExtendedMetadata;
+        using VicarImageBand::Rotate;
+};
+
+// What to run and for how long...
+struct BenchmarkParametersType
+{
+    // Constructor initializer...
+    BenchmarkParametersType()
+        : m_MinimumMilliseconds(500)
+    { }
+
+    // Only run kernels whose names begin with this, or all if empty...
+    string              m_KernelPrefix;
+
+    // Minimum time to repeat each kernel for...
+    size_t              m_MinimumMilliseconds;
+};
+
+// Show help...
+static void ShowHelp()
+{
+    cout <<   "Usage: viking-benchmark-kernels [options]\n"
+         <<   "      --help\n"
+         << _("\
+                              Show this help.\n")
+         <<   "      --kernel=prefix\n"
+         << _("\
+                              Only run kernels whose names begin with prefix,\n\
+                              such as 'transform.' or 'ocr.'.\n")
+         <<   "      --maximum-size=pixels\n"
+         << _("\
+                              Largest width or height of the synthetic image\n\
+                              band to run kernels on (default 1152).\n")
+         <<   "      --minimum-size=pixels\n"
+         << _("\
+                              Smallest width or height of the synthetic image\n\
+                              band to run kernels on (default 512).\n")
+         <<   "      --seed=number\n"
+         << _("\
+                              Seed the synthetic image band is generated from\n\
+                              (default 1).\n")
+         <<   "      --time=milliseconds\n"
+         << _("\
+                              Minimum time to repeat each kernel for (default\n\
+                              500).\n\n")
+
+         << _("\
+Times the extractor's hot inner routines in isolation on a synthetic image\n\
+band, reporting nanoseconds per call and per byte processed, and operator\n\
+new allocations per call. Allocations libpng and GNU Ocrad make with malloc\n\
+are not counted.\n");
+}
+
+// List the entries of a directory with their full paths, sorted...
+static void ListDirectory(const string &Directory, vector<string> &Entries)
+{
+    // Open the directory...
+    DIR *DirectoryStream = opendir(Directory.c_str());
+    if(!DirectoryStream)
+        throw string(_("could not open directory ")) + Directory;
+
+    // Collect every entry but the current and parent directories...
+    struct dirent *Entry = NULL;
+    while((Entry = readdir(DirectoryStream)) != NULL)
+    {
+        // Skip the current and parent directories...
+        const string Name = Entry->d_name;
+        if(Name == "." || Name == "..")
+            continue;
+
+        // Remember it...
+        Entries.push_back(Directory + Name);
+    }
+
+    // Cleanup...
+    closedir(DirectoryStream);
+
+    // Visit in a stable order...
+    sort(Entries.begin(), Entries.end());
+}
+
+// Time a kernel by repeating it in ever larger batches until the minimum time
+//  has elapsed, then report its cost per call and per byte processed...
+static void RunKernel(
+    const BenchmarkParametersType &Parameters,
+    const string &Name,
+    const size_t BytesPerCall,
+    const function<void()> &Kernel)
+{
+    // Not selected...
+    if(Parameters.m_KernelPrefix.compare(
+        0, string::npos, Name, 0, Parameters.m_KernelPrefix.length()) != 0)
+        return;
+
+    // Warm up caches and any buffers the kernel reuses...
+    Kernel();
+
+    // Variables...
+    const chrono::nanoseconds Minimum =
+        chrono::milliseconds(Parameters.m_MinimumMilliseconds);
+    size_t              Batch       = 1;
+    size_t              Calls       = 0;
+    chrono::nanoseconds Elapsed(0);
+
+    // Start counting allocations...
+    const size_t AllocationsBefore = AllocationCount.load(memory_order_relaxed);
+
+    // Keep doubling the batch until enough time has elapsed, so checking the
+    //  clock does not dominate the cheapest kernels...
+    while(Elapsed < Minimum)
+    {
+        // Time the batch...
+        const chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+        for(size_t Index = 0; Index < Batch; ++Index)
+            Kernel();
+        Elapsed += chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - Start);
+
+        // Account for it and grow the next...
+        Calls += Batch;
+        Batch *= 2;
+    }
+
+    // Stop counting allocations...
+    const size_t Allocations =
+        AllocationCount.load(memory_order_relaxed) - AllocationsBefore;
+
+    // Report...
+    const double NanosecondsPerCall =
+        static_cast<double>(Elapsed.count()) / Calls;
+    cout << left << setw(34) << Name << right
+         << setw(10) << Calls
+         << fixed
+         << setw(16) << setprecision(1) << NanosecondsPerCall
+         << setw(12) << setprecision(3) << NanosecondsPerCall / BytesPerCall
+         << setw(14) << setprecision(2) << static_cast<double>(Allocations) / Calls
+         << endl;
+}
+
+// Run every kernel on the given image band, already loaded...
+static void RunKernels(
+    const BenchmarkParametersType &Parameters,
+    BenchmarkBand &Band)
+{
+    // Variables...
+    VicarImageBand::RawBandDataType RawBandData;
+    VicarImageBand::RawBandDataType TransformedRawBandData;
+    vector<LogicalRecord>           Records;
+    string                          Extracted;
+
+    // Read the raw band data once as the input for the other kernels...
+    if(!Band.GetRawBandData(RawBandData))
+        throw string(_("could not read raw band data: ")) + Band.GetErrorMessage();
+    const size_t Width      = Band.GetOriginalWidth();
+    const size_t Height     = Band.GetOriginalHeight();
+    const size_t BandBytes  = Width * Height;
+
+    // Open the band for the label kernels...
+    ZZipFileDescriptor FileDescriptor(Band.Open());
+    if(!FileDescriptor.IsGood())
+        throw string(_("could not open image band: ")) + Band.GetInputFileName();
+
+    // Decode the labels of the first physical record to parse them again...
+    zzip_seek(FileDescriptor, Band.GetPhaseOffsetRequired(), SEEK_SET);
+    for(size_t Index = 0; Index < 5; ++Index)
+    {
+        // Decode...
+        Records.push_back(LogicalRecord(FileDescriptor));
+
+        // Stop at the last label...
+        if(Records.back().IsLastLabel())
+            break;
+    }
+    const size_t LabelBytes = Records.size() * LOGICAL_RECORD_SIZE;
+
+    // Summarize the band...
+    cout << _("image band ") << Band.GetInputFileNameOnly() << " ("
+         << Width << "x" << Height << ", "
+         << Band.GetDiodeBandTypeFriendlyString() << ", "
+         << Records.size() << _(" labels in first physical record)") << endl
+         << endl
+         << left << setw(34) << _("kernel") << right
+         << setw(10) << _("calls")
+         << setw(16) << _("ns/call")
+         << setw(12) << _("ns/byte")
+         << setw(14) << _("allocs/call") << endl;
+
+    // Logical record decoding of the labels, including the read...
+    RunKernel(Parameters, "logical_record.decode", LabelBytes, [&]()
+    {
+        LogicalRecord Record;
+        zzip_seek(FileDescriptor, Band.GetPhaseOffsetRequired(), SEEK_SET);
+        for(size_t Index = 0; Index < Records.size(); ++Index)
+            Record << FileDescriptor;
+    });
+
+    // Converting decoded labels to strings, plain and trimmed...
+    RunKernel(Parameters, "logical_record.get_string", LabelBytes, [&]()
+    {
+        for(size_t Index = 0; Index < Records.size(); ++Index)
+            Records[Index].GetString();
+    });
+    RunKernel(Parameters, "logical_record.get_string_trimmed", LabelBytes, [&]()
+    {
+        for(size_t Index = 0; Index < Records.size(); ++Index)
+            Records[Index].GetString(true, 2);
+    });
+
+    // Tokenizing the header record to select and run a basic metadata
+    //  parser, then the remaining labels for extended metadata...
+    RunKernel(Parameters, "header.parse_basic", LOGICAL_RECORD_SIZE, [&]()
+    {
+        zzip_seek(FileDescriptor, Band.GetPhaseOffsetRequired(), SEEK_SET);
+        Band.ParseBasicMetadata(FileDescriptor);
+    });
+    RunKernel(Parameters, "header.parse_extended", LabelBytes, [&]()
+    {
+        for(size_t Index = 0; Index < Records.size(); ++Index)
+            Band.ParseExtendedMetadata(Records[Index], Index);
+    });
+
+    // Reading the raw band data while accumulating its statistics...
+    RunKernel(Parameters, "raw_band.read", BandBytes, [&]()
+    {
+        Band.GetRawBandData(TransformedRawBandData);
+    });
+
+    // Geometric transformations...
+    RunKernel(Parameters, "transform.mirror_diagonal", BandBytes, [&]()
+    {
+        BenchmarkBand::MirrorDiagonal(RawBandData, TransformedRawBandData);
+    });
+    RunKernel(Parameters, "transform.mirror_left_right", BandBytes, [&]()
+    {
+        BenchmarkBand::MirrorLeftRight(RawBandData, TransformedRawBandData);
+    });
+    RunKernel(Parameters, "transform.mirror_top_bottom", BandBytes, [&]()
+    {
+        BenchmarkBand::MirrorTopBottom(RawBandData, TransformedRawBandData);
+    });
+    RunKernel(Parameters, "transform.rotate_90", BandBytes, [&]()
+    {
+        BenchmarkBand::Rotate(VicarImageBand::Rotate90, RawBandData, TransformedRawBandData);
+    });
+    RunKernel(Parameters, "transform.rotate_180", BandBytes, [&]()
+    {
+        BenchmarkBand::Rotate(VicarImageBand::Rotate180, RawBandData, TransformedRawBandData);
+    });
+    RunKernel(Parameters, "transform.rotate_270", BandBytes, [&]()
+    {
+        BenchmarkBand::Rotate(VicarImageBand::Rotate270, RawBandData, TransformedRawBandData);
+    });
+
+    // Optical character recognition at each rotation, with the cache cleared
+    //  so every pass is performed in full...
+    const VicarImageBand::RotationType Rotations[] =
+    {
+        VicarImageBand::None,
+        VicarImageBand::Rotate90,
+        VicarImageBand::Rotate180,
+        VicarImageBand::Rotate270
+    };
+    for(size_t Index = 0; Index < sizeof(Rotations) / sizeof(Rotations[0]); ++Index)
+    {
+        // Transform the band as ExamineImageVisually would, unless upright...
+        const VicarImageBand::RotationType Rotation = Rotations[Index];
+        VicarImageBand::RawBandDataType RotatedRawBandData;
+        if(Rotation != VicarImageBand::None)
+            BenchmarkBand::Rotate(Rotation, RawBandData, RotatedRawBandData);
+        const VicarImageBand::RawBandDataType &OCRInput =
+            (Rotation == VicarImageBand::None) ? RawBandData : RotatedRawBandData;
+
+        // Recognize...
+        RunKernel(
+            Parameters,
+            string("ocr.extract_") + VicarImageBand::GetRotationTag(Rotation),
+            BandBytes,
+            [&]()
+        {
+            Band.ClearOCRCache();
+            Band.ExtractOCR(OCRInput, Extracted, Rotation);
+        });
+    }
+
+    // Encoding as grayscale and as a colour composite of the same plane...
+    NullStreamBuffer    NullBuffer;
+    ostream             NullStream(&NullBuffer);
+    ImageEncoder::PlaneListType GrayscalePlanes(1, &RawBandData);
+    ImageEncoder::PlaneListType ColourPlanes(3, &RawBandData);
+    RunKernel(Parameters, "png.encode_grayscale", BandBytes, [&]()
+    {
+        PngEncoder Encoder(NullStream);
+        Encoder.Encode(GrayscalePlanes, Width, Height);
+    });
+    RunKernel(Parameters, "png.encode_rgb", BandBytes * 3, [&]()
+    {
+        PngEncoder Encoder(NullStream);
+        Encoder.Encode(ColourPlanes, Width, Height);
+    });
+}
+
+// Enumerator of long command line option identifiers...
+enum option_long_enum
+{
+    option_long_help = 256, /* To ensure no clashes with short option char identifiers */
+    option_long_kernel,
+    option_long_maximum_size,
+    option_long_minimum_size,
+    option_long_seed,
+    option_long_time
+};
+
+// Command line option structure...
+static option CommandLineLongOptions[] =
+{
+    {"help",                    no_argument,        NULL,   option_long_help},
+    {"kernel",                  required_argument,  NULL,   option_long_kernel},
+    {"maximum-size",            required_argument,  NULL,   option_long_maximum_size},
+    {"minimum-size",            required_argument,  NULL,   option_long_minimum_size},
+    {"seed",                    required_argument,  NULL,   option_long_seed},
+    {"time",                    required_argument,  NULL,   option_long_time},
+
+    // End of array marker...
+    {0, 0, 0, 0}
+};
+
+// Entry point...
+int main(int ArgumentCount, char *Arguments[])
+{
+    // Variables...
+    BenchmarkParametersType         Parameters;
+    SyntheticCorpus::ParametersType CorpusParameters;
+    int OptionCharacter = '\x0';
+    int OptionIndex     = 0;
+
+    // A handful of camera events at about the size of real ones is enough to
+    //  find a band with overlays, all on one tape of loose files...
+    CorpusParameters.m_CameraEvents     = 4;
+    CorpusParameters.m_FilesPerTape     = 999;
+    CorpusParameters.m_MaximumDimension = 1152;
+    CorpusParameters.m_MinimumDimension = 512;
+    CorpusParameters.m_ZippedPercent    = 0;
+
+    // Keep processing each option until there are none left...
+    while((OptionCharacter = getopt_long(
+        ArgumentCount, Arguments, "", CommandLineLongOptions, &OptionIndex)) != -1)
+    {
+        // Which option?
+        switch(OptionCharacter)
+        {
+            // Help...
+            case option_long_help: { ShowHelp(); exit(EXIT_SUCCESS); }
+
+            // Kernels to run...
+            case option_long_kernel:
+            { assert(optarg); Parameters.m_KernelPrefix = optarg; break; }
+
+            // Range of dimensions...
+            case option_long_maximum_size:
+            { assert(optarg); CorpusParameters.m_MaximumDimension = atoi(optarg); break; }
+            case option_long_minimum_size:
+            { assert(optarg); CorpusParameters.m_MinimumDimension = atoi(optarg); break; }
+
+            // Seed...
+            case option_long_seed:
+            { assert(optarg); CorpusParameters.m_Seed = strtoul(optarg, NULL, 10); break; }
+
+            // Minimum time per kernel...
+            case option_long_time:
+            { assert(optarg); Parameters.m_MinimumMilliseconds = atoi(optarg); break; }
+
+            // get_opt_long already dumped an error message...
+            default:
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    // No arguments expected...
+    if(optind != ArgumentCount)
+    {
+        ShowHelp();
+        exit(EXIT_FAILURE);
+    }
+
+    // Console the bands being loaded report to, with all but errors silenced
+    //  so messages are neither mixed into the report nor timed with kernels...
+    ProcessConsole::CreateSingleton();
+    ProcessConsole::GetInstance().SetChannelEnabled(Console::Info, false);
+    ProcessConsole::GetInstance().SetChannelEnabled(Console::Verbose, false);
+    ProcessConsole::GetInstance().SetChannelEnabled(Console::Warning, false);
+
+    // Kernels read the raw band data as stored...
+    Options BenchmarkOptions;
+    BenchmarkOptions.SetAutoRotate(false);
+    ExtractionContext Context(BenchmarkOptions, ProcessConsole::GetInstance());
+
+    // Scratch directory for the synthetic corpus...
+    char ScratchTemplate[] = "/tmp/viking-benchmark-kernels-XXXXXX";
+    if(!mkdtemp(ScratchTemplate))
+    {
+        cerr << _("could not create scratch directory") << endl;
+        exit(EXIT_FAILURE);
+    }
+    const string ScratchDirectory = string(ScratchTemplate) + "/";
+
+    // Variables...
+    vector<string>  Tapes;
+    vector<string>  Files;
+    int             ExitCode = EXIT_SUCCESS;
+
+    // Generate the corpus and run the kernels on a band of it...
+    try
+    {
+        // Generate...
+        SyntheticCorpus Corpus(ScratchDirectory, CorpusParameters);
+        Corpus.Generate();
+
+        // Only the tapes are wanted, not the manifest written alongside...
+        unlink((ScratchDirectory + SYNTHETIC_CORPUS_MANIFEST).c_str());
+
+        // Find all of the image bands on each tape...
+        ListDirectory(ScratchDirectory, Tapes);
+        for(size_t Index = 0; Index < Tapes.size(); ++Index)
+            ListDirectory(Tapes[Index] + "/", Files);
+
+        // Pick the first band with overlays detected, since that is what
+        //  real bands have, or otherwise the first that loads at all...
+        string SelectedFile;
+        for(size_t Index = 0; Index < Files.size(); ++Index)
+        {
+            // Load it...
+            BenchmarkBand Candidate(Context, Files[Index]);
+            Candidate.Load();
+
+            // Unusable...
+            if(!Candidate.IsOk())
+                continue;
+
+            // The first that loads at all will do if nothing better comes...
+            if(SelectedFile.empty())
+                SelectedFile = Files[Index];
+
+            // Overlays were detected, so look no further...
+            if(Candidate.IsAxisPresent() || Candidate.IsFullHistogramPresent())
+            {
+                SelectedFile = Files[Index];
+                break;
+            }
+        }
+
+        // Nothing loaded...
+        if(SelectedFile.empty())
+            throw string(_("no synthetic image band could be loaded"));
+
+        // Load it again and run the kernels on it...
+        BenchmarkBand Band(Context, SelectedFile);
+        Band.Load();
+        RunKernels(Parameters, Band);
+    }
+
+        // Failed...
+        catch(const string &Reason)
+        {
+            // Alert user...
+            cerr << Reason << endl;
+            ExitCode = EXIT_FAILURE;
+        }
+
+    // Remove the scratch directory...
+    for(size_t Index = 0; Index < Files.size(); ++Index)
+        unlink(Files[Index].c_str());
+    for(size_t Index = 0; Index < Tapes.size(); ++Index)
+        rmdir(Tapes[Index].c_str());
+    rmdir(ScratchTemplate);
+
+    // Cleanup...
+    ProcessConsole::DestroySingleton();
+
+    // Done...
+    return ExitCode;
+}
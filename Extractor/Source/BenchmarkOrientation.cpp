@@ -0,0 +1,345 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "Console.h"
+    #include "ExtractionContext.h"
+    #include "Options.h"
+    #include "VicarImageBand.h"
+
+    // Standard C++ / POSIX system headers...
+    #include <algorithm>
+    #include <cassert>
+    #include <chrono>
+    #include <cstdlib>
+    #include <fstream>
+    #include <iomanip>
+    #include <iostream>
+    #include <sstream>
+    #include <string>
+    #include <vector>
+    #include <getopt.h>
+
+// Using the standard namespace...
+using namespace std;
+
+// What the extractor should find in an image band, as listed in a manifest...
+struct ExpectedBandType
+{
+    // Path to the band, or an archive member as archive.zip:/member...
+    string              m_Path;
+
+    // Counterclockwise rotation in degrees needed to make it upright...
+    size_t              m_Rotation;
+
+    // Large histogram and axis present...
+    bool                m_Histogram;
+    bool                m_Axis;
+};
+
+// Running totals of how well and how quickly orientation was detected...
+struct ResultsType
+{
+    // Constructor initializer...
+    ResultsType()
+        : m_AllCorrect(0),
+          m_AxisCorrect(0),
+          m_Bands(0),
+          m_HistogramCorrect(0),
+          m_MaximumMilliseconds(0.0),
+          m_OCRPasses(0),
+          m_RotationCorrect(0),
+          m_TotalMilliseconds(0.0)
+    { }
+
+    // Bands with every field, and with each field, detected correctly...
+    size_t              m_AllCorrect;
+    size_t              m_AxisCorrect;
+
+    // Bands examined...
+    size_t              m_Bands;
+
+    // Bands with the large histogram detected correctly...
+    size_t              m_HistogramCorrect;
+
+    // Slowest band to load...
+    double              m_MaximumMilliseconds;
+
+    // OCR passes performed over all bands...
+    size_t              m_OCRPasses;
+
+    // Bands with the rotation detected correctly...
+    size_t              m_RotationCorrect;
+
+    // Time spent loading all bands...
+    double              m_TotalMilliseconds;
+};
+
+// Show help...
+static void ShowHelp()
+{
+    cout <<   "Usage: viking-benchmark-orientation [options] manifest\n"
+         <<   "      --help\n"
+         << _("\
+                              Show this help.\n")
+         <<   "      --verbose\n"
+         << _("\
+                              Report every image band, not just those detected\n\
+                              incorrectly.\n\n")
+
+         << _("\
+Loads every image band listed in a manifest, such as the one\n\
+viking-synthesize-corpus writes, and compares the rotation, large histogram,\n\
+and axis the extractor detects against the ground truth, reporting the\n\
+accuracy of each alongside the OCR passes and time spent per band. Each line\n\
+of the manifest is a path relative to it, the counterclockwise rotation in\n\
+degrees needed to make the band upright, and 0 or 1 for whether a large\n\
+histogram and an axis are present. Blank lines and those beginning with # are\n\
+ignored.\n");
+}
+
+// Read the ground truth of every band listed in a manifest, or throw an
+//  error...
+static void ReadManifest(
+    const string &ManifestFile,
+    vector<ExpectedBandType> &ExpectedBands)
+{
+    // Open the manifest...
+    ifstream Manifest(ManifestFile.c_str());
+    if(!Manifest)
+        throw string(_("could not open manifest ")) + ManifestFile;
+
+    // Paths are relative to the directory the manifest is in...
+    const size_t Separator = ManifestFile.find_last_of('/');
+    const string Directory =
+        (Separator == string::npos) ? string() : ManifestFile.substr(0, Separator + 1);
+
+    // Parse each line...
+    string Line;
+    for(size_t LineNumber = 1; getline(Manifest, Line); ++LineNumber)
+    {
+        // Skip blank lines and comments...
+        const size_t First = Line.find_first_not_of(" \t\r");
+        if(First == string::npos || Line[First] == '#')
+            continue;
+
+        // Parse the fields...
+        ExpectedBandType    Expected;
+        int                 Histogram   = 0;
+        int                 Axis        = 0;
+        istringstream       Fields(Line);
+        if(!(Fields >> Expected.m_Path >> Expected.m_Rotation >> Histogram >> Axis) ||
+           (Expected.m_Rotation % 90) != 0 || Expected.m_Rotation >= 360 ||
+           Histogram < 0 || Histogram > 1 || Axis < 0 || Axis > 1)
+        {
+            stringstream Error;
+            Error << _("malformed manifest line ") << LineNumber;
+            throw Error.str();
+        }
+        Expected.m_Histogram    = (Histogram == 1);
+        Expected.m_Axis         = (Axis == 1);
+
+        // Resolve relative paths...
+        if(Expected.m_Path[0] != '/')
+            Expected.m_Path = Directory + Expected.m_Path;
+
+        // Add it...
+        ExpectedBands.push_back(Expected);
+    }
+
+    // Nothing to examine...
+    if(ExpectedBands.empty())
+        throw string(_("manifest lists no image bands"));
+}
+
+// Load a band, compare what was detected against the ground truth, and
+//  accumulate the results...
+static void ExamineBand(
+    const ExtractionContext &Context,
+    const ExpectedBandType &Expected,
+    const bool Verbose,
+    ResultsType &Results)
+{
+    // Load it, timing everything the extractor does to examine it...
+    VicarImageBand Band(Context, Expected.m_Path);
+    const chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+    Band.Load();
+    const double Milliseconds =
+        chrono::duration<double, milli>(chrono::steady_clock::now() - Start).count();
+
+    // What was detected. A band that failed to load detected nothing...
+    const bool      Ok          = Band.IsOk();
+    const size_t    Rotation    = Ok ? static_cast<size_t>(Band.GetRotation()) * 90 : 0;
+    const bool      Histogram   = Ok && Band.IsFullHistogramPresent();
+    const bool      Axis        = Ok && Band.IsAxisPresent();
+
+    // Compare...
+    const bool RotationCorrect  = Ok && (Rotation == Expected.m_Rotation);
+    const bool HistogramCorrect = Ok && (Histogram == Expected.m_Histogram);
+    const bool AxisCorrect      = Ok && (Axis == Expected.m_Axis);
+    const bool AllCorrect       = RotationCorrect && HistogramCorrect && AxisCorrect;
+
+    // Accumulate...
+    ++Results.m_Bands;
+    Results.m_AllCorrect            += AllCorrect;
+    Results.m_AxisCorrect           += AxisCorrect;
+    Results.m_HistogramCorrect      += HistogramCorrect;
+    Results.m_RotationCorrect       += RotationCorrect;
+    Results.m_OCRPasses             += Band.GetOCRPasses();
+    Results.m_TotalMilliseconds     += Milliseconds;
+    Results.m_MaximumMilliseconds    = max(Results.m_MaximumMilliseconds, Milliseconds);
+
+    // Report it if wrong or asked to...
+    if(AllCorrect && !Verbose)
+        return;
+    cout << (AllCorrect ? "ok    " : "wrong ") << Expected.m_Path;
+    if(!Ok)
+        cout << ": " << Band.GetErrorMessage() << endl;
+    else
+        cout << ": rotation " << Rotation << " (" << Expected.m_Rotation << ")"
+             << ", histogram " << Histogram << " (" << Expected.m_Histogram << ")"
+             << ", axis " << Axis << " (" << Expected.m_Axis << ")"
+             << ", " << Band.GetOCRPasses() << " OCR passes, "
+             << fixed << setprecision(1) << Milliseconds << " ms" << endl;
+}
+
+// Report the accuracy and cost over every band...
+static void ReportResults(const ResultsType &Results)
+{
+    // Percentage of bands...
+    const double Bands = static_cast<double>(Results.m_Bands);
+    auto Percent = [Bands](const size_t Count) { return 100.0 * Count / Bands; };
+
+    // Report...
+    cout << fixed << setprecision(1)
+         << _("bands:              ") << Results.m_Bands << endl
+         << _("rotation correct:   ") << Percent(Results.m_RotationCorrect) << " %" << endl
+         << _("histogram correct:  ") << Percent(Results.m_HistogramCorrect) << " %" << endl
+         << _("axis correct:       ") << Percent(Results.m_AxisCorrect) << " %" << endl
+         << _("all correct:        ") << Percent(Results.m_AllCorrect) << " %" << endl
+         << setprecision(2)
+         << _("OCR passes:         ") << Results.m_OCRPasses
+         << " (" << Results.m_OCRPasses / Bands << _(" per band)") << endl
+         << setprecision(1)
+         << _("time per band:      ") << Results.m_TotalMilliseconds / Bands
+         << _(" ms mean, ") << Results.m_MaximumMilliseconds << _(" ms max") << endl;
+}
+
+// Enumerator of long command line option identifiers...
+enum option_long_enum
+{
+    option_long_help = 256, /* To ensure no clashes with short option char identifiers */
+    option_long_verbose
+};
+
+// Command line option structure...
+static option CommandLineLongOptions[] =
+{
+    {"help",                    no_argument,        NULL,   option_long_help},
+    {"verbose",                 no_argument,        NULL,   option_long_verbose},
+
+    // End of array marker...
+    {0, 0, 0, 0}
+};
+
+// Entry point...
+int main(int ArgumentCount, char *Arguments[])
+{
+    // Variables...
+    vector<ExpectedBandType>    ExpectedBands;
+    ResultsType                 Results;
+    bool                        Verbose         = false;
+    int                         OptionCharacter = '\x0';
+    int                         OptionIndex     = 0;
+    int                         ExitCode        = EXIT_SUCCESS;
+
+    // Keep processing each option until there are none left...
+    while((OptionCharacter = getopt_long(
+        ArgumentCount, Arguments, "", CommandLineLongOptions, &OptionIndex)) != -1)
+    {
+        // Which option?
+        switch(OptionCharacter)
+        {
+            // Help...
+            case option_long_help: { ShowHelp(); exit(EXIT_SUCCESS); }
+
+            // Report every band...
+            case option_long_verbose: { Verbose = true; break; }
+
+            // get_opt_long already dumped an error message...
+            default:
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    // Exactly one manifest expected...
+    if(optind + 1 != ArgumentCount)
+    {
+        ShowHelp();
+        exit(EXIT_FAILURE);
+    }
+
+    // Console the bands being loaded report to, with all but errors silenced
+    //  so messages are neither mixed into the report nor timed with bands...
+    ProcessConsole::CreateSingleton();
+    ProcessConsole::GetInstance().SetChannelEnabled(Console::Info, false);
+    ProcessConsole::GetInstance().SetChannelEnabled(Console::Verbose, false);
+    ProcessConsole::GetInstance().SetChannelEnabled(Console::Warning, false);
+
+    // Rotation is only reported when automatic rotation is on...
+    Options BenchmarkOptions;
+    BenchmarkOptions.SetAutoRotate(true);
+    ExtractionContext Context(BenchmarkOptions, ProcessConsole::GetInstance());
+
+    // Examine every band in the manifest and report...
+    try
+    {
+        // Read the ground truth...
+        ReadManifest(Arguments[optind], ExpectedBands);
+
+        // Examine each band...
+        for(size_t Index = 0; Index < ExpectedBands.size(); ++Index)
+            ExamineBand(Context, ExpectedBands[Index], Verbose, Results);
+
+        // Report...
+        ReportResults(Results);
+    }
+
+        // Failed...
+        catch(const string &Reason)
+        {
+            // Alert user...
+            cerr << Reason << endl;
+            ExitCode = EXIT_FAILURE;
+        }
+
+    // Cleanup...
+    ProcessConsole::DestroySingleton();
+
+    // Done...
+    return ExitCode;
+}
+
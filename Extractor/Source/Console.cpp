@@ -33,14 +33,17 @@
     #include <cstdlib>
     #include <cstring>
     #include <cerrno>
+    #include <utility>
 
 // Using the standard namespace...
 using namespace std;
 
 // Default constructor...
 Console::Console()
-    : m_UseColours(true),
-      m_UseCurrentFileName(true)
+    : m_EnabledChannels((1u << (Verbose + 1)) - 1),
+      m_UseColours(true),
+      m_UseCurrentFileName(true),
+      m_Asynchronous(false)
 {
     // Initialize i18n...
 
@@ -92,50 +95,56 @@ Console::Console()
     cout.precision(1);
 }
 
-// Get an output stream, if enabled, or dummy stream otherwise...
+// Get the calling thread's output stream, if enabled, or dummy stream
+//  otherwise...
 ostream &Console::Message(const Console::ChannelID ID)
 {
+    // Not enabled. Return the null stream...
+    if(!IsChannelEnabled(ID))
+        return m_DummyOutputStream;
+
     // Lookup the channel ID...
     ChannelMapType::const_iterator Iterator = m_ChannelMap.find(ID);
 
     // Should always be found...
     assert(Iterator != m_ChannelMap.end());
 
-    // Reset the terminal settings...
-    if(m_UseColours)
-        cout << "\033[0m";
-    
     // Get the channel structure...
-    Channel &RequestedChannel = *(Iterator->second);
+    const Channel &RequestedChannel = *(Iterator->second);
 
-        // Not enabled. Return the null stream...
-        if(!RequestedChannel.m_Enabled)
-            return m_DummyOutputStream;
+    // Get the calling thread's context and hand over whatever the last
+    //  message left without flushing, like a summary ending in \r only...
+    ThreadContext &Context = GetThreadContext();
+    Context.m_Buffer.Commit();
 
-    // Flush the last message, if this isn't the verbose stream which is noisy...
-    if(ID != Verbose)
-        cout.flush();
+    // Flush this message once committed, unless it's the noisy verbose
+    //  stream...
+    Context.m_Buffer.m_Flush = (ID != Verbose);
 
-    // Set to the requested foreground colour...
+    // Reset the terminal settings and set to the requested foreground
+    //  colour...
     if(m_UseColours)
-        cout << "\033[1;" << RequestedChannel.m_ForegroundColour << "m";
+        Context.m_Stream 
+            << "\033[0m\033[1;" 
+            << to_string(static_cast<int>(RequestedChannel.m_ForegroundColour)) 
+            << "m";
     
     // Begin message with current file name, if known, and enabled...
-    if(!m_CurrentFileName.empty() && m_UseCurrentFileName)
-        cout << m_CurrentFileName << ": ";
+    if(!Context.m_CurrentFileName.empty() && m_UseCurrentFileName)
+        Context.m_Stream << Context.m_CurrentFileName << ": ";
     
     // Prepend client's message with channel prefix...
-    cout << RequestedChannel.m_Prefix;
+    Context.m_Stream << RequestedChannel.m_Prefix;
 
     // Now return the stream...
-    return cout;
+    return Context.m_Stream;
 }
 
 // Get an output stream, if enabled, or dummy stream otherwise...
 ostream &Message(const Console::ChannelID ID)
 {
     // Return it...
-    return Console::GetInstance().Message(ID);
+    return ProcessConsole::GetInstance().Message(ID);
 }
 
 // Enable or suppress a given channel...
@@ -146,22 +155,173 @@ void Console::SetChannelEnabled(const Console::ChannelID ID, const bool Enabled)
 
     // Should always be found...
     assert(Iterator != m_ChannelMap.end());
+    (void) Iterator;
     
     // Set the channel enabled bit accordingly...
-    Channel &RequestedChannel  = *(Iterator->second);
-    RequestedChannel.m_Enabled = Enabled;
+    if(Enabled)
+        m_EnabledChannels |= (1u << ID);
+    else
+        m_EnabledChannels &= ~(1u << ID);
+}
+
+// Get the calling thread's context, creating it if it has none yet...
+Console::ThreadContext &Console::GetThreadContext()
+{
+    // Lock the map...
+    lock_guard<mutex> Lock(m_ThreadContextMutex);
+
+    // Lookup the calling thread...
+    ThreadContext *&Context = m_ThreadContextMap[this_thread::get_id()];
+
+    // First message from this thread, so create its context with the same
+    //  default floating point settings for every thread...
+    if(!Context)
+    {
+        Context = new ThreadContext(*this);
+        Context->m_Stream.setf(ios::fixed, ios::floatfield);
+        Context->m_Stream.precision(1);
+    }
+
+    // Done...
+    return *Context;
+}
+
+// Hand whatever has been composed to the console...
+void Console::LineBuffer::Commit()
+{
+    // Nothing composed...
+    if(pptr() == pbase())
+        return;
+
+    // Hand it over and start composing the next one...
+    m_Owner.Write(str(), m_Flush);
+    str(string());
+}
+
+// Hand complete lines to a writer thread instead of writing them directly, or
+//  stop doing so after writing out whatever is queued...
+void Console::SetAsynchronous(const bool Asynchronous)
+{
+    // Lock the queue...
+    unique_lock<mutex> Lock(m_QueueMutex);
+
+    // Already as requested...
+    if(m_Asynchronous == Asynchronous)
+        return;
+
+    // Start the writer thread...
+    if(Asynchronous)
+    {
+        m_Asynchronous = true;
+        m_Writer = thread(&Console::WriterThread, this);
+        return;
+    }
+
+    // Tell the writer thread to stop once it has written out what's queued
+    //  and wait for it. Anything written meanwhile goes directly...
+    m_Asynchronous = false;
+    m_QueueWake.notify_one();
+    Lock.unlock();
+    m_Writer.join();
+}
+
+// Set the current file name of the calling thread, which precedes its
+//  messages...
+void Console::SetCurrentFileName(const string &CurrentFileName)
+{
+    // Set it...
+    GetThreadContext().m_CurrentFileName = CurrentFileName;
+}
+
+// Write a complete message to standard output, or queue it for the writer
+//  thread if asynchronous...
+void Console::Write(const string &Text, const bool Flush)
+{
+    // Queue it if asynchronous...
+    {
+        lock_guard<mutex> Lock(m_QueueMutex);
+        if(m_Asynchronous)
+        {
+            m_QueuedMessages.push_back(make_pair(Text, Flush));
+            m_QueueWake.notify_one();
+            return;
+        }
+    }
+
+    // Otherwise write it directly...
+    lock_guard<mutex> Lock(m_OutputMutex);
+    cout << Text;
+    if(Flush)
+        cout.flush();
 }
 
-// Deconstructor...
+// Body of the writer thread. Writes out whatever is queued until told to stop
+//  and nothing is left...
+void Console::WriterThread()
+{
+    // Lock the queue...
+    unique_lock<mutex> Lock(m_QueueMutex);
+
+    // Keep writing until told to stop with nothing left queued...
+    while(true)
+    {
+        // Wait for something to be queued or to be told to stop...
+        while(m_QueuedMessages.empty() && m_Asynchronous)
+            m_QueueWake.wait(Lock);
+
+        // Told to stop and nothing left...
+        if(m_QueuedMessages.empty())
+            break;
+
+        // Take whatever is queued...
+        deque<pair<string, bool> > Messages;
+        Messages.swap(m_QueuedMessages);
+
+        // Write without holding the lock so callers never wait on the
+        //  terminal, flushing once for the whole batch if any asked to...
+        Lock.unlock();
+        {
+            lock_guard<mutex> OutputLock(m_OutputMutex);
+            bool Flush = false;
+            for(deque<pair<string, bool> >::const_iterator Iterator = Messages.begin();
+                Iterator != Messages.end();
+              ++Iterator)
+            {
+                cout << Iterator->first;
+                Flush = Flush || Iterator->second;
+            }
+            if(Flush)
+                cout.flush();
+        }
+        Lock.lock();
+    }
+}
+
+// Deconstructor writes out whatever hasn't been yet...
 Console::~Console()
 {
+    // Hand over whatever every thread left without flushing...
+    for(ThreadContextMapType::iterator Iterator = m_ThreadContextMap.begin();
+        Iterator != m_ThreadContextMap.end();
+      ++Iterator)
+        Iterator->second->m_Buffer.Commit();
+
+    // Wait for the writer thread to write out the rest...
+    SetAsynchronous(false);
+    cout.flush();
+
+    // Clear the thread context map...
+    for(ThreadContextMapType::iterator Iterator = m_ThreadContextMap.begin();
+        Iterator != m_ThreadContextMap.end();
+      ++Iterator)
+        delete Iterator->second;
+    m_ThreadContextMap.clear();
+
     // Clear the channel map...
     for(ChannelMapType::iterator Iterator = m_ChannelMap.begin();
         Iterator != m_ChannelMap.end();
       ++Iterator)
-    {
         delete Iterator->second;
-        m_ChannelMap.erase(Iterator);
-    }
+    m_ChannelMap.clear();
 }
 
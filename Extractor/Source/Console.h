@@ -29,8 +29,15 @@
     #include "ExplicitSingleton.h"
 
     // System headers...
+    #include <atomic>
+    #include <condition_variable>
+    #include <deque>
     #include <ostream>
     #include <map>
+    #include <mutex>
+    #include <sstream>
+    #include <string>
+    #include <thread>
     #include <clocale>
 
     // i18n...
@@ -38,13 +45,21 @@
     #define _(str) gettext (str)
     #define N_(str) gettext_noop (str)
 
-// Console explicit singleton class...
-class Console : public ExplicitSingleton<Console>
-{
-    // Because we are a singleton, only ExplicitSingleton can control our 
-    //  creation...
-    friend class ExplicitSingleton<Console>;
+// Write a message to the given channel of a console. Unlike calling Message()
+//  directly, nothing streamed into it is even evaluated when the channel is
+//  disabled, so muted messages in hot loops cost only the test...
+#define CONSOLE_MESSAGE(TargetConsole, ID) \
+    !(TargetConsole).IsChannelEnabled(ID) ? \
+        static_cast<void>(0) : Console::MessageTerminator() & (TargetConsole).Message(ID)
 
+// Console class. Each extraction writes to the one of its context, while the
+//  process console below takes diagnostics belonging to none of them. Each
+//  thread composes its messages in a buffer of its own which is only handed
+//  to standard output a whole line at a time, either directly or, if
+//  asynchronous, through a writer thread so the caller never waits on the
+//  terminal...
+class Console
+{
     // Public types...
     public:
 
@@ -58,12 +73,30 @@ class Console : public ExplicitSingleton<Console>
             Verbose
         }ChannelID;
 
+        // Gives CONSOLE_MESSAGE() a void expression whichever way it goes...
+        struct MessageTerminator
+        {
+            void operator&(std::ostream &) { }
+        };
+
     // Public methods...
     public:
 
-        // Get an output stream, if enabled, or dummy stream otherwise...
+        // Default constructor...
+        Console();
+
+        // Check whether a given channel is enabled...
+        bool IsChannelEnabled(const ChannelID ID) const
+            { return (m_EnabledChannels.load(std::memory_order_relaxed) >> ID) & 1; }
+
+        // Get the calling thread's output stream, if enabled, or dummy stream
+        //  otherwise...
         std::ostream &Message(const Console::ChannelID ID);
 
+        // Hand complete lines to a writer thread instead of writing them
+        //  directly, or stop doing so after writing out whatever is queued...
+        void SetAsynchronous(const bool Asynchronous = true);
+
         // Enable or disable the use of VT100 ANSI colours...
         void SetUseColours(const bool UseColours = true) 
             { m_UseColours = UseColours; }
@@ -75,18 +108,12 @@ class Console : public ExplicitSingleton<Console>
         // Enable or suppress a given channel...
         void SetChannelEnabled(const ChannelID ID, const bool Enabled);
 
-        // Set the current file name...
-        void SetCurrentFileName(const std::string &CurrentFileName)
-            { m_CurrentFileName = CurrentFileName; }
+        // Set the current file name of the calling thread, which precedes
+        //  its messages...
+        void SetCurrentFileName(const std::string &CurrentFileName);
 
-    // Private methods...
-    private:
-
-        // Default constructor...
-        Console();
-        
-        // Deconstructor...
-       ~Console();
+        // Deconstructor writes out whatever hasn't been yet...
+        virtual ~Console();
 
     // Protected types...
     protected:
@@ -111,14 +138,10 @@ class Console : public ExplicitSingleton<Console>
             // Constructor initializer...
             Channel(const ForegroundColour ForeColour,
                     const std::string &Prefix)
-                : m_Enabled(true),
-                  m_ForegroundColour(ForeColour),
+                : m_ForegroundColour(ForeColour),
                   m_Prefix(Prefix)
             { }
 
-            // Enabled flag...
-            bool                m_Enabled;
-
             // Foreground colour...
             ForegroundColour    m_ForegroundColour;
             
@@ -135,26 +158,132 @@ class Console : public ExplicitSingleton<Console>
             NullOutputStream() : std::ostream(0) { }
         };
 
+        // Buffer a thread's message is composed in, handed to the console
+        //  whenever its stream is flushed or the thread starts another...
+        class LineBuffer : public std::stringbuf
+        {
+            // Public methods...
+            public:
+
+                // Constructor...
+                LineBuffer(Console &Owner)
+                    : m_Flush(false), m_Owner(Owner)
+                { }
+
+                // Hand whatever has been composed to the console...
+                void Commit();
+
+                // Flush standard output once committed, as every channel but
+                //  the noisy verbose one does...
+                bool        m_Flush;
+
+            // Protected methods...
+            protected:
+
+                // Stream was flushed...
+                int sync() { Commit(); return 0; }
+
+            // Protected data...
+            protected:
+
+                // Console owning the buffer...
+                Console    &m_Owner;
+        };
+
+        // Everything a console keeps for each thread writing to it...
+        struct ThreadContext
+        {
+            // Constructor initializer...
+            ThreadContext(Console &Owner)
+                : m_Buffer(Owner),
+                  m_Stream(&m_Buffer)
+            { }
+
+            // Message being composed and the stream composing it...
+            LineBuffer          m_Buffer;
+            std::ostream        m_Stream;
+
+            // Current file name...
+            std::string         m_CurrentFileName;
+        };
+
+        // Thread context map type...
+        typedef std::map<std::thread::id, ThreadContext *> ThreadContextMapType;
+
+    // Protected methods...
+    protected:
+
+        // Get the calling thread's context, creating it if it has none yet...
+        ThreadContext &GetThreadContext();
+
+        // Write a complete message to standard output, or queue it for the
+        //  writer thread if asynchronous...
+        void Write(const std::string &Text, const bool Flush);
+
+        // Body of the writer thread. Writes out whatever is queued until told
+        //  to stop and nothing is left...
+        void WriterThread();
+
     // Protected data...
     protected:
-        
-        // Current file name...
-        std::string         m_CurrentFileName;
-        
+
         // Channel map...
         ChannelMapType      m_ChannelMap;
         
         // Dummy output stream...
         NullOutputStream    m_DummyOutputStream;
-        
+
+        // Bit per channel ID set while it is enabled...
+        std::atomic<unsigned int> m_EnabledChannels;
+
+        // Guards standard output so messages from different threads never
+        //  interleave...
+        std::mutex          m_OutputMutex;
+
+        // Messages queued for the writer thread, whether each wants standard
+        //  output flushed after it, guarded by the mutex, and woken when
+        //  there are any or it should stop...
+        std::deque<std::pair<std::string, bool> >
+                            m_QueuedMessages;
+        std::mutex          m_QueueMutex;
+        std::condition_variable m_QueueWake;
+
+        // Context of each thread that has written to the console, guarded by
+        //  the mutex...
+        ThreadContextMapType m_ThreadContextMap;
+        std::mutex          m_ThreadContextMutex;
+
         // Use VT100 ANSI colours or not...
         bool                m_UseColours;
         
         // Precede output with current file name...
         bool                m_UseCurrentFileName;
+
+        // Writer thread and whether messages are queued for it, guarded by
+        //  the queue mutex...
+        std::thread         m_Writer;
+        bool                m_Asynchronous;
+};
+
+// Process console explicit singleton class, for diagnostics that don't belong
+//  to any one extraction...
+class ProcessConsole : public Console, public ExplicitSingleton<ProcessConsole>
+{
+    // Because we are a singleton, only ExplicitSingleton can control our 
+    //  creation...
+    friend class ExplicitSingleton<ProcessConsole>;
+
+    // Private methods...
+    private:
+
+        // Default constructor...
+        ProcessConsole() { }
+
+        // Deconstructor...
+       ~ProcessConsole() { }
 };
 
-// Wrapper around the global singleton instance...
+// Wrapper around the process console singleton instance...
 std::ostream &Message(const Console::ChannelID ID);
 
 // Multiple include protection...
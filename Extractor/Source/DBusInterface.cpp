@@ -29,6 +29,7 @@
     #include "Console.h"
     
     // System headers...
+    #include <algorithm>
     #include <cassert>
     #include <cstdlib>
     #include <sstream>
@@ -43,6 +44,26 @@ using namespace std;
         "<node name='" VIKING_EXTRACTOR_DBUS_OBJECT_PATH "'>"
         "    <interface name='" VIKING_EXTRACTOR_DBUS_INTERFACE "'>"
         "        <method name='" VIKING_EXTRACTOR_DBUS_METHOD_START "'></method>"
+        "        <method name='" VIKING_EXTRACTOR_DBUS_METHOD_SUBMIT_JOB "'>"
+        "            <arg name='Input' type='s' direction='in'></arg>"
+        "            <arg name='Output' type='s' direction='in'></arg>"
+        "            <arg name='Arguments' type='as' direction='in'></arg>"
+        "            <arg name='JobID' type='u' direction='out'></arg>"
+        "        </method>"
+        "        <method name='" VIKING_EXTRACTOR_DBUS_METHOD_QUIT "'></method>"
+        "        <signal name='" VIKING_EXTRACTOR_DBUS_SIGNAL_IMAGE_RECONSTRUCTED "'>"
+        "            <arg name='OutputFile' type='s'></arg>"
+        "            <arg name='CameraEvent' type='s'></arg>"
+        "            <arg name='SolarDay' type='u'></arg>"
+        "            <arg name='BandTypeClass' type='s'></arg>"
+        "            <arg name='Width' type='u'></arg>"
+        "            <arg name='Height' type='u'></arg>"
+        "        </signal>"
+        "        <signal name='" VIKING_EXTRACTOR_DBUS_SIGNAL_JOB_FINISHED "'>"
+        "            <arg name='JobID' type='u'></arg>"
+        "            <arg name='Succeeded' type='b'></arg>"
+        "            <arg name='ErrorMessage' type='s'></arg>"
+        "        </signal>"
         "        <signal name='" VIKING_EXTRACTOR_DBUS_SIGNAL_PROGRESS "'>"
         "            <arg name='Fraction' type='d'></arg>"
         "        </signal>"
@@ -66,9 +87,19 @@ DBusInterface::DBusInterface()
   : m_BusName(VIKING_EXTRACTOR_DBUS_BUS_NAME),
     m_ObjectPath(VIKING_EXTRACTOR_DBUS_OBJECT_PATH),
     m_Interface(VIKING_EXTRACTOR_DBUS_INTERFACE),
+    m_ImageReconstructedSignal(VIKING_EXTRACTOR_DBUS_SIGNAL_IMAGE_RECONSTRUCTED),
+    m_JobFinishedSignal(VIKING_EXTRACTOR_DBUS_SIGNAL_JOB_FINISHED),
     m_NotificationSignal(VIKING_EXTRACTOR_DBUS_SIGNAL_NOTIFICATION),
     m_ProgressSignal(VIKING_EXTRACTOR_DBUS_SIGNAL_PROGRESS),
+    m_NextJobID(1),
+    m_Quit(false),
+    m_EmitterStop(false),
+    m_EmitterFlush(false),
+    m_EmitterInterval(1000000 / VIKING_EXTRACTOR_DBUS_SIGNAL_RATE),
     m_MainLoop(NULL),
+    m_PendingNotificationQueued(false),
+    m_PendingProgress(0.0),
+    m_PendingProgressQueued(false),
     m_RemoteStart(false),
     m_IntrospectionData(NULL),
     m_Connection(NULL),
@@ -84,51 +115,130 @@ DBusInterface::DBusInterface()
     RegisterOnSessionBus();
 }
 
-// Emit notification signal with string available to be displayed through GUI 
-//  or throw an error...
-void DBusInterface::EmitNotificationSignal(const string &Notification)
+// Body of the daemon's thread running GLib's main loop...
+void DBusInterface::DaemonThread()
+{
+    // Dispatch method calls until told to stop...
+    g_main_loop_run(m_MainLoop);
+}
+
+// Queue a signal announcing an image was reconstructed and written out. Unlike
+//  notifications and progress it is never coalesced, or terminates if emitting
+//  a previous signal failed...
+void DBusInterface::EmitImageReconstructedSignal(const ReconstructedImageType &Image)
 {
     // Sanity check...
     assert(!g_dbus_connection_is_closed(m_Connection));
 
-    // Prepare signal parameters...
-    GVariant *SignalParameters = g_variant_new("(s)", Notification.c_str());
-
-    // Emit the signal...
-    const bool Result = g_dbus_connection_emit_signal(
-        m_Connection, 
-        NULL, 
-        m_ObjectPath.c_str(), 
-        m_Interface.c_str(), 
-        m_NotificationSignal.c_str(), 
-        SignalParameters, 
-       &m_Error);
+    // Lock the queue...
+    unique_lock<mutex> Lock(m_EmitterMutex);
 
-        // Failed...
-        if(!Result)
+        // A previous signal couldn't be emitted...
+        if(!m_EmitterErrorMessage.empty())
         {
-            // Alert user and terminate...
-            Message(Console::Error) 
-                << "d-bus: " << _("could not emit 'Notification' signal...") 
-                << " (" << m_Error->message << ")" << endl;
-
-            // Cleanup and terminate...
-            g_clear_error(&m_Error);
-            exit(EXIT_FAILURE);
+            const string ErrorMessage = m_EmitterErrorMessage;
+            Lock.unlock();
+            TerminateOnEmitterError(ErrorMessage);
         }
 
+    // Queue behind any others not yet announced...
+    m_PendingReconstructedImages.push_back(Image);
+
+    // Wake the emitter...
+    StartEmitter();
+    m_EmitterWake.notify_one();
+}
+
+// Emit a job finished signal with whether it succeeded and why not, after
+//  every signal queued before it, or terminate on error...
+void DBusInterface::EmitJobFinishedSignal(
+    const size_t JobID,
+    const bool Succeeded,
+    const string &ErrorMessage)
+{
+    // Sanity check...
+    assert(!g_dbus_connection_is_closed(m_Connection));
+
+    // Let any progress reported before arrive first...
+    Flush();
+
+    // This one is never coalesced, so emit it right away...
+    string EmitErrorMessage;
+    if(!EmitSignal(
+        m_JobFinishedSignal, 
+        g_variant_new("(ubs)", static_cast<guint32>(JobID), Succeeded, ErrorMessage.c_str()),
+        EmitErrorMessage))
+        TerminateOnEmitterError(EmitErrorMessage);
+
     // Make sure the signal actually was dispatched...
     g_dbus_connection_flush_sync(m_Connection, NULL, NULL);
 }
 
-// Emit progress signal with progress clamped to [0.0, 100.0] or throw an error...
+// Queue a notification signal with string available to be displayed through
+//  GUI. It is emitted in the background, replacing any still queued, or
+//  terminates if emitting a previous signal failed...
+void DBusInterface::EmitNotificationSignal(const string &Notification)
+{
+    // Sanity check...
+    assert(!g_dbus_connection_is_closed(m_Connection));
+
+    // Lock the queue...
+    unique_lock<mutex> Lock(m_EmitterMutex);
+
+        // A previous signal couldn't be emitted...
+        if(!m_EmitterErrorMessage.empty())
+        {
+            const string ErrorMessage = m_EmitterErrorMessage;
+            Lock.unlock();
+            TerminateOnEmitterError(ErrorMessage);
+        }
+
+    // Replace whatever notification hasn't been emitted yet...
+    m_PendingNotification       = Notification;
+    m_PendingNotificationQueued = true;
+
+    // Wake the emitter...
+    StartEmitter();
+    m_EmitterWake.notify_one();
+}
+
+// Queue a progress signal with progress clamped to [0.0, 100.0]. It is emitted
+//  in the background, replacing any still queued, or terminates if emitting a
+//  previous signal failed...
 void DBusInterface::EmitProgressSignal(const double Progress)
 {
     // Sanity check...
     assert(!g_dbus_connection_is_closed(m_Connection));
 
-    // Prepare signal parameters...
-    GVariant *SignalParameters = g_variant_new("(d)", Progress);
+    // Lock the queue...
+    unique_lock<mutex> Lock(m_EmitterMutex);
+
+        // A previous signal couldn't be emitted...
+        if(!m_EmitterErrorMessage.empty())
+        {
+            const string ErrorMessage = m_EmitterErrorMessage;
+            Lock.unlock();
+            TerminateOnEmitterError(ErrorMessage);
+        }
+
+    // Replace whatever progress hasn't been emitted yet...
+    m_PendingProgress       = min(max(Progress, 0.0), 100.0);
+    m_PendingProgressQueued = true;
+
+    // Wake the emitter...
+    StartEmitter();
+    m_EmitterWake.notify_one();
+}
+
+// Emit a signal with the given name and parameters, or return false with an
+//  error message...
+bool DBusInterface::EmitSignal(
+    const string &Signal,
+    GVariant *SignalParameters,
+    string &ErrorMessage)
+{
+    // Variables...
+    GError *Error = NULL;
 
     // Emit the signal...
     const bool Result = g_dbus_connection_emit_signal(
@@ -136,25 +246,143 @@ void DBusInterface::EmitProgressSignal(const double Progress)
         NULL, 
         m_ObjectPath.c_str(), 
         m_Interface.c_str(), 
-        m_ProgressSignal.c_str(), 
+        Signal.c_str(), 
         SignalParameters, 
-       &m_Error);
+       &Error);
 
         // Failed...
         if(!Result)
         {
-            // Alert user and terminate...
-            Message(Console::Error) 
-                << "d-bus: " << _("could not emit 'Progress' signal...") 
-                << " (" << m_Error->message << ")" << endl;
+            // Format the error message...
+            stringstream ErrorStream;
+            ErrorStream
+                << _("could not emit '") << Signal << _("' signal...")
+                << " (" << Error->message << ")";
+            ErrorMessage = ErrorStream.str();
+
+            // Cleanup...
+            g_clear_error(&Error);
+            return false;
+        }
 
-            // Cleanup and terminate...
-            g_clear_error(&m_Error);
-            exit(EXIT_FAILURE);
+    // Done...
+    return true;
+}
+
+// Body of the signal emitter thread. Emits whatever is queued at most as often
+//  as the signal rate allows, without waiting on the bus...
+void DBusInterface::EmitterThread()
+{
+    // Lock the queue...
+    unique_lock<mutex> Lock(m_EmitterMutex);
+
+    // Keep emitting until told to stop with nothing left queued...
+    while(true)
+    {
+        // Wait for something to be queued, a flush, or to be told to stop...
+        while(!m_PendingNotificationQueued && 
+              !m_PendingProgressQueued && 
+              m_PendingReconstructedImages.empty() &&
+              !m_EmitterFlush && 
+              !m_EmitterStop)
+            m_EmitterWake.wait(Lock);
+
+        // Take whatever is queued...
+        const bool      NotificationQueued  = m_PendingNotificationQueued;
+        const string    Notification        = m_PendingNotification;
+        const bool      ProgressQueued      = m_PendingProgressQueued;
+        const double    Progress            = m_PendingProgress;
+        const bool      Flushing            = m_EmitterFlush || m_EmitterStop;
+        deque<ReconstructedImageType> ReconstructedImages;
+        ReconstructedImages.swap(m_PendingReconstructedImages);
+        m_PendingNotificationQueued = false;
+        m_PendingProgressQueued     = false;
+
+        // Emit without holding the lock so the caller never waits on the
+        //  bus...
+        Lock.unlock();
+        string ErrorMessage;
+        if(NotificationQueued)
+            EmitSignal(m_NotificationSignal, g_variant_new("(s)", Notification.c_str()), ErrorMessage);
+        if(ProgressQueued && ErrorMessage.empty())
+            EmitSignal(m_ProgressSignal, g_variant_new("(d)", Progress), ErrorMessage);
+        for(deque<ReconstructedImageType>::const_iterator Iterator = ReconstructedImages.begin();
+            Iterator != ReconstructedImages.end() && ErrorMessage.empty();
+          ++Iterator)
+            EmitSignal(
+                m_ImageReconstructedSignal,
+                g_variant_new(
+                    "(ssusuu)",
+                    Iterator->m_OutputFile.c_str(),
+                    Iterator->m_CameraEvent.c_str(),
+                    static_cast<guint32>(Iterator->m_SolarDay),
+                    Iterator->m_BandTypeClass.c_str(),
+                    static_cast<guint32>(Iterator->m_Width),
+                    static_cast<guint32>(Iterator->m_Height)),
+                ErrorMessage);
+
+        // Make sure the signals actually are dispatched, waiting for it only
+        //  when someone is waiting on us...
+        if(Flushing)
+            g_dbus_connection_flush_sync(m_Connection, NULL, NULL);
+        else
+            g_dbus_connection_flush(m_Connection, NULL, NULL, NULL);
+        Lock.lock();
+
+        // Remember the first failure for the next caller to report...
+        if(!ErrorMessage.empty() && m_EmitterErrorMessage.empty())
+            m_EmitterErrorMessage = ErrorMessage;
+
+        // Drained, so let anyone waiting on a flush know...
+        if(Flushing && 
+           !m_PendingNotificationQueued && 
+           !m_PendingProgressQueued && 
+           m_PendingReconstructedImages.empty())
+        {
+            // Done flushing...
+            m_EmitterFlush = false;
+            m_EmitterDrained.notify_all();
+
+            // Told to stop...
+            if(m_EmitterStop)
+                break;
         }
 
-    // Make sure the signal actually was dispatched...
-    g_dbus_connection_flush_sync(m_Connection, NULL, NULL);
+        // Coalesce whatever else is queued until the interval has elapsed,
+        //  unless told to flush or stop sooner...
+        const chrono::steady_clock::time_point Deadline =
+            chrono::steady_clock::now() + m_EmitterInterval;
+        while(!m_EmitterFlush && 
+              !m_EmitterStop && 
+              m_EmitterWake.wait_until(Lock, Deadline) != cv_status::timeout)
+            ;
+    }
+}
+
+// Block until every queued signal has been emitted and dispatched on the
+//  bus...
+void DBusInterface::Flush()
+{
+    // Lock the queue...
+    unique_lock<mutex> Lock(m_EmitterMutex);
+
+        // Nothing was ever queued...
+        if(!m_Emitter.joinable())
+            return;
+
+    // Ask the emitter to flush and wait for it to finish...
+    m_EmitterFlush = true;
+    m_EmitterWake.notify_one();
+    while(m_EmitterFlush)
+        m_EmitterDrained.wait(Lock);
+
+    // A signal couldn't be emitted...
+    if(!m_EmitterErrorMessage.empty())
+    {
+        const string ErrorMessage = m_EmitterErrorMessage;
+        Lock.unlock();
+        TerminateOnEmitterError(ErrorMessage);
+    }
 }
 
 // D-Bus interface method callback...
@@ -164,15 +392,22 @@ void DBusInterface::MethodCallback(
     const gchar *,                      /* ObjectPath */
     const gchar *InterfaceName,
     const gchar *MethodName,
-    GVariant *,                         /* Parameters */
+    GVariant *Parameters,
     GDBusMethodInvocation *Invocation,
     gpointer UserData)
 {
     // Retrieve this pointer from user data...
     DBusInterface &Context(*static_cast<DBusInterface *>(UserData));
     
+    // Start method, which a daemon has no use for...
+    if(g_strcmp0(MethodName, VIKING_EXTRACTOR_DBUS_METHOD_START) == 0 &&
+       Context.m_Daemon.joinable())
+        g_dbus_method_invocation_return_error(
+            Invocation, G_DBUS_ERROR, G_DBUS_ERROR_NOT_SUPPORTED,
+            _("Method %s.%s is not used by a daemon."), InterfaceName, MethodName);
+
     // Start method...
-    if(g_strcmp0(MethodName, VIKING_EXTRACTOR_DBUS_METHOD_START) == 0)
+    else if(g_strcmp0(MethodName, VIKING_EXTRACTOR_DBUS_METHOD_START) == 0)
     {
         // Inform WaitRemoteStart() that it can stop blocking now...
         Context.m_RemoteStart = true;
@@ -184,6 +419,67 @@ void DBusInterface::MethodCallback(
         g_dbus_method_invocation_return_value(Invocation, NULL);
     }
     
+    // Job submission and quit methods, which only a daemon serves...
+    else if((g_strcmp0(MethodName, VIKING_EXTRACTOR_DBUS_METHOD_SUBMIT_JOB) == 0 ||
+             g_strcmp0(MethodName, VIKING_EXTRACTOR_DBUS_METHOD_QUIT) == 0) &&
+            !Context.m_Daemon.joinable())
+        g_dbus_method_invocation_return_error(
+            Invocation, G_DBUS_ERROR, G_DBUS_ERROR_NOT_SUPPORTED,
+            _("Method %s.%s needs --daemon."), InterfaceName, MethodName);
+
+    // Submit a job...
+    else if(g_strcmp0(MethodName, VIKING_EXTRACTOR_DBUS_METHOD_SUBMIT_JOB) == 0)
+    {
+        // Variables...
+        const gchar    *Input       = NULL;
+        const gchar    *Output      = NULL;
+        const gchar   **Arguments   = NULL;
+        JobType         Job;
+
+        // Unpack the job...
+        g_variant_get(Parameters, "(&s&s^a&s)", &Input, &Output, &Arguments);
+        Job.m_Input     = Input;
+        Job.m_Output    = Output;
+        for(const gchar **Argument = Arguments; Argument && *Argument; ++Argument)
+            Job.m_Arguments.push_back(*Argument);
+        g_free(Arguments);
+
+            // Input is required...
+            if(Job.m_Input.empty())
+            {
+                g_dbus_method_invocation_return_error(
+                    Invocation, G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS,
+                    "%s", _("need input file or directory"));
+                return;
+            }
+
+        // Queue it and wake the daemon...
+        {
+            lock_guard<mutex> Lock(Context.m_JobMutex);
+            Job.m_ID = Context.m_NextJobID++;
+            Context.m_Jobs.push_back(Job);
+            Context.m_JobQueued.notify_one();
+        }
+
+        // Let the client know which job it was...
+        g_dbus_method_invocation_return_value(
+            Invocation, g_variant_new("(u)", static_cast<guint32>(Job.m_ID)));
+    }
+
+    // Quit once every job submitted so far has finished...
+    else if(g_strcmp0(MethodName, VIKING_EXTRACTOR_DBUS_METHOD_QUIT) == 0)
+    {
+        // Tell the daemon...
+        {
+            lock_guard<mutex> Lock(Context.m_JobMutex);
+            Context.m_Quit = true;
+            Context.m_JobQueued.notify_one();
+        }
+
+        // Acknowledge...
+        g_dbus_method_invocation_return_value(Invocation, NULL);
+    }
+
     // Some other method that we specified in the virtual table, but haven't
     //  implemented yet...
     else
@@ -305,6 +601,67 @@ void DBusInterface::RegisterOnSessionBus()
         NULL);
 }
 
+// Set the most number of times per second signals are emitted...
+void DBusInterface::SetSignalRate(const size_t SignalRate)
+{
+    // Lock the queue...
+    lock_guard<mutex> Lock(m_EmitterMutex);
+
+    // Emit no more often than that...
+    m_EmitterInterval = chrono::microseconds(1000000 / max<size_t>(SignalRate, 1));
+}
+
+// Serve method calls on a thread of their own so jobs can be submitted while
+//  another runs...
+void DBusInterface::StartDaemon()
+{
+    // Already started...
+    if(m_Daemon.joinable())
+        return;
+
+    // Run GLib's main loop on its own thread...
+    m_MainLoop = g_main_loop_new(NULL, FALSE);
+    m_Daemon = thread(&DBusInterface::DaemonThread, this);
+}
+
+// Start the signal emitter thread if it isn't already running. Caller must
+//  hold the emitter mutex...
+void DBusInterface::StartEmitter()
+{
+    // Already running...
+    if(m_Emitter.joinable())
+        return;
+
+    // Start...
+    m_Emitter = thread(&DBusInterface::EmitterThread, this);
+}
+
+// Stop the signal emitter thread after it has emitted whatever is still
+//  queued...
+void DBusInterface::StopEmitter()
+{
+    // Tell it to stop, if it was ever started...
+    {
+        lock_guard<mutex> Lock(m_EmitterMutex);
+        if(!m_Emitter.joinable())
+            return;
+        m_EmitterStop = true;
+        m_EmitterWake.notify_one();
+    }
+
+    // Wait for it to finish...
+    m_Emitter.join();
+}
+
+// Alert user the signal emitter thread failed to emit a signal and terminate.
+//  Caller must not hold the emitter mutex...
+void DBusInterface::TerminateOnEmitterError(const string &ErrorMessage)
+{
+    // Alert user and terminate...
+    Message(Console::Error) << "d-bus: " << ErrorMessage << endl;
+    exit(EXIT_FAILURE);
+}
+
 // Wait for a D-Bus signal before unblocking or throw an error...
 void DBusInterface::WaitRemoteStart()
 {
@@ -330,9 +687,42 @@ void DBusInterface::WaitRemoteStart()
     }
 }
 
+// Block until a job is submitted to the daemon, returning false instead once
+//  told to quit and every job submitted has been taken...
+bool DBusInterface::WaitJob(JobType &Job)
+{
+    // Lock the queue...
+    unique_lock<mutex> Lock(m_JobMutex);
+
+    // Wait for a job or to be told to quit...
+    while(m_Jobs.empty() && !m_Quit)
+        m_JobQueued.wait(Lock);
+
+    // Nothing left to do...
+    if(m_Jobs.empty())
+        return false;
+
+    // Take the next one...
+    Job = m_Jobs.front();
+    m_Jobs.pop_front();
+    return true;
+}
+
 // Deconstructor...
 DBusInterface::~DBusInterface()
 {
+    // Stop serving method calls, if a daemon...
+    if(m_Daemon.joinable())
+    {
+        g_main_loop_quit(m_MainLoop);
+        m_Daemon.join();
+        g_main_loop_unref(m_MainLoop);
+        m_MainLoop = NULL;
+    }
+
+    // Emit whatever signals are still queued...
+    StopEmitter();
+
     // Cleanup if a connection to the session bus is open...
     if(m_Connection)
     {
@@ -35,12 +35,19 @@
 
     // Our headers...
     #include "ExplicitSingleton.h"
+    #include "ProgressSink.h"
 
     // D-Bus...
     #include <gio/gio.h>
 
     // System headers...
+    #include <chrono>
+    #include <condition_variable>
+    #include <deque>
+    #include <mutex>
     #include <string>
+    #include <thread>
+    #include <vector>
     #include <clocale>
 
     // i18n...
@@ -54,33 +61,111 @@
 
     To invoke the Start method manually...
         $ gdbus call --session --dest com.cartesiantheatre.VikingExtractorService --object-path /com/cartesiantheatre/VikingExtractorObject --method com.cartesiantheatre.VikingExtractorInterface.Start
+
+    To submit a job to a daemon started with --daemon, given the input, the
+    output directory, and any further options, then have it quit once every
+    job submitted has finished...
+        $ gdbus call --session --dest com.cartesiantheatre.VikingExtractorService --object-path /com/cartesiantheatre/VikingExtractorObject --method com.cartesiantheatre.VikingExtractorInterface.SubmitJob "Input/" "Output/" "['--recursive', '--generate-metadata']"
+        $ gdbus call --session --dest com.cartesiantheatre.VikingExtractorService --object-path /com/cartesiantheatre/VikingExtractorObject --method com.cartesiantheatre.VikingExtractorInterface.Quit
+
+    To try a daemon without a desktop session, give it a private bus...
+        $ dbus-run-session -- viking-extractor --daemon
 */
 
 // D-Bus name, object path, interface, signal, and method constants...
 #define VIKING_EXTRACTOR_DBUS_BUS_NAME               "com.cartesiantheatre.VikingExtractorService"
 #define VIKING_EXTRACTOR_DBUS_OBJECT_PATH            "/com/cartesiantheatre/VikingExtractorObject"
 #define VIKING_EXTRACTOR_DBUS_INTERFACE              "com.cartesiantheatre.VikingExtractorInterface"
+#define VIKING_EXTRACTOR_DBUS_SIGNAL_IMAGE_RECONSTRUCTED "ImageReconstructed"
+#define VIKING_EXTRACTOR_DBUS_SIGNAL_JOB_FINISHED    "JobFinished"
 #define VIKING_EXTRACTOR_DBUS_SIGNAL_NOTIFICATION    "Notification"
 #define VIKING_EXTRACTOR_DBUS_SIGNAL_PROGRESS        "Progress"
+#define VIKING_EXTRACTOR_DBUS_METHOD_QUIT            "Quit"
 #define VIKING_EXTRACTOR_DBUS_METHOD_START           "Start"
+#define VIKING_EXTRACTOR_DBUS_METHOD_SUBMIT_JOB      "SubmitJob"
 
-// D-Bus interface singleton class...
-class DBusInterface : public ExplicitSingleton<DBusInterface>
+// Default most number of times per second signals are emitted. Notifications
+//  and progress reported in between are coalesced into the latest, while each
+//  reconstructed image is still announced...
+#define VIKING_EXTRACTOR_DBUS_SIGNAL_RATE            10
+
+// D-Bus interface singleton class, which also reports the progress of the
+//  extraction it drives...
+class DBusInterface : public ExplicitSingleton<DBusInterface>, public ProgressSink
 {
     // Because we are a singleton, only ExplicitSingleton can control our 
     //  creation...
     friend class ExplicitSingleton<DBusInterface>;
 
+    // Public types...
+    public:
+
+        // An extraction job submitted to a daemon...
+        struct JobType
+        {
+            // Constructor initializer...
+            JobType() : m_ID(0) { }
+
+            // Command line options on top of the daemon's own...
+            std::vector<std::string> m_Arguments;
+
+            // Identifier returned to the client that submitted it...
+            size_t              m_ID;
+
+            // Input file or directory, and the output directory...
+            std::string         m_Input;
+            std::string         m_Output;
+        };
+
     // Public methods...
     public:
 
-        // Emit notification signal with string available to be displayed 
-        //  through GUI or throw an error...
+        // Queue a signal announcing an image was reconstructed and written
+        //  out. Unlike notifications and progress it is never coalesced, or
+        //  terminates if emitting a previous signal failed...
+        void EmitImageReconstructedSignal(const ReconstructedImageType &Image);
+
+        // Emit a job finished signal with whether it succeeded and why not,
+        //  after every signal queued before it, or terminate on error...
+        void EmitJobFinishedSignal(
+            const size_t JobID,
+            const bool Succeeded,
+            const std::string &ErrorMessage);
+
+        // Queue a notification signal with string available to be displayed 
+        //  through GUI. It is emitted in the background, replacing any still
+        //  queued, or terminates if emitting a previous signal failed...
         void EmitNotificationSignal(const std::string &Message);
 
-        // Emit progress signal with progress clamped to [0.0, 100.0] or throw 
-        //  an error...
+        // Queue a progress signal with progress clamped to [0.0, 100.0]. It
+        //  is emitted in the background, replacing any still queued, or
+        //  terminates if emitting a previous signal failed...
         void EmitProgressSignal(const double Progress);
+
+        // Block until every queued signal has been emitted and dispatched on
+        //  the bus...
+        void Flush();
+
+        // Report progress of an extraction by queueing the equivalent
+        //  signals...
+        void ReportImageReconstructed(const ReconstructedImageType &Image)
+            { EmitImageReconstructedSignal(Image); }
+        void ReportNotification(const std::string &Notification)
+            { EmitNotificationSignal(Notification); }
+        void ReportProgress(const double Progress)
+            { EmitProgressSignal(Progress); }
+
+        // Set the most number of times per second signals are emitted...
+        void SetSignalRate(const size_t SignalRate);
+
+        // Serve method calls on a thread of their own so jobs can be
+        //  submitted while another runs...
+        void StartDaemon();
+
+        // Block until a job is submitted to the daemon, returning false
+        //  instead once told to quit and every job submitted has been
+        //  taken...
+        bool WaitJob(JobType &Job);
         
         // Wait for a D-Bus signal before unblocking or throw an error...
         void WaitRemoteStart();
@@ -97,6 +182,32 @@ class DBusInterface : public ExplicitSingleton<DBusInterface>
     // Protected methods...
     protected:
 
+        // Body of the daemon's thread running GLib's main loop...
+        void DaemonThread();
+
+        // Emit a signal with the given name and parameters, or return false
+        //  with an error message...
+        bool EmitSignal(
+            const std::string &Signal,
+            GVariant *SignalParameters,
+            std::string &ErrorMessage);
+
+        // Body of the signal emitter thread. Emits whatever is queued at most
+        //  as often as the signal rate allows, without waiting on the bus...
+        void EmitterThread();
+
+        // Start the signal emitter thread if it isn't already running. Caller
+        //  must hold the emitter mutex...
+        void StartEmitter();
+
+        // Stop the signal emitter thread after it has emitted whatever is
+        //  still queued...
+        void StopEmitter();
+
+        // Alert user the signal emitter thread failed to emit a signal and
+        //  terminate. Caller must not hold the emitter mutex...
+        void TerminateOnEmitterError(const std::string &ErrorMessage);
+
         // Register on the session bus...
         void RegisterOnSessionBus();
         
@@ -137,6 +248,12 @@ class DBusInterface : public ExplicitSingleton<DBusInterface>
 
         // Signals we emit...
 
+            // We emit this each time an image has been reconstructed...
+            const std::string   m_ImageReconstructedSignal;
+
+            // We emit this when a daemon's job has finished...
+            const std::string   m_JobFinishedSignal;
+
             // We emit this with string parameter when some new information to 
             //  be displayed through GUI during long operations
             const std::string   m_NotificationSignal;
@@ -153,9 +270,54 @@ class DBusInterface : public ExplicitSingleton<DBusInterface>
     // Protected data...
     protected:
 
+        // Thread running GLib's main loop in daemon mode...
+        std::thread         m_Daemon;
+
+        // Jobs submitted to the daemon and not yet taken, the identifier of
+        //  the next one, and whether it has been told to quit...
+        std::deque<JobType> m_Jobs;
+        size_t              m_NextJobID;
+        bool                m_Quit;
+
+        // Guards the jobs and quit flag, which are shared with the daemon's
+        //  thread, and woken when either changes...
+        std::mutex          m_JobMutex;
+        std::condition_variable m_JobQueued;
+
+        // Signal emitter thread, whether it has been told to stop, and
+        //  whether a caller is waiting for it to drain its queue...
+        std::thread         m_Emitter;
+        bool                m_EmitterStop;
+        bool                m_EmitterFlush;
+
+        // Woken when signals are queued or the emitter should stop or flush,
+        //  and when the emitter has drained its queue...
+        std::condition_variable m_EmitterDrained;
+        std::condition_variable m_EmitterWake;
+
+        // Error message of the signal that failed to be emitted, if any...
+        std::string         m_EmitterErrorMessage;
+
+        // Shortest time between the signal emitter thread emitting...
+        std::chrono::microseconds
+                            m_EmitterInterval;
+
+        // Guards everything shared with the signal emitter thread...
+        std::mutex          m_EmitterMutex;
+
         // GLib main event loop needed for gdbus events...
         GMainLoop          *m_MainLoop;
 
+        // Latest notification and progress queued and not yet emitted...
+        std::string         m_PendingNotification;
+        bool                m_PendingNotificationQueued;
+        double              m_PendingProgress;
+        bool                m_PendingProgressQueued;
+
+        // Reconstructed images queued and not yet announced...
+        std::deque<ReconstructedImageType>
+                            m_PendingReconstructedImages;
+
         // When flag set, remote start successfully initiated...
         bool                m_RemoteStart;
 
@@ -0,0 +1,61 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "ExtractionContext.h"
+
+// Using the standard namespace...
+using namespace std;
+
+// Constructor takes the options to extract with, which are copied, the
+//  console to write messages to, where to report progress, if anywhere, and
+//  the metrics registry to count in, if any...
+ExtractionContext::ExtractionContext(
+    const Options &ExtractionOptions,
+    Console &MessageConsole,
+    ProgressSink *Progress,
+    Metrics *Registry)
+    : m_Console(MessageConsole),
+      m_MemoryTracker(new MemoryTracker(ExtractionOptions.GetMemoryLimit(), Registry)),
+      m_Metrics(Registry),
+      m_Options(ExtractionOptions),
+      m_Profiler(ExtractionOptions.GetProfileFile().empty() && !Registry ?
+            NULL : new Profiler(Registry)),
+      m_ProgressSink(Progress),
+      m_Tracer(ExtractionOptions.GetTraceFile().empty() ? NULL : new Tracer)
+{
+
+}
+
+// Deconstructor...
+ExtractionContext::~ExtractionContext()
+{
+    // Cleanup the memory tracker, profiler, and tracer...
+    delete m_MemoryTracker;
+    delete m_Profiler;
+    delete m_Tracer;
+}
+
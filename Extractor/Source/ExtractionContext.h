@@ -0,0 +1,142 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _EXTRACTION_CONTEXT_H_
+#define _EXTRACTION_CONTEXT_H_
+
+// Includes...
+
+    // Our headers...
+    #include "Console.h"
+    #include "MemoryTracker.h"
+    #include "Metrics.h"
+    #include "Options.h"
+    #include "Profiler.h"
+    #include "ProgressSink.h"
+    #include "Tracer.h"
+
+    // System headers...
+    #include <ostream>
+
+// Everything a single extraction needs from whoever runs it, being its
+//  options, the console its messages are written to, where its progress is
+//  reported, and the metrics registry it counts what it did in. It is handed
+//  down the pipeline instead of reaching for process wide singletons, so an
+//  extraction's options and state are its own rather than global. Services
+//  like the resident cache, media emulator, and D-Bus interface are still
+//  process wide singletons shared by every extraction, which is why a daemon
+//  runs its jobs one at a time...
+class ExtractionContext
+{
+    // Public methods...
+    public:
+
+        // Constructor takes the options to extract with, which are copied,
+        //  the console to write messages to, where to report progress, if
+        //  anywhere, and the metrics registry to count in, if any, which is
+        //  usually shared by every extraction the process runs. The console,
+        //  progress sink, and metrics registry must outlive the context...
+        ExtractionContext(
+            const Options &ExtractionOptions,
+            Console &MessageConsole,
+            ProgressSink *Progress = NULL,
+            Metrics *Registry = NULL);
+
+        // Increment a counter of the metrics registry, if keeping metrics...
+        void Count(
+            const char *Name,
+            const std::string &Labels = std::string(),
+            const uint64_t Amount = 1) const
+            { if(m_Metrics) m_Metrics->Increment(Name, Labels, Amount); }
+
+        // Get the console messages are written to...
+        Console &GetConsole() const { return m_Console; }
+
+        // Get the tracker the large allocations of the extraction are
+        //  accounted with, and which knows the memory limit...
+        MemoryTracker &GetMemoryTracker() const { return *m_MemoryTracker; }
+
+        // Get the metrics registry to count in, or NULL if not keeping
+        //  metrics...
+        Metrics *GetMetrics() const { return m_Metrics; }
+
+        // Get the options to extract with...
+        const Options &GetOptions() const { return m_Options; }
+
+        // Get the profiler stages are timed with, or NULL if neither
+        //  profiling nor keeping metrics...
+        Profiler *GetProfiler() const { return m_Profiler; }
+
+        // Get where progress is reported, or NULL if nowhere...
+        ProgressSink *GetProgressSink() const { return m_ProgressSink; }
+
+        // Get the tracer spans of work are recorded with, or NULL if not
+        //  tracing...
+        Tracer *GetTracer() const { return m_Tracer; }
+
+        // Get an output stream of the console, if the channel is enabled, or
+        //  dummy stream otherwise...
+        std::ostream &Message(const Console::ChannelID ID) const
+            { return m_Console.Message(ID); }
+
+        // Deconstructor...
+       ~ExtractionContext();
+
+    // Protected data...
+    protected:
+
+        // Console messages are written to...
+        Console            &m_Console;
+
+        // Tracker the large allocations of the extraction are accounted
+        //  with...
+        MemoryTracker      *m_MemoryTracker;
+
+        // Metrics registry to count in, if any...
+        Metrics            *m_Metrics;
+
+        // Options to extract with...
+        const Options       m_Options;
+
+        // Profiler stages are timed with, if the options asked for a
+        //  profile or there are metrics to observe stage latencies in...
+        Profiler           *m_Profiler;
+
+        // Where progress is reported, if anywhere...
+        ProgressSink       *m_ProgressSink;
+
+        // Tracer spans of work are recorded with, if the options asked for
+        //  a trace...
+        Tracer             *m_Tracer;
+
+    // Private methods...
+    private:
+
+        // Forbid copy constructor and assignment, since the memory tracker,
+        //  profiler, and tracer are ours...
+        ExtractionContext(const ExtractionContext &);
+        ExtractionContext &operator=(const ExtractionContext &);
+};
+
+// Multiple include protection...
+#endif
+
@@ -0,0 +1,119 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "FileOutputSink.h"
+    #include "Miscellaneous.h"
+
+    // System headers...
+    #include <cassert>
+
+// Using the standard namespace...
+using namespace std;
+
+// Constructor takes the number of I/O threads to write on, the fsync policy,
+//  the tracer to record writes with, if any, and the memory tracker to account
+//  files waiting to be written with, if any...
+FileOutputSink::FileOutputSink(
+    const string &OutputRootDirectory,
+    const size_t IoThreads,
+    const OutputWriter::FsyncPolicyType FsyncPolicy,
+    Tracer *WriteTracer,
+    MemoryTracker *Memory)
+    : OutputSink(OutputRootDirectory),
+      m_Writer(IoThreads, FsyncPolicy, WriteTracer, Memory)
+{
+
+}
+
+// Abandon the file currently being written, if any...
+void FileOutputSink::AbortFile()
+{
+    // Nothing was written to disk yet, so just drop the buffer...
+    m_FileName.clear();
+    m_FileStream.str(string());
+    m_FileStream.clear();
+}
+
+// Wait for every file to be written, or throw an error...
+void FileOutputSink::Close()
+{
+    // No file should still be being written...
+    assert(m_FileName.empty());
+
+    // Wait for the writer...
+    m_Writer.Flush();
+}
+
+// Hand the file currently being written over to be written out, or throw an
+//  error...
+void FileOutputSink::CloseFile()
+{
+    // A file should have been being written...
+    assert(!m_FileName.empty());
+
+    // Take the buffered contents and clear the buffer for the next file...
+    string Contents = m_FileStream.str();
+    const string FileName = m_FileName;
+    AbortFile();
+
+    // Hand it over...
+    m_Writer.Submit(FileName, Contents);
+}
+
+// Check whether the given output file already exists or is waiting to be
+//  written...
+bool FileOutputSink::Exists(const string &FileName) const
+{
+    return m_Writer.IsPending(FileName) || (access(FileName.c_str(), F_OK) == 0);
+}
+
+// Begin writing the given output file and return the stream its contents are
+//  to be written to, or throw an error...
+ostream &FileOutputSink::OpenFile(const string &FileName)
+{
+    // Only one file may be written at a time...
+    assert(m_FileName.empty());
+
+    // Begin buffering...
+    m_FileName = FileName;
+    return m_FileStream;
+}
+
+// Create the given directory and all of its parents, unless it was already,
+//  or throw an error...
+void FileOutputSink::PrepareDirectory(const string &Directory)
+{
+    // Already created or found this one...
+    if(m_CreatedDirectories.find(Directory) != m_CreatedDirectories.end())
+        return;
+
+    // Create it and remember that it exists now...
+    if(!CreateDirectoryRecursively(Directory))
+        throw string(_("could not create output directory for file"));
+    m_CreatedDirectories.insert(Directory);
+}
+
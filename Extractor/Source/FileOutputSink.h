@@ -0,0 +1,109 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _FILE_OUTPUT_SINK_H_
+#define _FILE_OUTPUT_SINK_H_
+
+// Includes...
+
+    // Our headers...
+    #include "OutputSink.h"
+    #include "OutputWriter.h"
+
+    // System headers...
+    #include <set>
+    #include <sstream>
+    #include <string>
+    #include <clocale>
+
+    // i18n...
+    #include "gettext.h"
+    #define _(str) gettext (str)
+    #define N_(str) gettext_noop (str)
+
+// Writes each output file to its own file in the output directory tree. Each
+//  file is buffered whole and handed to an OutputWriter which publishes it
+//  atomically in the background...
+class FileOutputSink : public OutputSink
+{
+    // Public methods...
+    public:
+
+        // Constructor takes the number of I/O threads to write on, the fsync
+        //  policy, the tracer to record writes with, if any, and the memory
+        //  tracker to account files waiting to be written with, if any...
+        FileOutputSink(
+            const std::string &OutputRootDirectory,
+            const size_t IoThreads,
+            const OutputWriter::FsyncPolicyType FsyncPolicy,
+            Tracer *WriteTracer = NULL,
+            MemoryTracker *Memory = NULL);
+
+        // Abandon the file currently being written, if any...
+        void AbortFile();
+
+        // Wait for every file to be written, or throw an error...
+        void Close();
+
+        // Hand the file currently being written over to be written out, or
+        //  throw an error...
+        void CloseFile();
+
+        // Check whether the given output file already exists or is waiting
+        //  to be written...
+        bool Exists(const std::string &FileName) const;
+
+        // Wait for every file closed so far to be written, or throw an
+        //  error...
+        void Flush() { m_Writer.Flush(); }
+
+        // Check whether the given output file is still waiting to be
+        //  written...
+        bool IsPending(const std::string &FileName) const { return m_Writer.IsPending(FileName); }
+
+        // Begin writing the given output file and return the stream its
+        //  contents are to be written to, or throw an error...
+        std::ostream &OpenFile(const std::string &FileName);
+
+        // Create the given directory and all of its parents, unless it was
+        //  already, or throw an error...
+        void PrepareDirectory(const std::string &Directory);
+
+    // Protected data...
+    protected:
+
+        // Directories already known to exist, so they're only created once...
+        std::set<std::string> m_CreatedDirectories;
+
+        // Name of the file currently being written...
+        std::string         m_FileName;
+
+        // Contents of the file currently being written...
+        std::ostringstream  m_FileStream;
+
+        // Writes the files out...
+        OutputWriter        m_Writer;
+};
+
+// Multiple include protection...
+#endif
+
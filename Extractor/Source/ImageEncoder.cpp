@@ -0,0 +1,81 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "ImageEncoder.h"
+
+// Using the standard namespace...
+using namespace std;
+
+// Constructor takes the stream to write the encoded image to...
+ImageEncoder::ImageEncoder(ostream &OutputStream)
+    : m_OutputStream(OutputStream)
+{
+
+}
+
+// Check the planes hold at least an image of the given dimensions in either
+//  one or three channels, or throw an error...
+void ImageEncoder::CheckPlanes(
+    const PlaneListType &Planes,
+    const size_t Width,
+    const size_t Height)
+{
+    // Only grayscale or RGB are supported...
+    if(Planes.size() != 1 && Planes.size() != 3)
+        throw string(_("image encoder given an unsupported number of planes"));
+
+    // Check that each plane really has enough scanlines of enough pixels...
+    for(size_t Plane = 0; Plane < Planes.size(); ++Plane)
+    {
+        // Not enough scanlines...
+        if(Planes[Plane]->size() < Height)
+            throw string(_("image encoder given a plane with too few scanlines"));
+
+        // Not enough pixels...
+        for(size_t Y = 0; Y < Height; ++Y)
+        {
+            if((*Planes[Plane])[Y].size() < Width)
+                throw string(_("image encoder given a scanline that was too short"));
+        }
+    }
+}
+
+// Write to the output stream, or throw an error...
+void ImageEncoder::Write(const void *Data, const size_t Size)
+{
+    // Write and check for error...
+    m_OutputStream.write(static_cast<const char *>(Data), Size);
+    if(!m_OutputStream.good())
+        throw string(_("could not write to output stream"));
+}
+
+// Deconstructor...
+ImageEncoder::~ImageEncoder()
+{
+
+}
+
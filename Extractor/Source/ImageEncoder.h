@@ -0,0 +1,94 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _IMAGE_ENCODER_H_
+#define _IMAGE_ENCODER_H_
+
+// Includes...
+
+    // System headers...
+    #include <ostream>
+    #include <string>
+    #include <vector>
+    #include <stdint.h>
+    #include <clocale>
+
+    // i18n...
+    #include "gettext.h"
+    #define _(str) gettext (str)
+    #define N_(str) gettext_noop (str)
+
+// Base of the output image encoders. An image is handed over as planes,
+//  being either one for grayscale or three for red, green, and blue, exactly
+//  as they were extracted from their image bands...
+class ImageEncoder
+{
+    // Public types...
+    public:
+
+        // A single plane of pixels, stored as a list of scanlines...
+        typedef std::vector< std::vector<uint8_t> > PlaneType;
+
+        // List of planes, one for grayscale or red, green, and blue...
+        typedef std::vector<const PlaneType *>      PlaneListType;
+
+    // Public methods...
+    public:
+
+        // Constructor takes the stream to write the encoded image to...
+        ImageEncoder(std::ostream &OutputStream);
+
+        // Encode an image of the given dimensions from either one plane as
+        //  grayscale or three planes as RGB, or throw an error. Every
+        //  scanline of every plane must be at least Width pixels and there
+        //  must be at least Height of them...
+        virtual void Encode(
+            const PlaneListType &Planes,
+            const size_t Width,
+            const size_t Height) = 0;
+
+        // Deconstructor...
+        virtual ~ImageEncoder();
+
+    // Protected methods...
+    protected:
+
+        // Check the planes hold at least an image of the given dimensions in
+        //  either one or three channels, or throw an error...
+        static void CheckPlanes(
+            const PlaneListType &Planes,
+            const size_t Width,
+            const size_t Height);
+
+        // Write to the output stream, or throw an error...
+        void Write(const void *Data, const size_t Size);
+
+    // Protected data...
+    protected:
+
+        // Stream encoded image is written to...
+        std::ostream       &m_OutputStream;
+};
+
+// Multiple include protection...
+#endif
+
@@ -136,8 +136,8 @@ string LogicalRecord::GetString(
     return Selection;
 }
 
-// Convert ASCII to EBCDIC encoded character...
-char LogicalRecord::AsciiToEbcdic(const uint8_t AsciiCharacter) const
+// Convert ASCII to EBCDIC encoded character, such as for composing labels...
+char LogicalRecord::AsciiToEbcdic(const uint8_t AsciiCharacter)
 {
     // Lookup...
     return ms_AsciiToEbcdicTable[AsciiCharacter];
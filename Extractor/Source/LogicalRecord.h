@@ -62,6 +62,10 @@ class LogicalRecord
         // Constructor from an input stream...
         LogicalRecord(ZZipFileDescriptor &FileDescriptor);
 
+        // Convert ASCII to EBCDIC encoded character, such as for composing
+        //  labels...
+        static char AsciiToEbcdic(const uint8_t AsciiCharacter);
+
         // Get a string or substring, stripping non-friendly bytes. If
         //  trim is true will strip leading and trailing whitespace 
         //  and logical record markers...
@@ -92,9 +96,6 @@ class LogicalRecord
     // Protected methods...
     protected:
 
-        // Convert ASCII to EBCDIC encoded character...
-        char AsciiToEbcdic(const uint8_t AsciiCharacter) const;
-
         // Convert EBCDIC to ASCII encoded character...
         char EbcdicToAscii(const uint8_t EbcdicCharacter) const;
 
@@ -0,0 +1,225 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "MediaEmulator.h"
+    #include "Metrics.h"
+
+    // System headers...
+    #include <algorithm>
+    #include <thread>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+// Using the standard namespace...
+using namespace std;
+
+// Default constructor...
+MediaEmulator::MediaEmulator()
+    : m_Busy(0),
+      m_BytesRead(0),
+      m_HeadOffset(-1),
+      m_Metrics(NULL),
+      m_Ready(chrono::steady_clock::now()),
+      m_SeekLatency(0),
+      m_Seeks(0),
+      m_Throughput(0)
+{
+    // Start from zziplib's own handlers and intercept opening, closing, and
+    //  reading. Seeking and sizing files need no emulation of their own since
+    //  a read notices where it starts from...
+    zzip_init_io(&m_Handlers, 0);
+    m_Handlers.fd.open  = OpenHandler;
+    m_Handlers.fd.close = CloseHandler;
+    m_Handlers.fd.read  = ReadHandler;
+}
+
+// Close a descriptor and forget which file it was of...
+int MediaEmulator::CloseHandler(int Descriptor)
+{
+    // Forget it...
+    MediaEmulator &Emulator = GetInstance();
+    {
+        lock_guard<mutex> Lock(Emulator.m_Mutex);
+        Emulator.m_Files.erase(Descriptor);
+    }
+
+    // Close it...
+    return close(Descriptor);
+}
+
+// Set the milliseconds a seek takes, the most bytes per second that can be
+//  read or zero for no cap, and the metrics registry to count seeks in, if
+//  any...
+void MediaEmulator::Configure(
+    const size_t SeekLatency,
+    const size_t Throughput,
+    Metrics *Registry)
+{
+    // Store...
+    lock_guard<mutex> Lock(m_Mutex);
+    m_Metrics       = Registry;
+    m_SeekLatency   = chrono::milliseconds(SeekLatency);
+    m_Throughput    = Throughput;
+}
+
+// Get the total time the emulated media was busy seeking and reading, in
+//  seconds...
+double MediaEmulator::GetBusySeconds() const
+{
+    lock_guard<mutex> Lock(m_Mutex);
+    return chrono::duration<double>(m_Busy).count();
+}
+
+// Get the number of bytes read through the emulated media...
+uint64_t MediaEmulator::GetBytesRead() const
+{
+    lock_guard<mutex> Lock(m_Mutex);
+    return m_BytesRead;
+}
+
+// Get the I/O handlers to open files and archives with, or NULL for zziplib's
+//  own if not emulating...
+zzip_plugin_io_t MediaEmulator::GetHandlers()
+{
+    return IsInstantiated() ? &GetInstance().m_Handlers : NULL;
+}
+
+// Get the number of seeks the emulated drive head made...
+uint64_t MediaEmulator::GetSeeks() const
+{
+    lock_guard<mutex> Lock(m_Mutex);
+    return m_Seeks;
+}
+
+// Open a file and remember which one it was, since the head only stays put
+//  between reads of the same file...
+int MediaEmulator::OpenHandler(zzip_char_t *FileName, int Flags, ...)
+{
+    // Open it. The input is only ever read, so there is never a mode to
+    //  create it with...
+    const int Descriptor = open(FileName, Flags);
+    if(Descriptor < 0)
+        return Descriptor;
+
+    // Remember which file it is...
+    struct stat FileStatus;
+    if(fstat(Descriptor, &FileStatus) == 0)
+    {
+        MediaEmulator &Emulator = GetInstance();
+        lock_guard<mutex> Lock(Emulator.m_Mutex);
+        Emulator.m_Files[Descriptor] =
+            FileIdentityType(FileStatus.st_dev, FileStatus.st_ino);
+    }
+
+    // Done...
+    return Descriptor;
+}
+
+// Read from a descriptor, then wait as long as the emulated media would have
+//  taken to...
+zzip_ssize_t MediaEmulator::ReadHandler(
+    int Descriptor,
+    void *Buffer,
+    zzip_size_t Length)
+{
+    // Note where the read starts, then read...
+    const off_t Offset = lseek(Descriptor, 0, SEEK_CUR);
+    const ssize_t BytesRead = read(Descriptor, Buffer, Length);
+
+    // Wait for whatever was read...
+    if(BytesRead > 0)
+        GetInstance().Transfer(Descriptor, Offset, BytesRead);
+
+    // Done...
+    return BytesRead;
+}
+
+// Wait for the emulated media to transfer the given number of bytes starting
+//  at the given offset into the file the descriptor is of...
+void MediaEmulator::Transfer(
+    const int Descriptor,
+    const off_t Offset,
+    const size_t Length)
+{
+    // Variables...
+    bool                            Seeked  = false;
+    chrono::steady_clock::time_point Finish;
+
+    // Book the drive, one read after another like a single head would...
+    {
+        // Lock...
+        lock_guard<mutex> Lock(m_Mutex);
+
+        // Which file is being read...
+        const FileMapType::const_iterator Iterator = m_Files.find(Descriptor);
+        const FileIdentityType File =
+            (Iterator != m_Files.end()) ? Iterator->second : FileIdentityType();
+
+        // Start once the drive is done with whatever it was already asked to
+        //  read...
+        const chrono::steady_clock::time_point Start =
+            max(chrono::steady_clock::now(), m_Ready);
+        chrono::nanoseconds Duration(0);
+
+        // Seek if the head is anywhere other than where this read begins...
+        if(!(File == m_HeadFile) || Offset != m_HeadOffset)
+        {
+            Duration += m_SeekLatency;
+            Seeked = true;
+            ++m_Seeks;
+        }
+
+        // Transfer at the capped throughput, if any...
+        if(m_Throughput > 0)
+            Duration += chrono::nanoseconds(
+                static_cast<uint64_t>(Length) * 1000000000ULL / m_Throughput);
+
+        // The head is left at the end of the read, and the drive busy until
+        //  then...
+        m_HeadFile      = File;
+        m_HeadOffset    = Offset + Length;
+        m_BytesRead    += Length;
+        m_Busy         += Duration;
+        Finish = m_Ready = Start + Duration;
+    }
+
+    // Count the seek...
+    if(Seeked && m_Metrics)
+        m_Metrics->Increment("viking_extractor_emulated_seeks_total");
+
+    // Only sleep once at least a millisecond behind the drive, so the many
+    //  tiny label reads don't each pay for a system call. Their delay still
+    //  accrues, since the drive stays booked until it would be done...
+    if(Finish - chrono::steady_clock::now() >= chrono::milliseconds(1))
+        this_thread::sleep_until(Finish);
+}
+
+// Deconstructor...
+MediaEmulator::~MediaEmulator()
+{
+}
@@ -0,0 +1,176 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _MEDIA_EMULATOR_H_
+#define _MEDIA_EMULATOR_H_
+
+// Includes...
+
+    // Our headers...
+    #include "ExplicitSingleton.h"
+
+    // zziplib...
+    #include <zzip/zzip.h>
+    #include <zzip/plugin.h>
+
+    // System headers...
+    #include <chrono>
+    #include <map>
+    #include <mutex>
+    #include <stdint.h>
+    #include <sys/types.h>
+
+// Forward declarations...
+class Metrics;
+
+// Emulates reading the input from slower media, such as the DVD the product
+//  ships on or storage shared over a network, on an ordinary disk. Files and
+//  archives are opened through zziplib I/O handlers that delay each read as
+//  though it went through a single drive head, paying the seek latency
+//  whenever a read does not start where the previous one ended, and never
+//  reading faster than the throughput cap. It only exists when asked for, so
+//  users open files with GetHandlers(), which is NULL for zziplib's own
+//  otherwise...
+class MediaEmulator : public ExplicitSingleton<MediaEmulator>
+{
+    // Because we are a singleton, only ExplicitSingleton can control our
+    //  creation...
+    friend class ExplicitSingleton<MediaEmulator>;
+
+    // Public methods...
+    public:
+
+        // Set the milliseconds a seek takes, the most bytes per second that
+        //  can be read or zero for no cap, and the metrics registry to count
+        //  seeks in, if any...
+        void Configure(
+            const size_t SeekLatency,
+            const size_t Throughput,
+            Metrics *Registry = NULL);
+
+        // Get the total time the emulated media was busy seeking and reading,
+        //  in seconds...
+        double GetBusySeconds() const;
+
+        // Get the number of bytes read through the emulated media...
+        uint64_t GetBytesRead() const;
+
+        // Get the I/O handlers to open files and archives with, or NULL for
+        //  zziplib's own if not emulating...
+        static zzip_plugin_io_t GetHandlers();
+
+        // Get the number of seeks the emulated drive head made...
+        uint64_t GetSeeks() const;
+
+    // Private methods...
+    private:
+
+        // Default constructor...
+        MediaEmulator();
+
+        // Deconstructor...
+       ~MediaEmulator();
+
+    // Protected types...
+    protected:
+
+        // A file on the disk, being the same one no matter which descriptor
+        //  it was opened with...
+        struct FileIdentityType
+        {
+            // Constructor initializer...
+            FileIdentityType(const dev_t Device = 0, const ino_t Inode = 0)
+                : m_Device(Device), m_Inode(Inode)
+            { }
+
+            // Is this the same file?
+            bool operator==(const FileIdentityType &Other) const
+                { return m_Device == Other.m_Device && m_Inode == Other.m_Inode; }
+
+            // Device and inode...
+            dev_t               m_Device;
+            ino_t               m_Inode;
+        };
+
+        // Open descriptors and the file each is of...
+        typedef std::map<int, FileIdentityType> FileMapType;
+
+    // Protected methods...
+    protected:
+
+        // zziplib I/O handlers...
+        static int CloseHandler(int Descriptor);
+        static int OpenHandler(zzip_char_t *FileName, int Flags, ...);
+        static zzip_ssize_t ReadHandler(int Descriptor, void *Buffer, zzip_size_t Length);
+
+        // Wait for the emulated media to transfer the given number of bytes
+        //  starting at the given offset into the file the descriptor is of...
+        void Transfer(
+            const int Descriptor,
+            const off_t Offset,
+            const size_t Length);
+
+    // Protected data...
+    protected:
+
+        // Time the emulated media was busy seeking and reading...
+        std::chrono::nanoseconds
+                            m_Busy;
+
+        // Bytes read through the emulated media...
+        uint64_t            m_BytesRead;
+
+        // Open descriptors and the file each is of...
+        FileMapType         m_Files;
+
+        // zziplib I/O handlers files and archives are opened with...
+        zzip_plugin_io_handlers
+                            m_Handlers;
+
+        // File and offset the emulated drive head is at...
+        FileIdentityType    m_HeadFile;
+        off_t               m_HeadOffset;
+
+        // Metrics registry to count seeks in, if any...
+        Metrics            *m_Metrics;
+
+        // Guards everything...
+        mutable std::mutex  m_Mutex;
+
+        // Time the emulated media finishes whatever it was last asked to read
+        //  and becomes free...
+        std::chrono::steady_clock::time_point
+                            m_Ready;
+
+        // Time a seek takes...
+        std::chrono::nanoseconds
+                            m_SeekLatency;
+
+        // Number of seeks the emulated drive head made...
+        uint64_t            m_Seeks;
+
+        // Most bytes per second that can be read, or zero for no cap...
+        size_t              m_Throughput;
+};
+
+// Multiple include protection...
+#endif
@@ -0,0 +1,239 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "MemoryTracker.h"
+
+    // System headers...
+    #include <cassert>
+    #include <iomanip>
+    #include <sstream>
+
+    // POSIX headers...
+    #include <sys/resource.h>
+
+// Using the standard namespace...
+using namespace std;
+
+// Constructor charges the given bytes to a category...
+MemoryTracker::Reservation::Reservation(
+    MemoryTracker &Tracker,
+    const CategoryType Category,
+    const size_t Bytes)
+    : m_Bytes(Bytes),
+      m_Category(Category),
+      m_Tracker(Tracker)
+{
+    // Charge...
+    m_Tracker.Charge(m_Category, m_Bytes);
+}
+
+// Deconstructor releases the charge...
+MemoryTracker::Reservation::~Reservation()
+{
+    // Release...
+    m_Tracker.Release(m_Category, m_Bytes);
+}
+
+// Constructor takes the most bytes that may be charged across all categories
+//  at once before the limit is exceeded, or zero for no limit, and the
+//  metrics registry to publish usage in, if any...
+MemoryTracker::MemoryTracker(const size_t Limit, Metrics *Registry)
+    : m_Limit(Limit),
+      m_Metrics(Registry),
+      m_Total(0),
+      m_TotalPeak(0)
+{
+    // Nothing charged yet...
+    for(size_t Category = 0; Category < Categories; ++Category)
+    {
+        m_Current[Category] = 0;
+        m_Peak[Category]    = 0;
+    }
+}
+
+// Charge bytes to a category...
+void MemoryTracker::Charge(const CategoryType Category, const size_t Bytes)
+{
+    // Check some assumptions...
+    assert(Category < Categories);
+
+    // Nothing to charge...
+    if(Bytes == 0)
+        return;
+
+    // Charge the category and the total, raising their peaks...
+    const bool Peaked =
+        RaisePeak(m_Peak[Category], m_Current[Category].fetch_add(Bytes) + Bytes);
+    RaisePeak(m_TotalPeak, m_Total.fetch_add(Bytes) + Bytes);
+
+    // Publish it, if keeping metrics...
+    if(m_Metrics)
+    {
+        const string Labels = Metrics::Label("category", GetCategoryName(Category));
+        m_Metrics->Adjust("viking_extractor_memory_bytes", Labels, static_cast<int64_t>(Bytes));
+        if(Peaked)
+            m_Metrics->Raise("viking_extractor_memory_peak_bytes", Labels, m_Peak[Category].load());
+    }
+}
+
+// Format a byte count with a binary unit for people to read...
+string MemoryTracker::FormatBytes(const size_t Bytes)
+{
+    // Units, each 1024 times the last...
+    static const char *Units[] = { "B", "KiB", "MiB", "GiB", "TiB" };
+
+    // Find the largest unit that leaves at least one of them...
+    double Scaled = static_cast<double>(Bytes);
+    size_t Unit = 0;
+    while(Scaled >= 1024.0 && Unit + 1 < sizeof(Units) / sizeof(Units[0]))
+    {
+        Scaled /= 1024.0;
+      ++Unit;
+    }
+
+    // Format...
+    ostringstream Formatted;
+    Formatted << fixed << setprecision(Unit == 0 ? 0 : 1) << Scaled << " " << Units[Unit];
+    return Formatted.str();
+}
+
+// Get a category's short, untranslated name, as used in metrics...
+const char *MemoryTracker::GetCategoryName(const CategoryType Category)
+{
+    // Which category?
+    switch(Category)
+    {
+        case BandDescriptors:   return "band_descriptors";
+        case RasterBuffers:     return "raster_buffers";
+        case OCRScratch:        return "ocr_scratch";
+        case EncoderStaging:    return "encoder_staging";
+        default:                return "unknown";
+    }
+}
+
+// Get the peak resident set size of the whole process, in bytes, or zero if
+//  unknown...
+size_t MemoryTracker::GetPeakResidentSetSize()
+{
+    // Ask the kernel...
+    struct rusage Usage;
+    if(getrusage(RUSAGE_SELF, &Usage) != 0)
+        return 0;
+
+    // Reported in kilobytes on Linux, but bytes on Darwin...
+#ifdef __APPLE__
+    return static_cast<size_t>(Usage.ru_maxrss);
+#else
+    return static_cast<size_t>(Usage.ru_maxrss) * 1024;
+#endif
+}
+
+// Publish the peak resident set size of the process in the metrics registry,
+//  if any...
+void MemoryTracker::PublishPeakResidentSetSize() const
+{
+    // Publish...
+    if(m_Metrics)
+        m_Metrics->Raise("viking_extractor_peak_resident_bytes", string(), GetPeakResidentSetSize());
+}
+
+// Raise a peak to the given value, if higher, returning true if it was...
+bool MemoryTracker::RaisePeak(atomic<size_t> &Peak, const size_t Value)
+{
+    // Keep trying until either the peak is already higher or we replace it...
+    size_t Current = Peak.load();
+    while(Current < Value)
+    {
+        if(Peak.compare_exchange_weak(Current, Value))
+            return true;
+    }
+
+    // Already higher...
+    return false;
+}
+
+// Release bytes previously charged to a category...
+void MemoryTracker::Release(const CategoryType Category, const size_t Bytes)
+{
+    // Check some assumptions...
+    assert(Category < Categories);
+    assert(m_Current[Category].load() >= Bytes);
+
+    // Nothing to release...
+    if(Bytes == 0)
+        return;
+
+    // Release from the category and the total...
+    m_Current[Category].fetch_sub(Bytes);
+    m_Total.fetch_sub(Bytes);
+
+    // Publish it, if keeping metrics...
+    if(m_Metrics)
+        m_Metrics->Adjust(
+            "viking_extractor_memory_bytes",
+            Metrics::Label("category", GetCategoryName(Category)),
+           -static_cast<int64_t>(Bytes));
+}
+
+// Write a table of the current and peak bytes of each category, followed by
+//  the peak resident set size of the process...
+void MemoryTracker::WriteSummary(ostream &Stream) const
+{
+    // Format in a stream of our own so the caller's settings are left
+    //  alone...
+    ostringstream Table;
+
+    // Heading...
+    Table << _("memory accounted (current / peak):") << endl;
+
+    // Each category...
+    for(size_t Category = 0; Category < Categories; ++Category)
+    {
+        Table << "    " << left << setw(20)
+              << GetCategoryName(static_cast<CategoryType>(Category))
+              << right << setw(12) << FormatBytes(GetCurrent(static_cast<CategoryType>(Category)))
+              << " / "
+              << setw(12) << FormatBytes(GetPeak(static_cast<CategoryType>(Category)))
+              << endl;
+    }
+
+    // All of them...
+    Table << "    " << left << setw(20) << _("total")
+          << right << setw(12) << FormatBytes(GetTotal())
+          << " / "
+          << setw(12) << FormatBytes(GetTotalPeak());
+    if(m_Limit != 0)
+        Table << _(" of ") << FormatBytes(m_Limit) << _(" limit");
+    Table << endl;
+
+    // The whole process, which also covers what was never accounted...
+    Table << _("peak resident set size: ") << FormatBytes(GetPeakResidentSetSize()) << endl;
+
+    // Write it out...
+    Stream << Table.str();
+}
+
@@ -0,0 +1,201 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _MEMORY_TRACKER_H_
+#define _MEMORY_TRACKER_H_
+
+// Includes...
+
+    // Our headers...
+    #include "Metrics.h"
+
+    // System headers...
+    #include <atomic>
+    #include <cstddef>
+    #include <ostream>
+    #include <string>
+    #include <clocale>
+
+    // i18n...
+    #include "gettext.h"
+    #define _(str) gettext (str)
+    #define N_(str) gettext_noop (str)
+
+// Accounts for the large allocations of an extraction by category, from
+//  whichever threads make them, keeping both what is currently held and the
+//  most that ever was at once. It does not intercept the allocator, so only
+//  what is charged to it is seen, but that covers the buffers that dominate an
+//  extraction's footprint. A limit may be set, which the pipeline checks
+//  before committing to work that would exceed it so it can shed or serialize
+//  the work instead...
+class MemoryTracker
+{
+    // Public types...
+    public:
+
+        // Category of an allocation...
+        typedef enum
+        {
+            // Image band descriptors held while indexing and reconstructing...
+            BandDescriptors,
+
+            // Pixel data of image bands read off of the media, and rotated
+            //  copies of it...
+            RasterBuffers,
+
+            // Flattened and rescaled images handed to the OCR library...
+            OCRScratch,
+
+            // Encoded output files staged in memory until written...
+            EncoderStaging,
+
+            // Number of categories...
+            Categories
+
+        }CategoryType;
+
+        // Holds a charge for as long as it is in scope...
+        class Reservation
+        {
+            // Public methods...
+            public:
+
+                // Constructor charges the given bytes to a category...
+                Reservation(
+                    MemoryTracker &Tracker,
+                    const CategoryType Category,
+                    const size_t Bytes);
+
+                // Deconstructor releases the charge...
+               ~Reservation();
+
+            // Protected data...
+            protected:
+
+                // Bytes charged...
+                const size_t            m_Bytes;
+
+                // Category charged...
+                const CategoryType      m_Category;
+
+                // Tracker charged...
+                MemoryTracker          &m_Tracker;
+
+            // Private methods...
+            private:
+
+                // Forbid copy constructor and assignment, since the charge
+                //  would be released twice...
+                Reservation(const Reservation &);
+                Reservation &operator=(const Reservation &);
+        };
+
+    // Public methods...
+    public:
+
+        // Constructor takes the most bytes that may be charged across all
+        //  categories at once before the limit is exceeded, or zero for no
+        //  limit, and the metrics registry to publish usage in, if any...
+        MemoryTracker(const size_t Limit = 0, Metrics *Registry = NULL);
+
+        // Charge bytes to a category...
+        void Charge(const CategoryType Category, const size_t Bytes);
+
+        // Get a category's short, untranslated name, as used in metrics...
+        static const char *GetCategoryName(const CategoryType Category);
+
+        // Get the bytes currently charged to a category...
+        size_t GetCurrent(const CategoryType Category) const
+            { return m_Current[Category].load(); }
+
+        // Get the limit, or zero if there is none...
+        size_t GetLimit() const { return m_Limit; }
+
+        // Get the most bytes ever charged to a category at once...
+        size_t GetPeak(const CategoryType Category) const
+            { return m_Peak[Category].load(); }
+
+        // Get the peak resident set size of the whole process, in bytes, or
+        //  zero if unknown...
+        static size_t GetPeakResidentSetSize();
+
+        // Get the bytes currently charged across all categories, and the most
+        //  ever charged at once...
+        size_t GetTotal() const { return m_Total.load(); }
+        size_t GetTotalPeak() const { return m_TotalPeak.load(); }
+
+        // Publish the peak resident set size of the process in the metrics
+        //  registry, if any...
+        void PublishPeakResidentSetSize() const;
+
+        // Release bytes previously charged to a category...
+        void Release(const CategoryType Category, const size_t Bytes);
+
+        // Check whether charging the given bytes more would exceed the limit,
+        //  if there is one...
+        bool WouldExceedLimit(const size_t Bytes) const
+            { return (m_Limit != 0) && (m_Total.load() + Bytes > m_Limit); }
+
+        // Write a table of the current and peak bytes of each category,
+        //  followed by the peak resident set size of the process...
+        void WriteSummary(std::ostream &Stream) const;
+
+    // Protected methods...
+    protected:
+
+        // Format a byte count with a binary unit for people to read...
+        static std::string FormatBytes(const size_t Bytes);
+
+        // Raise a peak to the given value, if higher, returning true if it
+        //  was...
+        static bool RaisePeak(std::atomic<size_t> &Peak, const size_t Value);
+
+    // Protected data...
+    protected:
+
+        // Bytes currently charged to each category...
+        std::atomic<size_t>     m_Current[Categories];
+
+        // Most bytes that may be charged at once, or zero for no limit...
+        const size_t            m_Limit;
+
+        // Metrics registry to publish usage in, if any...
+        Metrics                *m_Metrics;
+
+        // Most bytes ever charged to each category at once...
+        std::atomic<size_t>     m_Peak[Categories];
+
+        // Bytes currently charged across all categories, and the most ever...
+        std::atomic<size_t>     m_Total;
+        std::atomic<size_t>     m_TotalPeak;
+
+    // Private methods...
+    private:
+
+        // Forbid copy constructor and assignment...
+        MemoryTracker(const MemoryTracker &);
+        MemoryTracker &operator=(const MemoryTracker &);
+};
+
+// Multiple include protection...
+#endif
+
@@ -0,0 +1,318 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "MetadataCatalogue.h"
+    #include "Miscellaneous.h"
+
+    // System headers...
+    #include <algorithm>
+    #include <cstdio>
+    #include <sstream>
+
+    // POSIX headers...
+    #include <unistd.h>
+
+// Using the standard namespace...
+using namespace std;
+
+// Every column a row may have, in the order they are written. Band rows leave
+//  the image only columns empty and image rows leave the band only ones...
+static const char *CatalogueColumns[] =
+{
+    "record",
+    "kind",
+    "image_file",
+    "camera_event",
+    "solar_day",
+    "lander",
+    "month",
+    "width",
+    "height",
+    "band_count",
+    "bands",
+    "diode_band_type",
+    "input_file",
+    "file_size",
+    "magnetic_tape",
+    "magnetic_tape_file_ordinal",
+    "physical_record_size",
+    "physical_record_padding",
+    "raw_image_offset",
+    "phase_offset_required",
+    "basic_heuristic_method",
+    "azimuth_elevation",
+    "overlay_axis_present",
+    "overlay_full_histogram_present",
+    "mean_pixel_value",
+    "minimum_pixel_value",
+    "maximum_pixel_value",
+    "pixel_value_variance",
+    "dropout_scanlines",
+    "saturated_pixels",
+    "histogram"
+};
+
+// Constructor creates the catalogue file within the output root directory, or
+//  throws an error...
+MetadataCatalogue::MetadataCatalogue(
+    const string &OutputRootDirectory,
+    const FormatType Format,
+    const bool Overwrite,
+    const bool Resume)
+    : m_Buffer(METADATA_CATALOGUE_BUFFER_SIZE),
+      m_FileName(OutputRootDirectory +
+        ((Format == FormatCsv) ? "catalogue.csv" : "catalogue.jsonl")),
+      m_Format(Format),
+      m_OutputRootDirectory(OutputRootDirectory)
+{
+    // Check if a previous run left one behind...
+    const bool Exists = (access(m_FileName.c_str(), F_OK) == 0);
+
+    // Overwrite not enabled and catalogue already existed, don't overwrite,
+    //  unless resuming the run that left it...
+    if(!Resume && !Overwrite && Exists)
+        throw string(_("output metadata catalogue already exists, not overwriting (use --overwrite to override)"));
+
+    // Collect rows in a large buffer so they reach the file in big writes
+    //  rather than a line at a time, then create the catalogue or append to
+    //  the one being resumed...
+    m_Stream.rdbuf()->pubsetbuf(&m_Buffer[0], m_Buffer.size());
+    m_Stream.open(m_FileName.c_str(), ios::out | ios::binary | (Resume ? ios::app : ios::trunc));
+
+        // Failed...
+        if(!m_Stream.is_open())
+            throw string(_("could not create output metadata catalogue: ")) + m_FileName;
+
+    // CSV begins with a header naming every column, unless it was already
+    //  written before...
+    if(m_Format == FormatCsv && !(Resume && Exists))
+    {
+        for(size_t Column = 0; Column < sizeof(CatalogueColumns) / sizeof(CatalogueColumns[0]); ++Column)
+            m_Stream << (Column ? "," : "") << CatalogueColumns[Column];
+        m_Stream << '\n';
+    }
+}
+
+// Add a row for each of the bands an output image was made from, followed by
+//  one for the image itself, or throw an error. The kind is one of colour,
+//  grayscale, or unreconstructable...
+void MetadataCatalogue::AddImage(
+    const string &ImageFileName,
+    const string &Kind,
+    const ImageBandListType &ImageBandList)
+{
+    // Image file name relative to the catalogue...
+    const string RelativeImageFileName =
+        (ImageFileName.compare(0, m_OutputRootDirectory.length(), m_OutputRootDirectory) == 0) ?
+            ImageFileName.substr(m_OutputRootDirectory.length()) : ImageFileName;
+
+    // Output image is only as large as its smallest band, and is described
+    //  by its band types...
+    size_t Width    = 0;
+    size_t Height   = 0;
+    string Bands;
+
+    // One row for each band...
+    for(ImageBandListType::const_iterator Iterator = ImageBandList.begin();
+        Iterator != ImageBandList.end();
+      ++Iterator)
+    {
+        // Get image and its quality statistics...
+        const VicarImageBand &ImageBand = *Iterator;
+        const BandStatistics &Statistics = ImageBand.GetStatistics();
+
+        // Fold into the image's dimensions and band list...
+        const bool First = (Iterator == ImageBandList.begin());
+        Width   = First ? ImageBand.GetTransformedWidth() : min(Width, ImageBand.GetTransformedWidth());
+        Height  = First ? ImageBand.GetTransformedHeight() : min(Height, ImageBand.GetTransformedHeight());
+        Bands  += (First ? "" : " ") + ImageBand.GetDiodeBandTypeFriendlyString();
+
+        // Format the histogram as a JSON array or space separated in CSV...
+        stringstream Histogram;
+        Histogram << ((m_Format == FormatJsonLines) ? "[" : "");
+        for(size_t Bin = 0; Bin < BAND_STATISTICS_HISTOGRAM_BINS; ++Bin)
+        {
+            Histogram
+                << (Bin ? ((m_Format == FormatJsonLines) ? "," : " ") : "")
+                << Statistics.GetHistogramBin(Bin);
+        }
+        Histogram << ((m_Format == FormatJsonLines) ? "]" : "");
+
+        // Describe the band...
+        RowType Row;
+        SetStringField(Row, "record", "band");
+        SetStringField(Row, "kind", Kind);
+        SetStringField(Row, "image_file", RelativeImageFileName);
+        SetStringField(Row, "camera_event", ImageBand.GetCameraEventLabelNoSol());
+        SetNumberField(Row, "solar_day", ImageBand.GetSolarDay());
+        SetNumberField(Row, "lander", ImageBand.GetLanderNumber());
+        SetStringField(Row, "month", ImageBand.GetMonth());
+        SetNumberField(Row, "width", ImageBand.GetTransformedWidth());
+        SetNumberField(Row, "height", ImageBand.GetTransformedHeight());
+        SetStringField(Row, "diode_band_type", ImageBand.GetDiodeBandTypeFriendlyString());
+        SetStringField(Row, "input_file", ImageBand.GetInputFileNameOnly());
+        SetNumberField(Row, "file_size", ImageBand.GetFileSize());
+        SetNumberField(Row, "magnetic_tape", ImageBand.GetMagneticTapeNumber());
+        SetNumberField(Row, "magnetic_tape_file_ordinal", ImageBand.GetFileOrdinalOnMagneticTape());
+        SetNumberField(Row, "physical_record_size", ImageBand.GetPhysicalRecordSize());
+        SetNumberField(Row, "physical_record_padding", ImageBand.GetPhysicalRecordPadding());
+        SetNumberField(Row, "raw_image_offset", ImageBand.GetRawImageOffset());
+        SetNumberField(Row, "phase_offset_required", ImageBand.GetPhaseOffsetRequired());
+        SetNumberField(Row, "basic_heuristic_method", ImageBand.GetBasicMetadataParserHeuristic());
+        SetStringField(Row, "azimuth_elevation", ImageBand.GetAzimuthElevation());
+        SetBooleanField(Row, "overlay_axis_present", ImageBand.IsAxisPresent());
+        SetBooleanField(Row, "overlay_full_histogram_present", ImageBand.IsFullHistogramPresent());
+        SetNumberField(Row, "mean_pixel_value", ImageBand.GetMeanPixelValue());
+        SetNumberField(Row, "minimum_pixel_value", static_cast<int>(Statistics.GetMinimum()));
+        SetNumberField(Row, "maximum_pixel_value", static_cast<int>(Statistics.GetMaximum()));
+        SetNumberField(Row, "pixel_value_variance", Statistics.GetVariance());
+        SetNumberField(Row, "dropout_scanlines", Statistics.GetDropoutRows());
+        SetNumberField(Row, "saturated_pixels", Statistics.GetSaturatedPixels());
+        Row["histogram"] = FieldType(Histogram.str(), m_Format == FormatCsv);
+        WriteRow(Row);
+    }
+
+    // Nothing more to say without any bands...
+    if(ImageBandList.empty())
+        return;
+
+    // Describe the image itself...
+    const VicarImageBand &FirstImageBand = ImageBandList.front();
+    RowType Row;
+    SetStringField(Row, "record", "image");
+    SetStringField(Row, "kind", Kind);
+    SetStringField(Row, "image_file", RelativeImageFileName);
+    SetStringField(Row, "camera_event", FirstImageBand.GetCameraEventLabelNoSol());
+    SetNumberField(Row, "solar_day", FirstImageBand.GetSolarDay());
+    SetNumberField(Row, "lander", FirstImageBand.GetLanderNumber());
+    SetStringField(Row, "month", FirstImageBand.GetMonth());
+    SetNumberField(Row, "width", Width);
+    SetNumberField(Row, "height", Height);
+    SetNumberField(Row, "band_count", ImageBandList.size());
+    SetStringField(Row, "bands", Bands);
+    WriteRow(Row);
+}
+
+// Flush and close the catalogue, or throw an error...
+void MetadataCatalogue::Close()
+{
+    // Close and check for error...
+    m_Stream.close();
+    if(m_Stream.fail())
+        throw string(_("could not write output metadata catalogue: ")) + m_FileName;
+}
+
+// Push every row added so far out to the file, or throw an error...
+void MetadataCatalogue::Flush()
+{
+    // Flush and check for error...
+    m_Stream.flush();
+    if(m_Stream.fail())
+        throw string(_("could not write output metadata catalogue: ")) + m_FileName;
+}
+
+// Escape a value for a CSV field, quoting it if necessary...
+string MetadataCatalogue::EscapeCsv(const string &Value)
+{
+    // Nothing that needs quoting...
+    if(Value.find_first_of(",\"\r\n") == string::npos)
+        return Value;
+
+    // Quote, doubling any quotes within...
+    string Escaped = "\"";
+    for(string::const_iterator Iterator = Value.begin(); Iterator != Value.end(); ++Iterator)
+        Escaped += (*Iterator == '"') ? string("\"\"") : string(1, *Iterator);
+    return Escaped + "\"";
+}
+
+// Set a field of a row to a boolean...
+void MetadataCatalogue::SetBooleanField(RowType &Row, const string &Column, const bool Value)
+{
+    Row[Column] = FieldType(Value ? "true" : "false", false);
+}
+
+// Set a field of a row to a number...
+template <typename NumberType>
+void MetadataCatalogue::SetNumberField(RowType &Row, const string &Column, const NumberType Value)
+{
+    stringstream Formatted;
+    Formatted << Value;
+    Row[Column] = FieldType(Formatted.str(), false);
+}
+
+// Set a field of a row to a string...
+void MetadataCatalogue::SetStringField(RowType &Row, const string &Column, const string &Value)
+{
+    Row[Column] = FieldType(Value, true);
+}
+
+// Write a row out in the catalogue's format, or throw an error...
+void MetadataCatalogue::WriteRow(const RowType &Row)
+{
+    // Variables...
+    bool First = true;
+
+    // JSON objects are braced...
+    if(m_Format == FormatJsonLines)
+        m_Stream << '{';
+
+    // Write each column in order...
+    for(size_t Column = 0; Column < sizeof(CatalogueColumns) / sizeof(CatalogueColumns[0]); ++Column)
+    {
+        // Find the field for this column...
+        const RowType::const_iterator Field = Row.find(CatalogueColumns[Column]);
+
+        // CSV has every column, leaving those without a field empty...
+        if(m_Format == FormatCsv)
+        {
+            m_Stream << (Column ? "," : "");
+            if(Field != Row.end())
+                m_Stream << EscapeCsv(Field->second.m_Value);
+            continue;
+        }
+
+        // JSON only has the fields present...
+        if(Field == Row.end())
+            continue;
+
+        // Write the member...
+        m_Stream << (First ? "" : ",") << '"' << CatalogueColumns[Column] << "\":";
+        if(Field->second.m_Quoted)
+            m_Stream << '"' << EscapeJson(Field->second.m_Value) << '"';
+        else
+            m_Stream << Field->second.m_Value;
+        First = false;
+    }
+
+    // End of the row...
+    m_Stream << ((m_Format == FormatJsonLines) ? "}\n" : "\n");
+
+    // Check for error...
+    if(!m_Stream.good())
+        throw string(_("could not write output metadata catalogue: ")) + m_FileName;
+}
+
@@ -0,0 +1,160 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _METADATA_CATALOGUE_H_
+#define _METADATA_CATALOGUE_H_
+
+// Includes...
+
+    // Our headers...
+    #include "VicarImageBand.h"
+
+    // System headers...
+    #include <fstream>
+    #include <map>
+    #include <string>
+    #include <vector>
+    #include <clocale>
+
+    // i18n...
+    #include "gettext.h"
+    #define _(str) gettext (str)
+    #define N_(str) gettext_noop (str)
+
+// Size of the buffer catalogue rows are collected in before being written...
+#define METADATA_CATALOGUE_BUFFER_SIZE (1024 * 1024)
+
+// A single machine readable catalogue of the metadata of every image written
+//  during a run, with one row per band and one per output image, written
+//  incrementally as each image is completed...
+class MetadataCatalogue
+{
+    // Public types...
+    public:
+
+        // Catalogue format...
+        typedef enum
+        {
+            // Comma separated values with a header row...
+            FormatCsv,
+
+            // One JSON object per line...
+            FormatJsonLines
+
+        }FormatType;
+
+        // List of the image bands an output image was made from...
+        typedef std::vector<VicarImageBand> ImageBandListType;
+
+    // Public methods...
+    public:
+
+        // Constructor creates the catalogue file within the output root
+        //  directory, replacing one already there only if allowed to
+        //  overwrite, or appends to the one an interrupted run left there
+        //  if resuming, or throws an error...
+        MetadataCatalogue(
+            const std::string &OutputRootDirectory,
+            const FormatType Format,
+            const bool Overwrite,
+            const bool Resume = false);
+
+        // Add a row for each of the bands an output image was made from,
+        //  followed by one for the image itself, or throw an error. The kind
+        //  is one of colour, grayscale, or unreconstructable...
+        void AddImage(
+            const std::string &ImageFileName,
+            const std::string &Kind,
+            const ImageBandListType &ImageBandList);
+
+        // Flush and close the catalogue, or throw an error...
+        void Close();
+
+        // Push every row added so far out to the file, or throw an error...
+        void Flush();
+
+        // Get the name of the catalogue file...
+        const std::string &GetFileName() const { return m_FileName; }
+
+    // Protected types...
+    protected:
+
+        // A field value and whether it needs quoting as a JSON string...
+        struct FieldType
+        {
+            // Default constructor...
+            FieldType()
+                : m_Quoted(false)
+            { }
+
+            // Constructor initializer...
+            FieldType(const std::string &Value, const bool Quoted)
+                : m_Quoted(Quoted), m_Value(Value)
+            { }
+
+            // Quote as a JSON string...
+            bool                m_Quoted;
+
+            // Value formatted as text...
+            std::string         m_Value;
+        };
+
+        // Fields of a row by column name...
+        typedef std::map<std::string, FieldType> RowType;
+
+    // Protected methods...
+    protected:
+
+        // Escape a value for a CSV field, quoting it if necessary...
+        static std::string EscapeCsv(const std::string &Value);
+
+        // Set a field of a row to a boolean, number, or string...
+        static void SetBooleanField(RowType &Row, const std::string &Column, const bool Value);
+        template <typename NumberType>
+        static void SetNumberField(RowType &Row, const std::string &Column, const NumberType Value);
+        static void SetStringField(RowType &Row, const std::string &Column, const std::string &Value);
+
+        // Write a row out in the catalogue's format, or throw an error...
+        void WriteRow(const RowType &Row);
+
+    // Protected data...
+    protected:
+
+        // Buffer the catalogue stream collects rows in...
+        std::vector<char>   m_Buffer;
+
+        // Name of the catalogue file...
+        std::string         m_FileName;
+
+        // Format of the catalogue...
+        FormatType          m_Format;
+
+        // Output root directory, stripped from image file names...
+        std::string         m_OutputRootDirectory;
+
+        // Catalogue being written...
+        std::ofstream       m_Stream;
+};
+
+// Multiple include protection...
+#endif
+
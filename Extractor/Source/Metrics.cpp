@@ -0,0 +1,476 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "Metrics.h"
+
+    // System headers...
+    #include <cassert>
+    #include <cerrno>
+    #include <cstdio>
+    #include <cstring>
+    #include <fstream>
+    #include <sstream>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/time.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+
+// Using the standard namespace...
+using namespace std;
+
+// Every metric family that may be updated, in the order they are written...
+static const struct
+{
+    // Name of the family...
+    const char *m_Name;
+
+    // Prometheus metric type...
+    const char *m_Type;
+
+    // Whether it has a single series without labels, exported as zero until
+    //  first updated...
+    bool        m_Unlabelled;
+
+    // Description...
+    const char *m_Help;
+}
+Families[] =
+{
+    { "viking_extractor_jobs_total", "counter", false,
+        "Extractions run, by outcome." },
+    { "viking_extractor_files_indexed_total", "counter", true,
+        "Prospective input files found while indexing the input." },
+    { "viking_extractor_bands_loaded_total", "counter", false,
+        "Image bands loaded and indexed into a camera event, by where they were loaded from." },
+    { "viking_extractor_bands_rejected_total", "counter", false,
+        "Image bands rejected, by reason, being indexed when rejected for a reason a band index or run journal did not remember." },
+    { "viking_extractor_bytes_read_total", "counter", false,
+        "Bytes of band headers and pixel data read, raw as stored on the media, estimated from the compression ratio of archive members, or inflated." },
+    { "viking_extractor_phase_offsets_total", "counter", true,
+        "Image bands whose records needed a phase offset to decode." },
+    { "viking_extractor_tangential_record_boundaries_total", "counter", true,
+        "Tangential physical record boundaries whose padding was skipped." },
+    { "viking_extractor_ocr_passes_total", "counter", false,
+        "OCR passes over image band annotations, by rotation." },
+    { "viking_extractor_ocr_cache_hits_total", "counter", true,
+        "OCR passes skipped because the annotation was already recognized at another orientation." },
+    { "viking_extractor_camera_events_total", "counter", false,
+        "Camera events reconstructed or that failed to be, by outcome." },
+    { "viking_extractor_components_dumped_total", "counter", true,
+        "Image band components of unreconstructable camera events dumped as is." },
+    { "viking_extractor_memory_bytes", "gauge", false,
+        "Bytes of large allocations currently accounted to each category, summed over running extractions." },
+    { "viking_extractor_memory_peak_bytes", "gauge", false,
+        "Most bytes of large allocations any one extraction accounted to each category at once." },
+    { "viking_extractor_peak_resident_bytes", "gauge", true,
+        "Peak resident set size of the process as of the last extraction to finish." },
+    { "viking_extractor_emulated_seeks_total", "counter", false,
+        "Seeks the drive head of emulated input media made." },
+    { "viking_extractor_stage_duration_seconds", "histogram", false,
+        "Time spent within each stage of the extraction." }
+};
+
+// Upper bound of each latency histogram bucket, in seconds...
+static const double LatencyBuckets[METRICS_LATENCY_BUCKETS] =
+{
+    0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+    0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+};
+
+// Check if a family was described...
+static bool IsFamily(const char *Name, const char *Type)
+{
+    // Search...
+    for(size_t Index = 0; Index < sizeof(Families) / sizeof(Families[0]); ++Index)
+    {
+        if(strcmp(Families[Index].m_Name, Name) == 0)
+            return strcmp(Families[Index].m_Type, Type) == 0;
+    }
+
+    // Not found...
+    return false;
+}
+
+// Default constructor...
+Metrics::Metrics()
+    : m_ServerSocket(-1),
+      m_Serving(false)
+{
+    // Export unlabelled counters and gauges as zero before they are first incremented...
+    for(size_t Index = 0; Index < sizeof(Families) / sizeof(Families[0]); ++Index)
+    {
+        if(Families[Index].m_Unlabelled)
+            m_Counters[Families[Index].m_Name][string()] = 0;
+    }
+}
+
+// Increment a counter by the given amount...
+void Metrics::Increment(
+    const char *Name,
+    const string &Labels,
+    const uint64_t Amount)
+{
+    // Must have been described...
+    assert(IsFamily(Name, "counter"));
+
+    // Lock and increment...
+    lock_guard<mutex> Lock(m_Mutex);
+    m_Counters[Name][Labels] += Amount;
+}
+
+// Adjust a gauge up or down by the given amount...
+void Metrics::Adjust(
+    const char *Name,
+    const string &Labels,
+    const int64_t Amount)
+{
+    // Must have been described...
+    assert(IsFamily(Name, "gauge"));
+
+    // Lock and adjust, the series never going below zero overall...
+    lock_guard<mutex> Lock(m_Mutex);
+    m_Counters[Name][Labels] += static_cast<uint64_t>(Amount);
+}
+
+// Format a label to identify a series by, escaping its value...
+string Metrics::Label(const char *Name, const string &Value)
+{
+    // Variables...
+    string Label = string(Name) + "=\"";
+
+    // Escape backslashes, quotes, and line feeds...
+    for(string::const_iterator Character = Value.begin();
+        Character != Value.end();
+      ++Character)
+    {
+        switch(*Character)
+        {
+            case '\\':  Label += "\\\\"; break;
+            case '"':   Label += "\\\""; break;
+            case '\n':  Label += "\\n"; break;
+            default:    Label += *Character; break;
+        }
+    }
+
+    // Close it...
+    Label += "\"";
+    return Label;
+}
+
+// Observe a latency, in seconds, in a histogram...
+void Metrics::Observe(
+    const char *Name,
+    const string &Labels,
+    const double Seconds)
+{
+    // Must have been described...
+    assert(IsFamily(Name, "histogram"));
+
+    // Lock the series...
+    lock_guard<mutex> Lock(m_Mutex);
+    HistogramType &Histogram = m_Histograms[Name][Labels];
+
+    // Count it in the first bucket it fits in, if any, leaving the rest to
+    //  be made cumulative when written...
+    for(size_t Bucket = 0; Bucket < METRICS_LATENCY_BUCKETS; ++Bucket)
+    {
+        if(Seconds <= LatencyBuckets[Bucket])
+        {
+          ++Histogram.m_Buckets[Bucket];
+            break;
+        }
+    }
+
+    // Update totals...
+  ++Histogram.m_Count;
+    Histogram.m_Sum += Seconds;
+}
+
+// Raise a gauge to the given value, if higher than it already is...
+void Metrics::Raise(
+    const char *Name,
+    const string &Labels,
+    const uint64_t Value)
+{
+    // Must have been described...
+    assert(IsFamily(Name, "gauge"));
+
+    // Lock and raise...
+    lock_guard<mutex> Lock(m_Mutex);
+    uint64_t &Series = m_Counters[Name][Labels];
+    if(Value > Series)
+        Series = Value;
+}
+
+// Start serving the metrics over a Unix domain socket at the given path,
+//  answering each connection with a plain HTTP response so a scraper or curl
+//  --unix-socket can read them, or throw an error...
+void Metrics::Serve(const string &SocketPath)
+{
+    // Variables...
+    sockaddr_un Address;
+    struct stat Status;
+
+    // Already serving...
+    assert(!m_Server.joinable());
+
+    // Path must fit in the address...
+    memset(&Address, 0, sizeof(Address));
+    if(SocketPath.size() >= sizeof(Address.sun_path))
+        throw string(_("metrics socket path too long: ")) + SocketPath;
+    Address.sun_family = AF_UNIX;
+    strncpy(Address.sun_path, SocketPath.c_str(), sizeof(Address.sun_path) - 1);
+
+    // Replace a socket a previous run left behind, but never anything else
+    //  that happens to be at the path...
+    if(lstat(SocketPath.c_str(), &Status) == 0)
+    {
+        // Not a socket...
+        if(!S_ISSOCK(Status.st_mode))
+            throw string(_("could not serve metrics on ")) + SocketPath + " (" + strerror(EEXIST) + ")";
+
+        // Stale socket...
+        unlink(SocketPath.c_str());
+    }
+
+    // Listen...
+    m_ServerSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(m_ServerSocket == -1 ||
+       bind(m_ServerSocket, reinterpret_cast<sockaddr *>(&Address), sizeof(Address)) == -1 ||
+       listen(m_ServerSocket, 8) == -1)
+    {
+        // Cleanup and alert caller...
+        const string Reason = strerror(errno);
+        if(m_ServerSocket != -1)
+            close(m_ServerSocket);
+        m_ServerSocket = -1;
+        throw string(_("could not serve metrics on ")) + SocketPath + " (" + Reason + ")";
+    }
+
+    // Start answering...
+    m_SocketPath    = SocketPath;
+    m_Serving       = true;
+    m_Server        = thread(&Metrics::ServerThread, this);
+}
+
+// Accept and answer connections until told to stop...
+void Metrics::ServerThread()
+{
+    // Keep answering while serving...
+    while(m_Serving)
+    {
+        // Wait a short while for a connection so we notice being stopped...
+        pollfd Poll;
+        Poll.fd         = m_ServerSocket;
+        Poll.events     = POLLIN;
+        Poll.revents    = 0;
+        if(poll(&Poll, 1, 250) <= 0)
+            continue;
+
+        // Accept it...
+        const int Client = accept(m_ServerSocket, NULL, NULL);
+        if(Client == -1)
+            continue;
+
+        // Don't let a stalled client hold us up for long...
+        timeval Timeout;
+        Timeout.tv_sec  = 1;
+        Timeout.tv_usec = 0;
+        setsockopt(Client, SOL_SOCKET, SO_RCVTIMEO, &Timeout, sizeof(Timeout));
+        setsockopt(Client, SOL_SOCKET, SO_SNDTIMEO, &Timeout, sizeof(Timeout));
+
+        // Read the request up to the end of its header, whatever it asked
+        //  for, since there is only the one thing to answer with...
+        string Request;
+        char Buffer[512];
+        while(Request.find("\r\n\r\n") == string::npos && Request.size() < 4096)
+        {
+            const ssize_t BytesRead = recv(Client, Buffer, sizeof(Buffer), 0);
+            if(BytesRead <= 0)
+                break;
+            Request.append(Buffer, BytesRead);
+        }
+
+        // Format the response...
+        ostringstream Body;
+        Write(Body);
+        ostringstream Response;
+        Response
+            << "HTTP/1.0 200 OK\r\n"
+            << "Content-Type: text/plain; version=0.0.4\r\n"
+            << "Content-Length: " << Body.str().size() << "\r\n"
+            << "Connection: close\r\n\r\n"
+            << Body.str();
+
+        // Send it, giving up on the client if it goes away...
+        const string Data = Response.str();
+        size_t Sent = 0;
+        while(Sent < Data.size())
+        {
+            const ssize_t BytesSent =
+                send(Client, Data.data() + Sent, Data.size() - Sent, MSG_NOSIGNAL);
+            if(BytesSent <= 0)
+                break;
+            Sent += BytesSent;
+        }
+
+        // Done with it...
+        close(Client);
+    }
+}
+
+// Stop serving the metrics, if serving...
+void Metrics::StopServing()
+{
+    // Not serving...
+    if(!m_Server.joinable())
+        return;
+
+    // Tell the server thread to stop and wait for it...
+    m_Serving = false;
+    m_Server.join();
+
+    // Stop listening...
+    close(m_ServerSocket);
+    m_ServerSocket = -1;
+    unlink(m_SocketPath.c_str());
+}
+
+// Write the metrics in the text exposition format...
+void Metrics::Write(ostream &Stream) const
+{
+    // Format in a stream of our own so the caller's precision is left
+    //  alone...
+    ostringstream Text;
+    Text.precision(9);
+
+    // Lock the series...
+    lock_guard<mutex> Lock(m_Mutex);
+
+    // Write each family in the order described...
+    for(size_t Index = 0; Index < sizeof(Families) / sizeof(Families[0]); ++Index)
+    {
+        // Get the family...
+        const char *Name = Families[Index].m_Name;
+
+        // A counter or gauge...
+        if(strcmp(Families[Index].m_Type, "histogram") != 0)
+        {
+            // Nothing updated yet...
+            map<string, CounterSeriesMapType>::const_iterator Family = m_Counters.find(Name);
+            if(Family == m_Counters.end())
+                continue;
+
+            // Describe it...
+            Text << "# HELP " << Name << " " << Families[Index].m_Help << "\n"
+                 << "# TYPE " << Name << " " << Families[Index].m_Type << "\n";
+
+            // Write each series...
+            for(CounterSeriesMapType::const_iterator Series = Family->second.begin();
+                Series != Family->second.end();
+              ++Series)
+            {
+                Text << Name;
+                if(!Series->first.empty())
+                    Text << "{" << Series->first << "}";
+                Text << " " << Series->second << "\n";
+            }
+        }
+
+        // A histogram...
+        else
+        {
+            // Nothing observed yet...
+            map<string, HistogramSeriesMapType>::const_iterator Family = m_Histograms.find(Name);
+            if(Family == m_Histograms.end())
+                continue;
+
+            // Describe it...
+            Text << "# HELP " << Name << " " << Families[Index].m_Help << "\n"
+                 << "# TYPE " << Name << " histogram\n";
+
+            // Write each series...
+            for(HistogramSeriesMapType::const_iterator Series = Family->second.begin();
+                Series != Family->second.end();
+              ++Series)
+            {
+                // Labels each bucket is qualified with...
+                const string Prefix = Series->first.empty() ? string() : Series->first + ",";
+                const HistogramType &Histogram = Series->second;
+
+                // Cumulative buckets...
+                uint64_t Cumulative = 0;
+                for(size_t Bucket = 0; Bucket < METRICS_LATENCY_BUCKETS; ++Bucket)
+                {
+                    Cumulative += Histogram.m_Buckets[Bucket];
+                    Text << Name << "_bucket{" << Prefix
+                         << "le=\"" << LatencyBuckets[Bucket] << "\"} "
+                         << Cumulative << "\n";
+                }
+                Text << Name << "_bucket{" << Prefix << "le=\"+Inf\"} "
+                     << Histogram.m_Count << "\n";
+
+                // Totals...
+                const string Labels = Series->first.empty() ? string() : "{" + Series->first + "}";
+                Text << Name << "_sum" << Labels << " " << Histogram.m_Sum << "\n"
+                     << Name << "_count" << Labels << " " << Histogram.m_Count << "\n";
+            }
+        }
+    }
+
+    // Write it out...
+    Stream << Text.str();
+}
+
+// Write the metrics to a textfile, replacing it atomically so the collector
+//  never sees it half written, or throw an error...
+void Metrics::WriteTextfile(const string &FileName) const
+{
+    // Write beside it first...
+    const string TemporaryFileName = FileName + ".tmp";
+    ofstream Stream(TemporaryFileName.c_str(), ios::out | ios::trunc);
+    if(!Stream.is_open())
+        throw string(_("could not create metrics: ")) + TemporaryFileName;
+    Write(Stream);
+    Stream.close();
+    if(Stream.fail())
+        throw string(_("could not write metrics: ")) + TemporaryFileName;
+
+    // Then replace it...
+    if(rename(TemporaryFileName.c_str(), FileName.c_str()) != 0)
+        throw string(_("could not replace metrics: ")) + FileName;
+}
+
+// Deconstructor...
+Metrics::~Metrics()
+{
+    // Stop serving, if we were...
+    StopServing();
+}
+
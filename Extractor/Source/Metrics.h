@@ -0,0 +1,178 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+// Includes...
+
+    // System headers...
+    #include <atomic>
+    #include <cstddef>
+    #include <map>
+    #include <mutex>
+    #include <ostream>
+    #include <string>
+    #include <thread>
+    #include <stdint.h>
+    #include <clocale>
+
+    // i18n...
+    #include "gettext.h"
+    #define _(str) gettext (str)
+    #define N_(str) gettext_noop (str)
+
+// Number of finite upper bounds of each latency histogram's buckets...
+#define METRICS_LATENCY_BUCKETS 14
+
+// Operational counters, gauges, and latency histograms of every extraction
+//  the process runs, exported in the Prometheus text exposition format either as a
+//  textfile for the node exporter to collect or served over a local socket to
+//  whoever asks while a daemon stays resident. Only the metric families
+//  described in Metrics.cpp may be updated, each series of a family being
+//  told apart by its labels, formatted with Label()...
+class Metrics
+{
+    // Public methods...
+    public:
+
+        // Default constructor...
+        Metrics();
+
+        // Adjust a gauge up or down by the given amount...
+        void Adjust(
+            const char *Name,
+            const std::string &Labels,
+            const int64_t Amount);
+
+        // Increment a counter by the given amount...
+        void Increment(
+            const char *Name,
+            const std::string &Labels = std::string(),
+            const uint64_t Amount = 1);
+
+        // Format a label to identify a series by, escaping its value...
+        static std::string Label(const char *Name, const std::string &Value);
+
+        // Observe a latency, in seconds, in a histogram...
+        void Observe(
+            const char *Name,
+            const std::string &Labels,
+            const double Seconds);
+
+        // Raise a gauge to the given value, if higher than it already is...
+        void Raise(
+            const char *Name,
+            const std::string &Labels,
+            const uint64_t Value);
+
+        // Start serving the metrics over a Unix domain socket at the given
+        //  path, answering each connection with a plain HTTP response so a
+        //  scraper or curl --unix-socket can read them, or throw an
+        //  error...
+        void Serve(const std::string &SocketPath);
+
+        // Stop serving the metrics, if serving...
+        void StopServing();
+
+        // Write the metrics in the text exposition format...
+        void Write(std::ostream &Stream) const;
+
+        // Write the metrics to a textfile, replacing it atomically so the
+        //  collector never sees it half written, or throw an error...
+        void WriteTextfile(const std::string &FileName) const;
+
+        // Deconstructor...
+       ~Metrics();
+
+    // Protected types...
+    protected:
+
+        // A histogram series...
+        struct HistogramType
+        {
+            // Constructor initializer...
+            HistogramType()
+                : m_Count(0),
+                  m_Sum(0.0)
+            {
+                for(size_t Bucket = 0; Bucket < METRICS_LATENCY_BUCKETS; ++Bucket)
+                    m_Buckets[Bucket] = 0;
+            }
+
+            // Observations at or below each bucket's upper bound, not yet
+            //  made cumulative...
+            uint64_t            m_Buckets[METRICS_LATENCY_BUCKETS];
+
+            // Number of observations and their sum...
+            uint64_t            m_Count;
+            double              m_Sum;
+        };
+
+        // Series of a family by their labels...
+        typedef std::map<std::string, uint64_t> CounterSeriesMapType;
+        typedef std::map<std::string, HistogramType> HistogramSeriesMapType;
+
+    // Protected methods...
+    protected:
+
+        // Accept and answer connections until told to stop...
+        void ServerThread();
+
+    // Protected data...
+    protected:
+
+        // Counter and gauge series by family name...
+        std::map<std::string, CounterSeriesMapType>
+                                m_Counters;
+
+        // Histogram series by family name...
+        std::map<std::string, HistogramSeriesMapType>
+                                m_Histograms;
+
+        // Guards the counters, gauges, and histograms...
+        mutable std::mutex      m_Mutex;
+
+        // Thread answering connections, if serving...
+        std::thread             m_Server;
+
+        // Listening socket, or -1 if not serving...
+        int                     m_ServerSocket;
+
+        // Path of the listening socket...
+        std::string             m_SocketPath;
+
+        // Cleared to tell the server thread to stop...
+        std::atomic<bool>       m_Serving;
+
+    // Private methods...
+    private:
+
+        // Forbid copy constructor and assignment, since the server thread is
+        //  ours...
+        Metrics(const Metrics &);
+        Metrics &operator=(const Metrics &);
+};
+
+// Multiple include protection...
+#endif
+
@@ -74,6 +74,46 @@ bool CreateDirectoryRecursively(const std::string &Path)
         return true;
 }
 
+// Escape a value as the body of a JSON string...
+string EscapeJson(const string &Value)
+{
+    // Variables...
+    string Escaped;
+
+    // Escape quotes, backslashes, and control characters...
+    for(string::const_iterator Iterator = Value.begin(); Iterator != Value.end(); ++Iterator)
+    {
+        // Which character?
+        const unsigned char Character = *Iterator;
+        switch(Character)
+        {
+            case '"':   Escaped += "\\\""; break;
+            case '\\':  Escaped += "\\\\"; break;
+            case '\n':  Escaped += "\\n"; break;
+            case '\r':  Escaped += "\\r"; break;
+            case '\t':  Escaped += "\\t"; break;
+
+            // Anything else, which is passed through unless a control
+            //  character...
+            default:
+            {
+                if(Character < 0x20)
+                {
+                    char Code[7];
+                    snprintf(Code, sizeof(Code), "\\u%04x", Character);
+                    Escaped += Code;
+                }
+                else
+                    Escaped += Character;
+                break;
+            }
+        }
+    }
+
+    // Done...
+    return Escaped;
+}
+
 // Convert a given Martian solar day in the range [1 .. n] to Ls angle...
 float SolarDayToLs(const size_t SolarDay)
 {
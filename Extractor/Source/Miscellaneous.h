@@ -41,6 +41,9 @@
 // Create a directory and all of its parents, if necessary...
 bool CreateDirectoryRecursively(const std::string &Path);
 
+// Escape a value as the body of a JSON string...
+std::string EscapeJson(const std::string &Value);
+
 // Three way min() / max() function templates...
 template<class T> const T &min3(const T &A, const T &B, const T &C) { return std::min(A, std::min(B, C)); }
 template<class T> const T &max3(const T &A, const T &B, const T &C) { return std::max(A, std::max(B, C)); }
@@ -26,34 +26,91 @@
     
     // Our headers...
     #include "Options.h"
+#ifdef USE_DBUS_INTERFACE
+    #include "DBusInterface.h"
+#endif
     
     // System headers...
     #include <algorithm>
     #include <cctype>
+    #include <cstdlib>
     #include <limits>
     #include <iostream>
+    #include <sstream>
     
 // Using the standard namespace...
 using namespace std;
 
+// Parse a size in bytes with an optional K, M, or G binary suffix, returning
+//  false if it isn't one...
+static bool ParseSize(const string &Size, size_t &Bytes)
+{
+    // Variables...
+    char *End = NULL;
+
+    // Parse the number...
+    const unsigned long long Value = strtoull(Size.c_str(), &End, 10);
+
+        // Nothing numeric...
+        if(End == Size.c_str() || Size[0] == '-')
+            return false;
+
+    // Scale by the suffix, if any...
+    unsigned long long Scale = 1;
+    switch(toupper(*End))
+    {
+        case '\0': break;
+        case 'K':   Scale = 1024ULL; break;
+        case 'M':   Scale = 1024ULL * 1024; break;
+        case 'G':   Scale = 1024ULL * 1024 * 1024; break;
+        default:    return false;
+    }
+
+    // Nothing may follow the suffix...
+    if(*End != '\0' && *(End + 1) != '\0')
+        return false;
+
+    // Store...
+    Bytes = static_cast<size_t>(Value * Scale);
+    return true;
+}
+
 // Default constructor...
 Options::Options()
     :   m_AutoRotate(true),
+#ifdef USE_DBUS_INTERFACE
+        m_Daemon(false),
+#endif
         m_DirectorizeBandTypeClass(false),
         m_DirectorizeLocation(false),
         m_DirectorizeMonth(false),
         m_DirectorizeSol(false),
         m_DryRun(false),
+        m_EmulateMedia(false),
+        m_EmulatedSeekLatency(0),
+        m_EmulatedThroughput(0),
         m_FilterLander(0),
         m_FilterSolarDay(numeric_limits<size_t>::max()),
+        m_FsyncPolicy(OutputWriter::FsyncNone),
         m_IgnoreBadFiles(false),
         m_Interlace(false),
+        m_IoThreads(2),
         m_Jobs(1),
+        m_MemoryLimit(0),
+        m_MetadataFormat(MetadataTxt),
         m_NoReconstruct(false),
+        m_OutputArchiveFormat(ArchiveOutputSink::FormatZip),
+        m_OutputFormat(FormatPng),
         m_Overwrite(false),
+        m_ParallelDeflate(false),
+        m_Plan(false),
         m_Recursive(false),
 #ifdef USE_DBUS_INTERFACE
         m_RemoteStart(false),
+#endif
+        m_Resume(false),
+#ifdef USE_DBUS_INTERFACE
+        m_SignalRate(VIKING_EXTRACTOR_DBUS_SIGNAL_RATE),
 #endif
         m_GenerateMetadata(false),
         m_SummarizeOnly(false)
@@ -62,6 +119,49 @@ Options::Options()
     SetFilterDiodeClass("any");
 }
 
+// Emulate reading the input from slower media, either one of the dvd or
+//  network presets, or a seek latency in milliseconds and a throughput cap in
+//  bytes per second with an optional K, M, or G suffix separated by a colon,
+//  such as 100:10M, a throughput of zero being uncapped, or throw an error...
+void Options::SetEmulateMedia(const string &Media)
+{
+    // An 8x DVD drive...
+    if(Media == "dvd")
+    {
+        m_EmulatedSeekLatency   = 100;
+        m_EmulatedThroughput    = 8 * 1385000;
+    }
+
+    // Spinning disks shared over a 100 Mbit/s network...
+    else if(Media == "network")
+    {
+        m_EmulatedSeekLatency   = 5;
+        m_EmulatedThroughput    = 12500000;
+    }
+
+    // Explicit latency and throughput...
+    else
+    {
+        // Find the separator...
+        const size_t Colon = Media.find(':');
+        if(Colon == string::npos || Colon == 0 || Media[0] == '-')
+            throw string(_("invalid media to emulate: ")) + Media;
+
+        // Parse the seek latency...
+        char *End = NULL;
+        m_EmulatedSeekLatency = strtoul(Media.c_str(), &End, 10);
+        if(End != Media.c_str() + Colon)
+            throw string(_("invalid media to emulate: ")) + Media;
+
+        // Parse the throughput...
+        if(!ParseSize(Media.substr(Colon + 1), m_EmulatedThroughput))
+            throw string(_("invalid media to emulate: ")) + Media;
+    }
+
+    // Remember to...
+    m_EmulateMedia = true;
+}
+
 // Set the camera event filter...
 void Options::SetFilterCameraEvent(const std::string &CameraEvent)
 {
@@ -155,6 +255,189 @@ void Options::SetFilterLander(const size_t Lander)
     m_FilterLander = Lander;
 }
 
+// Set when to flush output files to stable storage, or throw an error...
+void Options::SetFsyncPolicy(const string &FsyncPolicy)
+{
+    // Leave it to the operating system...
+    if(FsyncPolicy == "none")
+        m_FsyncPolicy = OutputWriter::FsyncNone;
+
+    // Each file before it is renamed into place...
+    else if(FsyncPolicy == "file")
+        m_FsyncPolicy = OutputWriter::FsyncFile;
+
+    // Each file and its directory after the rename...
+    else if(FsyncPolicy == "full")
+        m_FsyncPolicy = OutputWriter::FsyncFull;
+
+    // Unsupported...
+    else
+        throw string(_("unsupported fsync policy: ")) + FsyncPolicy;
+}
+
+// Set the most bytes of large allocations an extraction may account for at
+//  once, with an optional K, M, or G binary suffix, or zero for no limit, or
+//  throw an error...
+void Options::SetMemoryLimit(const string &MemoryLimit)
+{
+    // Parse and store...
+    if(!ParseSize(MemoryLimit, m_MemoryLimit))
+        throw string(_("invalid memory limit: ")) + MemoryLimit;
+}
+
+// Set the format generated metadata is written in, which also enables
+//  generating it, or throw an error...
+void Options::SetMetadataFormat(const string &MetadataFormat)
+{
+    // Text file beside each image...
+    if(MetadataFormat == "txt")
+        m_MetadataFormat = MetadataTxt;
+
+    // Comma separated values catalogue...
+    else if(MetadataFormat == "csv")
+        m_MetadataFormat = MetadataCsv;
+
+    // JSON Lines catalogue...
+    else if(MetadataFormat == "jsonl")
+        m_MetadataFormat = MetadataJsonLines;
+
+    // Unsupported...
+    else
+        throw string(_("unsupported metadata format: ")) + MetadataFormat;
+
+    // Asking for a format implies wanting metadata...
+    m_GenerateMetadata = true;
+}
+
+// Set the archive to write all output into, its format being picked by its
+//  file name extension, or throw an error...
+void Options::SetOutputArchive(const string &OutputArchive)
+{
+    // Get the file name extension in lower case...
+    const size_t Dot = OutputArchive.find_last_of('.');
+    string Extension;
+    if(Dot != string::npos)
+    {
+        transform(
+            OutputArchive.begin() + Dot + 1,
+            OutputArchive.end(),
+            back_inserter(Extension),
+          ::tolower);
+    }
+
+    // Tar...
+    if(Extension == "tar")
+        m_OutputArchiveFormat = ArchiveOutputSink::FormatTar;
+
+    // Zip...
+    else if(Extension == "zip")
+        m_OutputArchiveFormat = ArchiveOutputSink::FormatZip;
+
+    // Unsupported...
+    else
+        throw string(_("output archive must end in .tar or .zip: ")) + OutputArchive;
+
+    // Remember it...
+    m_OutputArchive = OutputArchive;
+}
+
+// Set the output image file format or throw an error...
+void Options::SetOutputFormat(const string &OutputFormat)
+{
+    // Portable network graphics...
+    if(OutputFormat == "png")
+        m_OutputFormat = FormatPng;
+
+    // Binary PGM or PPM...
+    else if(OutputFormat == "pnm")
+        m_OutputFormat = FormatPnm;
+
+    // Raw planar with sidecar...
+    else if(OutputFormat == "raw")
+        m_OutputFormat = FormatRaw;
+
+    // Unsupported...
+    else
+        throw string(_("unsupported output format: ")) + OutputFormat;
+}
+
+// Set the PNG encoding profile from a comma separated list of level, strategy,
+//  and filter settings, such as level=9,strategy=rle,filter=paeth, or throw an
+//  error...
+void Options::SetPngProfile(const string &Profile)
+{
+    // Start from the defaults so unmentioned settings are left to libpng...
+    PngEncoder::ProfileType NewProfile;
+
+    // Examine each setting...
+    stringstream Settings(Profile);
+    string Setting;
+    while(getline(Settings, Setting, ','))
+    {
+        // Split into name and value...
+        const size_t Separator = Setting.find('=');
+        if(Separator == string::npos)
+            throw string(_("invalid png profile setting: ")) + Setting;
+        const string Name   = Setting.substr(0, Separator);
+        const string Value  = Setting.substr(Separator + 1);
+
+        // Compression level...
+        if(Name == "level")
+        {
+            // Check bounds...
+            if(Value.empty() || Value.find_first_not_of("0123456789") != string::npos ||
+               atoi(Value.c_str()) > 9)
+                throw string(_("png compression level must be from 0 to 9: ")) + Value;
+
+            // Store...
+            NewProfile.m_Level = atoi(Value.c_str());
+        }
+
+        // Compression strategy...
+        else if(Name == "strategy")
+        {
+            if(Value == "default")
+                NewProfile.m_Strategy = Z_DEFAULT_STRATEGY;
+            else if(Value == "filtered")
+                NewProfile.m_Strategy = Z_FILTERED;
+            else if(Value == "huffman")
+                NewProfile.m_Strategy = Z_HUFFMAN_ONLY;
+            else if(Value == "rle")
+                NewProfile.m_Strategy = Z_RLE;
+            else if(Value == "fixed")
+                NewProfile.m_Strategy = Z_FIXED;
+            else
+                throw string(_("unsupported png compression strategy: ")) + Value;
+        }
+
+        // Scanline filter...
+        else if(Name == "filter")
+        {
+            if(Value == "none")
+                NewProfile.m_Filter = PngEncoder::FilterNone;
+            else if(Value == "sub")
+                NewProfile.m_Filter = PngEncoder::FilterSub;
+            else if(Value == "up")
+                NewProfile.m_Filter = PngEncoder::FilterUp;
+            else if(Value == "average")
+                NewProfile.m_Filter = PngEncoder::FilterAverage;
+            else if(Value == "paeth")
+                NewProfile.m_Filter = PngEncoder::FilterPaeth;
+            else if(Value == "adaptive")
+                NewProfile.m_Filter = PngEncoder::FilterAdaptive;
+            else
+                throw string(_("unsupported png filter: ")) + Value;
+        }
+
+        // Unknown...
+        else
+            throw string(_("invalid png profile setting: ")) + Setting;
+    }
+
+    // Store...
+    m_PngProfile = NewProfile;
+}
+
 // Deconstructor...
 Options::~Options()
 {
@@ -29,8 +29,10 @@
     #include <config.h>
 
     // Our headers...
+    #include "ArchiveOutputSink.h"
+    #include "OutputWriter.h"
     #include "VicarImageBand.h"
-    #include "ExplicitSingleton.h"
+    #include "PngEncoder.h"
     
     // System headers...
     #include <string>
@@ -42,77 +44,157 @@
     #define _(str) gettext (str)
     #define N_(str) gettext_noop (str)
 
-// Options explicit singleton class...
-class Options : public ExplicitSingleton<Options>
+// Options of an extraction, parsed from the command line or set by whoever
+//  embeds the extractor...
+class Options
 {
-    // Because we are a singleton, only ExplicitSingleton can control our 
-    //  creation...
-    friend class ExplicitSingleton<Options>;
-
     // Public types...
     public:
 
         // A set of photosensor array diode band types...
         typedef std::set< VicarImageBand::PSADiode >  FilterDiodeBandSet;
 
+        // Output image file format...
+        typedef enum
+        {
+            // Portable network graphics...
+            FormatPng,
+
+            // Binary PGM for grayscale or PPM for colour...
+            FormatPnm,
+
+            // Raw planar bytes with a text sidecar describing them...
+            FormatRaw
+
+        }OutputFormatType;
+
+        // Metadata format...
+        typedef enum
+        {
+            // A text file beside each output image...
+            MetadataTxt,
+
+            // A single comma separated values catalogue for the whole run...
+            MetadataCsv,
+
+            // A single JSON Lines catalogue for the whole run...
+            MetadataJsonLines
+
+        }MetadataFormatType;
+
     // Public methods...
     public:
 
+        // Default constructor...
+        Options();
+
         // Get options...
         bool            GetAutoRotate() const { return m_AutoRotate; }
+#ifdef USE_DBUS_INTERFACE
+        bool            GetDaemon() const { return m_Daemon; }
+#endif
         bool            GetDirectorizeBandTypeClass() const { return m_DirectorizeBandTypeClass; }
         bool            GetDirectorizeLocation() const { return m_DirectorizeLocation; }
         bool            GetDirectorizeMonth() const { return m_DirectorizeMonth; }
         bool            GetDirectorizeSol() const { return m_DirectorizeSol; }
         bool            GetDryRun() const { return m_DryRun; }
+        bool            GetEmulateMedia() const { return m_EmulateMedia; }
+        size_t          GetEmulatedSeekLatency() const { return m_EmulatedSeekLatency; }
+        size_t          GetEmulatedThroughput() const { return m_EmulatedThroughput; }
         const std::string &
                         GetFilterCameraEvent() const { return m_FilterCameraEvent; }
         const FilterDiodeBandSet &
                          GetFilterDiodeBandSet() const { return m_FilterDiodeBandSet; }
         size_t          GetFilterLander() const { return m_FilterLander; }
         size_t          GetFilterSolarDay() const { return m_FilterSolarDay; }
+        OutputWriter::FsyncPolicyType
+                        GetFsyncPolicy() const { return m_FsyncPolicy; }
         bool            GetGenerateMetadata() const { return m_GenerateMetadata; }
         bool            GetIgnoreBadFiles() const { return m_IgnoreBadFiles; }
+        const std::string &
+                        GetIndexFile() const { return m_IndexFile; }
         bool            GetInterlace() const { return m_Interlace; }
+        size_t          GetIoThreads() const { return m_IoThreads; }
         size_t          GetJobs() const { return m_Jobs; }
+        size_t          GetMemoryLimit() const { return m_MemoryLimit; }
+        MetadataFormatType
+                        GetMetadataFormat() const { return m_MetadataFormat; }
+        const std::string &
+                        GetMetricsFile() const { return m_MetricsFile; }
+        const std::string &
+                        GetMetricsSocket() const { return m_MetricsSocket; }
         bool            GetNoReconstruct() const { return m_NoReconstruct; };
+        const std::string &
+                        GetOutputArchive() const { return m_OutputArchive; }
+        ArchiveOutputSink::FormatType
+                        GetOutputArchiveFormat() const { return m_OutputArchiveFormat; }
+        OutputFormatType
+                        GetOutputFormat() const { return m_OutputFormat; }
         bool            GetOverwrite() const { return m_Overwrite; }
+        bool            GetParallelDeflate() const { return m_ParallelDeflate; }
+        bool            GetPlan() const { return m_Plan; }
+        const PngEncoder::ProfileType &
+                        GetPngProfile() const { return m_PngProfile; }
+        const std::string &
+                        GetProfileFile() const { return m_ProfileFile; }
         bool            GetRecursive() const { return m_Recursive; }
 #ifdef USE_DBUS_INTERFACE
         bool            GetRemoteStart() const { return m_RemoteStart; }
+#endif
+        bool            GetResume() const { return m_Resume; }
+#ifdef USE_DBUS_INTERFACE
+        size_t          GetSignalRate() const { return m_SignalRate; }
 #endif
         bool            GetSummarizeOnly() const { return m_SummarizeOnly; }
         bool            GetSuppress() const { return m_Suppress; }
+        const std::string &
+                        GetTraceFile() const { return m_TraceFile; }
 
         // Set options...
         void            SetAutoRotate(const bool AutoRotate = true) { m_AutoRotate = AutoRotate; }
+#ifdef USE_DBUS_INTERFACE
+        void            SetDaemon(const bool Daemon = true) { m_Daemon = Daemon; }
+#endif
         void            SetDirectorizeBandTypeClass(const bool DirectorizeBandTypeClass = true) { m_DirectorizeBandTypeClass = DirectorizeBandTypeClass; }
         void            SetDirectorizeLocation(const bool DirectorizeLocation = true) { m_DirectorizeLocation = DirectorizeLocation; }
         void            SetDirectorizeMonth(const bool DirectorizeMonth = true) { m_DirectorizeMonth = DirectorizeMonth; }
         void            SetDirectorizeSol(const bool DirectorizeSol = true) { m_DirectorizeSol = DirectorizeSol; }
         void            SetDryRun(const bool DryRun = true) { m_DryRun = DryRun; }
+        void            SetEmulateMedia(const std::string &Media);
         void            SetFilterCameraEvent(const std::string &CameraEvent);
         void            SetFilterDiodeClass(const std::string &DiodeClass);
         void            SetFilterLander(const size_t Lander);
         void            SetFilterSolarDay(const size_t SolarDay) { m_FilterSolarDay = SolarDay; }
+        void            SetFsyncPolicy(const std::string &FsyncPolicy);
         void            SetIgnoreBadFiles(const bool IgnoreBadFiles = true) { m_IgnoreBadFiles = IgnoreBadFiles; }
+        void            SetIndexFile(const std::string &IndexFile) { m_IndexFile = IndexFile; }
         void            SetInterlace(const bool Interlace = true) { m_Interlace = Interlace; }
+        void            SetIoThreads(const size_t IoThreads) { m_IoThreads = IoThreads; }
         void            SetJobs(const size_t Jobs) { m_Jobs = Jobs; }
+        void            SetMemoryLimit(const std::string &MemoryLimit);
+        void            SetMetadataFormat(const std::string &MetadataFormat);
+        void            SetMetricsFile(const std::string &MetricsFile) { m_MetricsFile = MetricsFile; }
+        void            SetMetricsSocket(const std::string &MetricsSocket) { m_MetricsSocket = MetricsSocket; }
         void            SetNoReconstruct(const bool NoReconstruct = true) { m_NoReconstruct = NoReconstruct; }
+        void            SetOutputArchive(const std::string &OutputArchive);
+        void            SetOutputFormat(const std::string &OutputFormat);
         void            SetOverwrite(const bool Overwrite = true) { m_Overwrite = Overwrite; }
+        void            SetParallelDeflate(const bool ParallelDeflate = true) { m_ParallelDeflate = ParallelDeflate; }
+        void            SetPlan(const bool Plan = true) { m_Plan = Plan; }
+        void            SetPngProfile(const std::string &Profile);
+        void            SetProfileFile(const std::string &ProfileFile) { m_ProfileFile = ProfileFile; }
         void            SetRecursive(const bool Recursive = true) { m_Recursive = Recursive; }
 #ifdef USE_DBUS_INTERFACE
         void            SetRemoteStart(const bool RemoteStart = true) { m_RemoteStart = RemoteStart; }
+#endif
+        void            SetResume(const bool Resume = true) { m_Resume = Resume; }
+#ifdef USE_DBUS_INTERFACE
+        void            SetSignalRate(const size_t SignalRate) { m_SignalRate = SignalRate; }
 #endif
         void            SetGenerateMetadata(const bool GenerateMetadata = true) { m_GenerateMetadata = GenerateMetadata; }
         void            SetSummarizeOnly(const bool SummarizeOnly = true) { m_SummarizeOnly = SummarizeOnly; }
         void            SetSuppress(const bool Suppress = true) { m_Suppress = Suppress; }
-
-    // Private methods...
-    private:
-
-        // Default constructor...
-        Options();
+        void            SetTraceFile(const std::string &TraceFile) { m_TraceFile = TraceFile; }
 
         // Deconstructor...
        ~Options();
@@ -123,6 +205,12 @@ class Options : public ExplicitSingleton<Options>
         // Use OCR to try and figure out correct image orientation...
         bool                m_AutoRotate;
 
+#ifdef USE_DBUS_INTERFACE
+        // Stay resident and recover whatever jobs are submitted over D-Bus
+        //  until told to quit...
+        bool                m_Daemon;
+#endif
+
         // Place reconstructed images in a subdirectory of their band 
         //  type class... (e.g. Colour)
         bool                m_DirectorizeBandTypeClass;
@@ -142,6 +230,13 @@ class Options : public ExplicitSingleton<Options>
         // Don't actually write out any files...
         bool                m_DryRun;
 
+        // Emulate reading the input from slower media, taking the given
+        //  milliseconds to seek and reading no more than the given bytes per
+        //  second, or zero for no cap...
+        bool                m_EmulateMedia;
+        size_t              m_EmulatedSeekLatency;
+        size_t              m_EmulatedThroughput;
+
         // Filter based on matching camera event ID, such as 22A158...
         std::string         m_FilterCameraEvent;
             
@@ -154,22 +249,71 @@ class Options : public ExplicitSingleton<Options>
         // Filter by solar day...
         size_t              m_FilterSolarDay;
 
+        // When to flush output files to stable storage...
+        OutputWriter::FsyncPolicyType
+                            m_FsyncPolicy;
+
         // Don't stop processing files when you hit a bad one...
         bool                m_IgnoreBadFiles;
+
+        // Band index to load bands from and remember them in, or empty if
+        //  none...
+        std::string         m_IndexFile;
         
         // Use Adam7 interlacing...
         bool                m_Interlace;
 
+        // Number of threads to write output files on, or zero to write them
+        //  on the reconstructing thread...
+        size_t              m_IoThreads;
+
         // Number of threads to use...
         size_t              m_Jobs;
 
+        // Most bytes of large allocations an extraction may account for at
+        //  once before it sheds or serializes work, or zero for no limit...
+        size_t              m_MemoryLimit;
+
+        // Format generated metadata is written in...
+        MetadataFormatType  m_MetadataFormat;
+
+        // Count what each extraction did and write the metrics here as a
+        //  Prometheus textfile...
+        std::string         m_MetricsFile;
+
+        // Serve the metrics over a Unix domain socket here while running...
+        std::string         m_MetricsSocket;
+
         // Don't attempt to reconstruct camera events, just dump all 
         //  available band data as separate images...
         bool                m_NoReconstruct;
 
+        // Single zip or tar archive to write all output into instead of the
+        //  output directory tree, or empty if none, and its format...
+        std::string         m_OutputArchive;
+        ArchiveOutputSink::FormatType
+                            m_OutputArchiveFormat;
+
+        // Output image file format...
+        OutputFormatType    m_OutputFormat;
+
         // Overwrite output files...
         bool                m_Overwrite;
 
+        // Deflate PNG image data in independent chunks across --jobs
+        //  threads...
+        bool                m_ParallelDeflate;
+
+        // Stop after parsing headers and only describe what would be
+        //  reconstructed, written, or dumped...
+        bool                m_Plan;
+
+        // PNG compression level, strategy, and scanline filter...
+        PngEncoder::ProfileType m_PngProfile;
+
+        // Time each stage of the extraction and write the timings here...
+        std::string         m_ProfileFile;
+
         // Recursively scan subdirectories if the input is a directory...
         bool                m_Recursive;
 
@@ -178,6 +322,15 @@ class Options : public ExplicitSingleton<Options>
         bool                m_RemoteStart;
 #endif
 
+        // Resume from the run journal in the output directory, skipping
+        //  whatever a previous run finished...
+        bool                m_Resume;
+
+#ifdef USE_DBUS_INTERFACE
+        // Most number of times per second D-Bus signals are emitted...
+        size_t              m_SignalRate;
+#endif
+
         // Generate metadata...
         bool                m_GenerateMetadata;
         
@@ -186,6 +339,9 @@ class Options : public ExplicitSingleton<Options>
         
         // Disable warnings and errors...
         bool                m_Suppress;
+
+        // Record spans of work and write them here as a trace...
+        std::string         m_TraceFile;
 };
 
 // Multiple include protection...
@@ -0,0 +1,58 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "OutputSink.h"
+
+// Using the standard namespace...
+using namespace std;
+
+// Constructor takes the output root directory every file name handed to the
+//  sink is beneath, ending with a path separator...
+OutputSink::OutputSink(const string &OutputRootDirectory)
+    : m_OutputRootDirectory(OutputRootDirectory)
+{
+
+}
+
+// Get the path of a file relative to the output root directory...
+string OutputSink::GetRelativePath(const string &FileName) const
+{
+    // Beneath the output root directory, so strip it...
+    if(FileName.compare(0, m_OutputRootDirectory.length(), m_OutputRootDirectory) == 0)
+        return FileName.substr(m_OutputRootDirectory.length());
+
+    // Otherwise just make sure it isn't absolute...
+    const size_t Start = FileName.find_first_not_of('/');
+    return (Start == string::npos) ? string() : FileName.substr(Start);
+}
+
+// Deconstructor...
+OutputSink::~OutputSink()
+{
+
+}
+
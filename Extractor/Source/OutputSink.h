@@ -0,0 +1,98 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _OUTPUT_SINK_H_
+#define _OUTPUT_SINK_H_
+
+// Includes...
+
+    // System headers...
+    #include <ostream>
+    #include <string>
+    #include <clocale>
+
+    // i18n...
+    #include "gettext.h"
+    #define _(str) gettext (str)
+    #define N_(str) gettext_noop (str)
+
+// Base of the destinations reconstructed images and their metadata are
+//  written to. Files are named by their full path beneath the output root
+//  directory, exactly as ReconstructableImage::CreateOutputFileName composes
+//  them, and are written one at a time...
+class OutputSink
+{
+    // Public methods...
+    public:
+
+        // Constructor takes the output root directory every file name handed
+        //  to the sink is beneath, ending with a path separator...
+        OutputSink(const std::string &OutputRootDirectory);
+
+        // Abandon the file currently being written, if any, leaving nothing
+        //  of it behind...
+        virtual void AbortFile() = 0;
+
+        // Finish writing all output, or throw an error...
+        virtual void Close() = 0;
+
+        // Finish the file currently being written, or throw an error...
+        virtual void CloseFile() = 0;
+
+        // Check whether the given output file already exists...
+        virtual bool Exists(const std::string &FileName) const = 0;
+
+        // Make sure every file closed so far has reached the file system, or
+        //  throw an error...
+        virtual void Flush() = 0;
+
+        // Check whether the given output file was closed but has yet to
+        //  reach the file system...
+        virtual bool IsPending(const std::string &FileName) const = 0;
+
+        // Begin writing the given output file and return the stream its
+        //  contents are to be written to, or throw an error...
+        virtual std::ostream &OpenFile(const std::string &FileName) = 0;
+
+        // Make sure files can be written into the given directory, or throw
+        //  an error...
+        virtual void PrepareDirectory(const std::string &Directory) = 0;
+
+        // Deconstructor...
+        virtual ~OutputSink();
+
+    // Protected methods...
+    protected:
+
+        // Get the path of a file relative to the output root directory...
+        std::string GetRelativePath(const std::string &FileName) const;
+
+    // Protected data...
+    protected:
+
+        // Output root directory...
+        std::string         m_OutputRootDirectory;
+};
+
+// Multiple include protection...
+#endif
+
@@ -0,0 +1,303 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "OutputWriter.h"
+    #include "Probes.h"
+
+    // System headers...
+    #include <cerrno>
+    #include <cstring>
+    #include <vector>
+
+    // POSIX headers...
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+// Using the standard namespace...
+using namespace std;
+
+// Constructor takes the number of I/O threads, or zero to write on the
+//  caller's thread, the fsync policy, and the tracer to record writes and
+//  waits for room with, if any...
+OutputWriter::OutputWriter(
+    const size_t Threads,
+    const FsyncPolicyType FsyncPolicy,
+    Tracer *WriteTracer,
+    MemoryTracker *Memory)
+    : m_FsyncPolicy(FsyncPolicy),
+      m_FileMode(0),
+      m_MemoryTracker(Memory),
+      m_QueueLimit(Threads * 2),
+      m_Stopping(false),
+      m_Tracer(WriteTracer)
+{
+    // Temporary files are created private, so remember what permissions the
+    //  umask would have given the file had it been created directly...
+    const mode_t Mask = umask(0);
+    umask(Mask);
+    m_FileMode = 0666 & ~Mask;
+
+    // Start the I/O threads...
+    for(size_t Thread = 0; Thread < Threads; ++Thread)
+        m_Threads.push_back(thread(&OutputWriter::Worker, this));
+}
+
+// Throw the first error a write ran into, if any. Mutex must be held...
+void OutputWriter::CheckError() const
+{
+    if(!m_ErrorMessage.empty())
+        throw m_ErrorMessage;
+}
+
+// Wait for every file submitted so far to be written, or throw the first
+//  error any of them ran into...
+void OutputWriter::Flush()
+{
+    // Wait for everything pending to be written...
+    unique_lock<mutex> Lock(m_Mutex);
+    while(!m_PendingNames.empty())
+        m_Drained.wait(Lock);
+
+    // Check for error...
+    CheckError();
+}
+
+// Check whether the given file is still waiting to be written...
+bool OutputWriter::IsPending(const string &FileName) const
+{
+    lock_guard<mutex> Lock(m_Mutex);
+    return (m_PendingNames.find(FileName) != m_PendingNames.end());
+}
+
+// Hand over the complete contents of a file to be written, taking them out of
+//  the caller's string. Blocks while the queue is full, and throws if an
+//  earlier write failed...
+void OutputWriter::Submit(const string &FileName, string &Contents)
+{
+    // Take the contents without copying them...
+    PendingFileType File;
+    File.m_FileName = FileName;
+    File.m_Contents.swap(Contents);
+
+    // No I/O threads, or queueing it would exceed the memory limit, so just
+    //  write it now...
+    if(m_Threads.empty() ||
+       (m_MemoryTracker && m_MemoryTracker->WouldExceedLimit(File.m_Contents.size())))
+    {
+        WriteFile(File);
+        return;
+    }
+
+    // Wait for room in the queue, giving up if an earlier write failed...
+    unique_lock<mutex> Lock(m_Mutex);
+    if(m_Queue.size() >= m_QueueLimit && m_ErrorMessage.empty())
+    {
+        Tracer::Span Span(m_Tracer, "wait_for_io_thread");
+        Span.SetArgument("file", FileName);
+        while(m_Queue.size() >= m_QueueLimit && m_ErrorMessage.empty())
+            m_Drained.wait(Lock);
+    }
+    CheckError();
+
+    // Account for it until written...
+    if(m_MemoryTracker)
+        m_MemoryTracker->Charge(MemoryTracker::EncoderStaging, File.m_Contents.size());
+
+    // Queue it and wake an I/O thread...
+    m_PendingNames.insert(File.m_FileName);
+    m_Queue.push_back(PendingFileType());
+    m_Queue.back().m_FileName.swap(File.m_FileName);
+    m_Queue.back().m_Contents.swap(File.m_Contents);
+    m_Queued.notify_one();
+}
+
+// Write a file to a temporary name beside it and rename it into place, or
+//  throw an error...
+void OutputWriter::WriteFile(const PendingFileType &File) const
+{
+    // Trace it and time it, if anything is attached to its probe...
+    Tracer::Span Span(m_Tracer, "write_file");
+    Span.SetArgument("file", File.m_FileName);
+    const uint64_t ProbeStart = PROBE_TIMESTAMP(output_write);
+
+    // Split off the directory, if there is one...
+    const size_t Separator = File.m_FileName.find_last_of('/');
+    const string Directory =
+        (Separator == string::npos) ? string(".") : File.m_FileName.substr(0, Separator + 1);
+    const string BaseName =
+        (Separator == string::npos) ? File.m_FileName : File.m_FileName.substr(Separator + 1);
+
+    // Create a hidden temporary file beside the destination so the rename
+    //  stays on the same file system...
+    string Template = Directory + (Separator == string::npos ? "/." : ".") + BaseName + ".XXXXXX";
+    vector<char> TemporaryName(Template.begin(), Template.end());
+    TemporaryName.push_back('\0');
+    const int FileDescriptor = mkstemp(&TemporaryName[0]);
+
+        // Failed...
+        if(FileDescriptor < 0)
+            throw string(_("could not open output file for writing: ")) + File.m_FileName;
+
+    // Write it all out, then give it the permissions it would have had and
+    //  flush it if asked. The cause of the first failure is kept since later
+    //  calls may overwrite errno...
+    const char *Data    = File.m_Contents.data();
+    size_t      Left    = File.m_Contents.size();
+    int         Error   = 0;
+    while(Left > 0 && !Error)
+    {
+        // Write as much as will go...
+        const ssize_t Written = write(FileDescriptor, Data, Left);
+
+        // Interrupted, try again...
+        if(Written < 0 && errno == EINTR)
+            continue;
+
+        // Failed...
+        if(Written < 0)
+            Error = errno;
+
+        // Nothing went, but nothing said why...
+        else if(Written == 0)
+            Error = EIO;
+
+        // Otherwise advance...
+        else
+        {
+            Data += Written;
+            Left -= Written;
+        }
+    }
+    if(!Error && fchmod(FileDescriptor, m_FileMode) != 0)
+        Error = errno;
+    if(!Error && m_FsyncPolicy != FsyncNone && fsync(FileDescriptor) != 0)
+        Error = errno;
+    if(close(FileDescriptor) != 0 && !Error)
+        Error = errno;
+
+    // Publish under the real name...
+    if(!Error && rename(&TemporaryName[0], File.m_FileName.c_str()) != 0)
+        Error = errno;
+
+    // Failed, so don't leave the temporary file behind...
+    if(Error)
+    {
+        unlink(&TemporaryName[0]);
+        throw string(_("could not write output file: ")) + File.m_FileName +
+            " (" + strerror(Error) + ")";
+    }
+
+    // Flush the directory too so the rename itself is durable, if asked...
+    if(m_FsyncPolicy == FsyncFull)
+    {
+        // Open it...
+        const int DirectoryDescriptor = open(Directory.c_str(), O_RDONLY | O_DIRECTORY);
+
+            // Failed...
+            if(DirectoryDescriptor < 0)
+                throw string(_("could not flush output directory: ")) + Directory;
+
+        // Flush and close...
+        const bool Synced = (fsync(DirectoryDescriptor) == 0);
+        close(DirectoryDescriptor);
+        if(!Synced)
+            throw string(_("could not flush output directory: ")) + Directory;
+    }
+
+    // Fire the probe...
+    PROBE3(output_write,
+        File.m_FileName.c_str(), File.m_Contents.size(), PROBE_ELAPSED(ProbeStart));
+}
+
+// Body of each I/O thread...
+void OutputWriter::Worker()
+{
+    // Keep writing until told to stop and nothing is left...
+    while(true)
+    {
+        // Wait for a file to write...
+        PendingFileType File;
+        {
+            unique_lock<mutex> Lock(m_Mutex);
+            while(m_Queue.empty() && !m_Stopping)
+                m_Queued.wait(Lock);
+
+            // Told to stop and nothing left...
+            if(m_Queue.empty())
+                return;
+
+            // Take it off the queue and let submitters know there is room...
+            File.m_FileName.swap(m_Queue.front().m_FileName);
+            File.m_Contents.swap(m_Queue.front().m_Contents);
+            m_Queue.pop_front();
+            m_Drained.notify_all();
+        }
+
+        // Write it, remembering only the first error...
+        string ErrorMessage;
+        try
+        {
+            WriteFile(File);
+        }
+
+            // Failed...
+            catch(const string &WriteErrorMessage)
+            {
+                ErrorMessage = WriteErrorMessage;
+            }
+
+        // No longer holding its contents...
+        if(m_MemoryTracker)
+            m_MemoryTracker->Release(MemoryTracker::EncoderStaging, File.m_Contents.size());
+
+        // No longer pending...
+        lock_guard<mutex> Lock(m_Mutex);
+        m_PendingNames.erase(m_PendingNames.find(File.m_FileName));
+        if(m_ErrorMessage.empty())
+            m_ErrorMessage = ErrorMessage;
+        m_Drained.notify_all();
+    }
+}
+
+// Deconstructor waits for outstanding writes and stops the pool...
+OutputWriter::~OutputWriter()
+{
+    // Tell the I/O threads to stop once the queue drains...
+    {
+        lock_guard<mutex> Lock(m_Mutex);
+        m_Stopping = true;
+        m_Queued.notify_all();
+    }
+
+    // Wait for them...
+    for(vector<thread>::iterator Iterator = m_Threads.begin();
+        Iterator != m_Threads.end();
+      ++Iterator)
+        Iterator->join();
+}
+
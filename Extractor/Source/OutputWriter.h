@@ -0,0 +1,173 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _OUTPUT_WRITER_H_
+#define _OUTPUT_WRITER_H_
+
+// Includes...
+
+    // Our headers...
+    #include "MemoryTracker.h"
+    #include "Tracer.h"
+
+    // System headers...
+    #include <condition_variable>
+    #include <deque>
+    #include <mutex>
+    #include <set>
+    #include <string>
+    #include <thread>
+    #include <vector>
+    #include <clocale>
+
+    // POSIX headers...
+    #include <sys/types.h>
+
+    // i18n...
+    #include "gettext.h"
+    #define _(str) gettext (str)
+    #define N_(str) gettext_noop (str)
+
+// Writes whole output files handed to it on a small pool of I/O threads so
+//  reconstruction never stalls on a slow disk. Each file is written under a
+//  temporary name beside its destination and only renamed into place once
+//  complete, so a partial file never appears under its real name...
+class OutputWriter
+{
+    // Public types...
+    public:
+
+        // When to flush written files to stable storage...
+        typedef enum
+        {
+            // Leave it to the operating system...
+            FsyncNone,
+
+            // Flush each file before renaming it into place...
+            FsyncFile,
+
+            // Also flush the directory after the rename so the new name is
+            //  durable too...
+            FsyncFull
+
+        }FsyncPolicyType;
+
+    // Public methods...
+    public:
+
+        // Constructor takes the number of I/O threads, or zero to write on
+        //  the caller's thread, the fsync policy, the tracer to record writes
+        //  and waits for room with, if any, and the memory tracker to account
+        //  queued files with, if any...
+        OutputWriter(
+            const size_t Threads,
+            const FsyncPolicyType FsyncPolicy,
+            Tracer *WriteTracer = NULL,
+            MemoryTracker *Memory = NULL);
+
+        // Wait for every file submitted so far to be written, or throw the
+        //  first error any of them ran into...
+        void Flush();
+
+        // Check whether the given file is still waiting to be written...
+        bool IsPending(const std::string &FileName) const;
+
+        // Hand over the complete contents of a file to be written, taking
+        //  them out of the caller's string. Blocks while the queue is full,
+        //  and throws if an earlier write failed. If queueing it would exceed
+        //  the memory limit, it is written on the caller's thread instead...
+        void Submit(const std::string &FileName, std::string &Contents);
+
+        // Deconstructor waits for outstanding writes and stops the pool...
+       ~OutputWriter();
+
+    // Protected types...
+    protected:
+
+        // A file waiting to be written...
+        struct PendingFileType
+        {
+            // Name of the file...
+            std::string         m_FileName;
+
+            // Its complete contents...
+            std::string         m_Contents;
+        };
+
+    // Protected methods...
+    protected:
+
+        // Throw the first error a write ran into, if any. Mutex must be
+        //  held...
+        void CheckError() const;
+
+        // Write a file to a temporary name beside it and rename it into
+        //  place, or throw an error...
+        void WriteFile(const PendingFileType &File) const;
+
+        // Body of each I/O thread...
+        void Worker();
+
+    // Protected data...
+    protected:
+
+        // Signalled when the queue has room or drains, and when it has work...
+        std::condition_variable m_Drained;
+        std::condition_variable m_Queued;
+
+        // First error a write ran into, if any...
+        std::string         m_ErrorMessage;
+
+        // Fsync policy...
+        FsyncPolicyType     m_FsyncPolicy;
+
+        // Permissions to give new files, as open() would with the umask...
+        mode_t              m_FileMode;
+
+        // Memory tracker to account queued files with, if any...
+        MemoryTracker      *m_MemoryTracker;
+
+        // Guards everything shared with the I/O threads...
+        mutable std::mutex  m_Mutex;
+
+        // Names of files submitted but not yet written...
+        std::multiset<std::string> m_PendingNames;
+
+        // Files waiting for an I/O thread...
+        std::deque<PendingFileType> m_Queue;
+
+        // Most files allowed to wait in the queue before submitting blocks...
+        size_t              m_QueueLimit;
+
+        // Set to tell the I/O threads to exit once the queue is empty...
+        bool                m_Stopping;
+
+        // The I/O threads...
+        std::vector<std::thread> m_Threads;
+
+        // Tracer to record writes and waits for room with, if any...
+        Tracer             *m_Tracer;
+};
+
+// Multiple include protection...
+#endif
+
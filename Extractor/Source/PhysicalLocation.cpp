@@ -0,0 +1,341 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "PhysicalLocation.h"
+    #include "MediaEmulator.h"
+
+    // zziplib...
+    #include <zzip/zzip.h>
+    #include <zzip/plugin.h>
+
+    // System headers...
+    #include <algorithm>
+    #include <cstring>
+    #include <vector>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+    // Linux extent mapping...
+    #ifdef HAVE_LINUX_FIEMAP_H
+        #include <linux/fiemap.h>
+        #include <linux/fs.h>
+        #include <sys/ioctl.h>
+    #endif
+
+// Using the standard namespace...
+using namespace std;
+
+// Zip record signatures and sizes of their fixed portions...
+#define ZIP_CENTRAL_HEADER_SIGNATURE        0x02014b50
+#define ZIP_CENTRAL_HEADER_SIZE             46
+#define ZIP_END_SIGNATURE                   0x06054b50
+#define ZIP_END_SIZE                        22
+#define ZIP_ZIP64_END_SIGNATURE             0x06064b50
+#define ZIP_ZIP64_END_SIZE                  56
+#define ZIP_ZIP64_EXTRA_FIELD               0x0001
+#define ZIP_ZIP64_LOCATOR_SIGNATURE         0x07064b50
+#define ZIP_ZIP64_LOCATOR_SIZE              20
+
+// Longest comment the end of central directory record can be followed by...
+#define ZIP_MAXIMUM_COMMENT                 0xffff
+
+// Get a little endian value of the given number of bytes...
+static uint64_t GetLittleEndian(const uint8_t *Data, const size_t Bytes)
+{
+    // Assemble, least significant byte first...
+    uint64_t Value = 0;
+    for(size_t Byte = Bytes; Byte-- > 0; )
+        Value = (Value << 8) | Data[Byte];
+
+    // Done...
+    return Value;
+}
+
+// Read exactly the requested number of bytes at the given offset through
+//  zziplib I/O handlers, or return false...
+static bool ReadAt(
+    zzip_plugin_io_t Handlers,
+    const int Descriptor,
+    const uint64_t Offset,
+    uint8_t *Buffer,
+    const size_t Length)
+{
+    // Seek...
+    if(Handlers->fd.seeks(Descriptor, Offset, SEEK_SET) != static_cast<zzip_off_t>(Offset))
+        return false;
+
+    // Read until done, since a read may return less than asked for...
+    for(size_t Done = 0; Done < Length; )
+    {
+        const zzip_ssize_t Read = Handlers->fd.read(Descriptor, Buffer + Done, Length - Done);
+        if(Read <= 0)
+            return false;
+        Done += Read;
+    }
+
+    // Done...
+    return true;
+}
+
+// Read the offset of the local header of every member of a zip archive out
+//  of its central directory, given an open descriptor, or return false...
+static bool ReadZipCentralDirectory(
+    zzip_plugin_io_t Handlers,
+    const int Descriptor,
+    PhysicalLocation::MemberOffsetMapType &MemberOffsets)
+{
+    // Size of the archive...
+    const zzip_off_t ArchiveSize = Handlers->fd.seeks(Descriptor, 0, SEEK_END);
+    if(ArchiveSize < ZIP_END_SIZE)
+        return false;
+
+    // Read the tail of the archive, which must hold the end of central
+    //  directory record, any comment after it, and the zip64 locator before
+    //  it...
+    const size_t TailSize = min<uint64_t>(
+        ArchiveSize, ZIP_ZIP64_LOCATOR_SIZE + ZIP_END_SIZE + ZIP_MAXIMUM_COMMENT);
+    const uint64_t TailOffset = ArchiveSize - TailSize;
+    vector<uint8_t> Tail(TailSize);
+    if(!ReadAt(Handlers, Descriptor, TailOffset, Tail.data(), TailSize))
+        return false;
+
+    // Find the end of central directory record, searching backwards past
+    //  any comment...
+    size_t End = TailSize - ZIP_END_SIZE + 1;
+    while(End-- > 0)
+    {
+        if(GetLittleEndian(&Tail[End], 4) == ZIP_END_SIGNATURE)
+            break;
+    }
+    if(End == static_cast<size_t>(-1))
+        return false;
+
+    // Where the central directory is and how big...
+    uint64_t CentralDirectorySize   = GetLittleEndian(&Tail[End + 12], 4);
+    uint64_t CentralDirectoryOffset = GetLittleEndian(&Tail[End + 16], 4);
+
+    // Either too big for the record, so look for them in the zip64 end of
+    //  central directory record the locator before it points to...
+    if(CentralDirectorySize == 0xffffffff || CentralDirectoryOffset == 0xffffffff)
+    {
+        // Find the locator...
+        if(End < ZIP_ZIP64_LOCATOR_SIZE)
+            return false;
+        const uint8_t *Locator = &Tail[End - ZIP_ZIP64_LOCATOR_SIZE];
+        if(GetLittleEndian(Locator, 4) != ZIP_ZIP64_LOCATOR_SIGNATURE)
+            return false;
+
+        // Read the record it points to...
+        uint8_t Zip64End[ZIP_ZIP64_END_SIZE];
+        if(!ReadAt(Handlers, Descriptor, GetLittleEndian(Locator + 8, 8), Zip64End, sizeof(Zip64End)) ||
+           GetLittleEndian(Zip64End, 4) != ZIP_ZIP64_END_SIGNATURE)
+            return false;
+
+        // Extract...
+        CentralDirectorySize    = GetLittleEndian(Zip64End + 40, 8);
+        CentralDirectoryOffset  = GetLittleEndian(Zip64End + 48, 8);
+    }
+
+    // Must lie within the archive...
+    if(CentralDirectoryOffset > static_cast<uint64_t>(ArchiveSize) ||
+       CentralDirectorySize > ArchiveSize - CentralDirectoryOffset)
+        return false;
+
+    // Read it...
+    vector<uint8_t> CentralDirectory(CentralDirectorySize);
+    if(!ReadAt(Handlers, Descriptor, CentralDirectoryOffset, CentralDirectory.data(), CentralDirectorySize))
+        return false;
+
+    // Walk each member's header...
+    for(size_t Header = 0; Header + ZIP_CENTRAL_HEADER_SIZE <= CentralDirectory.size(); )
+    {
+        // Check the signature...
+        const uint8_t *Entry = &CentralDirectory[Header];
+        if(GetLittleEndian(Entry, 4) != ZIP_CENTRAL_HEADER_SIGNATURE)
+            return false;
+
+        // Lengths of the variable portions, which must fit...
+        const size_t NameLength     = GetLittleEndian(Entry + 28, 2);
+        const size_t ExtraLength    = GetLittleEndian(Entry + 30, 2);
+        const size_t CommentLength  = GetLittleEndian(Entry + 32, 2);
+        const size_t EntrySize      =
+            ZIP_CENTRAL_HEADER_SIZE + NameLength + ExtraLength + CommentLength;
+        if(Header + EntrySize > CentralDirectory.size())
+            return false;
+
+        // Offset of its local header...
+        uint64_t LocalHeaderOffset = GetLittleEndian(Entry + 42, 4);
+
+        // Too big for the header, so it is in the zip64 extra field after
+        //  whichever of the sizes also were...
+        if(LocalHeaderOffset == 0xffffffff)
+        {
+            const uint8_t *Extra = Entry + ZIP_CENTRAL_HEADER_SIZE + NameLength;
+            for(size_t Field = 0; Field + 4 <= ExtraLength; )
+            {
+                // Size of this field...
+                const size_t FieldSize = GetLittleEndian(Extra + Field + 2, 2);
+
+                // The zip64 field...
+                if(GetLittleEndian(Extra + Field, 2) == ZIP_ZIP64_EXTRA_FIELD)
+                {
+                    size_t Value = Field + 4;
+                    if(GetLittleEndian(Entry + 24, 4) == 0xffffffff) Value += 8;
+                    if(GetLittleEndian(Entry + 20, 4) == 0xffffffff) Value += 8;
+                    if(Value + 8 <= Field + 4 + FieldSize && Value + 8 <= ExtraLength)
+                        LocalHeaderOffset = GetLittleEndian(Extra + Value, 8);
+                    break;
+                }
+
+                // Next field...
+                Field += 4 + FieldSize;
+            }
+        }
+
+        // Remember it by name...
+        const string Name(
+            reinterpret_cast<const char *>(Entry + ZIP_CENTRAL_HEADER_SIZE), NameLength);
+        MemberOffsets[Name] = LocalHeaderOffset;
+
+        // Next header...
+        Header += EntrySize;
+    }
+
+    // Done...
+    return true;
+}
+
+// Default constructor is somewhere before everything else...
+PhysicalLocation::PhysicalLocation()
+    : m_Device(0),
+      m_Mapped(false),
+      m_MemberOffset(0),
+      m_Offset(0)
+{
+}
+
+// Locate a loose file, or return false if it couldn't be...
+bool PhysicalLocation::LocateFile(const string &InputFile)
+{
+    // Fetch its attributes...
+    struct stat FileAttributes;
+    if(stat(InputFile.c_str(), &FileAttributes) != 0)
+        return false;
+
+    // Fall back to the inode, unless the extent can be found...
+    m_Device        = FileAttributes.st_dev;
+    m_Mapped        = false;
+    m_MemberOffset  = 0;
+    m_Offset        = FileAttributes.st_ino;
+
+#ifdef HAVE_LINUX_FIEMAP_H
+
+    // Ask the file system where its first extent is. File systems that
+    //  can't say, such as ISO 9660, just leave it located by inode...
+    const int Descriptor = open(InputFile.c_str(), O_RDONLY);
+    if(Descriptor >= 0)
+    {
+        // Room for the request and a single extent...
+        uint64_t Storage[(sizeof(struct fiemap) + sizeof(struct fiemap_extent)) / sizeof(uint64_t) + 1];
+        memset(Storage, 0, sizeof(Storage));
+        struct fiemap *Map = reinterpret_cast<struct fiemap *>(Storage);
+        Map->fm_length          = FIEMAP_MAX_OFFSET;
+        Map->fm_extent_count    = 1;
+
+        // Use it if it has one whose location is known, which it isn't yet
+        //  when the file system delays allocating it...
+        if(ioctl(Descriptor, FS_IOC_FIEMAP, Map) == 0 &&
+           Map->fm_mapped_extents > 0 &&
+           !(Map->fm_extents[0].fe_flags & FIEMAP_EXTENT_UNKNOWN))
+        {
+            m_Mapped = true;
+            m_Offset = Map->fm_extents[0].fe_physical;
+        }
+
+        // Cleanup...
+        close(Descriptor);
+    }
+
+#endif
+
+    // Done...
+    return true;
+}
+
+// Get the location of a member of this archive whose local header is at the
+//  given offset within it...
+PhysicalLocation PhysicalLocation::LocateMember(const uint64_t MemberOffset) const
+{
+    // Same place as the archive, just further in...
+    PhysicalLocation Member(*this);
+    Member.m_MemberOffset = MemberOffset;
+    return Member;
+}
+
+// Read the offset of the local header of every member of a zip archive out of
+//  its central directory, or return false if it couldn't be...
+bool PhysicalLocation::ReadZipMemberOffsets(
+    const string &ArchiveFile,
+    MemberOffsetMapType &MemberOffsets)
+{
+    // Read through emulated media if asked to, like the archive itself...
+    zzip_plugin_io_t Handlers = MediaEmulator::GetHandlers();
+    if(!Handlers)
+        Handlers = zzip_get_default_io();
+
+    // Open...
+    const int Descriptor = Handlers->fd.open(ArchiveFile.c_str(), O_RDONLY);
+    if(Descriptor < 0)
+        return false;
+
+    // Read, forgetting anything partially read on failure...
+    const bool Ok = ReadZipCentralDirectory(Handlers, Descriptor, MemberOffsets);
+    if(!Ok)
+        MemberOffsets.clear();
+
+    // Cleanup...
+    Handlers->fd.close(Descriptor);
+
+    // Done...
+    return Ok;
+}
+
+// Does this come before the other on the media? Files on different devices
+//  have no physical order, so are just kept together...
+bool PhysicalLocation::operator<(const PhysicalLocation &Other) const
+{
+    // Compare from most to least significant...
+    if(m_Device != Other.m_Device)
+        return m_Device < Other.m_Device;
+    if(m_Mapped != Other.m_Mapped)
+        return m_Mapped < Other.m_Mapped;
+    if(m_Offset != Other.m_Offset)
+        return m_Offset < Other.m_Offset;
+    return m_MemberOffset < Other.m_MemberOffset;
+}
+
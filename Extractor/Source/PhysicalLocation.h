@@ -0,0 +1,92 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _PHYSICAL_LOCATION_H_
+#define _PHYSICAL_LOCATION_H_
+
+// Includes...
+
+    // System headers...
+    #include <map>
+    #include <string>
+    #include <stdint.h>
+
+// Where a file's data begins on the media it is stored on, so files can be
+//  read in the order they are laid out rather than the order their directory
+//  happened to list them in, sparing slow media like a DVD from seeking back
+//  and forth. Loose files are located by the first extent the file system
+//  maps them to where it can say, and otherwise by inode number, which most
+//  file systems allocate roughly in order of creation. Archive members are
+//  located within the archive by the offset of their local header...
+class PhysicalLocation
+{
+    // Public types...
+    public:
+
+        // Archive member name to local header offset map...
+        typedef std::map<std::string, uint64_t> MemberOffsetMapType;
+
+    // Public methods...
+    public:
+
+        // Default constructor is somewhere before everything else...
+        PhysicalLocation();
+
+        // Locate a loose file, or return false if it couldn't be...
+        bool LocateFile(const std::string &InputFile);
+
+        // Get the location of a member of this archive whose local header is
+        //  at the given offset within it...
+        PhysicalLocation LocateMember(const uint64_t MemberOffset) const;
+
+        // Read the offset of the local header of every member of a zip
+        //  archive out of its central directory, or return false if it
+        //  couldn't be...
+        static bool ReadZipMemberOffsets(
+            const std::string &ArchiveFile,
+            MemberOffsetMapType &MemberOffsets);
+
+        // Does this come before the other on the media? Files on different
+        //  devices have no physical order, so are just kept together...
+        bool operator<(const PhysicalLocation &Other) const;
+
+    // Protected data...
+    protected:
+
+        // Device the file is on...
+        uint64_t            m_Device;
+
+        // True if located by the extent the file system mapped its data to,
+        //  false if only by inode...
+        bool                m_Mapped;
+
+        // Offset of the local header within the archive, if a member...
+        uint64_t            m_MemberOffset;
+
+        // Byte offset of the file's first extent on the device, or its inode
+        //  number if unmapped...
+        uint64_t            m_Offset;
+};
+
+// Multiple include protection...
+#endif
+
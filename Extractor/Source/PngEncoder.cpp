@@ -0,0 +1,699 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "PngEncoder.h"
+    #include "Console.h"
+
+    // System headers...
+    #include <algorithm>
+    #include <atomic>
+    #include <cstdlib>
+    #include <cstring>
+    #include <mutex>
+    #include <thread>
+
+// Using the standard namespace...
+using namespace std;
+
+// Adam7 pass geometry, being the first column and row sampled by each pass and
+//  the step between them...
+static const size_t Adam7ColumnStart[7] = { 0, 4, 0, 2, 0, 1, 0 };
+static const size_t Adam7ColumnStep[7]  = { 8, 8, 4, 4, 2, 2, 1 };
+static const size_t Adam7RowStart[7]    = { 0, 0, 4, 0, 2, 0, 1 };
+static const size_t Adam7RowStep[7]     = { 8, 8, 8, 4, 4, 2, 2 };
+
+// Paeth predictor of the PNG specification...
+static inline uint8_t PaethPredictor(const int Left, const int Above, const int UpperLeft)
+{
+    // Estimate and distances to each neighbour...
+    const int Estimate          = Left + Above - UpperLeft;
+    const int LeftDistance      = abs(Estimate - Left);
+    const int AboveDistance     = abs(Estimate - Above);
+    const int UpperLeftDistance = abs(Estimate - UpperLeft);
+
+    // Pick the closest, breaking ties in the order the specification does...
+    if(LeftDistance <= AboveDistance && LeftDistance <= UpperLeftDistance)
+        return Left;
+    if(AboveDistance <= UpperLeftDistance)
+        return Above;
+    return UpperLeft;
+}
+
+// Filter a scanline with a single filter type into the output, which must
+//  have room for the filter type byte and every byte of the scanline...
+static void FilterScanLineWith(
+    const int Filter,
+    const uint8_t *Current,
+    const uint8_t *Previous,
+    const size_t Length,
+    const size_t BytesPerPixel,
+    uint8_t *Output)
+{
+    // Filter type precedes filtered bytes...
+    Output[0] = static_cast<uint8_t>(Filter);
+  ++Output;
+
+    // Rows at the top of a pass have nothing above them, which filters the
+    //  same as a row of zeros...
+    vector<uint8_t> ZeroRow;
+    if(!Previous)
+    {
+        ZeroRow.resize(Length);
+        Previous = &ZeroRow.front();
+    }
+
+    // Filter each byte with the selected predictor. Neighbours left of the
+    //  image are zero...
+    size_t Index = 0;
+    switch(Filter)
+    {
+        // Left neighbour...
+        case PngEncoder::FilterSub:
+            for(; Index < BytesPerPixel && Index < Length; ++Index)
+                Output[Index] = Current[Index];
+            for(; Index < Length; ++Index)
+                Output[Index] = Current[Index] - Current[Index - BytesPerPixel];
+            break;
+
+        // Upper neighbour...
+        case PngEncoder::FilterUp:
+            for(; Index < Length; ++Index)
+                Output[Index] = Current[Index] - Previous[Index];
+            break;
+
+        // Mean of the left and upper neighbours...
+        case PngEncoder::FilterAverage:
+            for(; Index < BytesPerPixel && Index < Length; ++Index)
+                Output[Index] = Current[Index] - (Previous[Index] >> 1);
+            for(; Index < Length; ++Index)
+                Output[Index] = Current[Index] - ((Current[Index - BytesPerPixel] + Previous[Index]) >> 1);
+            break;
+
+        // Whichever neighbour is closest to their gradient...
+        case PngEncoder::FilterPaeth:
+            for(; Index < BytesPerPixel && Index < Length; ++Index)
+                Output[Index] = Current[Index] - Previous[Index];
+            for(; Index < Length; ++Index)
+                Output[Index] = Current[Index] - PaethPredictor(
+                    Current[Index - BytesPerPixel], Previous[Index], Previous[Index - BytesPerPixel]);
+            break;
+
+        // None...
+        default:
+            copy(Current, Current + Length, Output);
+            break;
+    }
+}
+
+// Constructor takes the stream to write the encoded image to, whether to Adam7
+//  interlace it, and the encoding profile...
+PngEncoder::PngEncoder(
+    ostream &OutputStream,
+    const bool Interlace,
+    const ProfileType &Profile)
+    : ImageEncoder(OutputStream),
+      m_Channels(0),
+      m_ErrorMessage(),
+      m_Height(0),
+      m_Interlace(Interlace),
+      m_Planes(NULL),
+      m_PngInfo(NULL),
+      m_PngStruct(NULL),
+      m_Profile(Profile),
+      m_Width(0)
+{
+    // Create the write structure with our own error handlers. An exception
+    //  can't be thrown through libpng's C frames, so errors are remembered
+    //  and longjmp()'d out of, then raised by CallLibpng()...
+    m_PngStruct = png_create_write_struct(
+        PNG_LIBPNG_VER_STRING, this, ErrorHandler, WarningHandler);
+
+        // Failed...
+        if(!m_PngStruct)
+            throw string(_("could not create png write structure"));
+
+    // Create the info structure...
+    m_PngInfo = png_create_info_struct(m_PngStruct);
+
+        // Failed...
+        if(!m_PngInfo)
+        {
+            // Cleanup and abort...
+            png_destroy_write_struct(&m_PngStruct, NULL);
+            throw string(_("could not create png info structure"));
+        }
+
+    // Route all encoded output to our stream...
+    png_set_write_fn(m_PngStruct, this, WriteHandler, FlushHandler);
+}
+
+// Deflate the filtered scanlines [First, Last) as one independent chunk of the
+//  zlib stream, or throw an error. Its uncompressed size and Adler-32 are
+//  returned for stitching the trailer...
+void PngEncoder::DeflateChunk(
+    const size_t First,
+    const size_t Last,
+    vector<uint8_t> &Compressed,
+    size_t &UncompressedSize,
+    uLong &Adler32) const
+{
+    // Variables...
+    vector<uint8_t> Filtered;
+    vector<uint8_t> Current;
+    vector<uint8_t> Previous;
+    size_t          DictionaryFirst = First;
+    size_t          DictionarySize  = 0;
+
+    // Back up far enough to regenerate a full window of the filtered data
+    //  preceding this chunk to prime the deflater's dictionary with. Filtering
+    //  is deterministic, so it comes out identical to the previous chunk's...
+    while(DictionaryFirst > 0 && DictionarySize < PNG_ENCODER_DICTIONARY_SIZE)
+        DictionarySize += GetFilteredScanLineSize(m_ScanLines[--DictionaryFirst]);
+
+    // The scanline preceding the first one regenerated, if in the same pass,
+    //  is needed to filter it against...
+    if(DictionaryFirst > 0 &&
+       m_ScanLines[DictionaryFirst - 1].m_Pass == m_ScanLines[DictionaryFirst].m_Pass)
+        SampleScanLine(m_ScanLines[DictionaryFirst - 1], Previous);
+
+    // Filter the dictionary scanlines and then the chunk's own...
+    for(size_t Index = DictionaryFirst; Index < Last; ++Index)
+    {
+        // First scanline of a new pass has nothing above it...
+        if(Index > DictionaryFirst &&
+           m_ScanLines[Index - 1].m_Pass != m_ScanLines[Index].m_Pass)
+            Previous.clear();
+
+        // Sample, filter, and keep it to filter the next one against...
+        SampleScanLine(m_ScanLines[Index], Current);
+        FilterScanLine(Current, Previous, Filtered);
+        Current.swap(Previous);
+    }
+
+    // Find the chunk's own data and the dictionary window preceding it...
+    const uint8_t  *Input       = Filtered.empty() ? NULL : &Filtered.front() + DictionarySize;
+    const size_t    InputSize   = Filtered.size() - DictionarySize;
+    const size_t    WindowSize  = min<size_t>(DictionarySize, PNG_ENCODER_DICTIONARY_SIZE);
+
+    // Prepare a raw deflater without its own header or trailer since only the
+    //  stitched stream as a whole gets those...
+    z_stream Stream;
+    Stream.zalloc   = Z_NULL;
+    Stream.zfree    = Z_NULL;
+    Stream.opaque   = Z_NULL;
+    if(deflateInit2(&Stream, m_Profile.m_Level, Z_DEFLATED, -15, 8, m_Profile.m_Strategy) != Z_OK)
+        throw string(_("could not initialize deflate"));
+
+    // Prime with the tail of the preceding data so matches can reach back
+    //  across the chunk boundary as they would in a serial stream...
+    if(WindowSize > 0 &&
+       deflateSetDictionary(&Stream, Input - WindowSize, WindowSize) != Z_OK)
+    {
+        deflateEnd(&Stream);
+        throw string(_("could not set deflate dictionary"));
+    }
+
+    // Compress. All but the last chunk end on a byte aligned sync flush so the
+    //  next one can simply be appended...
+    const bool  LastChunk   = (Last == m_ScanLines.size());
+    const int   Flush       = LastChunk ? Z_FINISH : Z_SYNC_FLUSH;
+    Compressed.resize(deflateBound(&Stream, InputSize) + 16);
+    Stream.next_in      = const_cast<Bytef *>(Input);
+    Stream.avail_in     = InputSize;
+    Stream.next_out     = &Compressed.front();
+    Stream.avail_out    = Compressed.size();
+    for(;;)
+    {
+        // Deflate what will fit...
+        const int Result = deflate(&Stream, Flush);
+        if(Result == Z_STREAM_ERROR)
+        {
+            deflateEnd(&Stream);
+            throw string(_("deflate failed"));
+        }
+
+        // Done once everything is consumed and flushed...
+        if((LastChunk && Result == Z_STREAM_END) ||
+           (!LastChunk && Stream.avail_in == 0 && Stream.avail_out > 0))
+            break;
+
+        // Otherwise grow the output and keep going...
+        const size_t Used = Compressed.size() - Stream.avail_out;
+        Compressed.resize(Compressed.size() * 2);
+        Stream.next_out     = &Compressed.front() + Used;
+        Stream.avail_out    = Compressed.size() - Used;
+    }
+
+    // Trim and cleanup...
+    Compressed.resize(Compressed.size() - Stream.avail_out);
+    deflateEnd(&Stream);
+
+    // Return the checksum and size of this chunk's uncompressed data...
+    UncompressedSize    = InputSize;
+    Adler32             = adler32(adler32(0L, Z_NULL, 0), Input, InputSize);
+}
+
+// Encode an image of the given dimensions from either one plane as grayscale
+//  or three planes as RGB, or throw an error...
+void PngEncoder::Encode(
+    const PlaneListType &Planes,
+    const size_t Width,
+    const size_t Height)
+{
+    // Check we were given what we need...
+    CheckPlanes(Planes, Width, Height);
+
+    // Remember what we are encoding...
+    m_Channels  = Planes.size();
+    m_Height    = Height;
+    m_Planes    = &Planes;
+    m_Width     = Width;
+
+    // Write the header...
+    CallLibpng([&]()
+    {
+        png_set_IHDR(
+            m_PngStruct,
+            m_PngInfo,
+            Width,
+            Height,
+            8,
+            m_Channels == 1 ? PNG_COLOR_TYPE_GRAY : PNG_COLOR_TYPE_RGB,
+            m_Interlace ? PNG_INTERLACE_ADAM7 : PNG_INTERLACE_NONE,
+            PNG_COMPRESSION_TYPE_DEFAULT,
+            PNG_FILTER_TYPE_DEFAULT);
+    });
+
+    // Encode the image data. The parallel encoder guards each of its own
+    //  calls into libpng since it keeps containers on the stack, but the
+    //  serial one keeps nothing there and can be guarded whole...
+    if(m_Profile.m_ParallelDeflate)
+        EncodeParallel();
+    else
+        CallLibpng([this]() { EncodeSerial(); });
+}
+
+// Encode with the image data split into chunks deflated in parallel and
+//  written out as IDAT chunks directly, or throw an error...
+void PngEncoder::EncodeParallel()
+{
+    // Resolve automatic choices the same way libpng would...
+    if(m_Profile.m_Filter == FilterAutomatic)
+        m_Profile.m_Filter = FilterAdaptive;
+    if(m_Profile.m_Strategy < 0)
+        m_Profile.m_Strategy = (m_Profile.m_Filter == FilterNone) ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+
+    // List every scanline of the filtered data stream in order, pass by pass
+    //  if interlaced, skipping empty passes as the specification requires...
+    m_ScanLines.clear();
+    const size_t Passes = m_Interlace ? 7 : 1;
+    for(size_t Pass = 0; Pass < Passes; ++Pass)
+    {
+        // Empty pass...
+        if(GetPassWidth(Pass) == 0)
+            continue;
+
+        // Each row this pass samples...
+        const size_t RowStart   = m_Interlace ? Adam7RowStart[Pass] : 0;
+        const size_t RowStep    = m_Interlace ? Adam7RowStep[Pass] : 1;
+        for(size_t Y = RowStart; Y < m_Height; Y += RowStep)
+            m_ScanLines.push_back(ScanLineReference(Pass, Y));
+    }
+
+    // Split the scanlines into chunks of roughly equal filtered size...
+    vector<size_t> ChunkFirst;
+    size_t ChunkBytes = 0;
+    for(size_t Index = 0; Index < m_ScanLines.size(); ++Index)
+    {
+        // Start a new chunk...
+        if(Index == 0 || ChunkBytes >= PNG_ENCODER_PARALLEL_CHUNK_SIZE)
+        {
+            ChunkFirst.push_back(Index);
+            ChunkBytes = 0;
+        }
+
+        // Account for this scanline...
+        ChunkBytes += GetFilteredScanLineSize(m_ScanLines[Index]);
+    }
+    ChunkFirst.push_back(m_ScanLines.size());
+    const size_t Chunks = ChunkFirst.size() - 1;
+
+    // Storage for each chunk's results...
+    vector< vector<uint8_t> >   Compressed(Chunks);
+    vector<size_t>              UncompressedSizes(Chunks);
+    vector<uLong>               Adler32s(Chunks);
+
+    // Workers claim the next chunk until there are none left, remembering
+    //  only the first error any of them hits...
+    atomic<size_t>  NextChunk(0);
+    mutex           ErrorMutex;
+    string          ErrorMessage;
+    auto Worker = [&]()
+    {
+        for(size_t Chunk = NextChunk++; Chunk < Chunks; Chunk = NextChunk++)
+        {
+            try
+            {
+                DeflateChunk(
+                    ChunkFirst[Chunk],
+                    ChunkFirst[Chunk + 1],
+                    Compressed[Chunk],
+                    UncompressedSizes[Chunk],
+                    Adler32s[Chunk]);
+            }
+
+                // Failed...
+                catch(const string &WorkerErrorMessage)
+                {
+                    lock_guard<mutex> Lock(ErrorMutex);
+                    if(ErrorMessage.empty())
+                        ErrorMessage = WorkerErrorMessage;
+                }
+        }
+    };
+
+    // Deflate on the requested number of threads, this one included...
+    const size_t Threads = max<size_t>(1, min(m_Profile.m_Threads, Chunks));
+    vector<thread> Pool;
+    for(size_t Index = 1; Index < Threads; ++Index)
+        Pool.push_back(thread(Worker));
+    Worker();
+    for(size_t Index = 0; Index < Pool.size(); ++Index)
+        Pool[Index].join();
+
+    // Check for error...
+    if(!ErrorMessage.empty())
+        throw ErrorMessage;
+
+    // Write the signature and header...
+    CallLibpng([this]() { png_write_info(m_PngStruct, m_PngInfo); });
+
+    // zlib stream header, with the level hint calculated as zlib would...
+    const int Level = (m_Profile.m_Level == Z_DEFAULT_COMPRESSION) ? 6 : m_Profile.m_Level;
+    uint8_t LevelHint = 3;
+    if(m_Profile.m_Strategy >= Z_HUFFMAN_ONLY || Level < 2)
+        LevelHint = 0;
+    else if(Level < 6)
+        LevelHint = 1;
+    else if(Level == 6)
+        LevelHint = 2;
+    uint8_t StreamHeader[2] = { 0x78, static_cast<uint8_t>(LevelHint << 6) };
+    StreamHeader[1] += 31 - ((StreamHeader[0] << 8) + StreamHeader[1]) % 31;
+
+    // zlib stream trailer, being the Adler-32 of all chunks combined...
+    uLong Adler32 = adler32(0L, Z_NULL, 0);
+    for(size_t Chunk = 0; Chunk < Chunks; ++Chunk)
+        Adler32 = adler32_combine(Adler32, Adler32s[Chunk], UncompressedSizes[Chunk]);
+    const uint8_t StreamTrailer[4] =
+    {
+        static_cast<uint8_t>(Adler32 >> 24),
+        static_cast<uint8_t>(Adler32 >> 16),
+        static_cast<uint8_t>(Adler32 >> 8),
+        static_cast<uint8_t>(Adler32)
+    };
+
+    // Each chunk becomes its own IDAT, the first carrying the stream header
+    //  and the last carrying the stream trailer...
+    for(size_t Chunk = 0; Chunk < Chunks; ++Chunk)
+    {
+        // Attach the header and trailer...
+        vector<uint8_t> &Data = Compressed[Chunk];
+        if(Chunk == 0)
+            Data.insert(Data.begin(), StreamHeader, StreamHeader + 2);
+        if(Chunk + 1 == Chunks)
+            Data.insert(Data.end(), StreamTrailer, StreamTrailer + 4);
+
+        // Write...
+        CallLibpng([&]()
+        {
+            png_write_chunk(
+                m_PngStruct, reinterpret_cast<png_const_bytep>("IDAT"),
+                &Data.front(), Data.size());
+        });
+
+        // Release this chunk's memory as soon as it is out...
+        vector<uint8_t>().swap(Data);
+    }
+
+    // Finish the image...
+    CallLibpng([this]()
+    {
+        png_write_chunk(m_PngStruct, reinterpret_cast<png_const_bytep>("IEND"), NULL, 0);
+    });
+    m_OutputStream.flush();
+}
+
+// Encode through libpng's own serial filtering and deflate. Must be run
+//  through CallLibpng()...
+void PngEncoder::EncodeSerial()
+{
+    // Apply whatever the profile doesn't leave up to libpng...
+    if(m_Profile.m_Level != Z_DEFAULT_COMPRESSION)
+        png_set_compression_level(m_PngStruct, m_Profile.m_Level);
+    if(m_Profile.m_Strategy >= 0)
+        png_set_compression_strategy(m_PngStruct, m_Profile.m_Strategy);
+    switch(m_Profile.m_Filter)
+    {
+        case FilterNone:        png_set_filter(m_PngStruct, 0, PNG_FILTER_NONE); break;
+        case FilterSub:         png_set_filter(m_PngStruct, 0, PNG_FILTER_SUB); break;
+        case FilterUp:          png_set_filter(m_PngStruct, 0, PNG_FILTER_UP); break;
+        case FilterAverage:     png_set_filter(m_PngStruct, 0, PNG_FILTER_AVG); break;
+        case FilterPaeth:       png_set_filter(m_PngStruct, 0, PNG_FILTER_PAETH); break;
+        case FilterAdaptive:    png_set_filter(m_PngStruct, 0, PNG_ALL_FILTERS); break;
+        default:                break;
+    }
+
+    // Write the signature and header...
+    png_write_info(m_PngStruct, m_PngInfo);
+
+    // Let libpng pick the pixels of each Adam7 pass out of full scanlines.
+    //  It needs every scanline once per pass, but since scanlines come
+    //  straight out of the planes this costs nothing more than the
+    //  interleaving...
+    const int Passes = png_set_interlace_handling(m_PngStruct);
+
+    // Room for one interleaved scanline when there is more than one plane...
+    if(m_Channels > 1)
+        m_ScanLine.resize(m_Width * m_Channels);
+
+    // Feed each scanline of each pass...
+    for(int Pass = 0; Pass < Passes; ++Pass)
+    {
+        for(size_t Y = 0; Y < m_Height; ++Y)
+        {
+            // Grayscale scanlines can be passed through as they are...
+            if(m_Channels == 1)
+            {
+                const vector<uint8_t> &Row = (*(*m_Planes)[0])[Y];
+                png_write_row(m_PngStruct, const_cast<png_bytep>(&Row.front()));
+            }
+
+            // Colour scanlines are interleaved into the scratch scanline...
+            else
+            {
+                // Interleave...
+                const uint8_t  *Red     = &(*(*m_Planes)[0])[Y].front();
+                const uint8_t  *Green   = &(*(*m_Planes)[1])[Y].front();
+                const uint8_t  *Blue    = &(*(*m_Planes)[2])[Y].front();
+                uint8_t        *Pixel   = &m_ScanLine.front();
+                for(size_t X = 0; X < m_Width; ++X, Pixel += 3)
+                {
+                    Pixel[0] = Red[X];
+                    Pixel[1] = Green[X];
+                    Pixel[2] = Blue[X];
+                }
+
+                // Encode...
+                png_write_row(m_PngStruct, &m_ScanLine.front());
+            }
+        }
+    }
+
+    // Finish the image...
+    png_write_end(m_PngStruct, m_PngInfo);
+}
+
+// Run a step that calls into libpng with our jump buffer armed, then throw any
+//  error libpng reported from within it once control is back in our own
+//  frame...
+void PngEncoder::CallLibpng(const function<void()> &Step)
+{
+    // libpng jumps back here on error...
+    if(setjmp(png_jmpbuf(m_PngStruct)))
+        throw string(_("png encoder failed: ")) + m_ErrorMessage;
+
+    // Run the step...
+    Step();
+}
+
+// Filter the given scanline against the one preceding it in its pass and
+//  append it to the filtered data stream...
+void PngEncoder::FilterScanLine(
+    const vector<uint8_t> &Current,
+    const vector<uint8_t> &Previous,
+    vector<uint8_t> &Filtered) const
+{
+    // Make room for the filter type byte and the filtered bytes...
+    const size_t    Length      = Current.size();
+    const size_t    Offset      = Filtered.size();
+    const uint8_t  *Above       = Previous.empty() ? NULL : &Previous.front();
+    Filtered.resize(Offset + 1 + Length);
+
+    // Single filter type requested...
+    if(m_Profile.m_Filter != FilterAdaptive)
+    {
+        FilterScanLineWith(
+            m_Profile.m_Filter, &Current.front(), Above, Length, m_Channels,
+            &Filtered[Offset]);
+        return;
+    }
+
+    // Otherwise try each and keep the one whose residuals have the smallest
+    //  sum of magnitudes, the same heuristic libpng uses...
+    vector<uint8_t> Candidate(1 + Length);
+    size_t          BestSum = static_cast<size_t>(-1);
+    for(int Filter = FilterNone; Filter <= FilterPaeth; ++Filter)
+    {
+        // Filter...
+        FilterScanLineWith(Filter, &Current.front(), Above, Length, m_Channels, &Candidate.front());
+
+        // Sum magnitudes of the residuals as signed bytes...
+        size_t Sum = 0;
+        for(size_t Index = 1; Index <= Length; ++Index)
+            Sum += abs(static_cast<int>(static_cast<int8_t>(Candidate[Index])));
+
+        // Best so far...
+        if(Sum < BestSum)
+        {
+            BestSum = Sum;
+            copy(Candidate.begin(), Candidate.end(), Filtered.begin() + Offset);
+        }
+    }
+}
+
+// Get the number of filtered bytes a scanline occupies in the data stream,
+//  including its filter type byte...
+size_t PngEncoder::GetFilteredScanLineSize(const ScanLineReference &ScanLine) const
+{
+    return 1 + GetPassWidth(ScanLine.m_Pass) * m_Channels;
+}
+
+// Get the width of an Adam7 pass, or the image if not interlaced...
+size_t PngEncoder::GetPassWidth(const size_t Pass) const
+{
+    // Not interlaced...
+    if(!m_Interlace)
+        return m_Width;
+
+    // Pass starts beyond the right edge...
+    if(m_Width <= Adam7ColumnStart[Pass])
+        return 0;
+
+    // Count the columns it samples...
+    return (m_Width - Adam7ColumnStart[Pass] + Adam7ColumnStep[Pass] - 1) / Adam7ColumnStep[Pass];
+}
+
+// Sample the pixels of a scanline of the given pass out of the planes and
+//  interleave them into the provided scanline...
+void PngEncoder::SampleScanLine(
+    const ScanLineReference &ScanLine,
+    vector<uint8_t> &Sampled) const
+{
+    // Columns sampled...
+    const size_t ColumnStart    = m_Interlace ? Adam7ColumnStart[ScanLine.m_Pass] : 0;
+    const size_t ColumnStep     = m_Interlace ? Adam7ColumnStep[ScanLine.m_Pass] : 1;
+    const size_t Width          = GetPassWidth(ScanLine.m_Pass);
+
+    // Interleave each plane's samples...
+    Sampled.resize(Width * m_Channels);
+    for(size_t Plane = 0; Plane < m_Channels; ++Plane)
+    {
+        const uint8_t  *Row     = &(*(*m_Planes)[Plane])[ScanLine.m_Y].front();
+        uint8_t        *Output  = &Sampled.front() + Plane;
+        for(size_t X = 0; X < Width; ++X, Output += m_Channels)
+           *Output = Row[ColumnStart + X * ColumnStep];
+    }
+}
+
+// libpng error callback. Remember the error for CallLibpng() to raise and
+//  jump back out to it...
+void PngEncoder::ErrorHandler(png_structp PngStruct, png_const_charp ErrorMessage)
+{
+    // Get the encoder and remember the error, without allocating...
+    PngEncoder *Encoder = static_cast<PngEncoder *>(png_get_error_ptr(PngStruct));
+    strncpy(Encoder->m_ErrorMessage, ErrorMessage, sizeof(Encoder->m_ErrorMessage) - 1);
+    Encoder->m_ErrorMessage[sizeof(Encoder->m_ErrorMessage) - 1] = '\0';
+
+    // Unwind libpng's frames...
+    png_longjmp(PngStruct, 1);
+}
+
+// libpng flush callback...
+void PngEncoder::FlushHandler(png_structp PngStruct)
+{
+    // Get the encoder and flush its stream...
+    PngEncoder *Encoder = static_cast<PngEncoder *>(png_get_io_ptr(PngStruct));
+    Encoder->m_OutputStream.flush();
+}
+
+// libpng warning callback...
+void PngEncoder::WarningHandler(png_structp PngStruct, png_const_charp WarningMessage)
+{
+    // Unused...
+    (void) PngStruct;
+
+    // Alert, but never let anything escape into libpng's C frames...
+    try
+    {
+        Message(Console::Warning) << _("png encoder: ") << WarningMessage << endl;
+    }
+
+        // Couldn't, so drop it...
+        catch(...)
+        {
+        }
+}
+
+// libpng write callback...
+void PngEncoder::WriteHandler(png_structp PngStruct, png_bytep Data, png_size_t Length)
+{
+    // Get the encoder...
+    PngEncoder *Encoder = static_cast<PngEncoder *>(png_get_io_ptr(PngStruct));
+
+    // Write and check for error...
+    Encoder->m_OutputStream.write(reinterpret_cast<const char *>(Data), Length);
+    if(!Encoder->m_OutputStream.good())
+        png_error(PngStruct, _("could not write to output stream"));
+}
+
+// Deconstructor...
+PngEncoder::~PngEncoder()
+{
+    // Cleanup libpng structures...
+    png_destroy_write_struct(&m_PngStruct, &m_PngInfo);
+}
+
@@ -0,0 +1,242 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _PNG_ENCODER_H_
+#define _PNG_ENCODER_H_
+
+// Includes...
+
+    // Our headers...
+    #include "ImageEncoder.h"
+
+    // System headers...
+    #include <functional>
+    #include <ostream>
+    #include <string>
+    #include <vector>
+    #include <stdint.h>
+    #include <clocale>
+
+    // Portable network graphics and compression APIs...
+    #include <png.h>
+    #include <zlib.h>
+
+    // i18n...
+    #include "gettext.h"
+    #define _(str) gettext (str)
+    #define N_(str) gettext_noop (str)
+
+// Target number of filtered bytes each independently deflated chunk covers
+//  when encoding with parallel deflate...
+#define PNG_ENCODER_PARALLEL_CHUNK_SIZE (128 * 1024)
+
+// Size of the deflate window and hence the dictionary each chunk is primed
+//  with from the tail of the one preceding it...
+#define PNG_ENCODER_DICTIONARY_SIZE     (32 * 1024)
+
+// Longest libpng error message kept, including its terminator...
+#define PNG_ENCODER_ERROR_MESSAGE_SIZE  256
+
+// Streaming PNG encoder. Scanlines are fed to libpng straight out of the
+//  planar band buffers they were extracted into, one scanline at a time, so
+//  the image is never staged in full a second time...
+class PngEncoder : public ImageEncoder
+{
+    // Public types...
+    public:
+
+        // Scanline filter to apply before compression...
+        typedef enum
+        {
+            FilterAutomatic = -1,
+            FilterNone,
+            FilterSub,
+            FilterUp,
+            FilterAverage,
+            FilterPaeth,
+            FilterAdaptive
+        }FilterType;
+
+        // Encoding profile...
+        struct ProfileType
+        {
+            // Constructor initializer picks the same defaults libpng would...
+            ProfileType()
+                : m_Filter(FilterAutomatic),
+                  m_Level(Z_DEFAULT_COMPRESSION),
+                  m_ParallelDeflate(false),
+                  m_Strategy(-1),
+                  m_Threads(1)
+            { }
+
+            // Scanline filter...
+            FilterType          m_Filter;
+
+            // zlib compression level, 0 to 9, or Z_DEFAULT_COMPRESSION...
+            int                 m_Level;
+
+            // Split the image data into chunks deflated independently on
+            //  separate threads, each primed with the tail of the previous
+            //  chunk as its dictionary, then stitch them into one stream...
+            bool                m_ParallelDeflate;
+
+            // zlib compression strategy, or -1 to pick Z_FILTERED when
+            //  filtering and Z_DEFAULT_STRATEGY otherwise as libpng does...
+            int                 m_Strategy;
+
+            // Number of threads to deflate on when parallel deflate is on...
+            size_t              m_Threads;
+        };
+
+    // Public methods...
+    public:
+
+        // Constructor takes the stream to write the encoded image to, whether
+        //  to Adam7 interlace it, and the encoding profile...
+        PngEncoder(
+            std::ostream &OutputStream,
+            const bool Interlace = false,
+            const ProfileType &Profile = ProfileType());
+
+        // Encode an image of the given dimensions from either one plane as
+        //  grayscale or three planes as RGB, or throw an error...
+        void Encode(
+            const PlaneListType &Planes,
+            const size_t Width,
+            const size_t Height);
+
+        // Deconstructor...
+       ~PngEncoder();
+
+    // Protected types...
+    protected:
+
+        // A scanline of the filtered image data stream, identified by the
+        //  Adam7 pass it belongs to, or zero if not interlaced, and the row
+        //  of the planes it is sampled from...
+        struct ScanLineReference
+        {
+            // Constructor initializer...
+            ScanLineReference(const size_t Pass, const size_t Y)
+                : m_Pass(Pass), m_Y(Y)
+            { }
+
+            // Pass and source row...
+            size_t              m_Pass;
+            size_t              m_Y;
+        };
+
+        // List of scanlines in the order they appear in the data stream...
+        typedef std::vector<ScanLineReference> ScanLineListType;
+
+    // Protected methods...
+    protected:
+
+        // Deflate the filtered scanlines [First, Last) as one independent
+        //  chunk of the zlib stream, or throw an error. Its uncompressed size
+        //  and Adler-32 are returned for stitching the trailer...
+        void DeflateChunk(
+            const size_t First,
+            const size_t Last,
+            std::vector<uint8_t> &Compressed,
+            size_t &UncompressedSize,
+            uLong &Adler32) const;
+
+        // Encode with the image data split into chunks deflated in parallel
+        //  and written out as IDAT chunks directly, or throw an error...
+        void EncodeParallel();
+
+        // Encode through libpng's own serial filtering and deflate. Must be
+        //  run through CallLibpng()...
+        void EncodeSerial();
+
+        // Run a step that calls into libpng with our jump buffer armed, then
+        //  throw any error libpng reported from within it once control is
+        //  back in our own frame. The step must not leave anything on the
+        //  stack needing destruction, since libpng jumps straight over it...
+        void CallLibpng(const std::function<void()> &Step);
+
+        // Filter the given scanline against the one preceding it in its pass
+        //  and append it to the filtered data stream...
+        void FilterScanLine(
+            const std::vector<uint8_t> &Current,
+            const std::vector<uint8_t> &Previous,
+            std::vector<uint8_t> &Filtered) const;
+
+        // Get the number of filtered bytes a scanline occupies in the data
+        //  stream, including its filter type byte...
+        size_t GetFilteredScanLineSize(const ScanLineReference &ScanLine) const;
+
+        // Get the width of an Adam7 pass, or the image if not interlaced...
+        size_t GetPassWidth(const size_t Pass) const;
+
+        // Sample the pixels of a scanline of the given pass out of the planes
+        //  and interleave them into the provided scanline...
+        void SampleScanLine(
+            const ScanLineReference &ScanLine,
+            std::vector<uint8_t> &Sampled) const;
+
+        // libpng callbacks...
+        static void ErrorHandler(png_structp PngStruct, png_const_charp ErrorMessage);
+        static void FlushHandler(png_structp PngStruct);
+        static void WarningHandler(png_structp PngStruct, png_const_charp WarningMessage);
+        static void WriteHandler(png_structp PngStruct, png_bytep Data, png_size_t Length);
+
+    // Protected data...
+    protected:
+
+        // Channels per pixel...
+        size_t              m_Channels;
+
+        // Last error libpng reported, held until we are out of its frames.
+        //  A plain buffer since nothing there may allocate or throw...
+        char                m_ErrorMessage[PNG_ENCODER_ERROR_MESSAGE_SIZE];
+
+        // Image height...
+        size_t              m_Height;
+
+        // Adam7 interlaced...
+        bool                m_Interlace;
+
+        // Planes being encoded...
+        const PlaneListType *m_Planes;
+
+        // libpng info and write structures...
+        png_infop           m_PngInfo;
+        png_structp         m_PngStruct;
+
+        // Encoding profile in use...
+        ProfileType         m_Profile;
+
+        // Scratch scanline for interleaving colour planes...
+        std::vector<uint8_t> m_ScanLine;
+
+        // Scanlines of the filtered data stream when deflating in parallel...
+        ScanLineListType    m_ScanLines;
+
+        // Image width...
+        size_t              m_Width;
+};
+
+// Multiple include protection...
+#endif
+
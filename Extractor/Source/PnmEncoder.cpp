@@ -0,0 +1,87 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "PnmEncoder.h"
+
+    // System headers...
+    #include <sstream>
+
+// Using the standard namespace...
+using namespace std;
+
+// Constructor takes the stream to write the encoded image to...
+PnmEncoder::PnmEncoder(ostream &OutputStream)
+    : ImageEncoder(OutputStream)
+{
+
+}
+
+// Encode an image of the given dimensions from either one plane as grayscale
+//  or three planes as RGB, or throw an error...
+void PnmEncoder::Encode(
+    const PlaneListType &Planes,
+    const size_t Width,
+    const size_t Height)
+{
+    // Check we were given what we need...
+    CheckPlanes(Planes, Width, Height);
+    const size_t Channels = Planes.size();
+
+    // Write the header. P5 is binary PGM and P6 is binary PPM...
+    stringstream Header;
+    Header << (Channels == 1 ? "P5" : "P6") << "\n" << Width << " " << Height << "\n255\n";
+    Write(Header.str().data(), Header.str().size());
+
+    // Room for one interleaved scanline when there is more than one plane...
+    if(Channels > 1)
+        m_ScanLine.resize(Width * Channels);
+
+    // Write each scanline...
+    for(size_t Y = 0; Y < Height; ++Y)
+    {
+        // Grayscale scanlines can be written as they are...
+        if(Channels == 1)
+        {
+            Write(&(*Planes[0])[Y].front(), Width);
+            continue;
+        }
+
+        // Colour scanlines are interleaved first...
+        const uint8_t  *Red     = &(*Planes[0])[Y].front();
+        const uint8_t  *Green   = &(*Planes[1])[Y].front();
+        const uint8_t  *Blue    = &(*Planes[2])[Y].front();
+        uint8_t        *Pixel   = &m_ScanLine.front();
+        for(size_t X = 0; X < Width; ++X, Pixel += 3)
+        {
+            Pixel[0] = Red[X];
+            Pixel[1] = Green[X];
+            Pixel[2] = Blue[X];
+        }
+        Write(&m_ScanLine.front(), m_ScanLine.size());
+    }
+}
+
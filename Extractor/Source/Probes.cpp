@@ -0,0 +1,43 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "Probes.h"
+
+// Define a probe's semaphore, which the tracer increments while attached...
+#define PROBE_SEMAPHORE_DEFINITION(Name) \
+    __extension__ unsigned short viking_extractor_##Name##_semaphore \
+        __attribute__((unused)) __attribute__((section(".probes"))) = 0
+
+// Semaphore of each probe...
+PROBE_SEMAPHORE_DEFINITION(band_load_start);
+PROBE_SEMAPHORE_DEFINITION(band_load_end);
+PROBE_SEMAPHORE_DEFINITION(ocr_pass);
+PROBE_SEMAPHORE_DEFINITION(raw_read_done);
+PROBE_SEMAPHORE_DEFINITION(reconstruct_start);
+PROBE_SEMAPHORE_DEFINITION(reconstruct_end);
+PROBE_SEMAPHORE_DEFINITION(output_write);
+
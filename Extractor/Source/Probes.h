@@ -0,0 +1,107 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _PROBES_H_
+#define _PROBES_H_
+
+// Includes...
+
+    // System headers...
+    #include <chrono>
+    #include <stdint.h>
+
+// USDT static tracepoints at the boundaries of each pipeline stage, for
+//  bpftrace, perf, or SystemTap to attach to a live run, all under the
+//  viking_extractor provider. Each compiles to a single nop until attached to.
+//  Durations are in nanoseconds and are only measured while something is
+//  attached to the probe that reports them, being zero otherwise...
+//
+//      band_load_start     (file)
+//      band_load_end       (file, ok, duration)
+//      ocr_pass            (file, rotation, characters, duration)
+//      raw_read_done       (file, bytes, duration)
+//      reconstruct_start   (camera_event)
+//      reconstruct_end     (camera_event, ok, duration)
+//      output_write        (file, bytes, duration)
+
+// Built with USDT probes...
+#ifdef USE_USDT
+
+    // Probes have semaphores the tracer increments while attached, so
+    //  arguments that cost something to gather can be skipped otherwise...
+    #define _SDT_HAS_SEMAPHORES 1
+    #include <sys/sdt.h>
+
+    // Declare a probe's semaphore...
+    #define PROBE_SEMAPHORE(Name) \
+        __extension__ extern unsigned short viking_extractor_##Name##_semaphore \
+            __attribute__((unused)) __attribute__((section(".probes")))
+
+    // Semaphore of each probe, defined in Probes.cpp...
+    PROBE_SEMAPHORE(band_load_start);
+    PROBE_SEMAPHORE(band_load_end);
+    PROBE_SEMAPHORE(ocr_pass);
+    PROBE_SEMAPHORE(raw_read_done);
+    PROBE_SEMAPHORE(reconstruct_start);
+    PROBE_SEMAPHORE(reconstruct_end);
+    PROBE_SEMAPHORE(output_write);
+
+    // Check if anything is attached to a probe...
+    #define PROBE_ENABLED(Name) \
+        __builtin_expect(viking_extractor_##Name##_semaphore, 0)
+
+    // Fire a probe with the given arguments...
+    #define PROBE1(Name, A)             DTRACE_PROBE1(viking_extractor, Name, A)
+    #define PROBE3(Name, A, B, C)       DTRACE_PROBE3(viking_extractor, Name, A, B, C)
+    #define PROBE4(Name, A, B, C, D)    DTRACE_PROBE4(viking_extractor, Name, A, B, C, D)
+
+// Built without, so probes vanish entirely and their arguments are never
+//  evaluated, only mentioned so what was kept for them isn't unused...
+#else
+
+    #define PROBE_ENABLED(Name)         false
+    #define PROBE1(Name, A)             static_cast<void>(sizeof((A), 0))
+    #define PROBE3(Name, A, B, C)       static_cast<void>(sizeof((A), (B), (C), 0))
+    #define PROBE4(Name, A, B, C, D)    static_cast<void>(sizeof((A), (B), (C), (D), 0))
+
+#endif
+
+// Get the monotonic clock in nanoseconds...
+inline uint64_t GetProbeClock()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Timestamp to measure a probe's duration argument from, or zero without
+//  reading the clock if nothing is attached to the probe...
+#define PROBE_TIMESTAMP(Name) \
+    (PROBE_ENABLED(Name) ? GetProbeClock() : static_cast<uint64_t>(0))
+
+// Nanoseconds elapsed since a probe timestamp, or zero if it wasn't taken
+//  because nothing was attached yet...
+#define PROBE_ELAPSED(Start) \
+    ((Start) ? GetProbeClock() - (Start) : static_cast<uint64_t>(0))
+
+// Multiple include protection...
+#endif
+
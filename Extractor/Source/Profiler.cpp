@@ -0,0 +1,252 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "Profiler.h"
+    #include "Miscellaneous.h"
+
+    // System headers...
+    #include <cassert>
+    #include <fstream>
+    #include <iomanip>
+    #include <sstream>
+
+// Using the standard namespace...
+using namespace std;
+
+// Current innermost scope of each thread...
+thread_local Profiler::Scope *Profiler::Scope::m_Current = NULL;
+
+// Constructor starts timing the stage, optionally tagged such as with the
+//  rotation it was tried at...
+Profiler::Scope::Scope(
+    Profiler *TargetProfiler,
+    const string &File,
+    const char *Stage,
+    const char *Tag)
+    : m_ChildSeconds(0.0),
+      m_File(File),
+      m_Parent(NULL),
+      m_Profiler(TargetProfiler),
+      m_Stage(Stage),
+      m_Tag(Tag)
+{
+    // Not profiling...
+    if(!m_Profiler)
+        return;
+
+    // Nest within whatever this thread was already timing...
+    m_Parent    = m_Current;
+    m_Current   = this;
+
+    // Start timing...
+    m_Start = chrono::steady_clock::now();
+}
+
+// Stop timing and record the time spent before going out of scope. It must
+//  be the innermost scope of the thread...
+void Profiler::Scope::Stop()
+{
+    // Not profiling or already stopped...
+    if(!m_Profiler)
+        return;
+
+    // Should be the innermost...
+    assert(m_Current == this);
+
+    // Stop timing...
+    const double Seconds = 
+        chrono::duration<double>(chrono::steady_clock::now() - m_Start).count();
+
+    // Unnest, charging the time to the enclosing stage's nested stages...
+    m_Current = m_Parent;
+    if(m_Parent)
+        m_Parent->m_ChildSeconds += Seconds;
+
+    // Record, with the tag appended to the stage name if any...
+    m_Profiler->Record(
+        m_File,
+        m_Tag ? string(m_Stage) + "." + m_Tag : string(m_Stage),
+        Seconds,
+        Seconds - m_ChildSeconds);
+
+    // Don't record again...
+    m_Profiler = NULL;
+}
+
+// Deconstructor records the time spent, unless already stopped...
+Profiler::Scope::~Scope()
+{
+    // Record...
+    Stop();
+}
+
+// Constructor takes the metrics registry to observe stage latencies in, if
+//  any, which must outlive the profiler...
+Profiler::Profiler(Metrics *Registry)
+    : m_Metrics(Registry)
+{
+}
+
+// Get the files, slowest first. Caller must hold the mutex...
+void Profiler::GetSlowestFiles(
+    multimap<double, const string *, greater<double> > &Files) const
+{
+    // Sort...
+    Files.clear();
+    for(FileMapType::const_iterator Iterator = m_Files.begin();
+        Iterator != m_Files.end();
+      ++Iterator)
+        Files.insert(make_pair(Iterator->second.m_Seconds, &Iterator->first));
+}
+
+// Record the total time spent within a stage of working on a file and that
+//  spent less the stages nested within it...
+void Profiler::Record(
+    const string &File,
+    const string &Stage,
+    const double Seconds,
+    const double SelfSeconds)
+{
+    // Observe the latency, if keeping metrics...
+    if(m_Metrics)
+        m_Metrics->Observe(
+            "viking_extractor_stage_duration_seconds",
+            Metrics::Label("stage", Stage),
+            Seconds);
+
+    // Lock the timings...
+    lock_guard<mutex> Lock(m_Mutex);
+
+    // Update the file's...
+    FileType &FileTimings = m_Files[File];
+    FileTimings.m_Seconds += SelfSeconds;
+
+    // Update the stage's, both for the file and the whole run...
+    StageType *Timings[2] = { &FileTimings.m_Stages[Stage], &m_Stages[Stage] };
+    for(size_t Index = 0; Index < 2; ++Index)
+    {
+      ++Timings[Index]->m_Calls;
+        Timings[Index]->m_Seconds      += Seconds;
+        Timings[Index]->m_SelfSeconds  += SelfSeconds;
+        Timings[Index]->m_Slowest       = max(Timings[Index]->m_Slowest, Seconds);
+    }
+}
+
+// Write the timings of every stage for the whole run and for each file,
+//  slowest first, as JSON, or throw an error...
+void Profiler::WriteJson(const string &FileName) const
+{
+    // Variables...
+    multimap<double, const string *, greater<double> > Files;
+
+    // Create the file...
+    ofstream Stream(FileName.c_str(), ios::out | ios::trunc);
+    if(!Stream.is_open())
+        throw string(_("could not create profile: ")) + FileName;
+    Stream << setprecision(9);
+
+    // Lock the timings...
+    lock_guard<mutex> Lock(m_Mutex);
+
+    // Whole run...
+    Stream << "{\n  \"stages\": ";
+    WriteStagesJson(Stream, m_Stages, "  ");
+
+    // Each file, slowest first...
+    Stream << ",\n  \"files\": [";
+    GetSlowestFiles(Files);
+    for(multimap<double, const string *, greater<double> >::const_iterator Iterator = Files.begin();
+        Iterator != Files.end();
+      ++Iterator)
+    {
+        Stream
+            << ((Iterator == Files.begin()) ? "\n" : ",\n")
+            << "    {\n"
+            << "      \"file\": \"" << EscapeJson(*Iterator->second) << "\",\n"
+            << "      \"seconds\": " << Iterator->first << ",\n"
+            << "      \"stages\": ";
+        WriteStagesJson(Stream, m_Files.find(*Iterator->second)->second.m_Stages, "      ");
+        Stream << "\n    }";
+    }
+    Stream << "\n  ]\n}\n";
+
+    // Check for error...
+    Stream.flush();
+    if(!Stream.good())
+        throw string(_("could not write profile: ")) + FileName;
+}
+
+// Write a table of the given number of slowest files...
+void Profiler::WriteSlowestFiles(ostream &Stream, const size_t Count) const
+{
+    // Variables...
+    multimap<double, const string *, greater<double> > Files;
+    size_t Listed = 0;
+
+    // Lock the timings...
+    lock_guard<mutex> Lock(m_Mutex);
+
+    // Nothing was timed...
+    if(m_Files.empty())
+        return;
+
+    // List as many as were asked for, slowest first...
+    Stream << _("slowest input files:") << endl;
+    GetSlowestFiles(Files);
+    for(multimap<double, const string *, greater<double> >::const_iterator Iterator = Files.begin();
+        Iterator != Files.end() && Listed < Count;
+      ++Iterator, ++Listed)
+    {
+        // Format the time without disturbing the caller's stream settings...
+        ostringstream Seconds;
+        Seconds << setw(12) << fixed << setprecision(3) << Iterator->first;
+        Stream << Seconds.str() << " s  " << *Iterator->second << endl;
+    }
+}
+
+// Write stage timings as a JSON object...
+void Profiler::WriteStagesJson(
+    ostream &Stream,
+    const StageMapType &Stages,
+    const string &Indent)
+{
+    // Each stage...
+    Stream << "{";
+    for(StageMapType::const_iterator Iterator = Stages.begin();
+        Iterator != Stages.end();
+      ++Iterator)
+        Stream
+            << ((Iterator == Stages.begin()) ? "\n" : ",\n")
+            << Indent << "  \"" << EscapeJson(Iterator->first) << "\": {"
+            << "\"calls\": " << Iterator->second.m_Calls
+            << ", \"seconds\": " << Iterator->second.m_Seconds
+            << ", \"self_seconds\": " << Iterator->second.m_SelfSeconds
+            << ", \"slowest\": " << Iterator->second.m_Slowest
+            << "}";
+    Stream << "\n" << Indent << "}";
+}
+
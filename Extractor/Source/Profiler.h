@@ -0,0 +1,212 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+// Includes...
+
+    // Our headers...
+    #include "Metrics.h"
+
+    // System headers...
+    #include <chrono>
+    #include <cstddef>
+    #include <functional>
+    #include <map>
+    #include <mutex>
+    #include <ostream>
+    #include <string>
+    #include <clocale>
+
+    // i18n...
+    #include "gettext.h"
+    #define _(str) gettext (str)
+    #define N_(str) gettext_noop (str)
+
+// Number of slowest input files listed at the end of the summary when
+//  profiling...
+#define PROFILER_SLOWEST_FILES  10
+
+// Accumulates how long each stage of the extraction spends on each file, from
+//  whichever threads it runs on. Stages nest, so besides the total time spent
+//  within a stage, the time spent in it less that of the stages nested within
+//  is kept too, and it is these that add up to the time spent on a file. Each
+//  time may also be observed in a latency histogram of a metrics registry...
+class Profiler
+{
+    // Public types...
+    public:
+
+        // Times a stage of working on a file for as long as it is in scope,
+        //  or does nothing if there is no profiler. The file name must outlive
+        //  it...
+        class Scope
+        {
+            // Public methods...
+            public:
+
+                // Constructor starts timing the stage, optionally tagged such
+                //  as with the rotation it was tried at...
+                Scope(
+                    Profiler *TargetProfiler,
+                    const std::string &File,
+                    const char *Stage,
+                    const char *Tag = NULL);
+
+                // Stop timing and record the time spent before going out of
+                //  scope. It must be the innermost scope of the thread...
+                void Stop();
+
+                // Deconstructor records the time spent, unless already
+                //  stopped...
+               ~Scope();
+
+            // Protected data...
+            protected:
+
+                // Time spent within stages nested in this one...
+                double                  m_ChildSeconds;
+
+                // Current innermost scope of the calling thread...
+                static thread_local Scope *m_Current;
+
+                // File being worked on...
+                const std::string      &m_File;
+
+                // Scope this one is nested within on the same thread, if
+                //  any...
+                Scope                  *m_Parent;
+
+                // Profiler to record in, or NULL if not profiling or
+                //  stopped...
+                Profiler               *m_Profiler;
+
+                // Stage and its tag, if any...
+                const char             *m_Stage;
+                const char             *m_Tag;
+
+                // When the stage started...
+                std::chrono::steady_clock::time_point
+                                        m_Start;
+        };
+
+    // Public methods...
+    public:
+
+        // Constructor takes the metrics registry to observe stage latencies
+        //  in, if any, which must outlive the profiler...
+        Profiler(Metrics *Registry = NULL);
+
+        // Record the total time spent within a stage of working on a file and
+        //  that spent less the stages nested within it...
+        void Record(
+            const std::string &File,
+            const std::string &Stage,
+            const double Seconds,
+            const double SelfSeconds);
+
+        // Write the timings of every stage for the whole run and for each
+        //  file, slowest first, as JSON, or throw an error...
+        void WriteJson(const std::string &FileName) const;
+
+        // Write a table of the given number of slowest files...
+        void WriteSlowestFiles(std::ostream &Stream, const size_t Count) const;
+
+    // Protected types...
+    protected:
+
+        // Timings of a stage...
+        struct StageType
+        {
+            // Constructor initializer...
+            StageType()
+                : m_Calls(0),
+                  m_Seconds(0.0),
+                  m_SelfSeconds(0.0),
+                  m_Slowest(0.0)
+            { }
+
+            // Number of times it ran...
+            size_t              m_Calls;
+
+            // Total time spent within it, and less nested stages...
+            double              m_Seconds;
+            double              m_SelfSeconds;
+
+            // Longest a single run of it took...
+            double              m_Slowest;
+        };
+
+        // Stage timings by stage name...
+        typedef std::map<std::string, StageType> StageMapType;
+
+        // Timings of a file...
+        struct FileType
+        {
+            // Constructor initializer...
+            FileType()
+                : m_Seconds(0.0)
+            { }
+
+            // Time spent on it across all stages...
+            double              m_Seconds;
+
+            // Time spent on it by stage...
+            StageMapType        m_Stages;
+        };
+
+        // File timings by file name...
+        typedef std::map<std::string, FileType> FileMapType;
+
+    // Protected methods...
+    protected:
+
+        // Get the files, slowest first. Caller must hold the mutex...
+        void GetSlowestFiles(
+            std::multimap<double, const std::string *, std::greater<double> > &Files) const;
+
+        // Write stage timings as a JSON object...
+        static void WriteStagesJson(
+            std::ostream &Stream,
+            const StageMapType &Stages,
+            const std::string &Indent);
+
+    // Protected data...
+    protected:
+
+        // Timings by file...
+        FileMapType             m_Files;
+
+        // Metrics registry stage latencies are observed in, if any...
+        Metrics                *m_Metrics;
+
+        // Guards the timings...
+        mutable std::mutex      m_Mutex;
+
+        // Timings by stage for the whole run...
+        StageMapType            m_Stages;
+};
+
+// Multiple include protection...
+#endif
+
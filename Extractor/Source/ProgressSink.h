@@ -0,0 +1,87 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _PROGRESS_SINK_H_
+#define _PROGRESS_SINK_H_
+
+// Includes...
+
+    // System headers...
+    #include <cstddef>
+    #include <string>
+
+// Where an extraction reports its progress to, such as a front end driving it.
+//  Implementations may be called from the extraction's thread only...
+class ProgressSink
+{
+    // Public types...
+    public:
+
+        // An image that was reconstructed and written out...
+        struct ReconstructedImageType
+        {
+            // Constructor initializer...
+            ReconstructedImageType()
+                : m_Height(0), m_SolarDay(0), m_Width(0) { }
+
+            // Band type class... (e.g. Colour)
+            std::string         m_BandTypeClass;
+
+            // Camera event label without the solar day...
+            std::string         m_CameraEvent;
+
+            // Image height...
+            size_t              m_Height;
+
+            // Full path to the output file...
+            std::string         m_OutputFile;
+
+            // Solar day the image was taken on...
+            size_t              m_SolarDay;
+
+            // Image width...
+            size_t              m_Width;
+        };
+
+    // Public methods...
+    public:
+
+        // Block until everything reported so far has reached the front end...
+        virtual void Flush() = 0;
+
+        // Report an image was reconstructed and its output written...
+        virtual void ReportImageReconstructed(const ReconstructedImageType &Image) = 0;
+
+        // Report some new information suitable to be displayed to the user
+        //  during long operations...
+        virtual void ReportNotification(const std::string &Notification) = 0;
+
+        // Report progress of the current operation, in [0.0, 100.0]...
+        virtual void ReportProgress(const double Progress) = 0;
+
+        // Deconstructor...
+        virtual ~ProgressSink() { }
+};
+
+// Multiple include protection...
+#endif
+
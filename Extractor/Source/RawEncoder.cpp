@@ -0,0 +1,57 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "RawEncoder.h"
+
+// Using the standard namespace...
+using namespace std;
+
+// Constructor takes the stream to write the encoded image to...
+RawEncoder::RawEncoder(ostream &OutputStream)
+    : ImageEncoder(OutputStream)
+{
+
+}
+
+// Encode an image of the given dimensions from either one plane as grayscale
+//  or three planes as RGB, or throw an error...
+void RawEncoder::Encode(
+    const PlaneListType &Planes,
+    const size_t Width,
+    const size_t Height)
+{
+    // Check we were given what we need...
+    CheckPlanes(Planes, Width, Height);
+
+    // Write each plane's scanlines straight out...
+    for(size_t Plane = 0; Plane < Planes.size(); ++Plane)
+    {
+        for(size_t Y = 0; Y < Height; ++Y)
+            Write(&(*Planes[Plane])[Y].front(), Width);
+    }
+}
+
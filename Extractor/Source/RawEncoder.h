@@ -0,0 +1,55 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _RAW_ENCODER_H_
+#define _RAW_ENCODER_H_
+
+// Includes...
+
+    // Our headers...
+    #include "ImageEncoder.h"
+
+    // System headers...
+    #include <ostream>
+
+// Raw planar encoder. Each plane is written out whole, one after the other,
+//  as unsigned bytes with no header. The dimensions and band order are left
+//  to a sidecar...
+class RawEncoder : public ImageEncoder
+{
+    // Public methods...
+    public:
+
+        // Constructor takes the stream to write the encoded image to...
+        RawEncoder(std::ostream &OutputStream);
+
+        // Encode an image of the given dimensions from either one plane as
+        //  grayscale or three planes as RGB, or throw an error...
+        void Encode(
+            const PlaneListType &Planes,
+            const size_t Width,
+            const size_t Height);
+};
+
+// Multiple include protection...
+#endif
+
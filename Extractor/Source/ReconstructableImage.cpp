@@ -28,6 +28,9 @@
     #include "ReconstructableImage.h"
     #include "Miscellaneous.h"
     #include "Console.h"
+    #include "PngEncoder.h"
+    #include "PnmEncoder.h"
+    #include "RawEncoder.h"
     
     // System headers...
     #include <cassert>
@@ -36,20 +39,27 @@
     #include <algorithm>
     #include <climits>
 
-    // Portable network graphics API...
-    #include <png++/png.hpp>
-
 // Using the standard namespace...
 using namespace std;
 
 // Constructor...
 ReconstructableImage::ReconstructableImage(
+    const ExtractionContext &Context,
     const std::string &OutputRootDirectory, 
-    const std::string &CameraEventLabel)
-    : m_OutputRootDirectory(OutputRootDirectory),
+    const std::string &CameraEventLabel,
+    OutputSink &Sink,
+    MetadataCatalogue *Catalogue)
+    : m_Context(Context),
+      m_OutputRootDirectory(OutputRootDirectory),
+      m_OutputSink(Sink),
+      m_MetadataCatalogue(Catalogue),
+      m_BandDescriptorBytes(0),
       m_CameraEventLabel(CameraEventLabel),
       m_DumpedImagesCount(0),
       m_LanderNumber(0),
+      m_Overwrite(m_Context.GetOptions().GetOverwrite()),
+      m_ReconstructedHeight(0),
+      m_ReconstructedWidth(0),
       m_SolarDay(0)
 {
     // Always need an label...
@@ -155,6 +165,11 @@ void ReconstructableImage::AddImageBand(const VicarImageBand &ImageBand)
         default:
             SetErrorAndReturn(_("cannot reconstruct image from unsupported diode band type"));
     }
+
+    // Account for the copy of the descriptor now held...
+    const size_t Footprint = ImageBand.GetMemoryFootprint();
+    m_Context.GetMemoryTracker().Charge(MemoryTracker::BandDescriptors, Footprint);
+    m_BandDescriptorBytes += Footprint;
 }
 
 // Create the necessary path to the output file and return a path. 
@@ -176,7 +191,7 @@ string ReconstructableImage::CreateOutputFileName(
         FullDirectory << _("Unreconstructable/");
 
     // Images are reconstructed in subfolder of location taken in if enabled...
-    if(Options::GetInstance().GetDirectorizeLocation())
+    if(m_Context.GetOptions().GetDirectorizeLocation())
     {
         // Location determined by lander image was taken from...
         switch(m_LanderNumber)
@@ -199,16 +214,16 @@ string ReconstructableImage::CreateOutputFileName(
     }
 
     // Images are reconstructed in subfolder of month if enabled...
-    if(Options::GetInstance().GetDirectorizeMonth() && !m_Month.empty())
+    if(m_Context.GetOptions().GetDirectorizeMonth() && !m_Month.empty())
         FullDirectory << m_Month << '/';
 
     // Images are reconstructed in subfolder of band type class if enabled...
-    if(Options::GetInstance().GetDirectorizeBandTypeClass() && !m_BandTypeClass.empty())
+    if(m_Context.GetOptions().GetDirectorizeBandTypeClass() && !m_BandTypeClass.empty())
         FullDirectory << m_BandTypeClass << '/';
 
     // Images are reconstructed in subfolder of solar day it was 
     //  taken on, so create the subfolder, if enabled...
-    if(Options::GetInstance().GetDirectorizeSol())
+    if(m_Context.GetOptions().GetDirectorizeSol())
         FullDirectory << m_SolarDay << '/';
 
     // Put inside of directory for this camera event, but only if it's 
@@ -218,12 +233,21 @@ string ReconstructableImage::CreateOutputFileName(
         FullDirectory << m_CameraEventNoSol << '/';
 
     // Create and check for error, if not a dry run...
-    if(!Options::GetInstance().GetDryRun() && 
-       !CreateDirectoryRecursively(FullDirectory.str()))
+    if(!m_Context.GetOptions().GetDryRun())
     {
-        // Set the error message and abort...
-        SetErrorMessage(_("could not create output directory for file"));
-        return string();
+        // Have the sink prepare the directory...
+        try
+        {
+            m_OutputSink.PrepareDirectory(FullDirectory.str());
+        }
+
+            // Failed...
+            catch(const string &ErrorMessage)
+            {
+                // Set the error message and abort...
+                SetErrorMessage(ErrorMessage);
+                return string();
+            }
     }
 
     // Compose the file name portion...
@@ -273,7 +297,7 @@ bool ReconstructableImage::DumpUnreconstructable(ImageBandListType &ImageBandLis
 
         // Create the directory to contain all grayscale image bands...
         const string FullDirectory = CreateOutputFileName(
-            true, "png", UnreconstructableName.str());
+            true, GetImageExtension(1), UnreconstructableName.str());
         
         // Dump the single channel as grayscale...
         if(ReconstructGrayscaleImage(FullDirectory, ImageBand))
@@ -281,9 +305,14 @@ bool ReconstructableImage::DumpUnreconstructable(ImageBandListType &ImageBandLis
             // Remember this...
           ++m_DumpedImagesCount;
 
-            // Saved successfully, now if generating metadata is enabled, dump...
-            if(Options::GetInstance().GetGenerateMetadata())
-                GenerateMetadata(CreateOutputFileName(true, "txt", UnreconstructableName.str()), ImageBandList);
+            // Saved successfully, now if generating metadata is enabled, dump.
+            //  Text files describe the whole band list, but a catalogue only
+            //  needs the band that was actually dumped...
+            if(m_Context.GetOptions().GetGenerateMetadata())
+                GenerateMetadata(
+                    FullDirectory,
+                    "unreconstructable",
+                    m_MetadataCatalogue ? ImageBandListType(1, ImageBand) : ImageBandList);
         }
     }
     
@@ -341,85 +370,164 @@ ReconstructableImage::FindBestImageBandWithNoAxis(
 
 // Generate metadata for file...
 void ReconstructableImage::GenerateMetadata(
-    const string &OutputFileName, 
+    const string &ImageFileName,
+    const string &Kind,
     const ImageBandListType &ImageBandList)
 {
     // Check for dry run...
-    if(Options::GetInstance().GetDryRun())
+    if(m_Context.GetOptions().GetDryRun())
         return;
 
+    // Time it...
+    Profiler::Scope Scope(m_Context.GetProfiler(), ImageFileName, "generate_metadata");
+
+    // Collecting a catalogue for the whole run instead...
+    if(m_MetadataCatalogue)
+    {
+        // Add the image and its bands...
+        try
+        {
+            m_MetadataCatalogue->AddImage(ImageFileName, Kind, ImageBandList);
+        }
+
+            // Failed...
+            catch(const string &ErrorMessage)
+            {
+                // Just give a warning...
+                m_Context.Message(Console::Warning) << ErrorMessage << endl;
+            }
+
+        // Done...
+        return;
+    }
+
+    // Text file sits beside the image with its extension swapped...
+    const string OutputFileName =
+        ImageFileName.substr(0, ImageFileName.find_last_of('.')) + ".txt";
+
     // Overwrite not enabled and file already existed, don't overwrite...
-    if(!Options::GetInstance().GetOverwrite() && 
-       (access(OutputFileName.c_str(), F_OK) == 0))
+    if(!m_Overwrite && 
+       m_OutputSink.Exists(OutputFileName))
     {
-        Message(Console::Warning) << _("output metadata already exists, not overwriting (use --overwrite to override)");
+        m_Context.Message(Console::Warning) << _("output metadata already exists, not overwriting (use --overwrite to override)");
         return;
     }
 
     // Create the metadata text file...
-    ofstream OutputFileStream(OutputFileName.c_str());
-    
+    try
+    {
+        ostream &OutputFileStream = m_OutputSink.OpenFile(OutputFileName);
+        WriteMetadata(OutputFileStream, ImageBandList);
+        m_OutputSink.CloseFile();
+    }
+
         // Failed...
-        if(!OutputFileStream.is_open())
+        catch(const string &)
         {
             // Just give a warning and abort...
-            Message(Console::Warning) << _("couldn't save metadata") << endl;
+            m_OutputSink.AbortFile();
+            m_Context.Message(Console::Warning) << _("couldn't save metadata") << endl;
             return;
         }
+}
 
+// Write the metadata of each of the given image bands out to a stream...
+void ReconstructableImage::WriteMetadata(
+    ostream &OutputFileStream,
+    const ImageBandListType &ImageBandList) const
+{
     // Give user some basic information about the metadata...
     OutputFileStream
         << _("The following is a machine generated collection of metadata of each of\n")
         << _("the image bands used to reconstruct a colour image.\n")
-        << endl;
+        << "\n";
 
     // Dump each section...
     for(ImageBandListConstIterator Iterator = ImageBandList.begin(); 
         Iterator != ImageBandList.end(); 
       ++Iterator)
     {
-        // Get image...
+        // Get image and its quality statistics...
         const VicarImageBand &ImageBand = *Iterator;
+        const BandStatistics &Statistics = ImageBand.GetStatistics();
+
+        // Format the histogram as a single line of bin counts...
+        stringstream Histogram;
+        for(size_t Bin = 0; Bin < BAND_STATISTICS_HISTOGRAM_BINS; ++Bin)
+            Histogram << (Bin ? " " : "") << Statistics.GetHistogramBin(Bin);
 
         // Dump metadata...
         OutputFileStream 
-            << _("basic heuristic method: ") << ImageBand.GetBasicMetadataParserHeuristic() << endl
-            << _("camera azimuth / elevation: ") << ImageBand.GetAzimuthElevation() << endl
-            << _("camera event: ") << ImageBand.GetCameraEventLabelNoSol() << endl
-            << _("camera event solar day: ") << ImageBand.GetSolarDay() << endl
-            << _("diode band type: ") << ImageBand.GetDiodeBandTypeFriendlyString() << endl
-            << _("file size: ") << ImageBand.GetFileSize() << endl
-            << _("input file: ") << ImageBand.GetInputFileNameOnly() << endl
-            << _("magnetic tape: ") << ImageBand.GetMagneticTapeNumber() << endl
-            << _("magnetic tape file ordinal: ") << ImageBand.GetFileOrdinalOnMagneticTape() << endl
-            << _("mean pixel value: ") << ImageBand.GetMeanPixelValue() << endl
-            << _("month: ") << ImageBand.GetMonth() << endl
-            << _("overlay axis present: ") << ImageBand.IsAxisPresent() << endl
-            << _("overlay full histogram present: ") << ImageBand.IsFullHistogramPresent() << endl
-            << _("physical record size: ") << ImageBand.GetPhysicalRecordSize() << endl
-            << _("physical record padding: ") << ImageBand.GetPhysicalRecordPadding() << endl
-            << _("phase offset required: ") << ImageBand.GetPhaseOffsetRequired() << endl
-            << _("raw image offset: ") << ImageBand.GetRawImageOffset() << endl
-            << endl 
-            << endl;
+            << _("basic heuristic method: ") << ImageBand.GetBasicMetadataParserHeuristic() << "\n"
+            << _("camera azimuth / elevation: ") << ImageBand.GetAzimuthElevation() << "\n"
+            << _("camera event: ") << ImageBand.GetCameraEventLabelNoSol() << "\n"
+            << _("camera event solar day: ") << ImageBand.GetSolarDay() << "\n"
+            << _("diode band type: ") << ImageBand.GetDiodeBandTypeFriendlyString() << "\n"
+            << _("dropout scanlines: ") << Statistics.GetDropoutRows() << "\n"
+            << _("file size: ") << ImageBand.GetFileSize() << "\n"
+            << _("histogram: ") << Histogram.str() << "\n"
+            << _("input file: ") << ImageBand.GetInputFileNameOnly() << "\n"
+            << _("magnetic tape: ") << ImageBand.GetMagneticTapeNumber() << "\n"
+            << _("magnetic tape file ordinal: ") << ImageBand.GetFileOrdinalOnMagneticTape() << "\n"
+            << _("maximum pixel value: ") << static_cast<int>(Statistics.GetMaximum()) << "\n"
+            << _("mean pixel value: ") << ImageBand.GetMeanPixelValue() << "\n"
+            << _("minimum pixel value: ") << static_cast<int>(Statistics.GetMinimum()) << "\n"
+            << _("month: ") << ImageBand.GetMonth() << "\n"
+            << _("overlay axis present: ") << ImageBand.IsAxisPresent() << "\n"
+            << _("overlay full histogram present: ") << ImageBand.IsFullHistogramPresent() << "\n"
+            << _("physical record size: ") << ImageBand.GetPhysicalRecordSize() << "\n"
+            << _("physical record padding: ") << ImageBand.GetPhysicalRecordPadding() << "\n"
+            << _("phase offset required: ") << ImageBand.GetPhaseOffsetRequired() << "\n"
+            << _("pixel value variance: ") << Statistics.GetVariance() << "\n"
+            << _("raw image offset: ") << ImageBand.GetRawImageOffset() << "\n"
+            << _("saturated pixels: ") << Statistics.GetSaturatedPixels() << "\n"
+            << "\n" 
+            << "\n";
     }
 }
 
-// Extract the image out as a PNG, or return false if failed...
-bool ReconstructableImage::Reconstruct()
+// Get the input files of every image band added...
+void ReconstructableImage::GetInputFiles(vector<string> &InputFiles) const
 {
-    // Sort each band lists from lowest to best quality. Note that this
-    //  does not necessarily mean that the best image of each band list
-    //  will form the best matching set, since the best of one band list
-    //  might have a full histogram and another might not...
-    sort(m_RedImageBandList.begin(),        m_RedImageBandList.end());
-    sort(m_GreenImageBandList.begin(),      m_GreenImageBandList.end());
-    sort(m_BlueImageBandList.begin(),       m_BlueImageBandList.end());
-    sort(m_Infrared1ImageBandList.begin(),  m_Infrared1ImageBandList.end());
-    sort(m_Infrared2ImageBandList.begin(),  m_Infrared2ImageBandList.end());
-    sort(m_Infrared3ImageBandList.begin(),  m_Infrared3ImageBandList.end());
-    sort(m_GrayImageBandList.begin(),       m_GrayImageBandList.end());
+    // Every band list...
+    const ImageBandListType *ImageBandLists[] =
+    {
+        &m_RedImageBandList,
+        &m_GreenImageBandList,
+        &m_BlueImageBandList,
+        &m_Infrared1ImageBandList,
+        &m_Infrared2ImageBandList,
+        &m_Infrared3ImageBandList,
+        &m_GrayImageBandList
+    };
+
+    // Gather each band's input file...
+    InputFiles.clear();
+    for(size_t List = 0; List < sizeof(ImageBandLists) / sizeof(ImageBandLists[0]); ++List)
+    {
+        for(ImageBandListConstIterator Iterator = ImageBandLists[List]->begin();
+            Iterator != ImageBandLists[List]->end();
+          ++Iterator)
+            InputFiles.push_back(Iterator->GetInputFileName());
+    }
+}
+
+// Get the file name extension for an output image with the given number of
+//  channels in the selected output format...
+string ReconstructableImage::GetImageExtension(const size_t Channels) const
+{
+    // Which format?
+    switch(m_Context.GetOptions().GetOutputFormat())
+    {
+        case Options::FormatPnm:    return (Channels == 1) ? "pgm" : "ppm";
+        case Options::FormatRaw:    return "raw";
+        default:                    return "png";
+    }
+}
 
+// Get what reconstructing would make out of the bands present...
+ReconstructableImage::ReconstructionType ReconstructableImage::GetReconstructionType() const
+{
     // Setup shorthand sizes to image band vectors...
     const size_t Reds       = m_RedImageBandList.size();
     const size_t Greens     = m_GreenImageBandList.size();
@@ -429,77 +537,219 @@ bool ReconstructableImage::Reconstruct()
     const size_t Infrareds3 = m_Infrared3ImageBandList.size();
     const size_t Grays      = m_GrayImageBandList.size();
 
-    // We haven't dumped any images until we do so directed from in here...
-    m_DumpedImagesCount = 0;
+    // User requested nothing be reassembled...
+    if(m_Context.GetOptions().GetNoReconstruct())
+        return ReconstructNothing;
 
     // Colour image reconstruction... (only all colour bands present)
-    if(!Options::GetInstance().GetNoReconstruct() &&
-       (min3(Reds, Greens, Blues) >= 1) && 
+    if((min3(Reds, Greens, Blues) >= 1) && 
        (Infrareds1 + Infrareds2 + Infrareds3 + Grays == 0))
+        return ReconstructColour;
+
+    // Grayscale image reconstruction... (only grayscale image bands)
+    if((Reds + Greens + Blues + Infrareds1 + Infrareds2 + Infrareds3 == 0) &&
+        Grays >= 1)
+        return ReconstructGrayscale;
+
+    /* Infrared image reconstruction... (only all infrared bands present)
+    if((Reds + Greens + Blues + Grays == 0) && 
+       (min(Infrareds1, Infrareds2, Infrareds3) >= 1))
+        return ReconstructInfrared;*/
+
+    // Unknown...
+    return ReconstructNothing;
+}
+
+// Describe what reconstructing would do without reading any pixels, being the
+//  candidate bands for each channel, best first, and the outputs that would be
+//  written or dumped...
+void ReconstructableImage::Plan(ostream &PlanStream)
+{
+    // Every band list and the name of the channel it would supply...
+    ImageBandListType *ImageBandLists[] =
+    {
+        &m_RedImageBandList,
+        &m_GreenImageBandList,
+        &m_BlueImageBandList,
+        &m_Infrared1ImageBandList,
+        &m_Infrared2ImageBandList,
+        &m_Infrared3ImageBandList,
+        &m_GrayImageBandList
+    };
+    const char *ChannelNames[] =
+    {
+        N_("red"),
+        N_("green"),
+        N_("blue"),
+        N_("infrared 1"),
+        N_("infrared 2"),
+        N_("infrared 3"),
+        N_("gray")
+    };
+
+    // Order candidates the same way reconstructing would. Overlays like axes
+    //  and histograms are only found by examining the pixels, which planning
+    //  skips, so candidates may swap places once they actually are...
+    SortImageBandLists();
+
+    // Describe the camera event and what would become of it...
+    const ReconstructionType Type = GetReconstructionType();
+    PlanStream << m_CameraEventLabel << ": ";
+    switch(Type)
     {
-        // Create full path to output file and create containing directory, if
-        //  necessary...
-        const string OutputFileName = CreateOutputFileName(false, "png");
+        case ReconstructColour:
+            PlanStream << _("colour") << " -> "
+                       << CreateOutputFileName(false, GetImageExtension(3)) << endl;
+            break;
 
-            // Failed...
-            if(IsError())
-                return false;
+        case ReconstructGrayscale:
+            PlanStream << _("grayscale") << " -> "
+                       << CreateOutputFileName(false, GetImageExtension(1)) << endl;
+            break;
 
-        // Attempt to reconstruct...
-        return ReconstructColourImage(
-                OutputFileName, 
-                m_RedImageBandList, 
-                m_GreenImageBandList, 
-                m_BlueImageBandList);
+        default:
+            PlanStream << _("unreconstructable, dumping all bands") << endl;
+            break;
     }
 
-    // Grayscale image reconstruction... (only grayscale image bands)
-    else if(!Options::GetInstance().GetNoReconstruct() &&
-            (Reds + Greens + Blues + Infrareds1 + Infrareds2 + Infrareds3 == 0) &&
-            Grays >= 1)
+    // Describe each channel's candidates...
+    for(size_t List = 0; List < sizeof(ImageBandLists) / sizeof(ImageBandLists[0]); ++List)
     {
-        // Create full path to output file and create containing 
-        // directory, if necessary...
-        const string OutputFileName = CreateOutputFileName(false, "png");
+        // Get the band list...
+        ImageBandListType &ImageBandList = *ImageBandLists[List];
 
-            // Failed...
-            if(IsError())
-                return false;
+            // No candidates for this channel...
+            if(ImageBandList.empty())
+                continue;
+
+        // Describe the channel...
+        PlanStream << "    " << _(ChannelNames[List]) << ": " 
+                   << ImageBandList.size() << _(" candidate(s)") << endl;
 
-        // Save best...
-        return ReconstructGrayscaleImage(
-            OutputFileName, 
-            m_GrayImageBandList.back());
+        // Each candidate, best first...
+        for(ImageBandListReverseIterator Iterator = ImageBandList.rbegin();
+            Iterator != ImageBandList.rend();
+          ++Iterator)
+        {
+            // Get the image band...
+            const VicarImageBand &ImageBand = *Iterator;
+
+            // Describe it...
+            PlanStream << "        " << ImageBand.GetInputFileName()
+                       << " (" << ImageBand.GetOriginalWidth() << "x" 
+                       << ImageBand.GetOriginalHeight()
+                       << ")";
+
+            // Unreconstructable, so the candidate would be dumped under the
+            //  same name DumpUnreconstructable() gives it...
+            if(Type == ReconstructNothing)
+            {
+                stringstream UnreconstructableName;
+                UnreconstructableName 
+                    << ImageBand.GetDiodeBandTypeFriendlyString()
+                    << "_"
+                    << (ImageBandList.rend() - Iterator - 1);
+                PlanStream << " -> " << CreateOutputFileName(
+                    true, GetImageExtension(1), UnreconstructableName.str());
+            }
+
+            // Done with this candidate...
+            PlanStream << endl;
+        }
     }
+}
 
-    /* Infrared image reconstruction... (only all infrared bands present)
-    else if(!Options::GetInstance().GetNoReconstruct() &&
-            (Reds + Greens + Blues + Grays == 0) && 
-            (min(Infrareds1, Infrareds2, Infrareds3) >= 1))
-    {
-        Message(Console::Info) << "reconstructed infrared image successfully" << endl;
-    }*/
+// Extract the image out as a PNG, or return false if failed...
+bool ReconstructableImage::Reconstruct()
+{
+    // Trace it...
+    Tracer::Span Span(m_Context.GetTracer(), "reconstruct");
+    Span.SetArgument("camera_event", m_CameraEventLabel);
 
-    // Unknown...
-    else
+    // Sort each band list from lowest to best quality...
+    SortImageBandLists();
+
+    // We haven't dumped any images until we do so directed from in here...
+    m_DumpedImagesCount = 0;
+
+    // Nor written out a reconstructed one...
+    m_ReconstructedFileName.clear();
+    m_ReconstructedHeight   = 0;
+    m_ReconstructedWidth    = 0;
+
+    // Reconstruct whatever the bands present allow...
+    switch(GetReconstructionType())
     {
-        // Dump...
-        DumpUnreconstructable(m_RedImageBandList);
-        DumpUnreconstructable(m_GreenImageBandList);
-        DumpUnreconstructable(m_BlueImageBandList);
-        DumpUnreconstructable(m_Infrared1ImageBandList);
-        DumpUnreconstructable(m_Infrared2ImageBandList);
-        DumpUnreconstructable(m_Infrared3ImageBandList);
-        DumpUnreconstructable(m_GrayImageBandList);
-
-        // This doesn't count as a successful reconstruction since user 
-        //  requested it not be reassembled...
-        if(!Options::GetInstance().GetNoReconstruct())
-            SetErrorAndReturnFalse(_("cannot reconstruct, dumped all bands"))
-        
-        // User explicitly requested no reconstruction, so not an error...
-        else
+        // Colour image reconstruction... (only all colour bands present)
+        case ReconstructColour:
+        {
+            // Create full path to output file and create containing directory,
+            //  if necessary...
+            const string OutputFileName = CreateOutputFileName(false, GetImageExtension(3));
+
+                // Failed...
+                if(IsError())
+                    return false;
+
+            // Attempt to reconstruct...
+            if(!ReconstructColourImage(
+                    OutputFileName, 
+                    m_RedImageBandList, 
+                    m_GreenImageBandList, 
+                    m_BlueImageBandList))
+                return false;
+
+            // Done...
+            m_ReconstructedFileName = OutputFileName;
             return true;
+        }
+
+        // Grayscale image reconstruction... (only grayscale image bands)
+        case ReconstructGrayscale:
+        {
+            // Create full path to output file and create containing 
+            // directory, if necessary...
+            const string OutputFileName = CreateOutputFileName(false, GetImageExtension(1));
+
+                // Failed...
+                if(IsError())
+                    return false;
+
+            // Save best...
+            if(!ReconstructGrayscaleImage(OutputFileName, m_GrayImageBandList.back()))
+                return false;
+
+            // Grayscale reconstructions never had a text file of their own,
+            //  but do get rows in a catalogue...
+            if(m_Context.GetOptions().GetGenerateMetadata() && m_MetadataCatalogue)
+                GenerateMetadata(OutputFileName, "grayscale", ImageBandListType(1, m_GrayImageBandList.back()));
+
+            // Done...
+            m_ReconstructedFileName = OutputFileName;
+            return true;
+        }
+
+        // Unknown...
+        default:
+        {
+            // Dump...
+            DumpUnreconstructable(m_RedImageBandList);
+            DumpUnreconstructable(m_GreenImageBandList);
+            DumpUnreconstructable(m_BlueImageBandList);
+            DumpUnreconstructable(m_Infrared1ImageBandList);
+            DumpUnreconstructable(m_Infrared2ImageBandList);
+            DumpUnreconstructable(m_Infrared3ImageBandList);
+            DumpUnreconstructable(m_GrayImageBandList);
+
+            // This doesn't count as a successful reconstruction since user 
+            //  requested it not be reassembled...
+            if(!m_Context.GetOptions().GetNoReconstruct())
+                SetErrorAndReturnFalse(_("cannot reconstruct, dumped all bands"))
+            
+            // User explicitly requested no reconstruction, so not an error...
+            else
+                return true;
+        }
     }
 }
 
@@ -516,11 +766,11 @@ bool ReconstructableImage::ReconstructColourImage(
     assert(!BlueImageBandList.empty());
 
     // Set file name for console messages to begin with...
-    Console::GetInstance().SetCurrentFileName(OutputFileName);
+    m_Context.GetConsole().SetCurrentFileName(OutputFileName);
 
     // Overwrite not enabled and file already existed, don't overwrite...
-    if(!Options::GetInstance().GetOverwrite() && 
-       (access(OutputFileName.c_str(), F_OK) == 0))
+    if(!m_Overwrite && 
+       m_OutputSink.Exists(OutputFileName))
         SetErrorAndReturnFalse(_("output already exists, not overwriting (use --overwrite to override)"));
 
     // Form the best image set from each band list...
@@ -586,8 +836,13 @@ bool ReconstructableImage::ReconstructColourImage(
     
         // Red...
 
-            // Get the best red image band...
+            // Get the best red image band and account for its raw band
+            //  data for as long as it is held...
             VicarImageBand &BestRedImageBand = *BestRedIterator;
+            MemoryTracker::Reservation RedReservation(
+                m_Context.GetMemoryTracker(),
+                MemoryTracker::RasterBuffers,
+                BestRedImageBand.GetTotalOriginalPixelSpace());
 
             // Get the raw band data and check for error...
             if(!BestRedImageBand.GetRawBandData(RedRawBandData))
@@ -599,8 +854,13 @@ bool ReconstructableImage::ReconstructColourImage(
         
         // Green...
         
-            // Get the best green image band...
+            // Get the best green image band and account for its raw band
+            //  data...
             VicarImageBand &BestGreenImageBand = *BestGreenIterator;
+            MemoryTracker::Reservation GreenReservation(
+                m_Context.GetMemoryTracker(),
+                MemoryTracker::RasterBuffers,
+                BestGreenImageBand.GetTotalOriginalPixelSpace());
 
             // Get the raw band data and check for error...
             if(!BestGreenImageBand.GetRawBandData(GreenRawBandData))
@@ -612,8 +872,13 @@ bool ReconstructableImage::ReconstructColourImage(
 
         // Blue...
             
-            // Get the best blue image band...
+            // Get the best blue image band and account for its raw band
+            //  data...
             VicarImageBand &BestBlueImageBand = *BestBlueIterator;
+            MemoryTracker::Reservation BlueReservation(
+                m_Context.GetMemoryTracker(),
+                MemoryTracker::RasterBuffers,
+                BestBlueImageBand.GetTotalOriginalPixelSpace());
 
             // Initialize extraction stream and check for error...
             if(!BestBlueImageBand.GetRawBandData(BlueRawBandData))
@@ -632,7 +897,7 @@ bool ReconstructableImage::ReconstructColourImage(
 
     // If the widths don't match or the heights don't match, issue a warning...
     if((MinimumWidth != MaximumWidth) || (MinimumHeight != MaximumHeight))
-        Message(Console::Warning) 
+        m_Context.Message(Console::Warning) 
             << _("image bands not all the same size, may be missing scanlines") 
             << " [" << MinimumWidth << ", " << MaximumWidth << "] x "
             << "[" << MinimumHeight << ", " << MaximumHeight << "]" << endl;
@@ -643,46 +908,39 @@ bool ReconstructableImage::ReconstructColourImage(
     const size_t Width  = min3(RedWidth, GreenWidth, BlueWidth);
     const size_t Height = min3(RedHeight, GreenHeight, BlueHeight);
 
-    // Allocate png storage...
-    png::image<png::rgb_pixel> PngImage(Width, Height);
-
-    // Toggle interlacing, if user selected...
-    if(Options::GetInstance().GetInterlace())
-        PngImage.set_interlace_type(png::interlace_adam7);
-    else
-        PngImage.set_interlace_type(png::interlace_none);
-
-    // Pass raw image data through encoder, row by row...
-    for(size_t Y = 0; Y < PngImage.get_height(); ++Y)
+    // Write out image, if not a dry run...
+    if(!m_Context.GetOptions().GetDryRun())
     {
-        // Pass raw image data through encoder, column by column...
-        for(size_t X = 0; X < PngImage.get_width(); ++X)
-        {
-            // Storage for this pixel's colours...
-            const uint8_t RedByte    = RedRawBandData.at(Y).at(X);
-            const uint8_t GreenByte  = GreenRawBandData.at(Y).at(X);
-            const uint8_t BlueByte   = BlueRawBandData.at(Y).at(X);
-
-            // Encode...
-            PngImage.set_pixel(X, Y, png::rgb_pixel(RedByte, GreenByte, BlueByte));
-        }
+        // Prepare list of planes and the bands they came from...
+        ImageEncoder::PlaneListType Planes;
+        Planes.push_back(&RedRawBandData);
+        Planes.push_back(&GreenRawBandData);
+        Planes.push_back(&BlueRawBandData);
+        PlaneBandListType PlaneBands;
+        PlaneBands.push_back(&BestRedImageBand);
+        PlaneBands.push_back(&BestGreenImageBand);
+        PlaneBands.push_back(&BestBlueImageBand);
+
+        // Encode...
+        if(!WriteImage(OutputFileName, Planes, PlaneBands, Width, Height))
+            return false;
     }
 
-    // Write out image, if not a dry run...
-    if(!Options::GetInstance().GetDryRun())
-        PngImage.write(OutputFileName);
-
     // If generation of metadata is enabled, dump it...
-    if(Options::GetInstance().GetGenerateMetadata())
+    if(m_Context.GetOptions().GetGenerateMetadata())
     {
         // Prepare list of components...
         ImageBandListType ImageBandList;
         ImageBandList.push_back(*BestRedIterator);
         ImageBandList.push_back(*BestGreenIterator);
         ImageBandList.push_back(*BestBlueIterator);
-        GenerateMetadata(CreateOutputFileName(false, "txt"), ImageBandList);
+        GenerateMetadata(OutputFileName, "colour", ImageBandList);
     }
 
+    // Remember its dimensions...
+    m_ReconstructedWidth    = Width;
+    m_ReconstructedHeight   = Height;
+
     // Done...
     return true;
 }
@@ -693,15 +951,19 @@ bool ReconstructableImage::ReconstructGrayscaleImage(
     VicarImageBand &BestGrayscaleImageBand)
 {
     // Set file name for console messages to begin with...
-    Console::GetInstance().SetCurrentFileName(OutputFileName);
+    m_Context.GetConsole().SetCurrentFileName(OutputFileName);
 
     // Overwrite not enabled and file already existed, don't overwrite...
-    if(!Options::GetInstance().GetOverwrite() && 
-       (access(OutputFileName.c_str(), F_OK) == 0))
+    if(!m_Overwrite && 
+       m_OutputSink.Exists(OutputFileName))
         SetErrorAndReturnFalse(_("output already exists, not overwriting (use --overwrite to override)"));
 
-    // Extraction raw band data...
+    // Extraction raw band data, accounted for as long as it is held...
     VicarImageBand::RawBandDataType RawBandData;
+    MemoryTracker::Reservation RawReservation(
+        m_Context.GetMemoryTracker(),
+        MemoryTracker::RasterBuffers,
+        BestGrayscaleImageBand.GetTotalOriginalPixelSpace());
 
     // Get the raw band data and check for error...
     if(!BestGrayscaleImageBand.GetRawBandData(RawBandData))
@@ -711,34 +973,200 @@ bool ReconstructableImage::ReconstructGrayscaleImage(
     const int Width   = BestGrayscaleImageBand.GetTransformedWidth();
     const int Height  = BestGrayscaleImageBand.GetTransformedHeight();
 
-    // Allocate png storage...
-    png::image<png::gray_pixel> PngImage(Width, Height);
+    // Write out, if not a dry run...
+    if(!m_Context.GetOptions().GetDryRun())
+    {
+        // Prepare list of the single plane and the band it came from...
+        ImageEncoder::PlaneListType Planes;
+        Planes.push_back(&RawBandData);
+        PlaneBandListType PlaneBands;
+        PlaneBands.push_back(&BestGrayscaleImageBand);
+
+        // Encode...
+        if(!WriteImage(OutputFileName, Planes, PlaneBands, Width, Height))
+            return false;
+    }
+
+    // Remember its dimensions...
+    m_ReconstructedWidth    = Width;
+    m_ReconstructedHeight   = Height;
 
-    // Toggle interlacing, if user selected...
-    if(Options::GetInstance().GetInterlace())
-        PngImage.set_interlace_type(png::interlace_adam7);
-    else
-        PngImage.set_interlace_type(png::interlace_none);
+    // Done...
+    return true;
+}
 
-    // Pass raw image data through encoder, row by row...
-    for(size_t Y = 0; Y < PngImage.get_height(); ++Y)
+// Sort each band list from lowest to best quality. Note that this does not
+//  necessarily mean that the best image of each band list will form the best
+//  matching set, since the best of one band list might have a full histogram
+//  and another might not...
+void ReconstructableImage::SortImageBandLists()
+{
+    // Sort...
+    sort(m_RedImageBandList.begin(),        m_RedImageBandList.end());
+    sort(m_GreenImageBandList.begin(),      m_GreenImageBandList.end());
+    sort(m_BlueImageBandList.begin(),       m_BlueImageBandList.end());
+    sort(m_Infrared1ImageBandList.begin(),  m_Infrared1ImageBandList.end());
+    sort(m_Infrared2ImageBandList.begin(),  m_Infrared2ImageBandList.end());
+    sort(m_Infrared3ImageBandList.begin(),  m_Infrared3ImageBandList.end());
+    sort(m_GrayImageBandList.begin(),       m_GrayImageBandList.end());
+}
+
+// Write the given planes out in the selected output format, or set an error
+//  and return false...
+bool ReconstructableImage::WriteImage(
+    const string &OutputFileName,
+    const ImageEncoder::PlaneListType &Planes,
+    const PlaneBandListType &PlaneBands,
+    const size_t Width,
+    const size_t Height)
+{
+    // Time and trace encoding and handing the file to the output sink...
+    Profiler::Scope Scope(m_Context.GetProfiler(), OutputFileName, "encode_write");
+    Tracer::Span Span(m_Context.GetTracer(), "encode_write");
+    Span.SetArgument("file", OutputFileName);
+    Span.SetArgument("camera_event", m_CameraEventLabel);
+
+    // The encoded file is staged in memory until handed to the output sink,
+    //  so account for it at its uncompressed size, which bounds it...
+    const size_t StagingBytes = Width * Height * Planes.size();
+    MemoryTracker::Reservation StagingReservation(
+        m_Context.GetMemoryTracker(), MemoryTracker::EncoderStaging, StagingBytes);
+
+    // Encode straight out of the planes...
+    try
     {
-        // Pass raw image data through encoder, column by column...
-        for(size_t X = 0; X < PngImage.get_width(); ++X)
+        // Open the output file...
+        ostream &OutputFileStream = m_OutputSink.OpenFile(OutputFileName);
+
+        // Which format?
+        switch(m_Context.GetOptions().GetOutputFormat())
         {
-            // Get this pixel's grayscale value...
-            uint8_t GrayByte = RawBandData.at(Y).at(X);
+            // Binary PGM or PPM...
+            case Options::FormatPnm:
+            {
+                PnmEncoder Encoder(OutputFileStream);
+                Encoder.Encode(Planes, Width, Height);
+                break;
+            }
 
-            // Encode...
-            PngImage.set_pixel(X, Y, GrayByte);
+            // Raw planar...
+            case Options::FormatRaw:
+            {
+                RawEncoder Encoder(OutputFileStream);
+                Encoder.Encode(Planes, Width, Height);
+                break;
+            }
+
+            // Portable network graphics...
+            default:
+            {
+                // Encoding profile selected by the user, deflating on as many
+                //  threads as jobs if parallel deflate was requested...
+                PngEncoder::ProfileType Profile = m_Context.GetOptions().GetPngProfile();
+                Profile.m_ParallelDeflate   = m_Context.GetOptions().GetParallelDeflate();
+                Profile.m_Threads           = m_Context.GetOptions().GetJobs();
+
+                // Parallel deflate holds every compressed chunk at once as
+                //  well as the staged file, so deflate serially instead if
+                //  that would exceed the memory limit...
+                if(Profile.m_ParallelDeflate &&
+                   m_Context.GetMemoryTracker().WouldExceedLimit(StagingBytes))
+                {
+                    CONSOLE_MESSAGE(m_Context.GetConsole(), Console::Verbose)
+                        << _("memory limit reached, deflating serially")
+                        << endl;
+                    Profile.m_ParallelDeflate = false;
+                }
+
+                // Encode...
+                PngEncoder Encoder(OutputFileStream, m_Context.GetOptions().GetInterlace(), Profile);
+                Encoder.Encode(Planes, Width, Height);
+                break;
+            }
         }
+
+        // Finish the file...
+        m_OutputSink.CloseFile();
     }
-    
-    // Write out, if not a dry run...
-    if(!Options::GetInstance().GetDryRun())
-        PngImage.write(OutputFileName);
+
+        // Failed...
+        catch(const string &ErrorMessage)
+        {
+            // Don't leave a partial image behind...
+            m_OutputSink.AbortFile();
+            SetErrorAndReturnFalse(ErrorMessage);
+        }
+
+    // Raw planar images need a sidecar to make sense of them...
+    if(m_Context.GetOptions().GetOutputFormat() == Options::FormatRaw)
+        return WriteRawSidecar(OutputFileName, PlaneBands, Width, Height);
+
+    // Done...
+    return true;
+}
+
+// Write the sidecar describing the layout of a raw planar image, or set an
+//  error and return false...
+bool ReconstructableImage::WriteRawSidecar(
+    const string &OutputFileName,
+    const PlaneBandListType &PlaneBands,
+    const size_t Width,
+    const size_t Height)
+{
+    // Sidecar sits beside the image with its extension swapped...
+    const string SidecarFileName =
+        OutputFileName.substr(0, OutputFileName.find_last_of('.')) + ".hdr";
+
+    // Rotation applied to the bands, in degrees counterclockwise...
+    int Rotation = 0;
+    switch(PlaneBands.front()->GetRotation())
+    {
+        case VicarImageBand::Rotate90:  Rotation = 90;  break;
+        case VicarImageBand::Rotate180: Rotation = 180; break;
+        case VicarImageBand::Rotate270: Rotation = 270; break;
+        default:                        Rotation = 0;   break;
+    }
+
+    // Band type of each plane, in the order they were written...
+    string Bands;
+    for(PlaneBandListType::const_iterator Iterator = PlaneBands.begin();
+        Iterator != PlaneBands.end();
+      ++Iterator)
+        Bands += (Bands.empty() ? "" : " ") + (*Iterator)->GetDiodeBandTypeFriendlyString();
+
+    // Create the sidecar and describe the layout. Keys are not translated
+    //  since this is meant to be parsed by other tools...
+    try
+    {
+        ostream &SidecarFileStream = m_OutputSink.OpenFile(SidecarFileName);
+        SidecarFileStream
+            << "bands: " << Bands << "\n"
+            << "byte order: none\n"
+            << "data file: " << OutputFileName.substr(OutputFileName.find_last_of("/\\") + 1) << "\n"
+            << "height: " << Height << "\n"
+            << "interleave: planar\n"
+            << "planes: " << PlaneBands.size() << "\n"
+            << "rotation: " << Rotation << "\n"
+            << "sample bits: 8\n"
+            << "width: " << Width << "\n";
+        m_OutputSink.CloseFile();
+    }
+
+        // Failed...
+        catch(const string &)
+        {
+            m_OutputSink.AbortFile();
+            SetErrorAndReturnFalse(_("could not write raw image sidecar"));
+        }
 
     // Done...
     return true;
 }
 
+// Deconstructor...
+ReconstructableImage::~ReconstructableImage()
+{
+    // No longer holding the band descriptors...
+    m_Context.GetMemoryTracker().Release(MemoryTracker::BandDescriptors, m_BandDescriptorBytes);
+}
+
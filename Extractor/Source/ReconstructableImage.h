@@ -26,7 +26,10 @@
 // Includes...
 
     // Our headers...
-    #include "Options.h"
+    #include "ExtractionContext.h"
+    #include "ImageEncoder.h"
+    #include "MetadataCatalogue.h"
+    #include "OutputSink.h"
     #include "VicarImageBand.h"
 
     // System headers...
@@ -44,17 +47,46 @@
 // Reconstructable image...
 class ReconstructableImage
 {
+    // Public types...
+    public:
+
+        // What reconstructing would make out of the bands present...
+        typedef enum
+        {
+            // A colour image from red, green, and blue bands...
+            ReconstructColour,
+
+            // A grayscale image from the best grayscale band...
+            ReconstructGrayscale,
+
+            // Nothing, so every band is dumped as unreconstructable...
+            ReconstructNothing
+
+        }ReconstructionType;
+
     // Public methods...
     public:
 
-        // Constructor...
+        // Constructor takes the context of the extraction, the output root
+        //  directory, the label of the camera event, the sink to write output
+        //  files to, and the run's metadata catalogue if one is being
+        //  collected...
         ReconstructableImage(
+            const ExtractionContext &Context,
             const std::string &OutputRootDirectory, 
-            const std::string &CameraEventLabel);
+            const std::string &CameraEventLabel,
+            OutputSink &Sink,
+            MetadataCatalogue *Catalogue = NULL);
 
         // Add an image band...
         void AddImageBand(const VicarImageBand &ImageBand);
 
+        // Get the band type class... (e.g. Colour)
+        const std::string &GetBandTypeClass() const { return m_BandTypeClass; }
+
+        // Get the camera event label without the solar day...
+        const std::string &GetCameraEventNoSol() const { return m_CameraEventNoSol; }
+
         // If the image wasn't reconstructed successfully, this is the
         //  number of component images that were dumped...
         size_t GetDumpedImagesCount() const { return m_DumpedImagesCount; }
@@ -63,13 +95,41 @@ class ReconstructableImage
         const std::string &GetErrorMessage() const 
             { return m_ErrorMessage; }
 
+        // Get the full path to the image the last reconstruction wrote out,
+        //  or empty if it didn't, along with its dimensions...
+        const std::string &GetReconstructedFileName() const { return m_ReconstructedFileName; }
+        size_t GetReconstructedHeight() const { return m_ReconstructedHeight; }
+        size_t GetReconstructedWidth() const { return m_ReconstructedWidth; }
+
+        // Get what reconstructing would make out of the bands present...
+        ReconstructionType GetReconstructionType() const;
+
+        // Get the input files of every image band added...
+        void GetInputFiles(std::vector<std::string> &InputFiles) const;
+
+        // Get the solar day the image was taken on...
+        size_t GetSolarDay() const { return m_SolarDay; }
+
         // Was an error set?
         bool IsError() const
             { return !m_ErrorMessage.empty(); }
 
+        // Describe what reconstructing would do without reading any pixels,
+        //  being the candidate bands for each channel, best first, and the
+        //  outputs that would be written or dumped...
+        void Plan(std::ostream &PlanStream);
+
         // Extract the image out as a PNG, or return false if failed...
         bool Reconstruct();
 
+        // Replace output files that already exist even without --overwrite,
+        //  such as those an interrupted run left behind for this camera
+        //  event...
+        void SetOverwrite(const bool Overwrite = true) { m_Overwrite = Overwrite; }
+
+        // Deconstructor...
+       ~ReconstructableImage();
+
     // Protected types...
     protected:
 
@@ -79,6 +139,9 @@ class ReconstructableImage
         typedef ImageBandListType::const_iterator   ImageBandListConstIterator;
         typedef ImageBandListType::reverse_iterator ImageBandListReverseIterator;
 
+        // List of the image bands each plane of an output image came from...
+        typedef std::vector<const VicarImageBand *> PlaneBandListType;
+
     // Protected methods...
     protected:
 
@@ -107,11 +170,18 @@ class ReconstructableImage
             ImageBandListType &ImageBandList, 
             ImageBandListReverseIterator &ReverseIterator) const;
 
-        // Generate metadata for file...
+        // Generate metadata for an output image of the given kind made
+        //  from the given bands, either as a text file beside it or into the
+        //  run's catalogue...
         void GenerateMetadata(
-            const std::string &OutputFileName, 
+            const std::string &ImageFileName,
+            const std::string &Kind,
             const ImageBandListType &ImageBandList);
 
+        // Get the file name extension for an output image with the given
+        //  number of channels in the selected output format...
+        std::string GetImageExtension(const size_t Channels) const;
+
         // Reconstruct a colour image from requested image bands...
         bool ReconstructColourImage(
             const std::string &OutputFileName, 
@@ -128,12 +198,48 @@ class ReconstructableImage
         void SetErrorMessage(const std::string &ErrorMessage)
             { m_ErrorMessage = ErrorMessage; }
 
+        // Sort each band list from lowest to best quality...
+        void SortImageBandLists();
+
+        // Write the given planes out in the selected output format, or set an
+        //  error and return false...
+        bool WriteImage(
+            const std::string &OutputFileName,
+            const ImageEncoder::PlaneListType &Planes,
+            const PlaneBandListType &PlaneBands,
+            const size_t Width,
+            const size_t Height);
+
+        // Write the metadata of each of the given image bands out to a
+        //  stream...
+        void WriteMetadata(
+            std::ostream &OutputFileStream,
+            const ImageBandListType &ImageBandList) const;
+
+        // Write the sidecar describing the layout of a raw planar image, or
+        //  set an error and return false...
+        bool WriteRawSidecar(
+            const std::string &OutputFileName,
+            const PlaneBandListType &PlaneBands,
+            const size_t Width,
+            const size_t Height);
+
     // Protected data...
     protected:
 
+        // Context of the extraction the image belongs to...
+        const ExtractionContext &m_Context;
+
         // Root output directory...
         std::string         m_OutputRootDirectory;
 
+        // Sink output files are written to...
+        OutputSink         &m_OutputSink;
+
+        // Catalogue metadata is collected in, or NULL if written as text
+        //  files beside each image...
+        MetadataCatalogue  *m_MetadataCatalogue;
+
         // Image band lists for different colour and infrared types...
         ImageBandListType   m_RedImageBandList;
         ImageBandListType   m_GreenImageBandList;
@@ -142,6 +248,9 @@ class ReconstructableImage
         ImageBandListType   m_Infrared2ImageBandList;
         ImageBandListType   m_Infrared3ImageBandList;
         ImageBandListType   m_GrayImageBandList;
+
+        // Bytes the band descriptors held are accounted for with...
+        size_t              m_BandDescriptorBytes;
         
         // Camera event label and same thing without the solar day...
         const std::string   m_CameraEventLabel;
@@ -163,6 +272,15 @@ class ReconstructableImage
         // Month image was taken on... (e.g. Libra)
         std::string         m_Month;
 
+        // Replace output files that already exist...
+        bool                m_Overwrite;
+
+        // Full path to the image the last reconstruction wrote out, or empty
+        //  if it didn't, and its dimensions...
+        std::string         m_ReconstructedFileName;
+        size_t              m_ReconstructedHeight;
+        size_t              m_ReconstructedWidth;
+
         // Solar day the image was taken on...
         size_t              m_SolarDay;
 };
@@ -0,0 +1,217 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "ResidentCache.h"
+    #include "MediaEmulator.h"
+
+    // GNU OCRAD...
+    #include <ocradlib.h>
+
+    // System headers...
+    #include <sys/stat.h>
+
+// Using the standard namespace...
+using namespace std;
+
+// Default constructor...
+ResidentCache::ResidentCache()
+{
+
+}
+
+// Get the given zip archive open, opening it again if it changed since it was
+//  last opened, or NULL on error. The archive stays owned by the cache and
+//  must not be closed by the caller...
+ZZIP_DIR *ResidentCache::AcquireArchive(const string &ArchiveFile)
+{
+    // Only one caller at a time...
+    lock_guard<mutex> Lock(m_Mutex);
+
+    // Check what the archive looks like now...
+    struct stat FileAttributes;
+    if(stat(ArchiveFile.c_str(), &FileAttributes) != 0)
+        return NULL;
+
+    // Already open and unchanged since...
+    ArchiveMapType::iterator Iterator = m_Archives.find(ArchiveFile);
+    if(Iterator != m_Archives.end())
+    {
+        // Still current...
+        if(Iterator->second.m_Size == FileAttributes.st_size &&
+           Iterator->second.m_Modified == FileAttributes.st_mtime)
+            return Iterator->second.m_Descriptor;
+
+        // Changed, so retire it. Something might still be reading from it...
+        m_RetiredArchives.push_back(Iterator->second.m_Descriptor);
+        m_Archives.erase(Iterator);
+    }
+
+    // Open it, through emulated media if asked to...
+    ArchiveType Archive;
+    Archive.m_Descriptor = zzip_dir_open_ext_io(
+        ArchiveFile.c_str(), NULL, NULL, MediaEmulator::GetHandlers());
+    Archive.m_Size       = FileAttributes.st_size;
+    Archive.m_Modified   = FileAttributes.st_mtime;
+
+        // Failed...
+        if(!Archive.m_Descriptor)
+            return NULL;
+
+    // Keep it...
+    m_Archives[ArchiveFile] = Archive;
+    return Archive.m_Descriptor;
+}
+
+// Get an OCR descriptor from the pool, opening a new one if none are free, or
+//  NULL on error. Return it with ReleaseOCRDescriptor()...
+OCRAD_Descriptor *ResidentCache::AcquireOCRDescriptor()
+{
+    // Reuse a free one, if there is one...
+    {
+        lock_guard<mutex> Lock(m_Mutex);
+        if(!m_OCRDescriptors.empty())
+        {
+            OCRAD_Descriptor *Descriptor = m_OCRDescriptors.back();
+            m_OCRDescriptors.pop_back();
+            return Descriptor;
+        }
+    }
+
+    // Otherwise open a new one...
+    OCRAD_Descriptor *Descriptor = OCRAD_open();
+
+        // Failed...
+        if(OCRAD_get_errno(Descriptor) != OCRAD_ok)
+        {
+            OCRAD_close(Descriptor);
+            return NULL;
+        }
+
+    // Done...
+    return Descriptor;
+}
+
+// Close an OCR descriptor from OpenOCRDescriptor(), or return it to the pool
+//  if a daemon keeps one...
+void ResidentCache::CloseOCRDescriptor(OCRAD_Descriptor *Descriptor)
+{
+    // Pooled...
+    if(IsInstantiated())
+        GetInstance().ReleaseOCRDescriptor(Descriptor);
+
+    // Otherwise close it...
+    else
+        OCRAD_close(Descriptor);
+}
+
+// Get the band index kept in the given file, mapping it the first time. It
+//  stays owned by the cache...
+BandIndex &ResidentCache::GetBandIndex(const string &IndexFile)
+{
+    // Only one caller at a time...
+    lock_guard<mutex> Lock(m_Mutex);
+
+    // Map it the first time...
+    BandIndex *&Index = m_BandIndices[IndexFile];
+    if(!Index)
+        Index = new BandIndex(IndexFile);
+
+    // Done...
+    return *Index;
+}
+
+// Open an OCR descriptor, or take one from the pool if a daemon keeps one, or
+//  NULL on error...
+OCRAD_Descriptor *ResidentCache::OpenOCRDescriptor()
+{
+    // Pooled...
+    if(IsInstantiated())
+        return GetInstance().AcquireOCRDescriptor();
+
+    // Otherwise open one...
+    OCRAD_Descriptor *Descriptor = OCRAD_open();
+
+        // Failed...
+        if(OCRAD_get_errno(Descriptor) != OCRAD_ok)
+        {
+            OCRAD_close(Descriptor);
+            return NULL;
+        }
+
+    // Done...
+    return Descriptor;
+}
+
+// Return an OCR descriptor to the pool...
+void ResidentCache::ReleaseOCRDescriptor(OCRAD_Descriptor *Descriptor)
+{
+    lock_guard<mutex> Lock(m_Mutex);
+    m_OCRDescriptors.push_back(Descriptor);
+}
+
+// Close archives that were replaced because they changed. Only safe between
+//  jobs, when nothing read from them can still be open...
+void ResidentCache::Trim()
+{
+    // Only one caller at a time...
+    lock_guard<mutex> Lock(m_Mutex);
+
+    // Close each...
+    for(vector<ZZIP_DIR *>::iterator Iterator = m_RetiredArchives.begin();
+        Iterator != m_RetiredArchives.end();
+      ++Iterator)
+        zzip_dir_close(*Iterator);
+
+    // Forget them...
+    m_RetiredArchives.clear();
+}
+
+// Deconstructor...
+ResidentCache::~ResidentCache()
+{
+    // Close retired archives...
+    Trim();
+
+    // Close open archives...
+    for(ArchiveMapType::iterator Iterator = m_Archives.begin();
+        Iterator != m_Archives.end();
+      ++Iterator)
+        zzip_dir_close(Iterator->second.m_Descriptor);
+
+    // Unmap band indices...
+    for(BandIndexMapType::iterator Iterator = m_BandIndices.begin();
+        Iterator != m_BandIndices.end();
+      ++Iterator)
+        delete Iterator->second;
+
+    // Close OCR descriptors...
+    for(vector<OCRAD_Descriptor *>::iterator Iterator = m_OCRDescriptors.begin();
+        Iterator != m_OCRDescriptors.end();
+      ++Iterator)
+        OCRAD_close(*Iterator);
+}
+
@@ -0,0 +1,144 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _RESIDENT_CACHE_H_
+#define _RESIDENT_CACHE_H_
+
+// Includes...
+
+    // Our headers...
+    #include "BandIndex.h"
+    #include "ExplicitSingleton.h"
+
+    // zziplib...
+    #include <zzip/zzip.h>
+
+    // System headers...
+    #include <map>
+    #include <mutex>
+    #include <string>
+    #include <vector>
+    #include <clocale>
+    #include <sys/types.h>
+
+    // i18n...
+    #include "gettext.h"
+    #define _(str) gettext (str)
+    #define N_(str) gettext_noop (str)
+
+// GNU OCRAD descriptor...
+struct OCRAD_Descriptor;
+
+// Resources kept open between the jobs of a long lived daemon so each one
+//  doesn't pay to open them again. Archives stay open with their central
+//  directories already read, OCR descriptors are pooled, and band indices stay
+//  mapped. It only exists in daemon mode, so users check IsInstantiated() and
+//  otherwise open and close resources themselves as usual. The cache itself
+//  is safe to call from any thread, but the archives and band indices it
+//  hands out are shared by every caller rather than copied, which is only
+//  safe because the daemon runs one job at a time...
+class ResidentCache : public ExplicitSingleton<ResidentCache>
+{
+    // Because we are a singleton, only ExplicitSingleton can control our 
+    //  creation...
+    friend class ExplicitSingleton<ResidentCache>;
+
+    // Public methods...
+    public:
+
+        // Get the given zip archive open, opening it again if it changed
+        //  since it was last opened, or NULL on error. The archive stays
+        //  owned by the cache and must not be closed by the caller...
+        ZZIP_DIR *AcquireArchive(const std::string &ArchiveFile);
+
+        // Get an OCR descriptor from the pool, opening a new one if none are
+        //  free, or NULL on error. Return it with ReleaseOCRDescriptor()...
+        OCRAD_Descriptor *AcquireOCRDescriptor();
+
+        // Close an OCR descriptor from OpenOCRDescriptor(), or return it to
+        //  the pool if a daemon keeps one...
+        static void CloseOCRDescriptor(OCRAD_Descriptor *Descriptor);
+
+        // Get the band index kept in the given file, mapping it the first
+        //  time. It stays owned by the cache...
+        BandIndex &GetBandIndex(const std::string &IndexFile);
+
+        // Open an OCR descriptor, or take one from the pool if a daemon keeps
+        //  one, or NULL on error...
+        static OCRAD_Descriptor *OpenOCRDescriptor();
+
+        // Return an OCR descriptor to the pool...
+        void ReleaseOCRDescriptor(OCRAD_Descriptor *Descriptor);
+
+        // Close archives that were replaced because they changed. Only safe
+        //  between jobs, when nothing read from them can still be open...
+        void Trim();
+
+    // Private methods...
+    private:
+
+        // Default constructor...
+        ResidentCache();
+
+        // Deconstructor...
+       ~ResidentCache();
+
+    // Protected types...
+    protected:
+
+        // An open archive and the size and modification time it had when
+        //  opened...
+        struct ArchiveType
+        {
+            ZZIP_DIR           *m_Descriptor;
+            off_t               m_Size;
+            time_t              m_Modified;
+        };
+
+        // Open archives and band indices by file name...
+        typedef std::map<std::string, ArchiveType>  ArchiveMapType;
+        typedef std::map<std::string, BandIndex *>  BandIndexMapType;
+
+    // Protected data...
+    protected:
+
+        // Open archives...
+        ArchiveMapType      m_Archives;
+
+        // Mapped band indices...
+        BandIndexMapType    m_BandIndices;
+
+        // Guards the archives, band indices, and OCR descriptor pool...
+        std::mutex          m_Mutex;
+
+        // OCR descriptors not currently in use...
+        std::vector<OCRAD_Descriptor *>
+                            m_OCRDescriptors;
+
+        // Archives replaced because they changed, to be closed by Trim()...
+        std::vector<ZZIP_DIR *>
+                            m_RetiredArchives;
+};
+
+// Multiple include protection...
+#endif
+
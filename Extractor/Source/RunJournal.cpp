@@ -0,0 +1,575 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "Console.h"
+    #include "RunJournal.h"
+
+    // System headers...
+    #include <cerrno>
+    #include <cstdio>
+    #include <cstring>
+
+    // Compression API, for its CRC-32...
+    #include <zlib.h>
+
+    // POSIX headers...
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+
+// Using the standard namespace...
+using namespace std;
+
+// First line of every journal, naming its format and version...
+#define RUN_JOURNAL_SIGNATURE   "viking-extractor-journal"
+#define RUN_JOURNAL_VERSION     "2"
+
+// Number of fields encoding a band entry...
+#define RUN_JOURNAL_BAND_FIELDS 28
+
+// Constructor opens the journal at the given path, replaying what a previous
+//  run recorded in it if resuming or otherwise starting it afresh, or throws
+//  an error...
+RunJournal::RunJournal(
+    const string &JournalFile,
+    const bool Resume,
+    const OutputWriter::FsyncPolicyType FsyncPolicy)
+    : m_FileDescriptor(-1),
+      m_FsyncPolicy(FsyncPolicy),
+      m_JournalFile(JournalFile)
+{
+    // Open the journal, creating it if necessary, and emptying it unless
+    //  resuming...
+    m_FileDescriptor = open(
+        m_JournalFile.c_str(),
+        O_RDWR | O_CREAT | O_APPEND | (Resume ? 0 : O_TRUNC),
+        0666);
+
+        // Failed...
+        if(m_FileDescriptor < 0)
+            throw string(_("could not open run journal: ")) + m_JournalFile;
+
+    // Read back whatever a previous run left in it...
+    string Contents;
+    char Buffer[64 * 1024];
+    for(;;)
+    {
+        // Read a block...
+        const ssize_t Read = read(m_FileDescriptor, Buffer, sizeof(Buffer));
+
+        // Interrupted, try again...
+        if(Read < 0 && errno == EINTR)
+            continue;
+
+        // Failed...
+        if(Read < 0)
+        {
+            close(m_FileDescriptor);
+            throw string(_("could not read run journal: ")) + m_JournalFile;
+        }
+
+        // Done...
+        if(Read == 0)
+            break;
+
+        // Keep it...
+        Contents.append(Buffer, Read);
+    }
+
+    // Replay it, then cut off anything after the intact part so new records
+    //  don't run on from a line torn by a crash...
+    const size_t IntactLength = Replay(Contents);
+    if(IntactLength < Contents.size())
+    {
+        // Alert...
+        if(IntactLength == 0)
+            Message(Console::Warning)
+                << _("run journal is unreadable or from a different version, starting afresh")
+                << endl;
+        else
+            Message(Console::Warning)
+                << _("run journal was cut short, discarding its last ")
+                << Contents.size() - IntactLength
+                << _(" bytes")
+                << endl;
+
+        // Truncate...
+        if(ftruncate(m_FileDescriptor, IntactLength) != 0)
+        {
+            close(m_FileDescriptor);
+            throw string(_("could not repair run journal: ")) + m_JournalFile;
+        }
+    }
+
+    // A new journal begins with its signature...
+    if(IntactLength == 0)
+    {
+        // Fields...
+        FieldListType Fields;
+        Fields.push_back(RUN_JOURNAL_SIGNATURE);
+        Fields.push_back(RUN_JOURNAL_VERSION);
+
+        // Write, not leaking the journal if that fails...
+        try
+        {
+            Append(Fields);
+        }
+
+            // Failed...
+            catch(const string &)
+            {
+                close(m_FileDescriptor);
+                throw;
+            }
+    }
+}
+
+// Append a line of the given fields to the journal, or throw an error...
+void RunJournal::Append(const FieldListType &Fields)
+{
+    // Encode it...
+    const string Line = EncodeLine(Fields);
+
+    // Write it, in one go unless the kernel says otherwise...
+    const char *Data = Line.data();
+    size_t      Left = Line.size();
+    while(Left > 0)
+    {
+        // Write as much as will go...
+        const ssize_t Written = write(m_FileDescriptor, Data, Left);
+
+        // Interrupted, try again...
+        if(Written < 0 && errno == EINTR)
+            continue;
+
+        // Failed...
+        if(Written <= 0)
+            throw string(_("could not write to run journal: ")) + m_JournalFile;
+
+        // Advance...
+        Data += Written;
+        Left -= Written;
+    }
+
+    // Flush it to stable storage if the fsync policy asks for it...
+    if(m_FsyncPolicy != OutputWriter::FsyncNone && fsync(m_FileDescriptor) != 0)
+        throw string(_("could not flush run journal: ")) + m_JournalFile;
+}
+
+// Record what loading found in a band, or throw an error...
+void RunJournal::AppendBand(
+    const string &InputFile,
+    const BandIndex::EntryType &Entry)
+{
+    // Begin with the input file and its key...
+    FieldListType Fields;
+    Fields.push_back("band");
+    Fields.push_back(InputFile);
+    if(!AppendKey(InputFile, Fields))
+        return;
+
+    // Then everything loading found...
+    EncodeBand(Entry, Fields);
+
+    // Record...
+    Append(Fields);
+}
+
+// Record that a camera event's reconstruction has begun, or throw an error...
+void RunJournal::AppendBegin(const string &CameraEventLabel)
+{
+    // Record...
+    FieldListType Fields;
+    Fields.push_back("begin");
+    Fields.push_back(CameraEventLabel);
+    Append(Fields);
+}
+
+// Record that a camera event's reconstruction from the given input files has
+//  finished and its output is written, or throw an error...
+void RunJournal::AppendEnd(
+    const string &CameraEventLabel,
+    const vector<string> &InputFiles)
+{
+    // Begin with the label...
+    FieldListType Fields;
+    Fields.push_back("end");
+    Fields.push_back(CameraEventLabel);
+
+    // Then each input file and its key. One that can't be examined any
+    //  more is recorded as such, so the event is never considered finished...
+    for(vector<string>::const_iterator Iterator = InputFiles.begin();
+        Iterator != InputFiles.end();
+      ++Iterator)
+    {
+        Fields.push_back(*Iterator);
+        if(!AppendKey(*Iterator, Fields))
+        {
+            Fields.push_back("-");
+            Fields.push_back("-");
+        }
+    }
+
+    // Record...
+    Append(Fields);
+}
+
+// Append the size and modification time of the given input file as it is
+//  now, returning false if it couldn't be examined...
+bool RunJournal::AppendKey(const string &InputFile, FieldListType &Fields)
+{
+    // Examine it...
+    uint64_t    Size        = 0;
+    int64_t     Modified    = 0;
+    if(!BandIndex::GetKey(InputFile, Size, Modified))
+        return false;
+
+    // Append...
+    Fields.push_back(FormatField(Size));
+    Fields.push_back(FormatField(Modified));
+    return true;
+}
+
+// Decode the fields of a band entry starting at the given field, returning
+//  false if there aren't enough...
+bool RunJournal::DecodeBand(
+    const FieldListType &Fields,
+    const size_t First,
+    BandIndex::EntryType &Entry)
+{
+    // Check there are enough...
+    if(Fields.size() != First + RUN_JOURNAL_BAND_FIELDS)
+        return false;
+
+    // Decode in the order they were encoded...
+    FieldListType::const_iterator Field = Fields.begin() + First;
+    Entry.m_AxisPresent                     = ParseField<int>(*Field++) != 0;
+    Entry.m_AzimuthElevation                = *Field++;
+    Entry.m_Bands                           = ParseField<size_t>(*Field++);
+    Entry.m_BasicMetadataParserHeuristic    = ParseField<int>(*Field++);
+    Entry.m_BytesPerColour                  = ParseField<int>(*Field++);
+    Entry.m_CameraEventLabel                = *Field++;
+    Entry.m_CameraEventLabelNoSol           = *Field++;
+    Entry.m_DiodeBandType                   = ParseField<int>(*Field++);
+    Entry.m_DropoutRows                     = ParseField<size_t>(*Field++);
+    Entry.m_ErrorMessage                    = *Field++;
+    Entry.m_FileOrdinalOnMagneticTape       = ParseField<size_t>(*Field++);
+    Entry.m_FullHistogramPresent            = ParseField<int>(*Field++) != 0;
+    istringstream Histogram(*Field++);
+    for(size_t Bin = 0; Bin < BAND_STATISTICS_HISTOGRAM_BINS; ++Bin)
+        if(!(Histogram >> Entry.m_Histogram[Bin]))
+            return false;
+    Entry.m_LanderNumber                    = ParseField<size_t>(*Field++);
+    Entry.m_MagneticTapeNumber              = ParseField<size_t>(*Field++);
+    Entry.m_Mean                            = ParseField<float>(*Field++);
+    Entry.m_OCRBuffer                       = *Field++;
+    Entry.m_Ok                              = ParseField<int>(*Field++) != 0;
+    Entry.m_OriginalHeight                  = ParseField<size_t>(*Field++);
+    Entry.m_OriginalWidth                   = ParseField<size_t>(*Field++);
+    Entry.m_PhaseOffsetRequired             = ParseField<size_t>(*Field++);
+    Entry.m_PhysicalRecordPadding           = ParseField<size_t>(*Field++);
+    Entry.m_PhysicalRecordSize              = ParseField<size_t>(*Field++);
+    Entry.m_PixelFormat                     = static_cast<char>(ParseField<int>(*Field++));
+    Entry.m_RawImageOffset                  = ParseField<size_t>(*Field++);
+    Entry.m_Rotation                        = ParseField<int>(*Field++);
+    Entry.m_SolarDay                        = ParseField<size_t>(*Field++);
+    Entry.m_Variance                        = ParseField<double>(*Field++);
+
+    // Done...
+    return true;
+}
+
+// Decode a line without its terminating new line, returning false if it fails
+//  its check...
+bool RunJournal::DecodeLine(const string &Line, FieldListType &Fields)
+{
+    // Split off the check...
+    const size_t Separator = Line.find('\t');
+    if(Separator == string::npos)
+        return false;
+
+    // Verify it...
+    const string Payload = Line.substr(Separator + 1);
+    const uLong Crc32 = crc32(
+        crc32(0L, Z_NULL, 0),
+        reinterpret_cast<const Bytef *>(Payload.data()),
+        Payload.size());
+    char Expected[9];
+    snprintf(Expected, sizeof(Expected), "%08lx", Crc32 & 0xffffffffUL);
+    if(Line.compare(0, Separator, Expected) != 0)
+        return false;
+
+    // Split the fields, undoing their escaping...
+    Fields.assign(1, string());
+    for(size_t Index = 0; Index < Payload.size(); ++Index)
+    {
+        // Next field...
+        if(Payload[Index] == '\t')
+        {
+            Fields.push_back(string());
+            continue;
+        }
+
+        // Escaped character...
+        if(Payload[Index] == '\\' && Index + 1 < Payload.size())
+        {
+            switch(Payload[++Index])
+            {
+                case 'n': Fields.back() += '\n'; break;
+                case 'r': Fields.back() += '\r'; break;
+                case 't': Fields.back() += '\t'; break;
+                default:  Fields.back() += Payload[Index]; break;
+            }
+            continue;
+        }
+
+        // Anything else...
+        Fields.back() += Payload[Index];
+    }
+
+    // Done...
+    return true;
+}
+
+// Encode the fields of a band entry...
+void RunJournal::EncodeBand(const BandIndex::EntryType &Entry, FieldListType &Fields)
+{
+    // Encode in the order they are decoded...
+    Fields.push_back(FormatField<int>(Entry.m_AxisPresent));
+    Fields.push_back(Entry.m_AzimuthElevation);
+    Fields.push_back(FormatField(Entry.m_Bands));
+    Fields.push_back(FormatField(Entry.m_BasicMetadataParserHeuristic));
+    Fields.push_back(FormatField(Entry.m_BytesPerColour));
+    Fields.push_back(Entry.m_CameraEventLabel);
+    Fields.push_back(Entry.m_CameraEventLabelNoSol);
+    Fields.push_back(FormatField(Entry.m_DiodeBandType));
+    Fields.push_back(FormatField(Entry.m_DropoutRows));
+    Fields.push_back(Entry.m_ErrorMessage);
+    Fields.push_back(FormatField(Entry.m_FileOrdinalOnMagneticTape));
+    Fields.push_back(FormatField<int>(Entry.m_FullHistogramPresent));
+    ostringstream Histogram;
+    for(size_t Bin = 0; Bin < BAND_STATISTICS_HISTOGRAM_BINS; ++Bin)
+        Histogram << (Bin ? " " : "") << Entry.m_Histogram[Bin];
+    Fields.push_back(Histogram.str());
+    Fields.push_back(FormatField(Entry.m_LanderNumber));
+    Fields.push_back(FormatField(Entry.m_MagneticTapeNumber));
+    Fields.push_back(FormatField(Entry.m_Mean));
+    Fields.push_back(Entry.m_OCRBuffer);
+    Fields.push_back(FormatField<int>(Entry.m_Ok));
+    Fields.push_back(FormatField(Entry.m_OriginalHeight));
+    Fields.push_back(FormatField(Entry.m_OriginalWidth));
+    Fields.push_back(FormatField(Entry.m_PhaseOffsetRequired));
+    Fields.push_back(FormatField(Entry.m_PhysicalRecordPadding));
+    Fields.push_back(FormatField(Entry.m_PhysicalRecordSize));
+    Fields.push_back(FormatField<int>(Entry.m_PixelFormat));
+    Fields.push_back(FormatField(Entry.m_RawImageOffset));
+    Fields.push_back(FormatField(Entry.m_Rotation));
+    Fields.push_back(FormatField(Entry.m_SolarDay));
+    Fields.push_back(FormatField(Entry.m_Variance));
+}
+
+// Encode a line of the given fields, including its check and terminating new
+//  line...
+string RunJournal::EncodeLine(const FieldListType &Fields)
+{
+    // Join the fields, escaping anything that would split them...
+    string Payload;
+    for(FieldListType::const_iterator Field = Fields.begin();
+        Field != Fields.end();
+      ++Field)
+    {
+        // Separate from the previous one...
+        if(Field != Fields.begin())
+            Payload += '\t';
+
+        // Escape...
+        for(string::const_iterator Character = Field->begin();
+            Character != Field->end();
+          ++Character)
+        {
+            switch(*Character)
+            {
+                case '\\': Payload += "\\\\"; break;
+                case '\n': Payload += "\\n"; break;
+                case '\r': Payload += "\\r"; break;
+                case '\t': Payload += "\\t"; break;
+                default:   Payload += *Character; break;
+            }
+        }
+    }
+
+    // Precede it with its check...
+    const uLong Crc32 = crc32(
+        crc32(0L, Z_NULL, 0),
+        reinterpret_cast<const Bytef *>(Payload.data()),
+        Payload.size());
+    char Check[10];
+    snprintf(Check, sizeof(Check), "%08lx\t", Crc32 & 0xffffffffUL);
+
+    // Done...
+    return Check + Payload + '\n';
+}
+
+// Find what a previous run found loading the given input file, if it hasn't
+//  changed since, or return false...
+bool RunJournal::FindBand(const string &InputFile, BandIndex::EntryType &Entry) const
+{
+    // Look it up...
+    BandMapType::const_iterator Iterator = m_Bands.find(InputFile);
+    if(Iterator == m_Bands.end())
+        return false;
+
+    // Check the file hasn't changed since...
+    uint64_t    Size        = 0;
+    int64_t     Modified    = 0;
+    if(!BandIndex::GetKey(InputFile, Size, Modified) ||
+       Size != Iterator->second.m_KeySize ||
+       Modified != Iterator->second.m_KeyModified)
+        return false;
+
+    // Store for caller...
+    Entry = Iterator->second.m_Entry;
+    return true;
+}
+
+// Get the input files a previous run finished the given camera event with, if
+//  they are unchanged, or return false...
+bool RunJournal::GetFinishedInputFiles(
+    const string &CameraEventLabel,
+    vector<string> &InputFiles) const
+{
+    // Look it up...
+    FinishedMapType::const_iterator Iterator =
+        m_FinishedCameraEvents.find(CameraEventLabel);
+    if(Iterator == m_FinishedCameraEvents.end())
+        return false;
+
+    // Store for caller...
+    InputFiles = Iterator->second;
+    return true;
+}
+
+// Check whether the given key fields match the input file as it is now...
+bool RunJournal::IsKeyCurrent(
+    const string &InputFile,
+    const string &Size,
+    const string &Modified)
+{
+    // Examine it...
+    uint64_t    CurrentSize     = 0;
+    int64_t     CurrentModified = 0;
+    if(!BandIndex::GetKey(InputFile, CurrentSize, CurrentModified))
+        return false;
+
+    // Compare...
+    return (FormatField(CurrentSize) == Size &&
+            FormatField(CurrentModified) == Modified);
+}
+
+// Replay the records of the journal as a previous run left it, returning the
+//  length of the intact part of it...
+size_t RunJournal::Replay(const string &Contents)
+{
+    // Variables...
+    size_t          IntactLength = 0;
+    FieldListType   Fields;
+
+    // Each complete line in turn, until one fails its check...
+    for(size_t LineEnd = Contents.find('\n');
+        LineEnd != string::npos;
+        LineEnd = Contents.find('\n', IntactLength))
+    {
+        // Decode it...
+        if(!DecodeLine(Contents.substr(IntactLength, LineEnd - IntactLength), Fields))
+            break;
+
+        // The first must be the signature of this version, or the whole
+        //  thing is started afresh...
+        if(IntactLength == 0 &&
+           (Fields.size() != 2 ||
+            Fields[0] != RUN_JOURNAL_SIGNATURE ||
+            Fields[1] != RUN_JOURNAL_VERSION))
+            break;
+
+        // A band was loaded...
+        if(Fields[0] == "band" && Fields.size() >= 4)
+        {
+            JournaledBandType Band;
+            Band.m_KeySize      = ParseField<uint64_t>(Fields[2]);
+            Band.m_KeyModified  = ParseField<int64_t>(Fields[3]);
+            if(DecodeBand(Fields, 4, Band.m_Entry))
+                m_Bands[Fields[1]] = Band;
+        }
+
+        // A camera event was begun, so it's unfinished until it ends again...
+        else if(Fields[0] == "begin" && Fields.size() == 2)
+        {
+            m_StartedCameraEvents.insert(Fields[1]);
+            m_FinishedCameraEvents.erase(Fields[1]);
+        }
+
+        // A camera event finished, if its input files haven't changed since...
+        else if(Fields[0] == "end" && Fields.size() >= 2 && (Fields.size() - 2) % 3 == 0)
+        {
+            // Gather the input files, checking each...
+            vector<string>  InputFiles;
+            bool            Current = true;
+            for(size_t Field = 2; Field < Fields.size() && Current; Field += 3)
+            {
+                InputFiles.push_back(Fields[Field]);
+                Current = IsKeyCurrent(Fields[Field], Fields[Field + 1], Fields[Field + 2]);
+            }
+
+            // Remember it as finished, or forget any earlier time it was...
+            if(Current)
+                m_FinishedCameraEvents[Fields[1]] = InputFiles;
+            else
+                m_FinishedCameraEvents.erase(Fields[1]);
+        }
+
+        // Everything up to here is intact...
+        IntactLength = LineEnd + 1;
+    }
+
+    // Gather every input file of a finished camera event...
+    for(FinishedMapType::const_iterator Iterator = m_FinishedCameraEvents.begin();
+        Iterator != m_FinishedCameraEvents.end();
+      ++Iterator)
+        m_FinishedInputFiles.insert(Iterator->second.begin(), Iterator->second.end());
+
+    // Done...
+    return IntactLength;
+}
+
+// Deconstructor...
+RunJournal::~RunJournal()
+{
+    // Close the journal...
+    if(m_FileDescriptor >= 0)
+        close(m_FileDescriptor);
+}
+
@@ -0,0 +1,227 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _RUN_JOURNAL_H_
+#define _RUN_JOURNAL_H_
+
+// Includes...
+
+    // Our headers...
+    #include "BandIndex.h"
+    #include "OutputWriter.h"
+
+    // System headers...
+    #include <limits>
+    #include <map>
+    #include <set>
+    #include <sstream>
+    #include <string>
+    #include <vector>
+    #include <stdint.h>
+    #include <clocale>
+
+    // i18n...
+    #include "gettext.h"
+    #define _(str) gettext (str)
+    #define N_(str) gettext_noop (str)
+
+// Name of the journal within the output root directory...
+#define RUN_JOURNAL_FILE_NAME               ".viking-extractor.journal"
+
+// Number of finished camera events to hold back before waiting for their
+//  output to be written and journaling them together, so the background
+//  writer isn't drained after every one...
+#define RUN_JOURNAL_CHECKPOINT_EVENTS       16
+
+// Append only journal of a run's progress, kept in the output directory so an
+//  interrupted run can be resumed. Every band loaded from its file and every
+//  camera event begun and finished is appended as a line of tab separated
+//  fields, preceded by a CRC-32 of them, in a single write. A line torn by a
+//  crash fails its check and is cut off when the journal is reopened. A
+//  finished camera event records the size and modification time of each of
+//  its input files, and is only considered finished so long as they are all
+//  unchanged...
+class RunJournal
+{
+    // Public methods...
+    public:
+
+        // Constructor opens the journal at the given path, replaying what a
+        //  previous run recorded in it if resuming or otherwise starting it
+        //  afresh, or throws an error...
+        RunJournal(
+            const std::string &JournalFile,
+            const bool Resume,
+            const OutputWriter::FsyncPolicyType FsyncPolicy);
+
+        // Record what loading found in a band, or throw an error...
+        void AppendBand(
+            const std::string &InputFile,
+            const BandIndex::EntryType &Entry);
+
+        // Record that a camera event's reconstruction has begun, or throw an
+        //  error...
+        void AppendBegin(const std::string &CameraEventLabel);
+
+        // Record that a camera event's reconstruction from the given input
+        //  files has finished and its output is written, or throw an
+        //  error...
+        void AppendEnd(
+            const std::string &CameraEventLabel,
+            const std::vector<std::string> &InputFiles);
+
+        // Find what a previous run found loading the given input file, if it
+        //  hasn't changed since, or return false...
+        bool FindBand(
+            const std::string &InputFile,
+            BandIndex::EntryType &Entry) const;
+
+        // Get the number of camera events a previous run finished whose
+        //  input files are unchanged...
+        size_t GetFinishedCameraEvents() const { return m_FinishedCameraEvents.size(); }
+
+        // Get the input files a previous run finished the given camera event
+        //  with, if they are unchanged, or return false...
+        bool GetFinishedInputFiles(
+            const std::string &CameraEventLabel,
+            std::vector<std::string> &InputFiles) const;
+
+        // Check if the given input file belongs to a camera event a previous
+        //  run finished whose input files are unchanged...
+        bool IsFinishedInputFile(const std::string &InputFile) const
+            { return (m_FinishedInputFiles.find(InputFile) != m_FinishedInputFiles.end()); }
+
+        // Check if a previous run began the given camera event, finished or
+        //  not, so whatever output it left behind is its own to replace...
+        bool IsStarted(const std::string &CameraEventLabel) const
+            { return (m_StartedCameraEvents.find(CameraEventLabel) != m_StartedCameraEvents.end()); }
+
+        // Deconstructor...
+       ~RunJournal();
+
+    // Protected types...
+    protected:
+
+        // A journaled band along with the key of its input file...
+        struct JournaledBandType
+        {
+            BandIndex::EntryType    m_Entry;
+            uint64_t                m_KeySize;
+            int64_t                 m_KeyModified;
+        };
+
+        // Journaled bands by input file name...
+        typedef std::map<std::string, JournaledBandType> BandMapType;
+
+        // Input files of finished camera events by label...
+        typedef std::map<std::string, std::vector<std::string> > FinishedMapType;
+
+        // Fields of a journal line...
+        typedef std::vector<std::string> FieldListType;
+
+    // Protected methods...
+    protected:
+
+        // Append a line of the given fields to the journal, or throw an
+        //  error...
+        void Append(const FieldListType &Fields);
+
+        // Decode the fields of a band entry starting at the given field,
+        //  returning false if there aren't enough...
+        static bool DecodeBand(
+            const FieldListType &Fields,
+            const size_t First,
+            BandIndex::EntryType &Entry);
+
+        // Encode the fields of a band entry...
+        static void EncodeBand(
+            const BandIndex::EntryType &Entry,
+            FieldListType &Fields);
+
+        // Encode a line of the given fields, including its check and
+        //  terminating new line...
+        static std::string EncodeLine(const FieldListType &Fields);
+
+        // Decode a line without its terminating new line, returning false if
+        //  it fails its check...
+        static bool DecodeLine(const std::string &Line, FieldListType &Fields);
+
+        // Append the size and modification time of the given input file as
+        //  it is now, returning false if it couldn't be examined...
+        static bool AppendKey(const std::string &InputFile, FieldListType &Fields);
+
+        // Format a number as a field...
+        template<typename T> static std::string FormatField(const T &Value)
+        {
+            std::ostringstream Stream;
+            Stream.precision(std::numeric_limits<T>::max_digits10);
+            Stream << Value;
+            return Stream.str();
+        }
+
+        // Parse a number out of a field, or zero if it isn't one...
+        template<typename T> static T ParseField(const std::string &Field)
+        {
+            std::istringstream Stream(Field);
+            T Value = T();
+            Stream >> Value;
+            return Value;
+        }
+
+        // Check whether the given key fields match the input file as it is
+        //  now...
+        static bool IsKeyCurrent(
+            const std::string &InputFile,
+            const std::string &Size,
+            const std::string &Modified);
+
+        // Replay the records of the journal as a previous run left it,
+        //  returning the length of the intact part of it...
+        size_t Replay(const std::string &Contents);
+
+    // Protected data...
+    protected:
+
+        // Bands previous runs loaded...
+        BandMapType             m_Bands;
+
+        // Journal's file descriptor...
+        int                     m_FileDescriptor;
+
+        // Camera events previous runs finished whose input files are
+        //  unchanged, and all of those input files...
+        FinishedMapType         m_FinishedCameraEvents;
+        std::set<std::string>   m_FinishedInputFiles;
+
+        // When to flush journal lines to stable storage...
+        OutputWriter::FsyncPolicyType m_FsyncPolicy;
+
+        // Journal file name...
+        std::string             m_JournalFile;
+
+        // Camera events previous runs began...
+        std::set<std::string>   m_StartedCameraEvents;
+};
+
+// Multiple include protection...
+#endif
+
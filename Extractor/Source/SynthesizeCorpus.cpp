@@ -0,0 +1,190 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "SyntheticCorpus.h"
+
+    // Standard C++ / POSIX system headers...
+    #include <cassert>
+    #include <iostream>
+    #include <string>
+    #include <cstdlib>
+    #include <getopt.h>
+
+// Using the standard namespace...
+using namespace std;
+
+// Show help...
+static void ShowHelp()
+{
+    cout <<   "Usage: viking-synthesize-corpus [options] output\n"
+         <<   "      --events=count\n"
+         << _("\
+                              Number of camera events to generate (default\n\
+                              100).\n")
+         <<   "      --files-per-tape=count\n"
+         << _("\
+                              Image bands on each magnetic tape before the next\n\
+                              is started, between 1 and 999 (default 64).\n")
+         <<   "      --help\n"
+         << _("\
+                              Show this help.\n")
+         <<   "      --maximum-size=pixels\n"
+         << _("\
+                              Largest width or height of an image band, no more\n\
+                              than 9999 (default 1024).\n")
+         <<   "      --minimum-size=pixels\n"
+         << _("\
+                              Smallest width or height of an image band, no\n\
+                              less than 64 (default 128).\n")
+         <<   "      --seed=number\n"
+         << _("\
+                              Seed the same corpus is always generated from\n\
+                              (default 1).\n")
+         <<   "      --zipped=percent\n"
+         << _("\
+                              Chance of each tape being written as a zip\n\
+                              archive rather than a directory of loose files\n\
+                              (default 25).\n\n")
+
+         << _("\
+Generates a corpus of synthetic Viking Lander VICAR image bands into the\n\
+'output' directory for benchmarking viking-extractor against, along with a\n\
+manifest.txt of the orientation and overlays of each band for\n\
+viking-benchmark-orientation.\n");
+}
+
+// Enumerator of long command line option identifiers...
+enum option_long_enum
+{
+    option_long_events = 256, /* To ensure no clashes with short option char identifiers */
+    option_long_files_per_tape,
+    option_long_help,
+    option_long_maximum_size,
+    option_long_minimum_size,
+    option_long_seed,
+    option_long_zipped
+};
+
+// Command line option structure...
+static option CommandLineLongOptions[] =
+{
+    {"events",                  required_argument,  NULL,   option_long_events},
+    {"files-per-tape",          required_argument,  NULL,   option_long_files_per_tape},
+    {"help",                    no_argument,        NULL,   option_long_help},
+    {"maximum-size",            required_argument,  NULL,   option_long_maximum_size},
+    {"minimum-size",            required_argument,  NULL,   option_long_minimum_size},
+    {"seed",                    required_argument,  NULL,   option_long_seed},
+    {"zipped",                  required_argument,  NULL,   option_long_zipped},
+
+    // End of array marker...
+    {0, 0, 0, 0}
+};
+
+// Entry point...
+int main(int ArgumentCount, char *Arguments[])
+{
+    // Variables...
+    SyntheticCorpus::ParametersType Parameters;
+    int OptionCharacter = '\x0';
+    int OptionIndex     = 0;
+
+    // Keep processing each option until there are none left...
+    while((OptionCharacter = getopt_long(
+        ArgumentCount, Arguments, "", CommandLineLongOptions, &OptionIndex)) != -1)
+    {
+        // Which option?
+        switch(OptionCharacter)
+        {
+            // Number of camera events...
+            case option_long_events:
+            { assert(optarg); Parameters.m_CameraEvents = atoi(optarg); break; }
+
+            // Files per tape...
+            case option_long_files_per_tape:
+            { assert(optarg); Parameters.m_FilesPerTape = atoi(optarg); break; }
+
+            // Help...
+            case option_long_help: { ShowHelp(); exit(EXIT_SUCCESS); }
+
+            // Range of dimensions...
+            case option_long_maximum_size:
+            { assert(optarg); Parameters.m_MaximumDimension = atoi(optarg); break; }
+            case option_long_minimum_size:
+            { assert(optarg); Parameters.m_MinimumDimension = atoi(optarg); break; }
+
+            // Seed...
+            case option_long_seed:
+            { assert(optarg); Parameters.m_Seed = strtoul(optarg, NULL, 10); break; }
+
+            // Chance of zipping...
+            case option_long_zipped:
+            { assert(optarg); Parameters.m_ZippedPercent = atoi(optarg); break; }
+
+            // get_opt_long already dumped an error message...
+            default:
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    // Exactly one output directory is needed...
+    if(optind + 1 != ArgumentCount)
+    {
+        ShowHelp();
+        exit(EXIT_FAILURE);
+    }
+
+    // Generate...
+    try
+    {
+        // Output directory should end with a path separator...
+        string OutputDirectory = Arguments[optind];
+        if(OutputDirectory.at(OutputDirectory.length() - 1) != '/')
+            OutputDirectory += '/';
+
+        // Generate the whole corpus...
+        SyntheticCorpus Corpus(OutputDirectory, Parameters);
+        Corpus.Generate();
+
+        // Summarize...
+        cout << _("generated ") << Corpus.GetBandsWritten()
+             << _(" image bands of ") << Parameters.m_CameraEvents
+             << _(" camera events on ") << Corpus.GetTapesWritten()
+             << _(" tapes (") << Corpus.GetBytesWritten() << _(" bytes)") << endl;
+    }
+
+        // Failed...
+        catch(const string &Reason)
+        {
+            // Alert user and abort...
+            cerr << Reason << endl;
+            exit(EXIT_FAILURE);
+        }
+
+    // Done...
+    return EXIT_SUCCESS;
+}
+
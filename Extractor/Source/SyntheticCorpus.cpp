@@ -0,0 +1,805 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "SyntheticCorpus.h"
+    #include "LogicalRecord.h"
+    #include "Miscellaneous.h"
+
+    // System headers...
+    #include <algorithm>
+    #include <cassert>
+    #include <cstring>
+    #include <iomanip>
+    #include <sstream>
+
+// Using the standard namespace...
+using namespace std;
+
+// Characters the overlay font has glyphs for, in the order of its table...
+static const char FontCharacters[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789/.-";
+
+// Glyph width, height, and advance in pixels before scaling...
+#define FONT_GLYPH_WIDTH    5
+#define FONT_GLYPH_HEIGHT   7
+#define FONT_GLYPH_ADVANCE  6
+
+// Overlay font, one byte per row of each glyph with the leftmost pixel in the
+//  fifth bit...
+static const uint8_t FontGlyphs[][FONT_GLYPH_HEIGHT] =
+{
+    { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, /* A */
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, /* B */
+    { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E }, /* C */
+    { 0x1E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x1E }, /* D */
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F }, /* E */
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 }, /* F */
+    { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F }, /* G */
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, /* H */
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, /* I */
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, /* J */
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, /* K */
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, /* L */
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 }, /* M */
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, /* N */
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, /* O */
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, /* P */
+    { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D }, /* Q */
+    { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 }, /* R */
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, /* S */
+    { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, /* T */
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, /* U */
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, /* V */
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A }, /* W */
+    { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, /* X */
+    { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 }, /* Y */
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, /* Z */
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, /* 0 */
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E }, /* 1 */
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F }, /* 2 */
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E }, /* 3 */
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 }, /* 4 */
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E }, /* 5 */
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E }, /* 6 */
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, /* 7 */
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, /* 8 */
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, /* 9 */
+    { 0x01, 0x01, 0x02, 0x04, 0x08, 0x10, 0x10 }, /* / */
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, /* . */
+    { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }  /* - */
+};
+
+// Diode tokens of a colour triplet and of the bands reconstructed as
+//  grayscale...
+static const char *ColourDiodes[]       = { "RED/T", "GRN/T", "BLU/T" };
+static const char *GrayscaleDiodes[]    = { "SURV", "BB1", "BB2", "BB3", "BB4" };
+
+// Get the number of decimal digits of a value...
+static size_t CountDigits(size_t Value)
+{
+    // Count each...
+    size_t Digits = 1;
+    while(Value >= 10)
+    {
+        Value /= 10;
+        ++Digits;
+    }
+
+    // Done...
+    return Digits;
+}
+
+// Constructor takes the directory to generate the corpus into and what to
+//  generate, or throws an error if it isn't sensible...
+SyntheticCorpus::SyntheticCorpus(
+    const string &OutputDirectory,
+    const ParametersType &Parameters)
+    : m_ArchiveSink(NULL),
+      m_BandsWritten(0),
+      m_BytesWritten(0),
+      m_FileSink(OutputDirectory, 1, OutputWriter::FsyncNone),
+      m_FileOrdinal(0),
+      m_NextHeaderFormat(0),
+      m_OutputDirectory(OutputDirectory),
+      m_Parameters(Parameters),
+      m_RandomState(Parameters.m_Seed ^ 0x9E3779B9),
+      m_Tape(0)
+{
+    // Check parameters...
+
+        // Nothing to generate...
+        if(m_Parameters.m_CameraEvents == 0)
+            throw string(_("at least one camera event is required"));
+
+        // Files are numbered with three digits on each tape...
+        if(m_Parameters.m_FilesPerTape == 0 || m_Parameters.m_FilesPerTape > 999)
+            throw string(_("files per tape must be between 1 and 999"));
+
+        // Bands must be big enough for the extractor not to skip them, yet
+        //  have dimensions of no more than four digits...
+        if(m_Parameters.m_MinimumDimension < 64 ||
+           m_Parameters.m_MaximumDimension > 9999 ||
+           m_Parameters.m_MinimumDimension > m_Parameters.m_MaximumDimension)
+            throw string(_("image band dimensions must be between 64 and 9999 pixels"));
+
+        // Chance of zipping...
+        if(m_Parameters.m_ZippedPercent > 100)
+            throw string(_("zipped percentage cannot exceed 100"));
+
+    // A xorshift generator never leaves zero once there...
+    if(m_RandomState == 0)
+        m_RandomState = 1;
+
+    // Create the output directory...
+    if(!CreateDirectoryRecursively(m_OutputDirectory))
+        throw string(_("could not create output directory"));
+
+    // Begin the manifest, explaining its columns...
+    m_Manifest.open((m_OutputDirectory + SYNTHETIC_CORPUS_MANIFEST).c_str());
+    if(!m_Manifest)
+        throw string(_("could not create manifest"));
+    m_Manifest
+        << "# Image bands the extractor examines visually, relative to this file." << endl
+        << "#  Columns are the path, counterclockwise rotation in degrees needed to" << endl
+        << "#  make it upright, and whether a large histogram and an axis are" << endl
+        << "#  present..." << endl;
+}
+
+// Compose the text of the header record for the given layout...
+string SyntheticCorpus::ComposeHeader(
+    const HeaderFormatType HeaderFormat,
+    const size_t Height,
+    const size_t Width)
+{
+    // Compose, spaced as the examples VicarImageBand::ParseBasicMetadata
+    //  documents...
+    stringstream Header;
+    switch(HeaderFormat)
+    {
+        case HeaderFormat1:
+            Header << "1   1" << Height << " " << Width << " I 1";
+            break;
+
+        case HeaderFormat1Spaced:
+            Header << "1   1 " << Height << "  " << Width << " I 1";
+            break;
+
+        case HeaderFormat2:
+            Header << "1   1 " << Height << Width << " I 1";
+            break;
+
+        case HeaderFormat2Joined:
+            Header << "1   1" << Height << Width << " L 1";
+            break;
+
+        case HeaderFormat3:
+            Header << Height << "     " << Width << Height << " " << Width << " L 1";
+            break;
+
+        case HeaderFormat4:
+            Header << Height << "     " << Width << " " << Height << " " << Width << " I 1";
+            break;
+
+        case HeaderFormat5:
+            Header << Height << "    " << Width << " " << Height << Width << " I 1";
+            break;
+
+        case HeaderFormat6:
+            Header << Height << "    " << Width << Height << Width << " L 1";
+            break;
+
+        default:
+            assert(false);
+    }
+
+    // Done...
+    return Header.str();
+}
+
+// Compose the text of every label record of a band, header first...
+void SyntheticCorpus::ComposeLabels(
+    const BandType &Band,
+    vector<string> &Labels) const
+{
+    // Variables...
+    stringstream Label;
+
+    // Start with the basic metadata header...
+    Labels.clear();
+    Labels.push_back(ComposeHeader(Band.m_HeaderFormat, Band.m_Height, Band.m_Width));
+
+    // Lander and camera event label, always in the second record...
+    Label.str(string());
+    Label << "VIKING LANDER " << Band.m_Lander
+          << "      CAMERA " << Band.m_Camera
+          << "              CE LABEL " << Band.m_CameraEventLabel;
+    Labels.push_back(Label.str());
+
+    // Diode, within the first physical record...
+    Label.str(string());
+    Label << "DIODE  " << left << setw(6) << Band.m_Diode
+          << "        STEP SIZE 0.12        CHANNEL/MODE  2/1";
+    Labels.push_back(Label.str());
+
+    // Directional vector...
+    Labels.push_back("AZIMUTH 115.0/135.0  ELEVATION -30(-60.66/  0.66)");
+
+    // The rest of the telemetry the extractor only saves...
+    Labels.push_back("OFFSET  1  GAIN 3    SCAN RATE 16K         DCS ACTIVE");
+    Labels.push_back("DATA RATE     0      PSA TEMP -29C(16)     DATA PATH RT/UH");
+    Label.str(string());
+    Label << "AVE DN VALUE  " << static_cast<size_t>(Band.m_Brightness)
+          << "      STAND DEV  31.23      RANGE  20 TO 240";
+    Labels.push_back(Label.str());
+
+    // Processing history, varying where the last label falls...
+    for(size_t Index = 0; Index < Band.m_HistoryLabels; ++Index)
+    {
+        Label.str(string());
+        Label << "RADCAM HISTORY " << Index + 1;
+        Labels.push_back(Label.str());
+    }
+
+    // Catalogue entry closes the labels...
+    Labels.push_back("LABCAT");
+}
+
+// Draw text into a band with its top left corner at the given position,
+//  clipping whatever doesn't fit...
+void SyntheticCorpus::DrawText(
+    vector<uint8_t> &Pixels,
+    const size_t Width,
+    const size_t Height,
+    const size_t Left,
+    const size_t Top,
+    const size_t Scale,
+    const string &Text)
+{
+    // Draw each character...
+    for(size_t Index = 0; Index < Text.length(); ++Index)
+    {
+        // Find its glyph, leaving a gap for any without one...
+        const char *Character = strchr(FontCharacters, Text[Index]);
+        if(!Character || Text[Index] == '\x0')
+            continue;
+        const uint8_t *Glyph = FontGlyphs[Character - FontCharacters];
+
+        // Set each of its pixels, scaled...
+        const size_t GlyphLeft = Left + Index * FONT_GLYPH_ADVANCE * Scale;
+        for(size_t Y = 0; Y < FONT_GLYPH_HEIGHT * Scale; ++Y)
+        {
+            for(size_t X = 0; X < FONT_GLYPH_WIDTH * Scale; ++X)
+            {
+                // Clipped...
+                if(GlyphLeft + X >= Width || Top + Y >= Height)
+                    continue;
+
+                // Set...
+                if(Glyph[Y / Scale] & (0x10 >> (X / Scale)))
+                    Pixels[(Top + Y) * Width + GlyphLeft + X] = 0xff;
+            }
+        }
+    }
+}
+
+// Encode a band's labels, padding, and pixels as a VICAR file...
+void SyntheticCorpus::EncodeBand(
+    const BandType &Band,
+    const vector<uint8_t> &Pixels,
+    string &Encoded) const
+{
+    // Variables...
+    vector<string> Labels;
+
+    // Compose the labels...
+    ComposeLabels(Band, Labels);
+
+    // Physical records are as wide as the band, or five logical records
+    //  if narrower, with the difference padded out...
+    const size_t PhysicalRecordPadding =
+        (Band.m_Width > 5 * LOGICAL_RECORD_SIZE) ? Band.m_Width - 5 * LOGICAL_RECORD_SIZE : 0;
+
+    // Begin with the VAX/VMS prefix, if any...
+    Encoded.assign(Band.m_PhaseOffset, '\x0');
+
+    // Encode each label as a logical record...
+    for(size_t Index = 0; Index < Labels.size(); ++Index)
+    {
+        // Crossed into the next physical record, so pad out the previous one
+        //  unless the boundary is tangential...
+        if(Index > 0 && (Index % 5) == 0 && !Band.m_Tangential)
+            Encoded.append(PhysicalRecordPadding, '\x0');
+
+        // Blank record, the first beginning with the magnetic tape marker...
+        string Record(LOGICAL_RECORD_SIZE, LogicalRecord::AsciiToEbcdic(' '));
+        size_t Column = 0;
+        if(Index == 0)
+        {
+            Record[0] = '\x0';
+            Record[1] = '\x1';
+            Column = 2;
+        }
+
+        // Fill in the text, leaving the last two bytes for the sentinel...
+        const string &Label = Labels.at(Index);
+        for(size_t Character = 0;
+            Character < Label.length() && Column < LOGICAL_RECORD_SIZE - 2;
+          ++Character, ++Column)
+            Record[Column] = LogicalRecord::AsciiToEbcdic(Label[Character]);
+
+        // Mark whether more labels follow...
+        Record[LOGICAL_RECORD_SIZE - 1] = LogicalRecord::AsciiToEbcdic(
+            (Index + 1 == Labels.size()) ? 'L' : 'C');
+
+        // Append...
+        Encoded += Record;
+    }
+
+    // The remaining logical records of the final physical record and its
+    //  padding are always present, tangential or not...
+    const size_t RemainingRecords = (5 - (Labels.size() % 5)) % 5;
+    Encoded.append(
+        RemainingRecords * LOGICAL_RECORD_SIZE + PhysicalRecordPadding, '\x0');
+
+    // Then the raw band data...
+    Encoded.append(Pixels.begin(), Pixels.end());
+}
+
+// Generate the whole corpus, or throw an error...
+void SyntheticCorpus::Generate()
+{
+    // Generate each camera event...
+    for(size_t CameraEvent = 0; CameraEvent < m_Parameters.m_CameraEvents; ++CameraEvent)
+        GenerateCameraEvent(CameraEvent);
+
+    // Finish the last tape if it was zipped...
+    if(m_ArchiveSink)
+    {
+        m_ArchiveSink->Close();
+        delete m_ArchiveSink;
+        m_ArchiveSink = NULL;
+    }
+
+    // Wait for every loose file to be written...
+    m_FileSink.Close();
+
+    // Make sure the whole manifest made it out...
+    m_Manifest.close();
+    if(m_Manifest.fail())
+        throw string(_("could not write manifest"));
+}
+
+// Generate every image band of the given camera event, or throw an error...
+void SyntheticCorpus::GenerateCameraEvent(const size_t CameraEvent)
+{
+    // Variables...
+    BandType        Band;
+    stringstream    CameraEventLabel;
+
+    // Every band of the event shares its scene...
+    const uint32_t SceneSeed = Random();
+
+    // Alternate landers and cameras...
+    Band.m_Lander = 1 + (CameraEvent % 2);
+    Band.m_Camera = 1 + ((CameraEvent / 2) % 2);
+
+    // Compose a label unique to the event, such as 12A045/017...
+    CameraEventLabel
+        << Band.m_Lander << Band.m_Camera
+        << static_cast<char>('A' + (CameraEvent / 1000) % 26)
+        << setfill('0') << setw(3) << (CameraEvent % 1000)
+        << '/' << setw(3) << (1 + (CameraEvent / 26000) % 999);
+    Band.m_CameraEventLabel = CameraEventLabel.str();
+
+    // Every band of the event has the same dimensions...
+    Band.m_Height   = RandomBetween(m_Parameters.m_MinimumDimension, m_Parameters.m_MaximumDimension);
+    Band.m_Width    = RandomBetween(m_Parameters.m_MinimumDimension, m_Parameters.m_MaximumDimension);
+
+    // Pick the diodes. Most events are colour triplets, the rest a single
+    //  band reconstructed as grayscale...
+    vector<string> Diodes;
+    const bool Colour = (Random() % 4) != 0;
+    if(Colour)
+        Diodes.assign(ColourDiodes, ColourDiodes + 3);
+    else
+        Diodes.push_back(GrayscaleDiodes[Random() % 5]);
+
+    // Colour bands all carry the same overlay so they can be matched into a
+    //  set. The extractor doesn't examine grayscale bands for one...
+    const OverlayType Overlay =
+        Colour ? static_cast<OverlayType>(Random() % 3) : OverlayNone;
+
+    // Overlays are sometimes stored turned on their side or upside down,
+    //  the same way for the whole set...
+    const size_t QuarterTurns = (Overlay != OverlayNone) ? Random() % 4 : 0;
+
+    // Sometimes the event was transmitted a second time without an overlay...
+    const size_t Variants = (Random() % 3 == 0) ? 2 : 1;
+
+    // Generate each band of each variant...
+    for(size_t Variant = 0; Variant < Variants; ++Variant)
+    {
+        for(size_t Diode = 0; Diode < Diodes.size(); ++Diode)
+        {
+            // Diode, overlay, and orientation...
+            Band.m_Diode        = Diodes.at(Diode);
+            Band.m_Overlay      = (Variant == 0) ? Overlay : OverlayNone;
+            Band.m_QuarterTurns = (Variant == 0) ? QuarterTurns : 0;
+
+            // Each band is somewhat brighter or darker than the others...
+            Band.m_Brightness = static_cast<uint8_t>(RandomBetween(24, 96));
+
+            // Use the next header layout that can express the dimensions,
+            //  which at least the first always can...
+            do
+            {
+                Band.m_HeaderFormat = static_cast<HeaderFormatType>(m_NextHeaderFormat);
+                m_NextHeaderFormat = (m_NextHeaderFormat + 1) % HeaderFormats;
+            }
+            while(!IsHeaderFormatCompatible(Band.m_HeaderFormat, Band.m_Height, Band.m_Width));
+
+            // Vary how the records are laid out. Padding shorter than a
+            //  logical record can't be told apart from a tangential boundary
+            //  by the extractor whenever the label it runs into happens to
+            //  end in a sentinel, so those are always left tangential...
+            const size_t PhysicalRecordPadding =
+                (Band.m_Width > 5 * LOGICAL_RECORD_SIZE) ? Band.m_Width - 5 * LOGICAL_RECORD_SIZE : 0;
+            Band.m_HistoryLabels    = Random() % 12;
+            Band.m_PhaseOffset      = Random() % 4;
+            Band.m_Tangential       =
+                (PhysicalRecordPadding > 0 && PhysicalRecordPadding < LOGICAL_RECORD_SIZE) ||
+                (Random() % 2 == 0);
+
+            // Write it...
+            WriteBand(Band, SceneSeed);
+        }
+    }
+}
+
+// Check whether a header layout can express the given dimensions
+//  unambiguously...
+bool SyntheticCorpus::IsHeaderFormatCompatible(
+    const HeaderFormatType HeaderFormat,
+    const size_t Height,
+    const size_t Width)
+{
+    // Count the digits of each...
+    const size_t HeightDigits   = CountDigits(Height);
+    const size_t WidthDigits    = CountDigits(Width);
+    const size_t JoinedDigits   = HeightDigits + WidthDigits;
+
+    // Check...
+    switch(HeaderFormat)
+    {
+        // Height and width are separate tokens...
+        case HeaderFormat1:
+        case HeaderFormat1Spaced:
+            return (HeightDigits <= 4 && WidthDigits <= 4);
+
+        // Joined height and width are split in half, with the height getting
+        //  the shorter half, and must be too long to pass for a height alone
+        //  when a token of their own...
+        case HeaderFormat2:
+            return (JoinedDigits > 4 && JoinedDigits <= 8 && JoinedDigits / 2 == HeightDigits);
+        case HeaderFormat2Joined:
+            return (JoinedDigits <= 8 && JoinedDigits / 2 == HeightDigits);
+
+        // Joined width and height must be too long to pass for a width...
+        case HeaderFormat3:
+            return (JoinedDigits > 4 && JoinedDigits <= 8);
+
+        // Each must be two to four digits...
+        case HeaderFormat4:
+        case HeaderFormat5:
+        case HeaderFormat6:
+            return (HeightDigits >= 2 && HeightDigits <= 4 &&
+                    WidthDigits >= 2 && WidthDigits <= 4);
+
+        // Unknown...
+        default:
+            return false;
+    }
+}
+
+// Get the next pseudorandom number...
+uint32_t SyntheticCorpus::Random()
+{
+    // Marsaglia's xorshift, so the corpus is the same on every platform...
+    m_RandomState ^= m_RandomState << 13;
+    m_RandomState ^= m_RandomState >> 17;
+    m_RandomState ^= m_RandomState << 5;
+    return m_RandomState;
+}
+
+// Get the next pseudorandom number within the given inclusive range...
+size_t SyntheticCorpus::RandomBetween(const size_t Minimum, const size_t Maximum)
+{
+    // Check...
+    assert(Minimum <= Maximum);
+
+    // Scale...
+    return Minimum + (Random() % (Maximum - Minimum + 1));
+}
+
+// Render a band's pixels from the scene seed shared by its camera event, along
+//  with its overlay...
+void SyntheticCorpus::RenderPixels(
+    const BandType &Band,
+    const uint32_t SceneSeed,
+    vector<uint8_t> &Pixels)
+{
+    // Dimensions of the upright image, swapped if it will be stored on its
+    //  side...
+    const bool Sideways = (Band.m_QuarterTurns % 2) != 0;
+    size_t Height       = Sideways ? Band.m_Width : Band.m_Height;
+    size_t Width        = Sideways ? Band.m_Height : Band.m_Width;
+
+    // Render the scene. Sky above the horizon is brighter than the terrain
+    //  beneath it, and every band adds noise of its own...
+    Pixels.resize(Height * Width);
+    const size_t Horizon = Height / 4 + (SceneSeed % (Height / 4));
+    for(size_t Y = 0; Y < Height; ++Y)
+    {
+        for(size_t X = 0; X < Width; ++X)
+        {
+            const size_t Terrain    = (X * 5 + Y * 3 + ((X ^ Y ^ SceneSeed) & 0x1f)) & 0x3f;
+            const size_t Sky        = (Y < Horizon) ? 0x40 : 0;
+            const size_t Value      = Band.m_Brightness + Terrain + Sky + (Random() & 0x0f);
+            Pixels[Y * Width + X]   = static_cast<uint8_t>(min<size_t>(Value, 0xff));
+        }
+    }
+
+    // Sometimes a few scanlines dropped out during transmission...
+    if(Random() % 4 == 0)
+    {
+        const size_t First = RandomBetween(Height / 3, (Height / 3) * 2);
+        const size_t Last  = min(Height, First + RandomBetween(1, 3));
+        fill(Pixels.begin() + First * Width, Pixels.begin() + Last * Width, 0);
+    }
+
+    // Scale overlay text up on larger bands...
+    const size_t Scale          = (Width >= 480 && Height >= 480) ? 2 : 1;
+    const size_t LineHeight     = (FONT_GLYPH_HEIGHT + 2) * Scale;
+    stringstream Text;
+
+    // Burn in the overlay...
+    switch(Band.m_Overlay)
+    {
+        // Azimuth axis along the bottom, with its caption upright...
+        case OverlayAxis:
+        {
+            // Blank the strip beneath the axis...
+            const size_t Top = Height - 2 * LineHeight - 4 * Scale;
+            fill(Pixels.begin() + Top * Width, Pixels.end(), 0);
+
+            // Draw the axis and its tick marks...
+            fill(Pixels.begin() + Top * Width, Pixels.begin() + (Top + 1) * Width, 0xff);
+            for(size_t X = 0; X < Width; X += 32)
+                for(size_t Y = Top; Y < Top + 3 * Scale; ++Y)
+                    Pixels[Y * Width + X] = 0xff;
+
+            // Caption it...
+            Text << "CAMERA " << Band.m_Camera << "  SCAN LINE  AZ 115";
+            DrawText(Pixels, Width, Height, 2 * Scale, Top + LineHeight, Scale, Text.str());
+            break;
+        }
+
+        // Large histogram down the left side, with its annotation upright
+        //  when the image itself is rotated...
+        case OverlayHistogram:
+        {
+            // Blank the strip...
+            const size_t StripWidth = min(Width / 2, 20 * FONT_GLYPH_ADVANCE * Scale + 4 * Scale);
+            for(size_t Y = 0; Y < Height; ++Y)
+                fill(Pixels.begin() + Y * Width, Pixels.begin() + Y * Width + StripWidth, 0);
+
+            // Annotate it...
+            const string Lines[] =
+            {
+                "VIKING LANDER " + string(1, static_cast<char>('0' + Band.m_Lander)),
+                "DIODE " + Band.m_Diode,
+                "CE LABEL " + Band.m_CameraEventLabel
+            };
+            for(size_t Line = 0; Line < 3; ++Line)
+                DrawText(Pixels, Width, Height, 2 * Scale, (1 + Line) * LineHeight, Scale, Lines[Line]);
+
+            // Draw the histogram beneath the annotation as a ragged bell of
+            //  bars...
+            const size_t Top = 5 * LineHeight;
+            if(Top >= Height || StripWidth <= 4)
+                break;
+            const size_t Span   = Height - Top;
+            const size_t Centre = Span / 2;
+            for(size_t Y = 0; Y < Span; ++Y)
+            {
+                const size_t Distance   = (Y > Centre) ? Y - Centre : Centre - Y;
+                const size_t Bell       = (StripWidth - 4) * (Centre + 1 - min(Distance, Centre)) / (Centre + 1);
+                const size_t Length     = Bell - min(Bell, static_cast<size_t>(Random() % 16));
+                fill(Pixels.begin() + (Top + Y) * Width + 2,
+                     Pixels.begin() + (Top + Y) * Width + 2 + Length, 0xff);
+            }
+            break;
+        }
+
+        // Vanilla image...
+        default:
+            break;
+    }
+
+    // Turn it the way it is stored, leaving it with the stored dimensions...
+    for(size_t Turn = 0; Turn < Band.m_QuarterTurns; ++Turn)
+        RotateClockwise(Pixels, Width, Height);
+    assert(Width == Band.m_Width && Height == Band.m_Height);
+}
+
+// Rotate pixels a quarter turn clockwise, swapping the dimensions...
+void SyntheticCorpus::RotateClockwise(
+    vector<uint8_t> &Pixels,
+    size_t &Width,
+    size_t &Height)
+{
+    // Each row becomes a column, the top row the rightmost...
+    vector<uint8_t> Rotated(Pixels.size());
+    for(size_t Y = 0; Y < Height; ++Y)
+        for(size_t X = 0; X < Width; ++X)
+            Rotated[X * Height + (Height - 1 - Y)] = Pixels[Y * Width + X];
+
+    // Store for caller...
+    Pixels.swap(Rotated);
+    swap(Width, Height);
+}
+
+// Finish the current tape, if any, and begin the next one, or throw an
+//  error...
+void SyntheticCorpus::StartTape()
+{
+    // Finish the current tape if it was zipped...
+    if(m_ArchiveSink)
+    {
+        m_ArchiveSink->Close();
+        delete m_ArchiveSink;
+        m_ArchiveSink = NULL;
+    }
+
+    // Tapes are numbered with four digits...
+    if(m_Tape == 9999)
+        throw string(_("too many tapes, use more files per tape"));
+
+    // Begin the next tape...
+    ++m_Tape;
+    m_FileOrdinal = 0;
+
+    // Name it...
+    stringstream TapeName;
+    TapeName << "tape_" << setfill('0') << setw(4) << m_Tape;
+
+    // Either zip it...
+    if(RandomBetween(1, 100) <= m_Parameters.m_ZippedPercent)
+    {
+        m_ArchiveSink = new ArchiveOutputSink(
+            m_OutputDirectory,
+            m_OutputDirectory + TapeName.str() + ".zip",
+            ArchiveOutputSink::FormatZip,
+            true,
+            OutputWriter::FsyncNone);
+    }
+
+    // Or leave it as a directory of loose files...
+    else
+        m_FileSink.PrepareDirectory(m_OutputDirectory + TapeName.str() + "/");
+}
+
+// Write a band as the next file on the current tape, or throw an error...
+void SyntheticCorpus::WriteBand(const BandType &Band, const uint32_t SceneSeed)
+{
+    // Variables...
+    vector<uint8_t> Pixels;
+    string          Encoded;
+    stringstream    FileName;
+
+    // Move on to the next tape once this one is full...
+    if(m_Tape == 0 || m_FileOrdinal == m_Parameters.m_FilesPerTape)
+        StartTape();
+    ++m_FileOrdinal;
+
+    // Render and encode...
+    RenderPixels(Band, SceneSeed, Pixels);
+    EncodeBand(Band, Pixels, Encoded);
+
+    // Name it after the tape and its position on it...
+    FileName << "vl_" << setfill('0') << setw(4) << m_Tape
+             << '.' << setw(3) << m_FileOrdinal;
+
+    // Archive members are flat, loose files go in the tape's directory...
+    OutputSink &Sink = m_ArchiveSink ?
+        static_cast<OutputSink &>(*m_ArchiveSink) : static_cast<OutputSink &>(m_FileSink);
+    stringstream TapeName;
+    TapeName << "tape_" << setfill('0') << setw(4) << m_Tape;
+    const string Path =
+        m_OutputDirectory + (m_ArchiveSink ? "" : TapeName.str() + "/") + FileName.str();
+
+    // Write it...
+    ostream &Stream = Sink.OpenFile(Path);
+    Stream.write(Encoded.data(), Encoded.size());
+    Sink.CloseFile();
+
+    // Record it in the manifest, archive members in the form the extractor
+    //  opens them by...
+    WriteManifestEntry(
+        Band,
+        TapeName.str() + (m_ArchiveSink ? ".zip:/" : "/") + FileName.str());
+
+    // Count it...
+    ++m_BandsWritten;
+    m_BytesWritten += Encoded.size();
+}
+
+// Record the orientation and overlays the extractor should find in a band it
+//  examines visually in the manifest, or throw an error...
+void SyntheticCorpus::WriteManifestEntry(const BandType &Band, const string &Path)
+{
+    // Only colour bands are examined...
+    if(count(ColourDiodes, ColourDiodes + 3, Band.m_Diode) == 0)
+        return;
+
+    // Expected rotation and overlays...
+    size_t  Rotation    = 0;
+    bool    Histogram   = false;
+    bool    Axis        = false;
+    switch(Band.m_Overlay)
+    {
+        // The axis caption reads upright once turned back...
+        case OverlayAxis:
+            Rotation    = Band.m_QuarterTurns * 90;
+            Axis        = true;
+            break;
+
+        // The histogram annotation reads upright a quarter turn short of the
+        //  image being upright, and the extractor counts it as an axis too...
+        case OverlayHistogram:
+            Rotation    = ((Band.m_QuarterTurns + 1) % 4) * 90;
+            Histogram   = true;
+            Axis        = true;
+            break;
+
+        // Nothing to find...
+        default:
+            break;
+    }
+
+    // Write it...
+    m_Manifest << Path << " " << Rotation << " " << Histogram << " " << Axis << endl;
+    if(!m_Manifest)
+        throw string(_("could not write manifest"));
+}
+
+// Deconstructor...
+SyntheticCorpus::~SyntheticCorpus()
+{
+    // Finish the last tape if it was zipped and still open...
+    delete m_ArchiveSink;
+}
+
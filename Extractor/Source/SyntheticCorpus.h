@@ -0,0 +1,296 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _SYNTHETIC_CORPUS_H_
+#define _SYNTHETIC_CORPUS_H_
+
+// Includes...
+
+    // Our headers...
+    #include "ArchiveOutputSink.h"
+    #include "FileOutputSink.h"
+
+    // System headers...
+    #include <fstream>
+    #include <string>
+    #include <vector>
+    #include <stdint.h>
+    #include <clocale>
+
+    // i18n...
+    #include "gettext.h"
+    #define _(str) gettext (str)
+    #define N_(str) gettext_noop (str)
+
+// Name of the manifest written into the top of the corpus...
+#define SYNTHETIC_CORPUS_MANIFEST "manifest.txt"
+
+// Generates a corpus of synthetic Viking Lander VICAR image bands to benchmark
+//  the extractor against, deterministically from a seed. Bands are grouped
+//  into magnetic tapes, each written either as a directory of loose files or
+//  as a single zip archive, and exercise every header layout the extractor
+//  recognizes, phase offsets, physical record padding and tangential
+//  boundaries, and colour triplets with and without overlays, some of them
+//  stored rotated. A manifest of the orientation and overlays the extractor
+//  should find in each band it examines visually is written alongside...
+class SyntheticCorpus
+{
+    // Public types...
+    public:
+
+        // What to generate...
+        struct ParametersType
+        {
+            // Constructor initializer picks a corpus that takes a few
+            //  seconds to extract...
+            ParametersType()
+                : m_CameraEvents(100),
+                  m_FilesPerTape(64),
+                  m_MaximumDimension(1024),
+                  m_MinimumDimension(128),
+                  m_Seed(1),
+                  m_ZippedPercent(25)
+            { }
+
+            // Number of camera events...
+            size_t              m_CameraEvents;
+
+            // Image bands written to each tape before starting the next...
+            size_t              m_FilesPerTape;
+
+            // Inclusive range of image band widths and heights...
+            size_t              m_MaximumDimension;
+            size_t              m_MinimumDimension;
+
+            // Pseudorandom number generator seed...
+            uint32_t            m_Seed;
+
+            // Chance of each tape being zipped rather than left loose...
+            size_t              m_ZippedPercent;
+        };
+
+    // Public methods...
+    public:
+
+        // Constructor takes the directory to generate the corpus into and
+        //  what to generate, or throws an error if it isn't sensible...
+        SyntheticCorpus(
+            const std::string &OutputDirectory,
+            const ParametersType &Parameters);
+
+        // Generate the whole corpus, or throw an error...
+        void Generate();
+
+        // Get the number of image bands and bytes written, and tapes they
+        //  were written to...
+        size_t GetBandsWritten() const { return m_BandsWritten; }
+        uint64_t GetBytesWritten() const { return m_BytesWritten; }
+        size_t GetTapesWritten() const { return m_Tape; }
+
+        // Deconstructor...
+       ~SyntheticCorpus();
+
+    // Protected types...
+    protected:
+
+        // Basic metadata header layouts, one for each token arrangement
+        //  VicarImageBand::ParseBasicMetadata distinguishes...
+        typedef enum
+        {
+            HeaderFormat1,          /* "1 1HHHH WWWW I 1" */
+            HeaderFormat1Spaced,    /* "1 1 HHHH WWWW I 1" */
+            HeaderFormat2,          /* "1 1 HHHHWWWW I 1" */
+            HeaderFormat2Joined,    /* "1 1HHHHWWWW L 1" */
+            HeaderFormat3,          /* "HHHH WWWWHHHH WWWW L 1" */
+            HeaderFormat4,          /* "HHHH WWWW HHHH WWWW I 1" */
+            HeaderFormat5,          /* "HHHH WWWW HHHHWWWW I 1" */
+            HeaderFormat6,          /* "HHHH WWWWHHHHWWWW L 1" */
+            HeaderFormats
+        }HeaderFormatType;
+
+        // Annotation burnt into the pixels...
+        typedef enum
+        {
+            OverlayNone,
+            OverlayAxis,
+            OverlayHistogram
+        }OverlayType;
+
+        // Everything needed to compose an image band...
+        struct BandType
+        {
+            // Mean pixel value the band is rendered around...
+            uint8_t             m_Brightness;
+
+            // Camera and lander the event was captured by...
+            size_t              m_Camera;
+            size_t              m_Lander;
+
+            // Camera event label, such as 12A045/017...
+            std::string         m_CameraEventLabel;
+
+            // VICAR diode token, such as RED/T...
+            std::string         m_Diode;
+
+            // Dimensions...
+            size_t              m_Height;
+            size_t              m_Width;
+
+            // Number of additional history labels after the required ones...
+            size_t              m_HistoryLabels;
+
+            // Header layout...
+            HeaderFormatType    m_HeaderFormat;
+
+            // Annotation...
+            OverlayType         m_Overlay;
+
+            // Bytes of VAX/VMS prefix before the first record...
+            size_t              m_PhaseOffset;
+
+            // Quarter turns clockwise the upright image was stored at, its
+            //  stored dimensions being the ones above...
+            size_t              m_QuarterTurns;
+
+            // Physical records aren't padded out to their full size...
+            bool                m_Tangential;
+        };
+
+    // Protected methods...
+    protected:
+
+        // Compose the text of the header record for the given layout...
+        static std::string ComposeHeader(
+            const HeaderFormatType HeaderFormat,
+            const size_t Height,
+            const size_t Width);
+
+        // Compose the text of every label record of a band, header first...
+        void ComposeLabels(
+            const BandType &Band,
+            std::vector<std::string> &Labels) const;
+
+        // Draw text into a band with its top left corner at the given
+        //  position, clipping whatever doesn't fit...
+        static void DrawText(
+            std::vector<uint8_t> &Pixels,
+            const size_t Width,
+            const size_t Height,
+            const size_t Left,
+            const size_t Top,
+            const size_t Scale,
+            const std::string &Text);
+
+        // Encode a band's labels, padding, and pixels as a VICAR file...
+        void EncodeBand(
+            const BandType &Band,
+            const std::vector<uint8_t> &Pixels,
+            std::string &Encoded) const;
+
+        // Generate every image band of the given camera event, or throw an
+        //  error...
+        void GenerateCameraEvent(const size_t CameraEvent);
+
+        // Check whether a header layout can express the given dimensions
+        //  unambiguously...
+        static bool IsHeaderFormatCompatible(
+            const HeaderFormatType HeaderFormat,
+            const size_t Height,
+            const size_t Width);
+
+        // Get the next pseudorandom number, or one within the given inclusive
+        //  range...
+        uint32_t Random();
+        size_t RandomBetween(const size_t Minimum, const size_t Maximum);
+
+        // Render a band's pixels from the scene seed shared by its camera
+        //  event, along with its overlay...
+        void RenderPixels(
+            const BandType &Band,
+            const uint32_t SceneSeed,
+            std::vector<uint8_t> &Pixels);
+
+        // Rotate pixels a quarter turn clockwise, swapping the dimensions...
+        static void RotateClockwise(
+            std::vector<uint8_t> &Pixels,
+            size_t &Width,
+            size_t &Height);
+
+        // Finish the current tape, if any, and begin the next one, or throw
+        //  an error...
+        void StartTape();
+
+        // Write a band as the next file on the current tape, or throw an
+        //  error...
+        void WriteBand(const BandType &Band, const uint32_t SceneSeed);
+
+        // Record the orientation and overlays the extractor should find in a
+        //  band it examines visually in the manifest, or throw an error...
+        void WriteManifestEntry(const BandType &Band, const std::string &Path);
+
+    // Protected data...
+    protected:
+
+        // Sink of the current tape if it is zipped...
+        ArchiveOutputSink  *m_ArchiveSink;
+
+        // Image bands and bytes written so far...
+        size_t              m_BandsWritten;
+        uint64_t            m_BytesWritten;
+
+        // Sink every loose tape is written through...
+        FileOutputSink      m_FileSink;
+
+        // Ordinal of the last file written to the current tape...
+        size_t              m_FileOrdinal;
+
+        // Ground truth of every band examined visually, for
+        //  viking-benchmark-orientation...
+        std::ofstream       m_Manifest;
+
+        // Next header layout to use...
+        size_t              m_NextHeaderFormat;
+
+        // Directory the corpus is generated into, ending with a separator...
+        std::string         m_OutputDirectory;
+
+        // What to generate...
+        ParametersType      m_Parameters;
+
+        // Pseudorandom number generator state...
+        uint32_t            m_RandomState;
+
+        // Number of the current tape, or zero before the first...
+        size_t              m_Tape;
+
+    // Private methods...
+    private:
+
+        // Forbid copy constructor and assignment, since the archive sink of
+        //  the current tape is ours...
+        SyntheticCorpus(const SyntheticCorpus &);
+        SyntheticCorpus &operator=(const SyntheticCorpus &);
+};
+
+// Multiple include protection...
+#endif
+
@@ -0,0 +1,168 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Includes...
+
+    // Provided by Autoconf...
+    #include <config.h>
+
+    // Our headers...
+    #include "Tracer.h"
+    #include "Miscellaneous.h"
+
+    // System headers...
+    #include <fstream>
+    #include <iomanip>
+
+    // POSIX headers...
+    #include <unistd.h>
+
+// Using the standard namespace...
+using namespace std;
+
+// Constructor starts the span...
+Tracer::Span::Span(Tracer *TargetTracer, const char *Name)
+    : m_Name(Name),
+      m_Tracer(TargetTracer)
+{
+    // Start the clock, if tracing...
+    if(m_Tracer)
+        m_Start = chrono::steady_clock::now();
+}
+
+// End the span before going out of scope...
+void Tracer::Span::End()
+{
+    // Not tracing or already ended...
+    if(!m_Tracer)
+        return;
+
+    // Record it and don't again...
+    m_Tracer->Record(m_Name, m_Start, chrono::steady_clock::now(), m_Arguments);
+    m_Tracer = NULL;
+}
+
+// Add an argument to show with the span...
+void Tracer::Span::SetArgument(const char *Name, const string &Value)
+{
+    // Only if tracing...
+    if(m_Tracer)
+        m_Arguments.push_back(make_pair(string(Name), Value));
+}
+
+// Deconstructor ends the span, unless already ended...
+Tracer::Span::~Span()
+{
+    // End it...
+    End();
+}
+
+// Default constructor starts the clock all spans are relative to...
+Tracer::Tracer()
+    : m_Origin(chrono::steady_clock::now())
+{
+
+}
+
+// Record a span that ran on the calling thread...
+void Tracer::Record(
+    const char *Name,
+    const chrono::steady_clock::time_point &Start,
+    const chrono::steady_clock::time_point &End,
+    const ArgumentListType &Arguments)
+{
+    // Lock the spans...
+    lock_guard<mutex> Lock(m_Mutex);
+
+    // Number the calling thread if it hasn't recorded anything before...
+    map<thread::id, size_t>::const_iterator Thread = 
+        m_Threads.insert(make_pair(this_thread::get_id(), m_Threads.size() + 1)).first;
+
+    // Add it...
+    m_Events.push_back(EventType());
+    EventType &Event = m_Events.back();
+    Event.m_Arguments   = Arguments;
+    Event.m_Duration    = chrono::duration<double, micro>(End - Start).count();
+    Event.m_Name        = Name;
+    Event.m_Start       = chrono::duration<double, micro>(Start - m_Origin).count();
+    Event.m_Thread      = Thread->second;
+}
+
+// Write every span recorded as trace event JSON, or throw an error...
+void Tracer::WriteJson(const string &FileName) const
+{
+    // Create the file...
+    ofstream Stream(FileName.c_str(), ios::out | ios::trunc);
+    if(!Stream.is_open())
+        throw string(_("could not create trace: ")) + FileName;
+    Stream << fixed << setprecision(3);
+
+    // Lock the spans...
+    lock_guard<mutex> Lock(m_Mutex);
+
+    // Name each thread after the order it was first seen in...
+    const pid_t ProcessID = getpid();
+    Stream << "{\"traceEvents\":[\n";
+    for(map<thread::id, size_t>::const_iterator Iterator = m_Threads.begin();
+        Iterator != m_Threads.end();
+      ++Iterator)
+        Stream
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << ProcessID
+            << ",\"tid\":" << Iterator->second
+            << ",\"args\":{\"name\":\"thread " << Iterator->second << "\"}},\n";
+
+    // Each span as a complete event...
+    for(vector<EventType>::const_iterator Iterator = m_Events.begin();
+        Iterator != m_Events.end();
+      ++Iterator)
+    {
+        // The span...
+        Stream
+            << "{\"name\":\"" << EscapeJson(Iterator->m_Name)
+            << "\",\"cat\":\"extraction\",\"ph\":\"X\",\"ts\":" << Iterator->m_Start
+            << ",\"dur\":" << Iterator->m_Duration
+            << ",\"pid\":" << ProcessID
+            << ",\"tid\":" << Iterator->m_Thread
+            << ",\"args\":{";
+
+        // Its arguments...
+        for(ArgumentListType::const_iterator Argument = Iterator->m_Arguments.begin();
+            Argument != Iterator->m_Arguments.end();
+          ++Argument)
+            Stream
+                << ((Argument == Iterator->m_Arguments.begin()) ? "" : ",")
+                << "\"" << EscapeJson(Argument->first) << "\":\""
+                << EscapeJson(Argument->second) << "\"";
+        Stream << "}},\n";
+    }
+
+    // The process itself, which also saves worrying about the last comma...
+    Stream
+        << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << ProcessID
+        << ",\"args\":{\"name\":\"viking-extractor\"}}\n"
+        << "],\"displayTimeUnit\":\"ms\"}\n";
+
+    // Check for error...
+    Stream.flush();
+    if(!Stream.good())
+        throw string(_("could not write trace: ")) + FileName;
+}
+
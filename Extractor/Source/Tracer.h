@@ -0,0 +1,152 @@
+/*
+    VikingExtractor, to recover images from Viking Lander operations.
+    Copyright (C) 2010-2018 Cartesian Theatre™ <info@cartesiantheatre.com>.
+
+    Public discussion on IRC available at #avaneya (irc.freenode.net)
+    or on the mailing list <avaneya@lists.avaneya.com>.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Multiple include protection...
+#ifndef _TRACER_H_
+#define _TRACER_H_
+
+// Includes...
+
+    // System headers...
+    #include <chrono>
+    #include <cstddef>
+    #include <map>
+    #include <mutex>
+    #include <string>
+    #include <thread>
+    #include <utility>
+    #include <vector>
+    #include <clocale>
+
+    // i18n...
+    #include "gettext.h"
+    #define _(str) gettext (str)
+    #define N_(str) gettext_noop (str)
+
+// Records spans of work on the threads that ran them, such as band loads, OCR
+//  passes, reconstructions, and writes, to be written out as Chrome trace
+//  event JSON which Perfetto or chrome://tracing can show as a timeline...
+class Tracer
+{
+    // Public types...
+    public:
+
+        // Arguments of a span, being name and value pairs...
+        typedef std::vector<std::pair<std::string, std::string> > ArgumentListType;
+
+        // Records a span for as long as it is in scope, or does nothing if
+        //  there is no tracer...
+        class Span
+        {
+            // Public methods...
+            public:
+
+                // Constructor starts the span...
+                Span(Tracer *TargetTracer, const char *Name);
+
+                // End the span before going out of scope...
+                void End();
+
+                // Add an argument to show with the span...
+                void SetArgument(const char *Name, const std::string &Value);
+
+                // Deconstructor ends the span, unless already ended...
+               ~Span();
+
+            // Protected data...
+            protected:
+
+                // Arguments to show with it...
+                ArgumentListType        m_Arguments;
+
+                // Name of the span...
+                const char             *m_Name;
+
+                // When it started...
+                std::chrono::steady_clock::time_point
+                                        m_Start;
+
+                // Tracer to record in, or NULL if not tracing or ended...
+                Tracer                 *m_Tracer;
+        };
+
+    // Public methods...
+    public:
+
+        // Default constructor starts the clock all spans are relative to...
+        Tracer();
+
+        // Record a span that ran on the calling thread...
+        void Record(
+            const char *Name,
+            const std::chrono::steady_clock::time_point &Start,
+            const std::chrono::steady_clock::time_point &End,
+            const ArgumentListType &Arguments);
+
+        // Write every span recorded as trace event JSON, or throw an
+        //  error...
+        void WriteJson(const std::string &FileName) const;
+
+    // Protected types...
+    protected:
+
+        // A recorded span...
+        struct EventType
+        {
+            // Arguments to show with it...
+            ArgumentListType    m_Arguments;
+
+            // How long it lasted, in microseconds...
+            double              m_Duration;
+
+            // Name of the span...
+            std::string         m_Name;
+
+            // When it started, in microseconds since the tracer was
+            //  created...
+            double              m_Start;
+
+            // Number of the thread it ran on...
+            size_t              m_Thread;
+        };
+
+    // Protected data...
+    protected:
+
+        // Spans recorded so far...
+        std::vector<EventType>  m_Events;
+
+        // Guards the spans and threads...
+        mutable std::mutex      m_Mutex;
+
+        // When the tracer was created...
+        std::chrono::steady_clock::time_point
+                                m_Origin;
+
+        // Number of each thread that recorded a span, in the order they
+        //  were first seen...
+        std::map<std::thread::id, size_t>
+                                m_Threads;
+};
+
+// Multiple include protection...
+#endif
+
@@ -26,16 +26,20 @@
 
     // Our headers...
     #include "VicarImageAssembler.h"
+    #include "ArchiveOutputSink.h"
     #include "Console.h"
-#ifdef USE_DBUS_INTERFACE
-    #include "DBusInterface.h"
-#endif
+    #include "ExtractionContext.h"
+    #include "FileOutputSink.h"
+    #include "MediaEmulator.h"
     #include "Miscellaneous.h"
+    #include "Probes.h"
+    #include "ResidentCache.h"
 
     // zziplib...
     #include <zzip/zzip.h>
 
     // System headers...
+    #include <algorithm>
     #include <cassert>
     #include <iostream>
     #include <iomanip>
@@ -50,10 +54,17 @@ using namespace std;
 
 // Construct and read the header, or throw an error...
 VicarImageAssembler::VicarImageAssembler(
+    const ExtractionContext &Context,
     const string &InputFileOrRootDirectory,
     const string &OutputRootDirectory)
-    : m_InputFileOrRootDirectory(InputFileOrRootDirectory),
-      m_OutputRootDirectory(OutputRootDirectory)
+    : m_BandIndex(NULL),
+      m_BandIndexResident(false),
+      m_Context(Context),
+      m_InputFileOrRootDirectory(InputFileOrRootDirectory),
+      m_OutputRootDirectory(OutputRootDirectory),
+      m_MetadataCatalogue(NULL),
+      m_OutputSink(NULL),
+      m_RunJournal(NULL)
 {
     // We should have been provided with an input directory...
     assert(!m_InputFileOrRootDirectory.empty());
@@ -71,25 +82,69 @@ VicarImageAssembler::VicarImageAssembler(
         m_OutputRootDirectory += '/';
 }
 
-// Add the given file to the list of prospective files to examine later...
-void VicarImageAssembler::AddProspectiveFile(const string &InputFile)
+// Add the given file, found at the given place on the media, to the list of
+//  prospective files to examine later...
+void VicarImageAssembler::AddProspectiveFile(
+    const string &InputFile,
+    const PhysicalLocation &Location)
 {
     // Add to the list of prospective files to examine later...
-    m_ProspectiveFiles.push_back(InputFile);
+    m_ProspectiveFiles.push_back(ProspectiveFileType(InputFile, Location));
+    m_Context.Count("viking_extractor_files_indexed_total");
 
-#ifdef USE_DBUS_INTERFACE
+    // Format a notification to the front end, if any...
+    if(m_Context.GetProgressSink())
+    {
+        stringstream FormattedMessage;
+        FormattedMessage
+            << _("Indexing mission data, please wait...") 
+            << m_ProspectiveFiles.size();
+        m_Context.GetProgressSink()->ReportNotification(FormattedMessage.str());
+    }
+}
 
-    // Format a notification to the Viking Lander Launcher...
-    stringstream FormattedMessage;
-    FormattedMessage
-        << _("Indexing mission data, please wait...") 
-        << m_ProspectiveFiles.size();
+// Announce to the front end each reconstructed image held back whose output
+//  has since reached the file system, in the order they were reconstructed,
+//  or all of them regardless if forced...
+void VicarImageAssembler::AnnounceReconstructedImages(const bool Force)
+{
+    // Announce until one is still waiting to be written...
+    while(!m_UnannouncedImages.empty() &&
+          (Force || !m_OutputSink->IsPending(m_UnannouncedImages.front().m_OutputFile)))
+    {
+        m_Context.GetProgressSink()->ReportImageReconstructed(m_UnannouncedImages.front());
+        m_UnannouncedImages.pop_front();
+    }
+}
 
-    // Emit message...
-    DBusInterface::GetInstance().EmitNotificationSignal(FormattedMessage.str());
+// Done with the given camera event, so hold it back to be journaled and, if
+//  memory is limited, release its reconstructable image and the band
+//  descriptors it holds, or throw an error...
+void VicarImageAssembler::FinishCameraEvent(const string &CameraEvent)
+{
+    // Find it...
+    CameraEventDictionaryIterator EventIterator = m_CameraEventDictionary.find(CameraEvent);
+    assert(EventIterator != m_CameraEventDictionary.end() && EventIterator->second);
 
-#endif
+    // Hold it back to be journaled along with the input files it was made
+    //  from, which are taken now since it may be gone by then...
+    if(m_RunJournal)
+    {
+        m_UnjournaledCameraEvents.push_back(FinishedCameraEventType(CameraEvent, vector<string>()));
+        EventIterator->second->GetInputFiles(m_UnjournaledCameraEvents.back().second);
+    }
 
+    // Its output has already been handed to the sink, so if memory is
+    //  limited there is no need to keep it around until the end. The entry
+    //  stays so the number of camera events is still known...
+    if(m_Context.GetMemoryTracker().GetLimit() != 0)
+    {
+        delete EventIterator->second;
+        EventIterator->second = NULL;
+    }
+
+    // Journal whatever has finished if there is enough of it...
+    JournalFinishedCameraEvents(false);
 }
 
 // Index archive contents into list of prospective files, or throw an error...
@@ -99,10 +154,31 @@ void VicarImageAssembler::IndexArchive(const string &InputArchiveFile)
     ZZIP_DIR       *Directory       = NULL;
     ZZIP_DIRENT    *DirectoryEntry  = NULL;
 
-    // Open directory and check for error...
-    if(!(Directory = zzip_opendir(InputArchiveFile.c_str())))
+    // Time it...
+    Profiler::Scope Scope(m_Context.GetProfiler(), InputArchiveFile, "index_archive");
+
+    // Open directory, through emulated media if asked to, or reuse the one a
+    //  daemon keeps open, and check for error...
+    const bool ResidentArchive = ResidentCache::IsInstantiated();
+    Directory = ResidentArchive ?
+        ResidentCache::GetInstance().AcquireArchive(InputArchiveFile) :
+        zzip_opendir_ext_io(
+            InputArchiveFile.c_str(), ZZIP_PREFERZIP, NULL, MediaEmulator::GetHandlers());
+    if(!Directory)
         throw string(_("unable to open input directory for indexing ")) + InputArchiveFile;
 
+    // Start from the first entry, since a kept one was read before...
+    if(ResidentArchive)
+        zzip_rewinddir(Directory);
+
+    // Find where the archive is and where each member is within it, so its
+    //  members can be read in the order they are stored. Without the central
+    //  directory's offsets they just stay in the order listed...
+    PhysicalLocation                        ArchiveLocation;
+    PhysicalLocation::MemberOffsetMapType   MemberOffsets;
+    ArchiveLocation.LocateFile(InputArchiveFile);
+    PhysicalLocation::ReadZipMemberOffsets(InputArchiveFile, MemberOffsets);
+
     // Add all VICAR files found...
     while((DirectoryEntry = zzip_readdir(Directory)))
     {
@@ -116,11 +192,19 @@ void VicarImageAssembler::IndexArchive(const string &InputArchiveFile)
 
         // Extension matches that of a potential Viking lander VICAR file...
         if((fnmatch(FNMATCH_ANY_VICAR, DirectoryEntry->d_name, 0) == 0))
-            AddProspectiveFile(CurrentFileName);
+        {
+            const PhysicalLocation::MemberOffsetMapType::const_iterator Offset =
+                MemberOffsets.find(DirectoryEntry->d_name);
+            AddProspectiveFile(
+                CurrentFileName,
+                ArchiveLocation.LocateMember(
+                    (Offset != MemberOffsets.end()) ? Offset->second : 0));
+        }
     }
 
-    // Cleanup...
-    zzip_closedir(Directory);
+    // Cleanup, unless a daemon keeps it...
+    if(!ResidentArchive)
+        zzip_closedir(Directory);
 }
 
 // Generate input file list from the input directory, or throw an
@@ -131,6 +215,9 @@ void VicarImageAssembler::IndexDirectory(const string &InputDirectory)
     DIR            *Directory       = nullptr;
     struct dirent  *DirectoryEntry  = nullptr;
 
+    // Time it...
+    Profiler::Scope Scope(m_Context.GetProfiler(), InputDirectory, "index_directory");
+
     // Make an editable copy of the original input directory...
     string NewInputDirectory = InputDirectory;
 
@@ -180,7 +267,81 @@ void VicarImageAssembler::IndexFile(const string &InputFile)
 
     // Extension matches that of a potential Viking lander VICAR file...
     else if((fnmatch(FNMATCH_ANY_VICAR, InputFile.c_str(), 0) == 0))
-        AddProspectiveFile(InputFile);
+    {
+        PhysicalLocation Location;
+        Location.LocateFile(InputFile);
+        AddProspectiveFile(InputFile, Location);
+    }
+}
+
+// Journal the finished camera events held back once there are enough of them,
+//  or regardless if forced, after waiting for their output to be written, or
+//  throw an error...
+void VicarImageAssembler::JournalFinishedCameraEvents(const bool Force)
+{
+    // Nothing to journal to, or not enough to bother yet...
+    if(!m_RunJournal ||
+       m_UnjournaledCameraEvents.empty() ||
+       (!Force && m_UnjournaledCameraEvents.size() < RUN_JOURNAL_CHECKPOINT_EVENTS))
+        return;
+
+    // Wait for their output to be written...
+    m_OutputSink->Flush();
+    if(m_MetadataCatalogue)
+        m_MetadataCatalogue->Flush();
+
+    // Journal each along with the input files it was made from...
+    for(vector<FinishedCameraEventType>::const_iterator Iterator = m_UnjournaledCameraEvents.begin();
+        Iterator != m_UnjournaledCameraEvents.end();
+      ++Iterator)
+        m_RunJournal->AppendEnd(Iterator->first, Iterator->second);
+
+    // Done...
+    m_UnjournaledCameraEvents.clear();
+}
+
+// Load an image band from the run journal or band index if either remembers
+//  it, otherwise from the file itself, remembering what was found for next
+//  time. Where it was loaded from is returned, for counting in metrics...
+const char *VicarImageAssembler::LoadImageBand(VicarImageBand &ImageBand)
+{
+    // Objects...
+    BandIndex::EntryType Entry;
+
+    // The run journal remembers it...
+    if(m_RunJournal && m_RunJournal->FindBand(ImageBand.GetInputFileName(), Entry))
+    {
+        ImageBand.LoadFromIndexEntry(Entry);
+        return "run_journal";
+    }
+
+    // The band index remembers it...
+    else if(m_BandIndex && ImageBand.LoadFromIndex(*m_BandIndex))
+        return "band_index";
+
+    // Otherwise load it from the file and remember it...
+    else
+    {
+        // Load, firing probes on either side...
+        const uint64_t ProbeStart = PROBE_TIMESTAMP(band_load_end);
+        PROBE1(band_load_start, ImageBand.GetInputFileName().c_str());
+        ImageBand.Load();
+        PROBE3(band_load_end,
+            ImageBand.GetInputFileName().c_str(), !ImageBand.IsError(),
+            PROBE_ELAPSED(ProbeStart));
+
+        // Remember...
+        if(m_BandIndex)
+            ImageBand.StoreInIndex(*m_BandIndex);
+        if(m_RunJournal && ImageBand.GetIndexEntry(Entry))
+            m_RunJournal->AppendBand(ImageBand.GetInputFileName(), Entry);
+
+        // Shrink it before it is held until reconstruction if memory is
+        //  limited...
+        if(m_Context.GetMemoryTracker().GetLimit() != 0)
+            ImageBand.Compact();
+        return "file";
+    }
 }
 
 // Reconstruct all possible images found of either the input
@@ -193,41 +354,118 @@ void VicarImageAssembler::Reconstruct()
     // Try to index the file or directory...
     try
     {
-#ifdef USE_DBUS_INTERFACE
-        // If remote start was enabled, block until D-Bus Ready signal received
-        //  or throws an exception...
-        if(Options::GetInstance().GetRemoteStart())
-            DBusInterface::GetInstance().WaitRemoteStart();
-#endif
-
         // Alert user...
-        Message(Console::Summary) << _("indexing mission data, please wait...") << endl;
+        m_Context.Message(Console::Summary) << _("indexing mission data, please wait...") << endl;
 
-#ifdef USE_DBUS_INTERFACE
-        // Provide a notification to the Viking Lander Launcher...
-        DBusInterface::GetInstance().EmitNotificationSignal(_("Indexing mission data, please wait..."));
-#endif
+        // Provide a notification to the front end, if any...
+        if(m_Context.GetProgressSink())
+            m_Context.GetProgressSink()->ReportNotification(_("Indexing mission data, please wait..."));
 
         // If summarize only mode is enabled, mute current file name, and all
         //  channels, except summarize...
-        if(Options::GetInstance().GetSummarizeOnly())
+        if(m_Context.GetOptions().GetSummarizeOnly())
         {
-            Console::GetInstance().SetUseCurrentFileName(false);
-            Console::GetInstance().SetChannelEnabled(Console::Error, false);
-            Console::GetInstance().SetChannelEnabled(Console::Info, false);
-            Console::GetInstance().SetChannelEnabled(Console::Warning, false);
+            m_Context.GetConsole().SetUseCurrentFileName(false);
+            m_Context.GetConsole().SetChannelEnabled(Console::Error, false);
+            m_Context.GetConsole().SetChannelEnabled(Console::Info, false);
+            m_Context.GetConsole().SetChannelEnabled(Console::Warning, false);
         }
 
         // If suppress mode is enabled, disable warnings and errors...
-        if(Options::GetInstance().GetSuppress())
+        if(m_Context.GetOptions().GetSuppress())
         {
-            Console::GetInstance().SetChannelEnabled(Console::Error, false);
-            Console::GetInstance().SetChannelEnabled(Console::Warning, false);
+            m_Context.GetConsole().SetChannelEnabled(Console::Error, false);
+            m_Context.GetConsole().SetChannelEnabled(Console::Warning, false);
         }
 
         // Reset assembler state...
         Reset();
 
+        // Everything goes into a single archive if the user asked for one
+        //  and this isn't a dry run, or otherwise the output directory...
+        if(!m_Context.GetOptions().GetOutputArchive().empty() &&
+           !m_Context.GetOptions().GetDryRun())
+            m_OutputSink = new ArchiveOutputSink(
+                m_OutputRootDirectory,
+                m_Context.GetOptions().GetOutputArchive(),
+                m_Context.GetOptions().GetOutputArchiveFormat(),
+                m_Context.GetOptions().GetOverwrite(),
+                m_Context.GetOptions().GetFsyncPolicy());
+        else
+            m_OutputSink = new FileOutputSink(
+                m_OutputRootDirectory,
+                m_Context.GetOptions().GetIoThreads(),
+                m_Context.GetOptions().GetFsyncPolicy(),
+                m_Context.GetTracer(),
+                &m_Context.GetMemoryTracker());
+
+        // Resuming needs the journal a previous run kept in the output
+        //  directory...
+        if(m_Context.GetOptions().GetResume() &&
+           (!m_Context.GetOptions().GetOutputArchive().empty() ||
+            m_Context.GetOptions().GetDryRun()))
+            throw string(_("--resume needs output written to the output directory"));
+
+        // Progress is journaled in the output directory so an interrupted run
+        //  can be resumed, if that's where output is going...
+        if(m_Context.GetOptions().GetOutputArchive().empty() &&
+           !m_Context.GetOptions().GetDryRun())
+        {
+            // Make sure the output root exists to hold it...
+            if(!CreateDirectoryRecursively(m_OutputRootDirectory))
+                throw string(_("could not create output directory for run journal"));
+
+            // Open it...
+            m_RunJournal = new RunJournal(
+                m_OutputRootDirectory + RUN_JOURNAL_FILE_NAME,
+                m_Context.GetOptions().GetResume(),
+                m_Context.GetOptions().GetFsyncPolicy());
+
+            // Alert user...
+            if(m_Context.GetOptions().GetResume())
+                m_Context.Message(Console::Info)
+                    << m_RunJournal->GetFinishedCameraEvents()
+                    << _(" camera events already finished with unchanged inputs, skipping")
+                    << endl;
+        }
+
+        // Metadata is collected into a single catalogue for the whole run if
+        //  the user asked for one and this isn't a dry run...
+        if(m_Context.GetOptions().GetGenerateMetadata() &&
+           m_Context.GetOptions().GetMetadataFormat() != Options::MetadataTxt &&
+           !m_Context.GetOptions().GetDryRun())
+        {
+            // Make sure the output root exists to hold it...
+            if(!CreateDirectoryRecursively(m_OutputRootDirectory))
+                throw string(_("could not create output directory for metadata catalogue"));
+
+            // Create it...
+            m_MetadataCatalogue = new MetadataCatalogue(
+                m_OutputRootDirectory,
+                (m_Context.GetOptions().GetMetadataFormat() == Options::MetadataCsv) ?
+                    MetadataCatalogue::FormatCsv : MetadataCatalogue::FormatJsonLines,
+                m_Context.GetOptions().GetOverwrite(),
+                m_Context.GetOptions().GetResume());
+        }
+
+        // Bands are loaded from an index of previous runs where still current,
+        //  if the user asked for one. A daemon keeps it mapped between jobs...
+        if(!m_Context.GetOptions().GetIndexFile().empty())
+        {
+            // Kept by the daemon...
+            m_BandIndexResident = ResidentCache::IsInstantiated();
+            if(m_BandIndexResident)
+            {
+                m_BandIndex = &ResidentCache::GetInstance().GetBandIndex(
+                    m_Context.GetOptions().GetIndexFile());
+                m_BandIndex->ResetFoundEntries();
+            }
+
+            // Otherwise just for this reconstruction...
+            else
+                m_BandIndex = new BandIndex(m_Context.GetOptions().GetIndexFile());
+        }
+
         // Generate input file list from the input file or directory...
 
             // Fetch attributes...
@@ -247,7 +485,7 @@ void VicarImageAssembler::Reconstruct()
         if(m_ProspectiveFiles.empty())
         {
             // Alert...
-            Message(Console::Summary)
+            m_Context.Message(Console::Summary)
                 << _("no prospective files found")
                 << endl;
 
@@ -255,36 +493,40 @@ void VicarImageAssembler::Reconstruct()
             return;
         }
 
-#ifdef USE_DBUS_INTERFACE
-        // Emit progress over D-Bus to drive the Viking Lander Remastered Launcher...
-        DBusInterface::GetInstance().EmitNotificationSignal(_("Analyzing mission data, please wait..."));
-#endif
+        // Read them in the order they are laid out on the media rather than
+        //  the order their directories listed them in, so slow media like a
+        //  DVD reads almost sequentially instead of seeking back and forth.
+        //  Files found at the same place keep the order they were found in...
+        stable_sort(m_ProspectiveFiles.begin(), m_ProspectiveFiles.end());
+
+        // Provide a notification to the front end, if any...
+        if(m_Context.GetProgressSink())
+            m_Context.GetProgressSink()->ReportNotification(_("Analyzing mission data, please wait..."));
 
         // Keep reading entries while there are some...
-        for(vector<string>::iterator CurrentFileIterator = m_ProspectiveFiles.begin();
+        for(vector<ProspectiveFileType>::iterator CurrentFileIterator = m_ProspectiveFiles.begin();
             CurrentFileIterator != m_ProspectiveFiles.end();
           ++CurrentFileIterator)
         {
             // Get the full path...
-            const string CurrentFile = *CurrentFileIterator;
+            const string CurrentFile = CurrentFileIterator->m_InputFile;
 
             // Construct an image band object...
-            VicarImageBand ImageBand(CurrentFile);
+            VicarImageBand ImageBand(m_Context, CurrentFile);
 
             // Calculate progress...
             const size_t ProspectiveFilesExamined = CurrentFileIterator - m_ProspectiveFiles.begin() + 1;
             const size_t TotalProspectiveFiles = m_ProspectiveFiles.size();
             const double PercentageExamined = static_cast<double>(ProspectiveFilesExamined) / TotalProspectiveFiles * 100.0;
 
-#ifdef USE_DBUS_INTERFACE
-            // Emit progress over D-Bus to drive the Viking Lander Remastered Launcher...
-            DBusInterface::GetInstance().EmitProgressSignal(PercentageExamined);
-#endif
+            // Report progress to the front end, if any...
+            if(m_Context.GetProgressSink())
+                m_Context.GetProgressSink()->ReportProgress(PercentageExamined);
 
             // Update summary, if enabled...
-            if(Options::GetInstance().GetSummarizeOnly())
+            if(m_Context.GetOptions().GetSummarizeOnly())
             {
-                Message(Console::Summary)
+                m_Context.Message(Console::Summary)
                     << "\r" << _("studying mission data index of ")
                     << ProspectiveFilesExamined << "/" << TotalProspectiveFiles
                     << " (" << PercentageExamined << " %)";
@@ -293,19 +535,33 @@ void VicarImageAssembler::Reconstruct()
             // Otherwise update console so it knows what current file we are
             //  working with...
             else
-                Console::GetInstance().SetCurrentFileName(ImageBand.GetInputFileNameOnly());
+                m_Context.GetConsole().SetCurrentFileName(ImageBand.GetInputFileNameOnly());
+
+            // Skip bands of camera events a previous run already finished...
+            if(m_RunJournal && m_RunJournal->IsFinishedInputFile(CurrentFile))
+            {
+                CONSOLE_MESSAGE(m_Context.GetConsole(), Console::Verbose)
+                    << _("camera event already finished, skipping")
+                    << endl;
+                continue;
+            }
 
             // Attempt to load the file...
-            ImageBand.Load();
+            const char *LoadedFrom = LoadImageBand(ImageBand);
 
                 // Failed...
                 if(ImageBand.IsError())
                 {
+                    // Count it...
+                    m_Context.Count(
+                        "viking_extractor_bands_rejected_total",
+                        Metrics::Label("reason", ImageBand.GetRejectionReason()));
+
                     // User requested we just skip over bad files....
-                    if(Options::GetInstance().GetIgnoreBadFiles())
+                    if(m_Context.GetOptions().GetIgnoreBadFiles())
                     {
                         // Alert and skip...
-                        Message(Console::Warning)
+                        m_Context.Message(Console::Warning)
                             << ImageBand.GetErrorMessage()
                             << _(", skipping")
                             << endl;
@@ -325,29 +581,35 @@ void VicarImageAssembler::Reconstruct()
 
             // Get user selected diode band filter set...
             const Options::FilterDiodeBandSet &DiodeBandSet =
-                Options::GetInstance().GetFilterDiodeBandSet();
+                m_Context.GetOptions().GetFilterDiodeBandSet();
 
             // Not part of the diode filter set...
             if(!DiodeBandSet.empty() &&
                (DiodeBandSet.find(ImageBand.GetDiodeBandType()) ==
                 DiodeBandSet.end()))
             {
-                // Alert, skip...
-                Message(Console::Info)
+                // Alert, count, skip...
+                m_Context.Message(Console::Info)
                     << _("filtering ")
                     << ImageBand.GetDiodeBandTypeFriendlyString()
                     << _(" type diode bands (--filter-diode[=type] to change)")
                     << endl;
+                m_Context.Count(
+                    "viking_extractor_bands_rejected_total",
+                    Metrics::Label("reason", "filtered"));
                 continue;
             }
 
             // Drop if no camera event label...
             if(!ImageBand.IsCameraEventLabelPresent())
             {
-                // Alert user, skip...
-                Message(Console::Error)
+                // Alert user, count, skip...
+                m_Context.Message(Console::Error)
                     << _("camera event doesn't identify itself, cannot index")
                     << endl;
+                m_Context.Count(
+                    "viking_extractor_bands_rejected_total",
+                    Metrics::Label("reason", "unlabelled"));
                 continue;
             }
 
@@ -365,15 +627,18 @@ void VicarImageAssembler::Reconstruct()
                 if(EventIterator == m_CameraEventDictionary.end())
                 {
                     // Alert user...
-                    Message(Console::Info)
+                    m_Context.Message(Console::Info)
                         << CameraEventLabel
                         << _(" is a new camera event, indexing")
                         << endl;
 
                     // Construct a new reconstructable image...
                     Reconstructable = new ReconstructableImage(
+                        m_Context,
                         m_OutputRootDirectory,
-                        CameraEventLabel);
+                        CameraEventLabel,
+                        *m_OutputSink,
+                        m_MetadataCatalogue);
 
                     // Insert the reconstructable image into the event dictionary.
                     //  We use the previous failed find iterator as a possible
@@ -386,7 +651,7 @@ void VicarImageAssembler::Reconstruct()
                 else
                 {
                     // Alert user...
-                    Message(Console::Info)
+                    m_Context.Message(Console::Info)
                         << CameraEventLabel
                         << _(" is a known camera event, indexing")
                         << endl;
@@ -402,11 +667,16 @@ void VicarImageAssembler::Reconstruct()
             // Check for error...
             if(Reconstructable->IsError())
             {
+                // Count it...
+                m_Context.Count(
+                    "viking_extractor_bands_rejected_total",
+                    Metrics::Label("reason", "unsupported_diode"));
+
                 // User requested we just skip over bad files....
-                if(Options::GetInstance().GetIgnoreBadFiles())
+                if(m_Context.GetOptions().GetIgnoreBadFiles())
                 {
                     // Alert and skip...
-                    Message(Console::Warning)
+                    m_Context.Message(Console::Warning)
                         << Reconstructable->GetErrorMessage()
                         << _(", skipping")
                         << endl;
@@ -423,21 +693,124 @@ void VicarImageAssembler::Reconstruct()
                     throw ErrorMessage;
                 }
             }
+
+            // Count it as loaded...
+            m_Context.Count(
+                "viking_extractor_bands_loaded_total",
+                Metrics::Label("source", LoadedFrom));
         }
 
         // Update summary, if enabled, beginning with new line since last was \r only...
-        if(Options::GetInstance().GetSummarizeOnly())
-            Message(Console::Summary) << endl;
+        if(m_Context.GetOptions().GetSummarizeOnly())
+            m_Context.Message(Console::Summary) << endl;
+
+        // A camera event a previous run finished that has gained bands since
+        //  has to be redone with all of them, so bring back those it was
+        //  finished with...
+        for(CameraEventDictionaryIterator EventIterator = m_CameraEventDictionary.begin();
+            m_RunJournal && EventIterator != m_CameraEventDictionary.end();
+          ++EventIterator)
+        {
+            // Get the input files it was finished with, if it was...
+            vector<string> FinishedInputFiles;
+            if(!m_RunJournal->GetFinishedInputFiles(EventIterator->first, FinishedInputFiles))
+                continue;
+
+            // Alert user...
+            m_Context.Message(Console::Info)
+                << EventIterator->first
+                << _(" gained bands since it was finished, redoing")
+                << endl;
+
+            // Load each and add it back...
+            for(vector<string>::const_iterator InputFileIterator = FinishedInputFiles.begin();
+                InputFileIterator != FinishedInputFiles.end();
+              ++InputFileIterator)
+            {
+                // Load...
+                VicarImageBand ImageBand(m_Context, *InputFileIterator);
+                LoadImageBand(ImageBand);
+
+                // It was fine last time, but no longer is...
+                if(ImageBand.IsError() ||
+                   ImageBand.GetCameraEventLabel() != EventIterator->first)
+                {
+                    m_Context.Message(Console::Warning)
+                        << ImageBand.GetErrorMessage()
+                        << _(", skipping")
+                        << endl;
+                    continue;
+                }
+
+                // Add it back...
+                EventIterator->second->AddImageBand(ImageBand);
+            }
+        }
+
+        // Save whatever the band index learned before anything is written...
+        if(m_BandIndex)
+        {
+            // Alert user...
+            m_Context.Message(Console::Info)
+                << m_BandIndex->GetFoundEntries() << "/" << m_ProspectiveFiles.size()
+                << _(" bands loaded from the band index, ")
+                << m_BandIndex->GetInsertedEntries()
+                << _(" added")
+                << endl;
+
+            // Save...
+            m_BandIndex->Save();
+        }
+
+        // Only planning, so describe what would become of each camera event
+        //  instead of reconstructing it...
+        if(m_Context.GetOptions().GetPlan())
+        {
+            // Tally of each kind of outcome...
+            size_t ColourImages             = 0;
+            size_t GrayscaleImages          = 0;
+            size_t UnreconstructableEvents  = 0;
+
+            // Describe each...
+            for(CameraEventDictionaryIterator EventIterator = m_CameraEventDictionary.begin();
+                EventIterator != m_CameraEventDictionary.end();
+              ++EventIterator)
+            {
+                // Get the reconstructable image object...
+                ReconstructableImage *Reconstructable = EventIterator->second;
+                assert(Reconstructable);
+
+                // Describe it...
+                Reconstructable->Plan(cout);
+
+                // Tally...
+                switch(Reconstructable->GetReconstructionType())
+                {
+                    case ReconstructableImage::ReconstructColour:       ++ColourImages; break;
+                    case ReconstructableImage::ReconstructGrayscale:    ++GrayscaleImages; break;
+                    default:                                            ++UnreconstructableEvents; break;
+                }
+            }
+
+            // Summarize...
+            cout << m_CameraEventDictionary.size() << _(" camera events, ")
+                 << ColourImages << _(" colour, ")
+                 << GrayscaleImages << _(" grayscale, ")
+                 << UnreconstructableEvents << _(" unreconstructable")
+                 << endl;
+
+            // Done...
+            return;
+        }
 
         // Total attempted reconstructions, total successful, and total just dumped...
         size_t AttemptedReconstruction      = 0;
         size_t SuccessfullyReconstructed    = 0;
         size_t DumpedImages                 = 0;
 
-#ifdef USE_DBUS_INTERFACE
-        // Emit progress over D-Bus to drive the Viking Lander Remastered Launcher...
-        DBusInterface::GetInstance().EmitNotificationSignal(_("Attempting forensic mission data recovery..."));
-#endif
+        // Provide a notification to the front end, if any...
+        if(m_Context.GetProgressSink())
+            m_Context.GetProgressSink()->ReportNotification(_("Attempting forensic mission data recovery..."));
 
         // Reconstruct each image...
         for(CameraEventDictionaryIterator EventIterator = m_CameraEventDictionary.begin();
@@ -452,24 +825,23 @@ void VicarImageAssembler::Reconstruct()
                 static_cast<double>(AttemptedReconstruction) /
                 m_CameraEventDictionary.size() * 100.0;
 
-#ifdef USE_DBUS_INTERFACE
-            // Emit progress over D-Bus to drive the Viking Lander Remastered Launcher...
-            DBusInterface::GetInstance().EmitProgressSignal(RecoveryProgress);
-#endif
+            // Report progress to the front end, if any...
+            if(m_Context.GetProgressSink())
+                m_Context.GetProgressSink()->ReportProgress(RecoveryProgress);
 
             // Update summary, if enabled...
-            if(Options::GetInstance().GetSummarizeOnly())
+            if(m_Context.GetOptions().GetSummarizeOnly())
             {
                 // Trying to reconstruct...
-                if(!Options::GetInstance().GetNoReconstruct())
-                    Message(Console::Summary)
+                if(!m_Context.GetOptions().GetNoReconstruct())
+                    m_Context.Message(Console::Summary)
                         << "\r" << _("attempting reconstruction ")
                         << AttemptedReconstruction << "/" << m_CameraEventDictionary.size()
                         << " (" << RecoveryProgress << " %)";
 
                 // Just dumping components...
                 else
-                    Message(Console::Summary)
+                    m_Context.Message(Console::Summary)
                         << "\r" << _("dumping components from ")
                         << AttemptedReconstruction << "/" << m_CameraEventDictionary.size()
                         << " (" << RecoveryProgress << " %)";
@@ -479,21 +851,50 @@ void VicarImageAssembler::Reconstruct()
             ReconstructableImage *Reconstructable = EventIterator->second;
             assert(Reconstructable);
 
-            // Reconstruct the image object and check for error...
-            if(!Reconstructable->Reconstruct())
+            // Journal that it has begun, having it replace anything a
+            //  previous run left behind for it...
+            if(m_RunJournal)
+            {
+                if(m_RunJournal->IsStarted(EventIterator->first))
+                    Reconstructable->SetOverwrite();
+                m_RunJournal->AppendBegin(EventIterator->first);
+            }
+
+            // Reconstruct the image object, firing probes on either side...
+            const uint64_t ProbeStart = PROBE_TIMESTAMP(reconstruct_end);
+            PROBE1(reconstruct_start, EventIterator->first.c_str());
+            const bool Reconstructed = Reconstructable->Reconstruct();
+            PROBE3(reconstruct_end,
+                EventIterator->first.c_str(), Reconstructed,
+                PROBE_ELAPSED(ProbeStart));
+
+            // Check for error...
+            if(!Reconstructed)
             {
                 // Since the image wasn't reconstructed successfully,
                 //  this is the number of component images that were dumped...
                 DumpedImages += Reconstructable->GetDumpedImagesCount();
 
+                // Count it...
+                m_Context.Count(
+                    "viking_extractor_camera_events_total",
+                    Metrics::Label("outcome", "failed"));
+                m_Context.Count(
+                    "viking_extractor_components_dumped_total",
+                    string(),
+                    Reconstructable->GetDumpedImagesCount());
+
                 // User requested we just skip over bad files....
-                if(Options::GetInstance().GetIgnoreBadFiles())
+                if(m_Context.GetOptions().GetIgnoreBadFiles())
                 {
                     // Alert and skip...
-                    Message(Console::Warning)
+                    m_Context.Message(Console::Warning)
                         << Reconstructable->GetErrorMessage()
                         << _(", skipping")
                         << endl;
+
+                    // Nothing more will be done with it...
+                    FinishCameraEvent(EventIterator->first);
                     continue;
                 }
 
@@ -510,20 +911,59 @@ void VicarImageAssembler::Reconstruct()
 
             // Otherwise, take note that we recovered one more...
             else
+            {
+                // Count it...
               ++SuccessfullyReconstructed;
+                m_Context.Count(
+                    "viking_extractor_camera_events_total",
+                    Metrics::Label("outcome", "reconstructed"));
+
+                // Hold it back to be announced to the front end, if any, once
+                //  its output is written, unless nothing was written...
+                if(m_Context.GetProgressSink() &&
+                   !Reconstructable->GetReconstructedFileName().empty() &&
+                   !m_Context.GetOptions().GetDryRun())
+                {
+                    ProgressSink::ReconstructedImageType Image;
+                    Image.m_BandTypeClass   = Reconstructable->GetBandTypeClass();
+                    Image.m_CameraEvent     = Reconstructable->GetCameraEventNoSol();
+                    Image.m_Height          = Reconstructable->GetReconstructedHeight();
+                    Image.m_OutputFile      = Reconstructable->GetReconstructedFileName();
+                    Image.m_SolarDay        = Reconstructable->GetSolarDay();
+                    Image.m_Width           = Reconstructable->GetReconstructedWidth();
+                    m_UnannouncedImages.push_back(Image);
+                }
+            }
+
+            // Announce whatever has been written by now...
+            AnnounceReconstructedImages(false);
+
+            // Finished with it...
+            FinishCameraEvent(EventIterator->first);
         }
 
-#ifdef USE_DBUS_INTERFACE
-        // Emit progress over D-Bus to drive the Viking Lander Remastered Launcher...
-        DBusInterface::GetInstance().EmitNotificationSignal(_("Recovery completed..."));
-#endif
+        // Finish writing all output, then journal whatever finished since the
+        //  last time...
+        m_OutputSink->Close();
+        if(m_MetadataCatalogue)
+            m_MetadataCatalogue->Close();
+        JournalFinishedCameraEvents(true);
+
+        // Announce whatever reconstructed images were still being written
+        //  and tell the front end, if any, that recovery has completed...
+        if(m_Context.GetProgressSink())
+        {
+            AnnounceReconstructedImages(true);
+            m_Context.GetProgressSink()->ReportNotification(_("Recovery completed..."));
+            m_Context.GetProgressSink()->Flush();
+        }
 
         // Update summary, if enabled, beginning with new line since last was \r only...
-        if(Options::GetInstance().GetSummarizeOnly())
+        if(m_Context.GetOptions().GetSummarizeOnly())
         {
             // We were trying to reconstruct...
-            if(!Options::GetInstance().GetNoReconstruct())
-                Message(Console::Summary)
+            if(!m_Context.GetOptions().GetNoReconstruct())
+                m_Context.Message(Console::Summary)
                     << endl
                     << _("successfully reconstructed ")
                     << SuccessfullyReconstructed << "/" << m_CameraEventDictionary.size()
@@ -532,19 +972,38 @@ void VicarImageAssembler::Reconstruct()
 
             // We were not trying to reconstruct...
             else
-                Message(Console::Summary)
+                m_Context.Message(Console::Summary)
                     << endl
                     << _("dumped ") << DumpedImages << _(" image components without reconstruction")
                     << endl;
         }
+
+        // Publish the peak resident set size and list what memory was
+        //  accounted for, if summary enabled...
+        m_Context.GetMemoryTracker().PublishPeakResidentSetSize();
+        if(m_Context.GetOptions().GetSummarizeOnly())
+            m_Context.GetMemoryTracker().WriteSummary(m_Context.Message(Console::Summary));
+
+        // Write out the stage timings and list the slowest files, if
+        //  profiling...
+        if(!m_Context.GetOptions().GetProfileFile().empty())
+        {
+            m_Context.GetProfiler()->WriteJson(m_Context.GetOptions().GetProfileFile());
+            m_Context.GetProfiler()->WriteSlowestFiles(
+                m_Context.Message(Console::Summary), PROFILER_SLOWEST_FILES);
+        }
+
+        // Write out the timeline, if tracing...
+        if(m_Context.GetTracer())
+            m_Context.GetTracer()->WriteJson(m_Context.GetOptions().GetTraceFile());
     }
 
         // Failed...
         catch(const string &AssemblerErrorMessage)
         {
             // Update summary, if enabled, beginning with new line since last was \r only...
-            if(Options::GetInstance().GetSummarizeOnly())
-                Message(Console::Summary) << AssemblerErrorMessage << endl;
+            if(m_Context.GetOptions().GetSummarizeOnly())
+                m_Context.Message(Console::Summary) << AssemblerErrorMessage << endl;
 
             // Reset assembler state...
             Reset();
@@ -571,6 +1030,25 @@ void VicarImageAssembler::Reset()
 
     // Cleanup dangling pointers...
     m_CameraEventDictionary.clear();
+
+    // Nothing left to announce...
+    m_UnannouncedImages.clear();
+
+    // Cleanup the output sink and metadata catalogue after the images that
+    //  were writing to them...
+    delete m_MetadataCatalogue;
+    m_MetadataCatalogue = NULL;
+    delete m_OutputSink;
+    m_OutputSink = NULL;
+
+    // Cleanup the band index, unless a daemon keeps it, and run journal...
+    if(!m_BandIndexResident)
+        delete m_BandIndex;
+    m_BandIndex = NULL;
+    m_BandIndexResident = false;
+    delete m_RunJournal;
+    m_RunJournal = NULL;
+    m_UnjournaledCameraEvents.clear();
 }
 
 // Deconstructor...
@@ -26,11 +26,17 @@
 // Includes...
 
     // Our headers...
-    #include "Options.h"
+    #include "BandIndex.h"
+    #include "ExtractionContext.h"
     #include "VicarImageBand.h"
+    #include "MetadataCatalogue.h"
+    #include "OutputSink.h"
+    #include "PhysicalLocation.h"
     #include "ReconstructableImage.h"
+    #include "RunJournal.h"
 
     // System headers...
+    #include <deque>
     #include <ostream>
     #include <vector>
     #include <set>
@@ -49,8 +55,10 @@ class VicarImageAssembler
     // Public methods...
     public:
 
-        // Constructor...
+        // Constructor takes the context of the extraction, which must outlive
+        //  the assembler...
         VicarImageAssembler(
+            const ExtractionContext &Context,
             const std::string &InputFileOrRootDirectory,
             const std::string &OutputRootDirectory);
 
@@ -64,13 +72,26 @@ class VicarImageAssembler
     // Protected methods...
     protected:
 
-        // Add the given file to the list of prospective files to examine later...
-        void AddProspectiveFile(const std::string &InputFile);
+        // Add the given file, found at the given place on the media, to the
+        //  list of prospective files to examine later...
+        void AddProspectiveFile(
+            const std::string &InputFile,
+            const PhysicalLocation &Location);
+
+        // Announce to the front end each reconstructed image held back whose
+        //  output has since reached the file system, in the order they were
+        //  reconstructed, or all of them regardless if forced...
+        void AnnounceReconstructedImages(const bool Force);
 
         // Index archive contents into list of prospective files, or throw an
         //  error...
         void IndexArchive(const std::string &InputArchiveFile);
 
+        // Done with the given camera event, so hold it back to be journaled
+        //  and, if memory is limited, release its reconstructable image and
+        //  the band descriptors it holds, or throw an error...
+        void FinishCameraEvent(const std::string &CameraEvent);
+
         // Generate input file list from the input directory, or throw an 
         //  error... (recursive)
         void IndexDirectory(const std::string &InputDirectory);
@@ -78,6 +99,17 @@ class VicarImageAssembler
         // Index file into list of prospective files, or throw an error...
         void IndexFile(const std::string &InputFile);
 
+        // Journal the finished camera events held back once there are enough
+        //  of them, or regardless if forced, after waiting for their output
+        //  to be written, or throw an error...
+        void JournalFinishedCameraEvents(const bool Force);
+
+        // Load an image band from the run journal or band index if either
+        //  remembers it, otherwise from the file itself, remembering what was
+        //  found for next time. Where it was loaded from is returned, for
+        //  counting in metrics...
+        const char *LoadImageBand(VicarImageBand &ImageBand);
+
         // Reset the assembler state...
         void Reset();
 
@@ -92,21 +124,76 @@ class VicarImageAssembler
         // Archived file name... (archive name, file in archive)
         typedef std::pair<std::string, std::string>             ArchivedFileNameType;
 
+        // Finished camera event... (camera event, input files it was made from)
+        typedef std::pair<std::string, std::vector<std::string> >
+                                                                FinishedCameraEventType;
+
+        // A file to examine and where its data begins on the media...
+        struct ProspectiveFileType
+        {
+            // Constructor initializer...
+            ProspectiveFileType(
+                const std::string &InputFile,
+                const PhysicalLocation &Location)
+                : m_InputFile(InputFile), m_Location(Location)
+            { }
+
+            // Is it laid out on the media before the other?
+            bool operator<(const ProspectiveFileType &Other) const
+                { return m_Location < Other.m_Location; }
+
+            // Path, or archive.zip:/member, and where it is...
+            std::string         m_InputFile;
+            PhysicalLocation    m_Location;
+        };
+
     // Protected data...
     protected:
 
+        // Index of previously loaded bands used during a reconstruction, if
+        //  the user asked for one...
+        BandIndex                          *m_BandIndex;
+
+        // The band index is kept mapped by the resident cache between
+        //  daemon jobs, so isn't ours to delete...
+        bool                                m_BandIndexResident;
+
         // Camera event dictionary multimap...
         CameraEventDictionaryType           m_CameraEventDictionary;
 
+        // Options, console, and front end of the extraction...
+        const ExtractionContext            &m_Context;
+
         // Input file or directory...
         std::string                         m_InputFileOrRootDirectory;
 
         // List of all potential files to examine...
-        std::vector<std::string>            m_ProspectiveFiles;
+        std::vector<ProspectiveFileType>    m_ProspectiveFiles;
         std::vector<ArchivedFileNameType>   m_ProspectiveArchivedFiles;
 
         // Output root directory...
         std::string                         m_OutputRootDirectory;
+
+        // Catalogue metadata is collected in during a reconstruction, if
+        //  not written as text files...
+        MetadataCatalogue                  *m_MetadataCatalogue;
+
+        // Sink output files are written to during a reconstruction...
+        OutputSink                         *m_OutputSink;
+
+        // Journal of the reconstruction's progress, if output is going into
+        //  the output directory...
+        RunJournal                         *m_RunJournal;
+
+        // Images reconstructed but not announced yet, being held back until
+        //  their output is written so a front end can open them straight
+        //  away...
+        std::deque<ProgressSink::ReconstructedImageType>
+                                            m_UnannouncedImages;
+
+        // Camera events finished but not journaled yet...
+        std::vector<FinishedCameraEventType>
+                                            m_UnjournaledCameraEvents;
 };
 
 // Multiple include protection...
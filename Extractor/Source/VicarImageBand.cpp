@@ -26,15 +26,14 @@
 
     // Our headers...    
     #include "Console.h"
+    #include "ExtractionContext.h"
     #include "LogicalRecord.h"
     #include "Miscellaneous.h"
-    #include "Options.h"
+    #include "Probes.h"
+    #include "ResidentCache.h"
     #include "VicarImageBand.h"
     #include "ZZipFileDescriptor.h"
 
-    // PNG writing...
-    #include <png++/png.hpp>
-    
     // Optical character recognition...
     #include <ocradlib.h>
 
@@ -59,18 +58,21 @@ using namespace std;
 
 // Construct...
 VicarImageBand::VicarImageBand(
+    const ExtractionContext &Context,
     const string &InputFile)
     : m_AxisPresent(false),
       m_Bands(0),
       m_BasicMetadataParserHeuristic(0),
       m_BytesPerColour(0),
+      m_Context(&Context),
       m_DiodeBandType(Unknown),
       m_FileOrdinalOnMagneticTape(0),
       m_FullHistogramPresent(false),
+      m_Indexable(false),
       m_InputFile(InputFile),
       m_LanderNumber(0),
       m_MagneticTapeNumber(0),
-      m_MeanPixelValue(0.0f),
+      m_OCRPasses(0),
       m_Ok(false),
       m_OriginalHeight(0),
       m_OriginalWidth(0),
@@ -79,6 +81,7 @@ VicarImageBand::VicarImageBand(
       m_PhysicalRecordSize(0),
       m_PixelFormat(0),
       m_RawImageOffset(0),
+      m_RejectionReason("corrupt"),
       m_Rotation(None),
       m_SolarDay(99999)
 {
@@ -210,15 +213,29 @@ bool VicarImageBand::CheckForHorizontalAxisAndExtractText(
     const RotationType Rotation, 
     string &OCRBuffer)
 {
-    // Space for rotated raw band data...
+    // Space for rotated raw band data, accounted for as long as it is held...
     RawBandDataType RotatedRawBandData;
+    MemoryTracker::Reservation RotatedReservation(
+        m_Context->GetMemoryTracker(),
+        MemoryTracker::RasterBuffers,
+        GetTotalOriginalPixelSpace());
 
     // Rotated as requested...
+    Profiler::Scope RotateScope(m_Context->GetProfiler(), m_InputFile, "rotate");
     Rotate(Rotation, RawBandData, RotatedRawBandData);
+    RotateScope.Stop();
 
     // Extract the OCR text and check for error...
+    Profiler::Scope OCRScope(
+        m_Context->GetProfiler(), m_InputFile, "extract_ocr.horizontal_axis", GetRotationTag(Rotation));
+    Tracer::Span OCRSpan(m_Context->GetTracer(), "ocr");
+    OCRSpan.SetArgument("file", m_InputFile);
+    OCRSpan.SetArgument("probe", "horizontal_axis");
+    OCRSpan.SetArgument("rotation", GetRotationTag(Rotation));
     if(!ExtractOCR(RotatedRawBandData, OCRBuffer, Rotation))
         return false;
+    OCRSpan.End();
+    OCRScope.Stop();
 
     // Look for words we would expect to see if oriented properly...
     if(OCRBuffer.find("AZ") != string::npos) return true;
@@ -239,15 +256,29 @@ bool VicarImageBand::CheckForLargeHistogramAndExtractText(
     const RotationType Rotation, 
     string &OCRBuffer)
 {
-    // Space for rotated raw band data...
+    // Space for rotated raw band data, accounted for as long as it is held...
     RawBandDataType RotatedRawBandData;
+    MemoryTracker::Reservation RotatedReservation(
+        m_Context->GetMemoryTracker(),
+        MemoryTracker::RasterBuffers,
+        GetTotalOriginalPixelSpace());
 
     // Rotated as requested...
+    Profiler::Scope RotateScope(m_Context->GetProfiler(), m_InputFile, "rotate");
     Rotate(Rotation, RawBandData, RotatedRawBandData);
+    RotateScope.Stop();
 
     // Extract the OCR text and check for error...
+    Profiler::Scope OCRScope(
+        m_Context->GetProfiler(), m_InputFile, "extract_ocr.large_histogram", GetRotationTag(Rotation));
+    Tracer::Span OCRSpan(m_Context->GetTracer(), "ocr");
+    OCRSpan.SetArgument("file", m_InputFile);
+    OCRSpan.SetArgument("probe", "large_histogram");
+    OCRSpan.SetArgument("rotation", GetRotationTag(Rotation));
     if(!ExtractOCR(RotatedRawBandData, OCRBuffer, Rotation))
         return false;
+    OCRSpan.End();
+    OCRScope.Stop();
 
     // Look for words we would expect to see if oriented properly...
     if(OCRBuffer.find("VIKING") != string::npos) return true;
@@ -264,6 +295,15 @@ bool VicarImageBand::CheckForLargeHistogramAndExtractText(
     else return false;
 }
 
+// Drop what is only needed while loading, such as the saved labels and the OCR
+//  cache, to shrink the descriptor while it waits to be reconstructed...
+void VicarImageBand::Compact()
+{
+    // Release the storage too, not just the contents...
+    string().swap(m_SavedLabelsBuffer);
+    RotationOCRCacheType().swap(m_RotationOCRCache);
+}
+
 // Examine image visually to determine things like suggested 
 //  orientation, optical character recognition, and histogram 
 //  detection, or set an error...
@@ -273,6 +313,12 @@ bool VicarImageBand::ExamineImageVisually()
     RawBandDataType RawBandData;
     RawBandDataType RotatedBandData;
 
+    // Account for the raw band data while it is examined...
+    MemoryTracker::Reservation RawReservation(
+        m_Context->GetMemoryTracker(),
+        MemoryTracker::RasterBuffers,
+        GetTotalOriginalPixelSpace());
+
     // Get the raw band data and check for error. No need to set an 
     //  error since callee does this...
     if(!GetRawBandData(RawBandData))
@@ -285,7 +331,7 @@ bool VicarImageBand::ExamineImageVisually()
         // Image needs to be rotated 90 degrees counterclockwise...
         if(CheckForLargeHistogramAndExtractText(RawBandData, None, m_OCRBuffer))
         {
-            Message(Console::Verbose) << _("image should be rotated 90 counterclockwise") << endl;
+            CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("image should be rotated 90 counterclockwise") << endl;
             m_Rotation = Rotate90;
             m_FullHistogramPresent = true;
             m_AxisPresent = true;
@@ -294,7 +340,7 @@ bool VicarImageBand::ExamineImageVisually()
         // Image needs to be rotated 180 degrees counterclockwise...
         else if(CheckForLargeHistogramAndExtractText(RawBandData, Rotate90, m_OCRBuffer))
         {
-            Message(Console::Verbose) << _("image should be rotated 180 counterclockwise") << endl;
+            CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("image should be rotated 180 counterclockwise") << endl;
             m_Rotation = Rotate180;
             m_FullHistogramPresent = true;
             m_AxisPresent = true;
@@ -303,7 +349,7 @@ bool VicarImageBand::ExamineImageVisually()
         // Image needs to be rotated 270 degrees counterclockwise...
         else if(CheckForLargeHistogramAndExtractText(RawBandData, Rotate180, m_OCRBuffer))
         {
-            Message(Console::Verbose) << _("image should be rotated 270 counterclockwise") << endl;
+            CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("image should be rotated 270 counterclockwise") << endl;
             m_Rotation = Rotate270;
             m_FullHistogramPresent = true;
             m_AxisPresent = true;
@@ -312,7 +358,7 @@ bool VicarImageBand::ExamineImageVisually()
         // Image does not need be rotated...
         else if(CheckForLargeHistogramAndExtractText(RawBandData, Rotate270, m_OCRBuffer))
         {
-            Message(Console::Verbose) << _("image does not need to be rotated") << endl;
+            CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("image does not need to be rotated") << endl;
             m_Rotation = None;
             m_FullHistogramPresent = true;
             m_AxisPresent = true;
@@ -325,7 +371,7 @@ bool VicarImageBand::ExamineImageVisually()
             // Image does not need be rotated...
             if(CheckForHorizontalAxisAndExtractText(RawBandData, None, m_OCRBuffer))
             {
-                Message(Console::Verbose) << _("image does not need to be rotated") << endl;
+                CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("image does not need to be rotated") << endl;
                 m_Rotation = None;
                 m_AxisPresent = true;
             }
@@ -333,7 +379,7 @@ bool VicarImageBand::ExamineImageVisually()
             // Image needs to be rotated 90 degrees counterclockwise...
             else if(CheckForHorizontalAxisAndExtractText(RawBandData, Rotate90, m_OCRBuffer))
             {
-                Message(Console::Verbose) << _("image should be rotated 90 counterclockwise") << endl;
+                CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("image should be rotated 90 counterclockwise") << endl;
                 m_Rotation = Rotate90;
                 m_AxisPresent = true;
             }
@@ -341,7 +387,7 @@ bool VicarImageBand::ExamineImageVisually()
             // Image needs to be rotated 180 degrees counterclockwise...
             else if(CheckForHorizontalAxisAndExtractText(RawBandData, Rotate180, m_OCRBuffer))
             {
-                Message(Console::Verbose) << _("image should be rotated 180 counterclockwise") << endl;
+                CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("image should be rotated 180 counterclockwise") << endl;
                 m_Rotation = Rotate180;
                 m_AxisPresent = true;
             }
@@ -349,7 +395,7 @@ bool VicarImageBand::ExamineImageVisually()
             // Image needs to be rotated 270 degrees counterclockwise...
             else if(CheckForHorizontalAxisAndExtractText(RawBandData, Rotate270, m_OCRBuffer))
             {
-                Message(Console::Verbose) << _("image should be rotated 270 counterclockwise") << endl;
+                CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("image should be rotated 270 counterclockwise") << endl;
                 m_Rotation = Rotate270;
                 m_AxisPresent = true;
             }
@@ -357,15 +403,15 @@ bool VicarImageBand::ExamineImageVisually()
             // No legible text hints found. Probably image without any axis or histogram overlay...
             else
             {
-                Message(Console::Warning) << _("could not guess image rotation") << endl;
+                m_Context->Message(Console::Warning) << _("could not guess image rotation") << endl;
                 m_Rotation = None;
                 m_OCRBuffer.clear();
             }
         }
 
-    // If autorotation isn't enabled, then leave rotation as none...
-    if(!Options::GetInstance().GetAutoRotate())
-        m_Rotation = None;
+    // Rotation is kept even if autorotation isn't enabled, since GetRotation()
+    //  and the transformed dimensions account for that themselves, and so a
+    //  band index remembers it regardless of the options it was built with...
 
     // Done...
     return true;
@@ -390,8 +436,9 @@ bool VicarImageBand::ExtractOCR(
         // Hit...
         if(CacheIterator != m_RotationOCRCache.end())
         {
-            // Alert user...
-            Message(Console::Verbose) << _("annotation cache hit optimization") << endl;
+            // Alert user and count it...
+            CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("annotation cache hit optimization") << endl;
+            m_Context->Count("viking_extractor_ocr_cache_hits_total");
             
             // Return the cached result...
             Extracted = CacheIterator->second;
@@ -402,11 +449,21 @@ bool VicarImageBand::ExtractOCR(
     const size_t Height = RawBandData.size();
     const size_t Width  = RawBandData.at(0).size();
 
-    // Initialize OCR library...
-    OCRAD_Descriptor *LibraryDescriptor = OCRAD_open();
+    // Account for the flattened copy and the library's own copy of it,
+    //  rescaled by a factor of three in each dimension...
+    MemoryTracker::Reservation ScratchReservation(
+        m_Context->GetMemoryTracker(),
+        MemoryTracker::OCRScratch,
+        Width * Height * (1 + 3 * 3));
+
+    // Start timing the pass, if anything is attached to its probe...
+    const uint64_t ProbeStart = PROBE_TIMESTAMP(ocr_pass);
+
+    // Initialize OCR library, or reuse a descriptor a daemon keeps open...
+    OCRAD_Descriptor *LibraryDescriptor = ResidentCache::OpenOCRDescriptor();
     
         // Fucked...
-        if(OCRAD_get_errno(LibraryDescriptor) != OCRAD_ok)
+        if(!LibraryDescriptor)
             SetErrorAndReturnFalse(_("GNU Ocrad failed to initialize"));
 
     // Load the raw image band data...
@@ -446,7 +503,7 @@ bool VicarImageBand::ExtractOCR(
     if(OCRAD_set_image(LibraryDescriptor, &OcrImage, true) != 0)
     {
         // Cleanup...
-        OCRAD_close(LibraryDescriptor);
+        ResidentCache::CloseOCRDescriptor(LibraryDescriptor);
 
         // Set error message...
         SetErrorAndReturnFalse(_("could not set OCR image"));
@@ -463,12 +520,18 @@ bool VicarImageBand::ExtractOCR(
     if(OCRAD_recognize(LibraryDescriptor, true) != 0)
     {
         // Cleanup...
-        OCRAD_close(LibraryDescriptor);
+        ResidentCache::CloseOCRDescriptor(LibraryDescriptor);
 
         // Set error message...
         SetErrorAndReturnFalse(_("OCR pass failed"));
     }
 
+    // Count the pass...
+    ++m_OCRPasses;
+    m_Context->Count(
+        "viking_extractor_ocr_passes_total",
+        Metrics::Label("rotation", GetRotationTag(RotationHint)));
+
     // Grab the text from each text block...
     for(int CurrentTextBlock = 0; 
         CurrentTextBlock < OCRAD_result_blocks(LibraryDescriptor); 
@@ -489,14 +552,19 @@ bool VicarImageBand::ExtractOCR(
     m_RotationOCRCache.insert(
         CacheIterator, RotationOCRCachePair(RotationHint, Extracted));
 
+    // Fire the probe...
+    PROBE4(ocr_pass,
+        m_InputFile.c_str(), GetRotationTag(RotationHint), Extracted.size(),
+        PROBE_ELAPSED(ProbeStart));
+
     // Be verbose...
-    Message(Console::Verbose) 
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) 
         << Extracted.size() 
         << _(" potential character annotations detected")
         << endl;
 
     // Cleanup...
-    OCRAD_close(LibraryDescriptor);
+    ResidentCache::CloseOCRDescriptor(LibraryDescriptor);
 
     // Return ok...
     return true;
@@ -560,6 +628,50 @@ int VicarImageBand::GetFileSize() const
     return zzip_tell(FileDescriptor);
 }
 
+// Get what loading found for a band index or run journal to remember, or
+//  return false if the outcome depended on more than the file itself, like a
+//  user filter...
+bool VicarImageBand::GetIndexEntry(BandIndex::EntryType &Entry) const
+{
+    // Not worth remembering...
+    if(!m_Indexable)
+        return false;
+
+    // Gather everything loading found...
+    Entry.m_AxisPresent                     = m_AxisPresent;
+    Entry.m_AzimuthElevation                = m_AzimuthElevation;
+    Entry.m_Bands                           = m_Bands;
+    Entry.m_BasicMetadataParserHeuristic    = m_BasicMetadataParserHeuristic;
+    Entry.m_BytesPerColour                  = m_BytesPerColour;
+    Entry.m_CameraEventLabel                = m_CameraEventLabel;
+    Entry.m_CameraEventLabelNoSol           = m_CameraEventLabelNoSol;
+    Entry.m_DiodeBandType                   = m_DiodeBandType;
+    Entry.m_DropoutRows                     = m_Statistics.GetDropoutRows();
+    Entry.m_ErrorMessage                    = m_ErrorMessage;
+    Entry.m_FileOrdinalOnMagneticTape       = m_FileOrdinalOnMagneticTape;
+    Entry.m_FullHistogramPresent            = m_FullHistogramPresent;
+    for(size_t Bin = 0; Bin < BAND_STATISTICS_HISTOGRAM_BINS; ++Bin)
+        Entry.m_Histogram[Bin] = m_Statistics.GetHistogramBin(Bin);
+    Entry.m_LanderNumber                    = m_LanderNumber;
+    Entry.m_MagneticTapeNumber              = m_MagneticTapeNumber;
+    Entry.m_Mean                            = m_Statistics.GetMean();
+    Entry.m_OCRBuffer                       = m_OCRBuffer;
+    Entry.m_Ok                              = m_Ok;
+    Entry.m_OriginalHeight                  = m_OriginalHeight;
+    Entry.m_OriginalWidth                   = m_OriginalWidth;
+    Entry.m_PhaseOffsetRequired             = m_PhaseOffsetRequired;
+    Entry.m_PhysicalRecordPadding           = m_PhysicalRecordPadding;
+    Entry.m_PhysicalRecordSize              = m_PhysicalRecordSize;
+    Entry.m_PixelFormat                     = m_PixelFormat;
+    Entry.m_RawImageOffset                  = m_RawImageOffset;
+    Entry.m_Rotation                        = m_Rotation;
+    Entry.m_SolarDay                        = m_SolarDay;
+    Entry.m_Variance                        = m_Statistics.GetVariance();
+
+    // Done...
+    return true;
+}
+
 // Get the input file name only without path...
 string VicarImageBand::GetInputFileNameOnly() const
 {
@@ -590,10 +702,44 @@ string VicarImageBand::GetLanderLocation() const
     }
 }
 
+// Estimate how many bytes the descriptor occupies, including what its strings
+//  and maps hold on the heap...
+size_t VicarImageBand::GetMemoryFootprint() const
+{
+    // Rough bookkeeping of each node of a map beyond its value...
+    const size_t MapNodeOverhead = 4 * sizeof(void *);
+
+    // The descriptor itself and its strings...
+    size_t Footprint = sizeof(*this);
+    Footprint += m_AzimuthElevation.capacity();
+    Footprint += m_CameraEventLabel.capacity();
+    Footprint += m_CameraEventLabelNoSol.capacity();
+    Footprint += m_ErrorMessage.capacity();
+    Footprint += m_InputFile.capacity();
+    Footprint += m_OCRBuffer.capacity();
+    Footprint += m_SavedLabelsBuffer.capacity();
+
+    // Its maps...
+    Footprint += m_BandTypeToFriendlyMap.size() *
+        (MapNodeOverhead + sizeof(BandTypeToFriendlyMap::value_type));
+    Footprint += m_TokenToBandTypeMap.size() *
+        (MapNodeOverhead + sizeof(TokenToBandTypeMap::value_type));
+    for(RotationOCRCacheType::const_iterator Iterator = m_RotationOCRCache.begin();
+        Iterator != m_RotationOCRCache.end();
+      ++Iterator)
+        Footprint += MapNodeOverhead + sizeof(RotationOCRCachePair) + Iterator->second.capacity();
+
+    // Done...
+    return Footprint;
+}
+
 // Get the raw band data transformed if autorotate was enabled. Use 
 //  GetTransformedWidth() / ...Height() to know adapted dimensions...
 bool VicarImageBand::GetRawBandData(VicarImageBand::RawBandDataType &RawBandData)
 {
+    // Time it...
+    Profiler::Scope Scope(m_Context->GetProfiler(), m_InputFile, "get_raw_band_data");
+
     // Clear caller's band data...
     RawBandData.clear();
 
@@ -612,30 +758,24 @@ bool VicarImageBand::GetRawBandData(VicarImageBand::RawBandDataType &RawBandData
     if(zzip_seek(FileDescriptor, m_RawImageOffset, SEEK_SET) == -1)
         SetErrorAndReturnFalse(_("file ended prematurely before raw image"));
 
-    // Clear the mean pixel value...
-    m_MeanPixelValue = 0.0f;
-
-    // Calculate inner bounding rectangle 1/3 image width and height to
-    //  sample mean pixel value. We do this to prevent sampling from
-    //  outside in the image overlay and histogram region...
-    const size_t    SampleRegion_Top    = m_OriginalHeight / 3;
-    const size_t    SampleRegion_Left   = m_OriginalWidth / 3;
-    const size_t    SampleRegion_Right  = (m_OriginalWidth / 3) * 2;
-    const size_t    SampleRegion_Bottom = (m_OriginalHeight / 3) * 2;
-    register size_t SampleRegionSize    = 0;
+    // Prepare to accumulate the band's quality statistics in the same pass
+    //  as it is read...
+    m_Statistics.Reset(m_OriginalWidth, m_OriginalHeight);
 
     // Preallocate the band data buffer since we should know already dimensions
     //  of image...
-    RawBandData.reserve(m_OriginalHeight);
+    RawBandData.resize(m_OriginalHeight);
+
+    // Start timing the read, if anything is attached to its probe...
+    const uint64_t ProbeStart = PROBE_TIMESTAMP(raw_read_done);
 
     // Read the whole image, row by row...
     for(size_t Y = 0; Y < m_OriginalHeight; ++Y)
     {
-        // The current row...
-        vector<uint8_t> CurrentRow;
-        
+        // The current row, read directly into the band data...
+        vector<uint8_t> &CurrentRow = RawBandData[Y];
+
         // Preallocate the row...
-        CurrentRow.reserve(m_OriginalWidth);
         CurrentRow.resize(m_OriginalWidth, 0xff);
 
         // Try to read the whole row in one pass...
@@ -646,83 +786,81 @@ bool VicarImageBand::GetRawBandData(VicarImageBand::RawBandDataType &RawBandData
             if((BytesRead != m_OriginalWidth) || !FileDescriptor.IsGood())
                 SetErrorAndReturnFalse(_("band data extraction i/o error"));
 
-        // Update mean pixel value...
-        for(size_t X = 0; X < m_OriginalWidth; ++X)
-        {
-            // Extract the current pixel value...
-            const uint8_t CurrentByte = CurrentRow.at(X);
-
-            // Check if within the pixel sample region...
-            if(X >= SampleRegion_Left  && 
-               X <= SampleRegion_Right &&
-               Y >= SampleRegion_Top   &&
-               Y <= SampleRegion_Bottom)
-            {
-                // Add to mean pixel value accumulator...
-                m_MeanPixelValue += CurrentByte;
-                SampleRegionSize++;
-            }
-        }
-
-        /* Read each pixel in this row, byte by byte...
-        for(size_t X = 0; X < m_OriginalWidth; ++X)
-        {
-            // Extract the current pixel value...
-            register uint8_t CurrentByte = 0xff;
-
-            // Check for error...
-            if((zzip_read(FileDescriptor, &CurrentByte, sizeof(CurrentByte)) 
-                    != sizeof(CurrentByte)) || !FileDescriptor.IsGood())
-                SetErrorAndReturnFalse(_("band data extraction i/o error"));
-
-            // Check if within the pixel sample region...
-            if(X >= SampleRegion_Left  && 
-               X <= SampleRegion_Right &&
-               Y >= SampleRegion_Top   &&
-               Y <= SampleRegion_Bottom)
-            {
-                // Add to mean pixel value accumulator...
-                m_MeanPixelValue += CurrentByte;
-                SampleRegionSize++;
-            }
-
-            // Add to row...
-            CurrentRow.push_back(CurrentByte);
-        }*/
-
-        // Add row to list of columns...
-        RawBandData.push_back(CurrentRow);
+        // Update statistics while the row is still hot in the cache...
+        m_Statistics.AccumulateRow(&CurrentRow.front(), Y);
     }
 
-    // Calculate the mean pixel value by dividing accumulator with 
-    //  total rectangle size...
-    m_MeanPixelValue /= SampleRegionSize;
+    // Count what was read and fire the probe...
+    CountBytesRead(FileDescriptor, m_OriginalHeight * m_OriginalWidth);
+    PROBE3(raw_read_done,
+        m_InputFile.c_str(), m_OriginalHeight * m_OriginalWidth,
+        PROBE_ELAPSED(ProbeStart));
+
+    // Calculate the mean pixel value, variance, and other derived 
+    //  statistics...
+    m_Statistics.Finalize();
 
     // Alert user if verbose mode enabled...
-    Message(Console::Verbose) << _("mean pixel value: ") << m_MeanPixelValue << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("mean pixel value: ") << m_Statistics.GetMean() << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("pixel value range: ") << static_cast<int>(m_Statistics.GetMinimum()) << " - " << static_cast<int>(m_Statistics.GetMaximum()) << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("dropout scanlines: ") << m_Statistics.GetDropoutRows() << endl;
 
     // Auto rotate was requested and requires a rotation...
-    if(Options::GetInstance().GetAutoRotate() && m_Rotation != None)
+    if(m_Context->GetOptions().GetAutoRotate() && m_Rotation != None)
     {
-        // Space for the rotated raw band data...
+        // Space for the rotated raw band data, accounted for while both
+        //  copies are held...
         RawBandDataType RotatedRawBandData;
+        MemoryTracker::Reservation RotatedReservation(
+            m_Context->GetMemoryTracker(),
+            MemoryTracker::RasterBuffers,
+            GetTotalOriginalPixelSpace());
 
         // Perform rotation...
+        Profiler::Scope RotateScope(m_Context->GetProfiler(), m_InputFile, "rotate");
         Rotate(m_Rotation, RawBandData, RotatedRawBandData);
+        RotateScope.Stop();
         
-        // Store result for caller...
-        RawBandData = RotatedRawBandData;
+        // Store result for caller, handing over the rotated copy rather than
+        //  copying it again...
+        RawBandData.swap(RotatedRawBandData);
     }
 
     // Done...
     return true;
 }
 
+// Get the rotation applied to the raw band data, or None if automatic rotation
+//  was disabled...
+VicarImageBand::RotationType VicarImageBand::GetRotation() const
+{
+    // Rotation is only applied when automatic rotation is enabled...
+    if(!m_Context->GetOptions().GetAutoRotate())
+        return None;
+
+    // Otherwise whatever was detected...
+    return m_Rotation;
+}
+
+// Get the angle of a rotation in degrees as text, to tag the profiling of work
+//  done at that rotation...
+const char *VicarImageBand::GetRotationTag(const RotationType Rotation)
+{
+    // Which rotation?
+    switch(Rotation)
+    {
+        case Rotate90:  return "90";
+        case Rotate180: return "180";
+        case Rotate270: return "270";
+        default:        return "0";
+    }
+}
+
 // Get image height, accounting for transformations like rotation...
 size_t VicarImageBand::GetTransformedHeight() const
 {
     // Depending on the rotation applied, if any, width and height can be swapped...
-    if(Options::GetInstance().GetAutoRotate() && (m_Rotation == Rotate90 || m_Rotation == Rotate270))
+    if(m_Context->GetOptions().GetAutoRotate() && (m_Rotation == Rotate90 || m_Rotation == Rotate270))
         return m_OriginalWidth;
     else
         return m_OriginalHeight;
@@ -732,7 +870,7 @@ size_t VicarImageBand::GetTransformedHeight() const
 size_t VicarImageBand::GetTransformedWidth() const
 {
     // Depending on the rotation applied, if any, width and height can be swapped...
-    if(Options::GetInstance().GetAutoRotate() && (m_Rotation == Rotate90 || m_Rotation == Rotate270))
+    if(m_Context->GetOptions().GetAutoRotate() && (m_Rotation == Rotate90 || m_Rotation == Rotate270))
         return m_OriginalHeight;
     else
         return m_OriginalWidth;
@@ -749,10 +887,34 @@ bool VicarImageBand::IsVicarTokenDiodeBandType(const string &DiodeBandTypeToken)
     return (Iterator != m_TokenToBandTypeMap.end());
 }
 
+// Count bytes read from the file in metrics, both inflated and as estimated to
+//  be stored on the media...
+void VicarImageBand::CountBytesRead(
+    const ZZipFileDescriptor &FileDescriptor,
+    const size_t InflatedBytes) const
+{
+    // Not keeping metrics...
+    if(!m_Context->GetMetrics())
+        return;
+
+    // Count...
+    m_Context->Count(
+        "viking_extractor_bytes_read_total",
+        Metrics::Label("kind", "inflated"),
+        InflatedBytes);
+    m_Context->Count(
+        "viking_extractor_bytes_read_total",
+        Metrics::Label("kind", "raw"),
+        static_cast<uint64_t>(InflatedBytes * FileDescriptor.GetStoredFraction()));
+}
+
 // Check if the header is at least readable, and if so, phase offset 
 //  required to decode file...
 bool VicarImageBand::IsHeaderIntact(size_t &PhaseOffsetRequired) const
 {
+    // Time it...
+    Profiler::Scope Scope(m_Context->GetProfiler(), m_InputFile, "is_header_intact");
+
     // Open the file...
     ZZipFileDescriptor FileDescriptor(Open());
 
@@ -838,40 +1000,68 @@ void VicarImageBand::Load()
     // Objects and variables...
     LogicalRecord   Record;
 
+    // Time it and trace it...
+    Profiler::Scope Scope(m_Context->GetProfiler(), m_InputFile, "load");
+    Tracer::Span Span(m_Context->GetTracer(), "load_band");
+    Span.SetArgument("file", m_InputFile);
+
     // Set the file name for console messages to be preceded with...
-    Console::GetInstance().SetCurrentFileName(GetInputFileNameOnly());
+    m_Context->GetConsole().SetCurrentFileName(GetInputFileNameOnly());
 
     // Be verbose...
-    Message(Console::Verbose) << _("loading") << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("loading") << endl;
+
+    // Whatever happens depends only on the file, unless it turns out
+    //  otherwise...
+    m_Indexable = true;
 
     // Open the file...
     ZZipFileDescriptor FileDescriptor(Open());
 
-        // Failed...
+        // Failed, perhaps only for now...
         if(!FileDescriptor.IsGood())
+        {
+            m_Indexable = false;
+            m_RejectionReason = "unreadable";
             SetErrorAndReturn(_("could not open input for reading"))
+        }
 
     // Check size...
     const int FileSize = GetFileSize();
 
         // Empty...
         if(FileSize == 0)
+        {
+            m_RejectionReason = "empty";
             SetErrorAndReturn(_("empty file, probably blank magnetic tape or not received back on Earth"))
+        }
 
         // Check to make sure it is at least four kilobytes...
         else if(FileSize < (4 * 1024))
+        {
+            m_RejectionReason = "too_small";
             SetErrorAndReturn(_("too small to be interesting (< 4 KB)"))
+        }
 
     // Check if the header is at least readable, and if so, retrieve phase 
     //  offset required to decode the file...
     if(!IsHeaderIntact(m_PhaseOffsetRequired))
+    {
+        m_RejectionReason = "not_vicar";
         SetErrorAndReturn(_("header is not intact, or not a VICAR file"))
+    }
     else if(m_PhaseOffsetRequired > 0)
-        Message(Console::Verbose) << _("header intact, but requires ") << m_PhaseOffsetRequired << _(" byte phase offset") << endl;
+    {
+        CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("header intact, but requires ") << m_PhaseOffsetRequired << _(" byte phase offset") << endl;
+        m_Context->Count("viking_extractor_phase_offsets_total");
+    }
 
     // Verify it's from one of the Viking Landers...
     if(!IsVikingLanderOrigin())
+    {
+        m_RejectionReason = "not_viking_lander";
         SetErrorAndReturn(_("did not originate from a Viking Lander"))
+    }
 
     // Extract the basic image metadata...
     ParseBasicMetadata(FileDescriptor);
@@ -886,13 +1076,17 @@ void VicarImageBand::Load()
     // Clear saved labels buffer, in case it already had data in it...
     m_SavedLabelsBuffer.clear();
 
+    // Time the walk through the physical records...
+    Profiler::Scope PhysicalRecordWalkScope(
+        m_Context->GetProfiler(), m_InputFile, "physical_record_walk");
+
     // Go through all physical records, parsing extended metadata, skipping past
     //  padding between physical records, and calculating the raw image data's 
     //  absolute offset...
     for(size_t PhysicalRecordIndex = 0; FileDescriptor.IsGood(); ++PhysicalRecordIndex)
     {
         // Verbosity...
-        Message(Console::Verbose)
+        CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose)
             << _("entering physical record ")
             << PhysicalRecordIndex + 1 
             << _(" starting at ")
@@ -915,7 +1109,7 @@ void VicarImageBand::Load()
           ++LocalLogicalRecordIndex)
         {
             // Verbosity...
-            Message(Console::Verbose) 
+            CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) 
                 << _("extracting logical record ") 
                 << LocalLogicalRecordIndex + 1 
                 << _("/5 starting at ")
@@ -933,7 +1127,7 @@ void VicarImageBand::Load()
             if(!Record.IsValidLabel())
             {
                 // Verbosity...
-                Message(Console::Error) 
+                m_Context->Message(Console::Error) 
                     << _("bad logical record terminator ")
                     << LocalLogicalRecordIndex + 1 
                     << _("/5 starting at ")
@@ -994,7 +1188,8 @@ void VicarImageBand::Load()
             {
                 // It was, so rewind and carry on since there is no 
                 //  physical record padding...
-                Message(Console::Verbose) << _("tangential physical record boundary detected, ignoring padding") << endl;
+                CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("tangential physical record boundary detected, ignoring padding") << endl;
+                m_Context->Count("viking_extractor_tangential_record_boundaries_total");
                 zzip_seek(FileDescriptor, CurrentPosition, SEEK_SET);
             }
             
@@ -1003,7 +1198,7 @@ void VicarImageBand::Load()
             else
             {
                 // Alert and seek...
-                Message(Console::Verbose) << _("seeking passed ") << m_PhysicalRecordPadding << _(" physical record padding") << endl;
+                CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("seeking passed ") << m_PhysicalRecordPadding << _(" physical record padding") << endl;
                 zzip_seek(FileDescriptor, CurrentPosition, SEEK_SET);
                 zzip_seek(FileDescriptor, m_PhysicalRecordPadding, SEEK_CUR);
             }
@@ -1013,11 +1208,14 @@ void VicarImageBand::Load()
     if(!FileDescriptor.IsGood())
         SetErrorAndReturn(_("unable to locate last logical record label"))
 
-    // Store raw image offset...
+    // Store raw image offset and count the headers walked to get there...
     m_RawImageOffset = zzip_tell(FileDescriptor);
+    PhysicalRecordWalkScope.Stop();
+    CountBytesRead(FileDescriptor, m_RawImageOffset);
+    Span.SetArgument("camera_event", m_CameraEventLabel);
 
     // Show user, if requested...
-    Message(Console::Verbose) << _("raw image offset: ") << m_RawImageOffset << hex << showbase << " (" << m_RawImageOffset << ")" << dec << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("raw image offset: ") << m_RawImageOffset << hex << showbase << " (" << m_RawImageOffset << ")" << dec << endl;
 
     // Calculate an absolute lower bound for file size...
     const int RequiredMinimumSize = 
@@ -1036,9 +1234,19 @@ void VicarImageBand::Load()
             << RequiredMinimumSize;
 
         // Set the error message and abort...
+        m_RejectionReason = "truncated";
         SetErrorAndReturn(ErrorStream.str());
     }
 
+    // Only planning, so stop at the header. Nothing the pixels would have
+    //  revealed is known, so this isn't worth remembering either...
+    if(m_Context->GetOptions().GetPlan())
+    {
+        m_Indexable = false;
+        m_Ok = true;
+        return;
+    }
+
     // Peform additional examination looking for things like histograms or other
     //  annotations, unless originating from broadband or solar PSAs which 
     //  didn't appear to contain any...
@@ -1063,14 +1271,106 @@ void VicarImageBand::Load()
     // Cleanup cache...
     m_RotationOCRCache.clear();
 
-    // Loaded ok...
+    // Loaded ok, tagged with the rotation actually applied...
+    Span.SetArgument("rotation", GetRotationTag(GetRotation()));
     m_Ok = true;
 }
 
+// Load from a band index instead of the file itself if it holds a current
+//  entry for it, setting error as loading the file did, or return false if it
+//  doesn't...
+bool VicarImageBand::LoadFromIndex(const BandIndex &Index)
+{
+    // Objects...
+    BandIndex::EntryType Entry;
+
+    // Look it up...
+    if(!Index.Find(m_InputFile, Entry))
+        return false;
+
+    // Load from it...
+    LoadFromIndexEntry(Entry);
+    return true;
+}
+
+// Load from what a band index or run journal remembered of loading the file
+//  before, setting error as loading the file did...
+void VicarImageBand::LoadFromIndexEntry(const BandIndex::EntryType &Entry)
+{
+    // Time it and trace it...
+    Profiler::Scope Scope(m_Context->GetProfiler(), m_InputFile, "load_from_index");
+    Tracer::Span Span(m_Context->GetTracer(), "load_band_from_index");
+    Span.SetArgument("file", m_InputFile);
+    Span.SetArgument("camera_event", Entry.m_CameraEventLabel);
+
+    // Set the file name for console messages to be preceded with...
+    m_Context->GetConsole().SetCurrentFileName(GetInputFileNameOnly());
+
+    // Be verbose...
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("loading from band index") << endl;
+
+    // Restore everything loading found...
+    m_AxisPresent                   = Entry.m_AxisPresent;
+    m_AzimuthElevation              = Entry.m_AzimuthElevation;
+    m_Bands                         = Entry.m_Bands;
+    m_BasicMetadataParserHeuristic  = Entry.m_BasicMetadataParserHeuristic;
+    m_BytesPerColour                = Entry.m_BytesPerColour;
+    m_CameraEventLabel              = Entry.m_CameraEventLabel;
+    m_CameraEventLabelNoSol         = Entry.m_CameraEventLabelNoSol;
+    m_DiodeBandType                 = static_cast<PSADiode>(Entry.m_DiodeBandType);
+    m_FileOrdinalOnMagneticTape     = Entry.m_FileOrdinalOnMagneticTape;
+    m_FullHistogramPresent          = Entry.m_FullHistogramPresent;
+    m_Indexable                     = true;
+    m_LanderNumber                  = Entry.m_LanderNumber;
+    m_MagneticTapeNumber            = Entry.m_MagneticTapeNumber;
+    m_OCRBuffer                     = Entry.m_OCRBuffer;
+    m_OriginalHeight                = Entry.m_OriginalHeight;
+    m_OriginalWidth                 = Entry.m_OriginalWidth;
+    m_PhaseOffsetRequired           = Entry.m_PhaseOffsetRequired;
+    m_PhysicalRecordPadding         = Entry.m_PhysicalRecordPadding;
+    m_PhysicalRecordSize            = Entry.m_PhysicalRecordSize;
+    m_PixelFormat                   = Entry.m_PixelFormat;
+    m_RawImageOffset                = Entry.m_RawImageOffset;
+    m_Rotation                      = static_cast<RotationType>(Entry.m_Rotation);
+    m_SolarDay                      = Entry.m_SolarDay;
+    m_Statistics.Restore(
+        Entry.m_Mean, Entry.m_Variance, Entry.m_DropoutRows, Entry.m_Histogram);
+
+    // It failed to load the same way last time, for a reason that was not
+    //  remembered...
+    if(!Entry.m_Ok)
+    {
+        m_RejectionReason = "indexed";
+        SetErrorAndReturn(Entry.m_ErrorMessage)
+    }
+
+    // User filters are never indexed, so check them now...
+    if(m_Context->GetOptions().GetFilterLander() != 0 &&
+       m_Context->GetOptions().GetFilterLander() != m_LanderNumber)
+        SetErrorMessage(_("filtering non-matching lander"));
+    else if(m_Context->GetOptions().GetFilterSolarDay() != numeric_limits<size_t>::max() &&
+            m_Context->GetOptions().GetFilterSolarDay() != m_SolarDay)
+        SetErrorMessage(_("filtering non-matching solar day"));
+    else if(!m_Context->GetOptions().GetFilterCameraEvent().empty() &&
+            m_Context->GetOptions().GetFilterCameraEvent() != m_CameraEventLabelNoSol)
+        SetErrorMessage(_("filtering non-matching camera event"));
+
+    // Remember why, if filtered...
+    if(IsError())
+        m_RejectionReason = "filtered";
+
+    // Otherwise loaded ok...
+    else
+        m_Ok = true;
+}
+
 // Get a file stream to access the raw file. Returned handle tests as false if 
 //  error...
 ZZipFileDescriptor VicarImageBand::Open() const
 {
+    // Time it...
+    Profiler::Scope Scope(m_Context->GetProfiler(), m_InputFile, "open");
+
     // Is this an archive? If so, open it as such...
     if(fnmatch(FNMATCH_ANY_ZIP ":/*", m_InputFile.c_str(), 0) == 0)
     {
@@ -1127,7 +1427,14 @@ bool VicarImageBand::operator<(const VicarImageBand &RightSide) const
         (m_DiodeBandType != Broadband4) &&  
         (m_DiodeBandType != Survey) && 
         (m_DiodeBandType != Sun))
-        return (m_MeanPixelValue < RightSide.m_MeanPixelValue);
+    {
+        // Equally bright, so the one missing fewer scanlines is better...
+        if(GetMeanPixelValue() == RightSide.GetMeanPixelValue())
+            return (m_Statistics.GetDropoutRows() > RightSide.m_Statistics.GetDropoutRows());
+
+        // Otherwise the brighter...
+        return (GetMeanPixelValue() < RightSide.GetMeanPixelValue());
+    }
 
     // If the PSA is broadband, survey, or solar, pick the one that is better...
     else
@@ -1135,7 +1442,7 @@ bool VicarImageBand::operator<(const VicarImageBand &RightSide) const
         // If they both cover the same number of pixels, select the one that is
         //  brighter...
         if(GetTotalOriginalPixelSpace() == RightSide.GetTotalOriginalPixelSpace())
-            return (m_MeanPixelValue < RightSide.m_MeanPixelValue);
+            return (GetMeanPixelValue() < RightSide.GetMeanPixelValue());
         
         // Otherwise select the one that covers a greater pixel area...
         else
@@ -1161,6 +1468,9 @@ void VicarImageBand::ParseBasicMetadata(ZZipFileDescriptor &FileDescriptor)
     size_t          TokenIndex          = 0;
     size_t          TokenLength[32];
 
+    // Time it...
+    Profiler::Scope Scope(m_Context->GetProfiler(), m_InputFile, "parse_basic_metadata");
+
     // Stream should have already been validated...
     assert(FileDescriptor.IsGood());
 
@@ -1433,17 +1743,17 @@ void VicarImageBand::ParseBasicMetadata(ZZipFileDescriptor &FileDescriptor)
             SetErrorAndReturn(_("unsupported colour bit depth"))
 
     // If verbosity is set, display basic metadata...
-    Message(Console::Verbose) << _("basic metadata parser heuristic: ") << m_BasicMetadataParserHeuristic << endl;
-    Message(Console::Verbose) << _("bands: ") << m_Bands << endl;
-    Message(Console::Verbose) << _("height: ") << m_OriginalHeight << endl;
-    Message(Console::Verbose) << _("width: ") << m_OriginalWidth << endl;
-    Message(Console::Verbose) << _("raw band data size: ") << m_OriginalWidth * m_OriginalHeight * m_BytesPerColour << _(" bytes") << endl;
-    Message(Console::Verbose) << _("file size: ") << GetFileSize() << _(" bytes") << endl;
-    Message(Console::Verbose) << _("format: integral") << endl;
-    Message(Console::Verbose) << _("bytes per colour: ") << m_BytesPerColour << endl;
-    Message(Console::Verbose) << _("photosensor diode band type: ") << GetDiodeBandTypeFriendlyString() << endl;
-    Message(Console::Verbose) << _("physical record size: ") << m_PhysicalRecordSize << hex << showbase << " (" << m_PhysicalRecordSize<< ")" << endl;
-    Message(Console::Verbose) << _("possible physical record padding: ")  << dec << m_PhysicalRecordPadding << hex << showbase << " (" << m_PhysicalRecordPadding<< ")" << dec << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("basic metadata parser heuristic: ") << m_BasicMetadataParserHeuristic << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("bands: ") << m_Bands << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("height: ") << m_OriginalHeight << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("width: ") << m_OriginalWidth << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("raw band data size: ") << m_OriginalWidth * m_OriginalHeight * m_BytesPerColour << _(" bytes") << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("file size: ") << GetFileSize() << _(" bytes") << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("format: integral") << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("bytes per colour: ") << m_BytesPerColour << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("photosensor diode band type: ") << GetDiodeBandTypeFriendlyString() << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("physical record size: ") << m_PhysicalRecordSize << hex << showbase << " (" << m_PhysicalRecordSize<< ")" << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("possible physical record padding: ")  << dec << m_PhysicalRecordPadding << hex << showbase << " (" << m_PhysicalRecordPadding<< ")" << dec << endl;
 
     // Basic metadata in theory should be enough to extract the band data...
     m_Ok = true;
@@ -1470,7 +1780,7 @@ void VicarImageBand::ParseBasicMetadataImplementation_Format1(
     char    DummyCharacter  = 0;
 
     // Alert user if verbose enabled...
-    Message(Console::Verbose) << _("heuristics selected format 1 basic metadata parser") << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("heuristics selected format 1 basic metadata parser") << endl;
 
     // Initialize a tokenizer, seeking passed two byte binary marker...
     stringstream Tokenizer(HeaderRecord.GetString(true, 2));
@@ -1541,7 +1851,7 @@ void VicarImageBand::ParseBasicMetadataImplementation_Format2(
     char    DummyCharacter  = 0;
 
     // Alert user if verbose enabled...
-    Message(Console::Verbose) << _("heuristics selected format 2 basic metadata parser") << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("heuristics selected format 2 basic metadata parser") << endl;
 
     // Initialize a tokenizer, seeking passed two byte binary marker...
     stringstream Tokenizer(HeaderRecord.GetString(true, 2));
@@ -1625,7 +1935,7 @@ void VicarImageBand::ParseBasicMetadataImplementation_Format3(
     string  Token;
 
     // Alert user if verbose enabled...
-    Message(Console::Verbose) << _("heuristics selected format 3 basic metadata parser") << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("heuristics selected format 3 basic metadata parser") << endl;
 
     // Initialize a tokenizer, seeking passed two byte binary marker...
     stringstream Tokenizer(HeaderRecord.GetString(true, 2));
@@ -1693,7 +2003,7 @@ void VicarImageBand::ParseBasicMetadataImplementation_Format4(
     string  Token;
 
     // Alert user if verbose enabled...
-    Message(Console::Verbose) << _("heuristics selected format 4 basic metadata parser") << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("heuristics selected format 4 basic metadata parser") << endl;
 
     // Initialize a tokenizer, seeking passed two byte binary marker...
     stringstream Tokenizer(HeaderRecord.GetString(true, 2));
@@ -1762,7 +2072,7 @@ void VicarImageBand::ParseBasicMetadataImplementation_Format5(
     string  Token;
 
     // Alert user if verbose enabled...
-    Message(Console::Verbose) << _("heuristics selected format 5 basic metadata parser") << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("heuristics selected format 5 basic metadata parser") << endl;
 
     // Initialize a tokenizer, seeking passed two byte binary marker...
     stringstream Tokenizer(HeaderRecord.GetString(true, 2));
@@ -1831,7 +2141,7 @@ void VicarImageBand::ParseBasicMetadataImplementation_Format6(
     char    Buffer[1024] = {0};
 
     // Alert user if verbose enabled...
-    Message(Console::Verbose) << _("heuristics selected format 6 basic metadata parser") << endl;
+    CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("heuristics selected format 6 basic metadata parser") << endl;
 
     // Initialize a tokenizer, seeking passed two byte binary marker...
     stringstream Tokenizer(HeaderRecord.GetString(true, 2));
@@ -1915,7 +2225,7 @@ void VicarImageBand::ParseExtendedMetadata(
             m_AzimuthElevation = Record.GetString(true);
 
             // Alert user if verbose mode enabled...
-            Message(Console::Verbose) << _("psa directional vector: ") << m_AzimuthElevation << endl;
+            CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("psa directional vector: ") << m_AzimuthElevation << endl;
         }
         
         // Possibly camera event label...
@@ -1930,7 +2240,7 @@ void VicarImageBand::ParseExtendedMetadata(
                 // Store the label...
                 Tokenizer >> Token;
                 SetCameraEventLabel(Token);
-                Message(Console::Verbose) << _("camera event label: ") << m_CameraEventLabel << endl;
+                CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) << _("camera event label: ") << m_CameraEventLabel << endl;
             }
 
             // Not a camera event, restore the token...
@@ -1953,17 +2263,21 @@ void VicarImageBand::ParseExtendedMetadata(
 
                 // Check validity...
                 if(m_LanderNumber > 2)
-                    Message(Console::Warning) << _("bad lander number") << endl;
+                    m_Context->Message(Console::Warning) << _("bad lander number") << endl;
 
                 // Be verbose if requested...
-                Message(Console::Verbose) 
+                CONSOLE_MESSAGE(m_Context->GetConsole(), Console::Verbose) 
                     << _("lander number: ") << m_LanderNumber 
                     << " (" << GetLanderLocation() << ")" << endl;
 
                 // Check for matching lander number, if user filtered...
-                if(Options::GetInstance().GetFilterLander() != 0 &&
-                   Options::GetInstance().GetFilterLander() != m_LanderNumber)
+                if(m_Context->GetOptions().GetFilterLander() != 0 &&
+                   m_Context->GetOptions().GetFilterLander() != m_LanderNumber)
+                {
+                    m_Indexable = false;
+                    m_RejectionReason = "filtered";
                     SetErrorAndReturn(_("filtering non-matching lander"))
+                }
             }
 
             // Not a camera event, restore the token...
@@ -2127,14 +2441,34 @@ void VicarImageBand::SetCameraEventLabel(const string &CameraEventLabel)
         m_SolarDay = atoi(SolarDay.c_str());
 
     // Check for matching solar day, if user filtered...
-    if(Options::GetInstance().GetFilterSolarDay() != numeric_limits<size_t>::max() && 
-       Options::GetInstance().GetFilterSolarDay() != m_SolarDay)
+    if(m_Context->GetOptions().GetFilterSolarDay() != numeric_limits<size_t>::max() && 
+       m_Context->GetOptions().GetFilterSolarDay() != m_SolarDay)
+    {
+        m_Indexable = false;
+        m_RejectionReason = "filtered";
         SetErrorAndReturn(_("filtering non-matching solar day"))
+    }
 
     // Check for matching camera event, if user filtered...
-    if(!Options::GetInstance().GetFilterCameraEvent().empty() && 
-       Options::GetInstance().GetFilterCameraEvent() != m_CameraEventLabelNoSol)
+    if(!m_Context->GetOptions().GetFilterCameraEvent().empty() && 
+       m_Context->GetOptions().GetFilterCameraEvent() != m_CameraEventLabelNoSol)
+    {
+        m_Indexable = false;
+        m_RejectionReason = "filtered";
         SetErrorAndReturn(_("filtering non-matching camera event"))
+    }
+}
+
+// Remember what loading found in a band index, unless the outcome depended on
+//  more than the file itself, like a user filter...
+void VicarImageBand::StoreInIndex(BandIndex &Index) const
+{
+    // Objects...
+    BandIndex::EntryType Entry;
+
+    // Remember it, if worth remembering...
+    if(GetIndexEntry(Entry))
+        Index.Insert(m_InputFile, Entry);
 }
 
 // Mirror the band data from left to right...
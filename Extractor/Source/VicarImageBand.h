@@ -26,6 +26,8 @@
 // Includes...
 
     // Our headers...
+    #include "BandIndex.h"
+    #include "BandStatistics.h"
     #include "LogicalRecord.h"
     #include "ZZipFileDescriptor.h"
 
@@ -46,6 +48,7 @@
     #define N_(str) gettext_noop (str)
 
 // Forward declarations...
+class ExtractionContext;
 class ZZipFileDescriptor;
 
 // 1970s era VICAR image class...
@@ -115,8 +118,15 @@ class VicarImageBand
     // Public methods...
     public:
 
-        // Construct...
-        VicarImageBand(const std::string &InputFile);
+        // Construct within the context of the extraction it belongs to...
+        VicarImageBand(
+            const ExtractionContext &Context,
+            const std::string &InputFile);
+
+        // Drop what is only needed while loading, such as the saved labels
+        //  and the OCR cache, to shrink the descriptor while it waits to be
+        //  reconstructed...
+        void Compact();
 
         // Get the azimuth / elevation string...
         const std::string &GetAzimuthElevation() const { return m_AzimuthElevation; }
@@ -143,6 +153,11 @@ class VicarImageBand
         // Get the file size, or -1 on error...
         int GetFileSize() const;
 
+        // Get what loading found for a band index or run journal to
+        //  remember, or return false if the outcome depended on more than
+        //  the file itself, like a user filter...
+        bool GetIndexEntry(BandIndex::EntryType &Entry) const;
+
         // Get the input file name with full path...
         const std::string &GetInputFileName() const { return m_InputFile; }
 
@@ -159,7 +174,11 @@ class VicarImageBand
         size_t GetMagneticTapeNumber() const { return m_MagneticTapeNumber; }
 
         // Get the mean pixel value of the inner rectangle...
-        float GetMeanPixelValue() const { return m_MeanPixelValue; }
+        float GetMeanPixelValue() const { return m_Statistics.GetMean(); }
+
+        // Estimate how many bytes the descriptor occupies, including what
+        //  its strings and maps hold on the heap...
+        size_t GetMemoryFootprint() const;
 
         // Get the Martian month of this camera event...
         std::string GetMonth() const;
@@ -167,6 +186,10 @@ class VicarImageBand
         // Get the OCR buffer...
         const std::string &GetOCRBuffer() const { return m_OCRBuffer; }
 
+        // Get the number of OCR passes examining the band took, not counting
+        //  those answered from the cache...
+        size_t GetOCRPasses() const { return m_OCRPasses; }
+
         // Get original image width and height, not accounting for rotation...
         size_t GetOriginalHeight() const { return m_OriginalHeight; }
         size_t GetOriginalWidth() const { return m_OriginalWidth; }
@@ -184,6 +207,22 @@ class VicarImageBand
         // Get the raw image offset...
         size_t GetRawImageOffset() const { return m_RawImageOffset; }
 
+        // Get a short, untranslated reason the band was rejected for, if it
+        //  was, to count rejections by in metrics...
+        const char *GetRejectionReason() const { return m_RejectionReason; }
+
+        // Get the rotation applied to the raw band data, or None if automatic
+        //  rotation was disabled...
+        RotationType GetRotation() const;
+
+        // Get the angle of a rotation in degrees as text, to tag the
+        //  profiling of work done at that rotation...
+        static const char *GetRotationTag(const RotationType Rotation);
+
+        // Get the quality statistics gathered the last time the raw band data
+        //  was read...
+        const BandStatistics &GetStatistics() const { return m_Statistics; }
+
         // Get the solar day the image was taken on...
         size_t GetSolarDay() const { return m_SolarDay; }
 
@@ -215,6 +254,15 @@ class VicarImageBand
         // Load as much of the file as possible, setting error on failure...
         void Load();
 
+        // Load from a band index instead of the file itself if it holds a
+        //  current entry for it, setting error as loading the file did, or
+        //  return false if it doesn't...
+        bool LoadFromIndex(const BandIndex &Index);
+
+        // Load from what a band index or run journal remembered of loading
+        //  the file before, setting error as loading the file did...
+        void LoadFromIndexEntry(const BandIndex::EntryType &Entry);
+
         // For comparing quality between images of the same camera event and same band type...
         bool operator<(const VicarImageBand &RightSide) const;
 
@@ -224,6 +272,10 @@ class VicarImageBand
         //  that probably denotes an unsupported diode type...
         PSADiode ProbeDiodeBandType(std::string &DiodeBandTypeHint) const;
 
+        // Remember what loading found in a band index, unless the outcome
+        //  depended on more than the file itself, like a user filter...
+        void StoreInIndex(BandIndex &Index) const;
+
     // Protected methods...
     protected:
 
@@ -259,6 +311,12 @@ class VicarImageBand
         // Get the photosensor diode band type from VICAR token... (e.g. "RED/T")
         PSADiode GetDiodeBandTypeFromVicarToken(const std::string &DiodeBandTypeToken) const;
 
+        // Count bytes read from the file in metrics, both inflated and as
+        //  estimated to be stored on the media...
+        void CountBytesRead(
+            const ZZipFileDescriptor &FileDescriptor,
+            const size_t InflatedBytes) const;
+
         // Check if the header is at least readable, and if so, phase offset
         //  required to decode file...
         bool IsHeaderIntact(size_t &PhaseOffsetRequired) const;
@@ -342,6 +400,9 @@ class VicarImageBand
         // Bytes per pixel...
         int                     m_BytesPerColour;
 
+        // Context of the extraction the band belongs to...
+        const ExtractionContext *m_Context;
+
         // Camera event label...
         std::string             m_CameraEventLabel;
 
@@ -360,6 +421,10 @@ class VicarImageBand
         // True if the image has a full histogram present...
         bool                    m_FullHistogramPresent;
 
+        // True if the outcome of the last load depended only on the file
+        //  itself, and so can be remembered in a band index...
+        bool                    m_Indexable;
+
         // Input file name...
         std::string             m_InputFile;
 
@@ -369,14 +434,12 @@ class VicarImageBand
         // Magnetic tape number this originated on...
         size_t                  m_MagneticTapeNumber;
 
-        // Pixel mean value of centre rectange which is 1/3 length and
-        //  width of image. We do this to prevent sampling from outside
-        //  in the image overlay and histogram region...
-        float                   m_MeanPixelValue;
-
         // Any OCR text that happened to be extracted...
         std::string             m_OCRBuffer;
 
+        // OCR passes performed, not counting cache hits...
+        size_t                  m_OCRPasses;
+
         // True if the file is probably extractable...
         bool                    m_Ok;
 
@@ -399,6 +462,9 @@ class VicarImageBand
         // Raw image offset...
         size_t                  m_RawImageOffset;
 
+        // Short, untranslated reason the band was rejected for, if it was...
+        const char             *m_RejectionReason;
+
         // Counterclockwise rotation to orient image properly which is
         //  always 0, 90, 180, or 270...
         RotationType            m_Rotation;
@@ -412,6 +478,10 @@ class VicarImageBand
         // Solar day image was taken on...
         size_t                  m_SolarDay;
 
+        // Quality statistics, such as the pixel mean value of the centre
+        //  rectangle, histogram, and dropout scanlines...
+        BandStatistics          m_Statistics;
+
         // Token to band type map...
         TokenToBandTypeMap      m_TokenToBandTypeMap;
 };
@@ -26,17 +26,22 @@
 
     // Our headers...
     #include "Console.h"
+    #include "ExtractionContext.h"
+    #include "MediaEmulator.h"
+    #include "Metrics.h"
     #include "VikingExtractor.h"
     #include "VicarImageAssembler.h"
     #include "VicarImageBand.h"
 #ifdef USE_DBUS_INTERFACE
     #include "DBusInterface.h"
+    #include "ResidentCache.h"
 #endif
 
     // Standard C++ / POSIX system headers...
     #include <cassert>
     #include <iostream>
     #include <string>
+    #include <vector>
     #include <cstring>
     #include <cstdlib>
     #include <getopt.h>
@@ -73,6 +78,15 @@ void ShowHelp()
          <<   "      --dry-run\n"
          << _("\
                               Don't write anything.\n")
+         <<   "      --emulate-media=media\n"
+         << _("\
+                              Read the input as though from slower media, to\n\
+                              benchmark access patterns, being dvd for an 8x\n\
+                              DVD drive, network for disks shared over 100\n\
+                              Mbit/s, or seek milliseconds and bytes per\n\
+                              second with an optional K, M, or G suffix, such\n\
+                              as 100:10M. A daemon reads every job through the\n\
+                              media it was started with.\n")
          <<   "      --help\n"
          << _("\
                               Show this help.\n")
@@ -80,9 +94,19 @@ void ShowHelp()
          << _("\
                               Don't stop on corrupt or problematic input file,\n\
                               but continue extraction of other files.\n")
+         <<   "      --index=file\n"
+         << _("\
+                              Load bands from, and remember them in, an index\n\
+                              so later runs over the same inputs need only\n\
+                              read the files they take pixels from.\n")
          <<   "      --interlace\n"
          << _("\
                               Encode output with Adam7 interlacing\n")
+         <<   "      --io-threads=threads\n"
+         << _("\
+                              Number of threads to write output files on in\n\
+                              the background, 2 by default, or 0 to write them\n\
+                              as soon as they are encoded.\n")
          <<   "  -j, --jobs[=threads]\n"
          << _("\
                               Number of threads to run parallelized. Only one\n\
@@ -105,10 +129,37 @@ void ShowHelp()
          << _("\
                               Look only for camera events taken on the specified\n\
                               solar day.\n")
+         <<   "      --fsync=policy\n"
+         << _("\
+                              Flush output files to stable storage never with\n\
+                              none (default), before publishing each with file,\n\
+                              or also flush its directory with full.\n")
          <<   "      --generate-metadata\n"
          << _("\
                               Whenever a colour image is recovered, machine\n\
                               generate a text file containing various metadata.\n")
+         <<   "      --memory-limit=size\n"
+         << _("\
+                              Limit the band descriptors, pixel buffers, OCR\n\
+                              scratch, and staged output an extraction holds\n\
+                              at once to size bytes, with an optional K, M, or\n\
+                              G suffix, by writing output synchronously and\n\
+                              deflating serially when it would be exceeded.\n")
+         <<   "      --metadata-format=format\n"
+         << _("\
+                              Generate metadata as a txt file beside each\n\
+                              image (default), or as a single csv or jsonl\n\
+                              catalogue for the whole run.\n")
+         <<   "      --metrics=file\n"
+         << _("\
+                              Count files, bands, OCR passes, bytes read, and\n\
+                              camera events, and time each stage, writing them\n\
+                              to file as a Prometheus textfile.\n")
+         <<   "      --metrics-socket=path\n"
+         << _("\
+                              Serve the same metrics over a Unix domain socket\n\
+                              at path for as long as running, such as when\n\
+                              staying resident as a daemon.\n")
          <<   "      --no-ansi-colours\n"
          << _("\
                               Disable VT/100 ANSI coloured terminal output.\n")
@@ -119,18 +170,60 @@ void ShowHelp()
          << _("\
                               Don't attempt to reconstruct camera events, just\n\
                               dump all available band data as separate images.\n")
+         <<   "      --output-archive=file\n"
+         << _("\
+                              Write all output into a single .zip or .tar\n\
+                              archive instead of the output directory, with\n\
+                              the directory layout kept as member paths.\n")
+         <<   "      --output-format=format\n"
+         << _("\
+                              Write images as png (default), pnm for binary\n\
+                              PGM or PPM, or raw for raw planar bytes with a\n\
+                              .hdr sidecar describing them.\n")
          <<   "      --overwrite\n"
          << _("\
                               Overwrite any existing output files.\n")
+         <<   "      --parallel-deflate\n"
+         << _("\
+                              Compress PNG image data in independent chunks on\n\
+                              as many threads as --jobs, still producing a\n\
+                              single valid PNG.\n")
+         <<   "      --plan\n"
+         << _("\
+                              Only parse headers and print each camera event\n\
+                              found, its candidate bands, and the outputs that\n\
+                              would be written or dumped. Implies --dry-run.\n")
+         <<   "      --png-profile=settings\n"
+         << _("\
+                              Comma separated PNG encoding settings, being\n\
+                              level from 0 to 9, strategy of default,\n\
+                              filtered, huffman, rle, or fixed, and filter of\n\
+                              none, sub, up, average, paeth, or adaptive, such\n\
+                              as level=9,filter=paeth.\n")
+         <<   "      --profile=file\n"
+         << _("\
+                              Time each stage of the extraction, write the\n\
+                              timings per file and for the whole run to file\n\
+                              as JSON, and list the slowest files at the end.\n")
          <<   "  -r, --recursive\n"
          << _("\
                               Scan subfolders as well if input is a directory.\n")
+         <<   "      --resume\n"
+         << _("\
+                              Resume from the journal an interrupted run kept\n\
+                              in the output directory, redoing only camera\n\
+                              events that didn't finish or whose input bands\n\
+                              changed since.\n")
          <<   "      --summarize-only\n"
          << _("\
                               Show summary of progress and final results only.\n")
          <<   "      --suppress\n"
          << _("\
                               Suppress all warnings and errors.\n")
+         <<   "      --trace=file\n"
+         << _("\
+                              Write a timeline of the work each thread did to\n\
+                              file as Chrome trace event JSON.\n")
          <<   "  -V, --verbose\n"
          << _("\
                               Be verbose\n")
@@ -158,271 +251,596 @@ warranty; not even for MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.\n\n"
     cout << _("Configured with: ") << CONFIGURATION_FLAGS << endl;
 }
 
-// Some cleanup code to run on termination...
-static void AtExitCleanup()
+// Enumerator of long command line option identifiers...
+enum option_long_enum
 {
-    // Explicit instantiation of several subsystem singletons need to now be
-    //  explicitly deconstructed. Order matters...
 #ifdef USE_DBUS_INTERFACE
-    DBusInterface::DestroySingleton();
+    option_long_daemon = 256, /* To ensure no clashes with short option char identifiers */
+    option_long_directorize_band_class,
+#else
+    option_long_directorize_band_class = 256, /* To ensure no clashes with short option char identifiers */
 #endif
-    Options::DestroySingleton();
-    Console::DestroySingleton();
-}
-
-// Entry point...
-int main(int ArgumentCount, char *Arguments[])
+    option_long_directorize_location,
+    option_long_directorize_month,
+    option_long_directorize_sol,
+    option_long_dry_run,
+    option_long_emulate_media,
+    option_long_filter_camera_event,
+    option_long_filter_diode_class,
+    option_long_filter_lander,
+    option_long_filter_solar_day,
+    option_long_fsync,
+    option_long_generate_metadata,
+    option_long_help,
+    option_long_ignore_bad_files,
+    option_long_index,
+    option_long_interlace,
+    option_long_io_threads,
+    option_long_jobs,
+    option_long_memory_limit,
+    option_long_metadata_format,
+    option_long_metrics,
+    option_long_metrics_socket,
+    option_long_no_ansi_colours,
+    option_long_no_auto_rotate,
+    option_long_no_reconstruct,
+    option_long_output_archive,
+    option_long_output_format,
+    option_long_overwrite,
+    option_long_parallel_deflate,
+    option_long_plan,
+    option_long_png_profile,
+    option_long_profile,
+    option_long_recursive,
+#ifdef USE_DBUS_INTERFACE
+    option_long_remote_start,
+#endif
+    option_long_resume,
+#ifdef USE_DBUS_INTERFACE
+    option_long_signal_rate,
+#endif
+    option_long_summarize_only,
+    option_long_suppress,
+    option_long_trace,
+    option_long_verbose,
+    option_long_version
+};
+
+// Command line option structure...
+static option CommandLineLongOptions[] =
 {
-    // Variables...
-    int         OptionCharacter             = '\x0';
-    int         OptionIndex                 = 0;
-    string      InputFileOrRootDirectory;
-    string      OutputRootDirectory;
-
-    // Some user options...
-    bool        VerboseConsole              = false;
-
-    // Explicit instantiation of several subsystem singletons. Order matters...
-    Console::CreateSingleton();
-    Options::CreateSingleton();
 #ifdef USE_DBUS_INTERFACE
-    DBusInterface::CreateSingleton();
+    /* No need to document since only relevant to VLR */
+    {"daemon",                  no_argument,        NULL,   option_long_daemon},
 #endif
-
-    // Cleanup code to run on termination...
-    atexit(AtExitCleanup);
-
-    // Enumerator of long command line option identifiers...
-    enum option_long_enum
-    {
-        option_long_directorize_band_class = 256, /* To ensure no clashes with short option char identifiers */
-        option_long_directorize_location,
-        option_long_directorize_month,
-        option_long_directorize_sol,
-        option_long_dry_run,
-        option_long_filter_camera_event,
-        option_long_filter_diode_class,
-        option_long_filter_lander,
-        option_long_filter_solar_day,
-        option_long_generate_metadata,
-        option_long_help,
-        option_long_ignore_bad_files,
-        option_long_interlace,
-        option_long_jobs,
-        option_long_no_ansi_colours,
-        option_long_no_auto_rotate,
-        option_long_no_reconstruct,
-        option_long_overwrite,
-        option_long_recursive,
+    {"directorize-band-class",  no_argument,        NULL,   option_long_directorize_band_class},
+    {"directorize-location",    no_argument,        NULL,   option_long_directorize_location},
+    {"directorize-month",       no_argument,        NULL,   option_long_directorize_month},
+    {"directorize-sol",         no_argument,        NULL,   option_long_directorize_sol},
+    {"dry-run",                 no_argument,        NULL,   option_long_dry_run},
+    {"emulate-media",           required_argument,  NULL,   option_long_emulate_media},
+    {"filter-camera-event",     required_argument,  NULL,   option_long_filter_camera_event},
+    {"filter-diode",            required_argument,  NULL,   option_long_filter_diode_class},
+    {"filter-lander",           required_argument,  NULL,   option_long_filter_lander},
+    {"filter-solar-day",        required_argument,  NULL,   option_long_filter_solar_day},
+    {"fsync",                   required_argument,  NULL,   option_long_fsync},
+    {"generate-metadata",       no_argument,        NULL,   option_long_generate_metadata},
+    {"help",                    no_argument,        NULL,   option_long_help},
+    {"ignore-bad-files",        no_argument,        NULL,   option_long_ignore_bad_files},
+    {"index",                   required_argument,  NULL,   option_long_index},
+    {"interlace",               no_argument,        NULL,   option_long_interlace},
+    {"io-threads",              required_argument,  NULL,   option_long_io_threads},
+    {"jobs",                    optional_argument,  NULL,   option_long_jobs},
+    {"memory-limit",            required_argument,  NULL,   option_long_memory_limit},
+    {"metadata-format",         required_argument,  NULL,   option_long_metadata_format},
+    {"metrics",                 required_argument,  NULL,   option_long_metrics},
+    {"metrics-socket",          required_argument,  NULL,   option_long_metrics_socket},
+    {"no-ansi-colours",         no_argument,        NULL,   option_long_no_ansi_colours},
+    {"no-auto-rotate",          no_argument,        NULL,   option_long_no_auto_rotate},
+    {"no-reconstruct",          no_argument,        NULL,   option_long_no_reconstruct},
+    {"output-archive",          required_argument,  NULL,   option_long_output_archive},
+    {"output-format",           required_argument,  NULL,   option_long_output_format},
+    {"overwrite",               no_argument,        NULL,   option_long_overwrite},
+    {"parallel-deflate",        no_argument,        NULL,   option_long_parallel_deflate},
+    {"plan",                    no_argument,        NULL,   option_long_plan},
+    {"png-profile",             required_argument,  NULL,   option_long_png_profile},
+    {"profile",                 required_argument,  NULL,   option_long_profile},
+    {"recursive",               no_argument,        NULL,   option_long_recursive},
 #ifdef USE_DBUS_INTERFACE
-        option_long_remote_start,
+    /* No need to document since only relevant to VLR */
+    {"remote-start",            no_argument,        NULL,   option_long_remote_start},
 #endif
-        option_long_summarize_only,
-        option_long_suppress,
-        option_long_verbose,
-        option_long_version
-    };
-
-    // Command line option structure...
-    option CommandLineLongOptions[] =
-    {
-        {"directorize-band-class",  no_argument,        NULL,   option_long_directorize_band_class},
-        {"directorize-location",    no_argument,        NULL,   option_long_directorize_location},
-        {"directorize-month",       no_argument,        NULL,   option_long_directorize_month},
-        {"directorize-sol",         no_argument,        NULL,   option_long_directorize_sol},
-        {"dry-run",                 no_argument,        NULL,   option_long_dry_run},
-        {"filter-camera-event",     required_argument,  NULL,   option_long_filter_camera_event},
-        {"filter-diode",            required_argument,  NULL,   option_long_filter_diode_class},
-        {"filter-lander",           required_argument,  NULL,   option_long_filter_lander},
-        {"filter-solar-day",        required_argument,  NULL,   option_long_filter_solar_day},
-        {"generate-metadata",       no_argument,        NULL,   option_long_generate_metadata},
-        {"help",                    no_argument,        NULL,   option_long_help},
-        {"ignore-bad-files",        no_argument,        NULL,   option_long_ignore_bad_files},
-        {"interlace",               no_argument,        NULL,   option_long_interlace},
-        {"jobs",                    optional_argument,  NULL,   option_long_jobs},
-        {"no-ansi-colours",         no_argument,        NULL,   option_long_no_ansi_colours},
-        {"no-auto-rotate",          no_argument,        NULL,   option_long_no_auto_rotate},
-        {"no-reconstruct",          no_argument,        NULL,   option_long_no_reconstruct},
-        {"overwrite",               no_argument,        NULL,   option_long_overwrite},
-        {"recursive",               no_argument,        NULL,   option_long_recursive},
+    {"resume",                  no_argument,        NULL,   option_long_resume},
 #ifdef USE_DBUS_INTERFACE
-        /* No need to document since only relevant to VLR */
-        {"remote-start",            no_argument,        NULL,   option_long_remote_start},
+    /* No need to document since only relevant to VLR */
+    {"signal-rate",             required_argument,  NULL,   option_long_signal_rate},
 #endif
-        {"summarize-only",          no_argument,        NULL,   option_long_summarize_only},
-        {"suppress",                no_argument,        NULL,   option_long_suppress},
-        {"verbose",                 no_argument,        NULL,   option_long_verbose},
-        {"version",                 no_argument,        NULL,   option_long_version},
-
-        // End of array marker...
-        {0, 0, 0, 0}
-    };
+    {"summarize-only",          no_argument,        NULL,   option_long_summarize_only},
+    {"suppress",                no_argument,        NULL,   option_long_suppress},
+    {"trace",                   required_argument,  NULL,   option_long_trace},
+    {"verbose",                 no_argument,        NULL,   option_long_verbose},
+    {"version",                 no_argument,        NULL,   option_long_version},
+
+    // End of array marker...
+    {0, 0, 0, 0}
+};
+
+// Parse the command line switches into the given options, or throw an error.
+//  Help, version, and unknown switches terminate, unless parsing those of a
+//  job submitted to a daemon...
+static void ParseOptions(
+    Options &CommandLineOptions,
+    int ArgumentCount,
+    char *Arguments[],
+    bool &VerboseConsole,
+    const bool Job)
+{
+    // Variables...
+    int OptionCharacter = '\x0';
+    int OptionIndex     = 0;
 
-    // Try to process the user's switches, looking for errors...
-    try
+    // Keep processing each option until there are none left...
+    while((OptionCharacter = getopt_long(
+        ArgumentCount, Arguments, "j::rVv", CommandLineLongOptions, &OptionIndex)) != -1)
     {
-        // Keep processing each option until there are none left...
-        while((OptionCharacter = getopt_long(
-            ArgumentCount, Arguments, "j::rVv", CommandLineLongOptions, &OptionIndex)) != -1)
+        // Which option?
+        switch(OptionCharacter)
         {
-            // Which option?
-            switch(OptionCharacter)
+            // Special case to set a flag, which we don't use...
+            case 0:
             {
-                // Special case to set a flag, which we don't use...
-                case 0:
-                {
-                    /* If this option set a flag, do nothing else now. */
-                    if(CommandLineLongOptions[OptionIndex].flag)
-                        break;
+                /* If this option set a flag, do nothing else now. */
+                if(CommandLineLongOptions[OptionIndex].flag)
+                    break;
 
-                    /*cout << "option " << CommandLineLongOptions[OptionIndex].name;
+                /*cout << "option " << CommandLineLongOptions[OptionIndex].name;
 
-                    if(optarg)
-                        cout << " with arg " << optarg;*/
+                if(optarg)
+                    cout << " with arg " << optarg;*/
 
-                    // Done...
-                    cout << endl;
-                    break;
-                }
+                // Done...
+                cout << endl;
+                break;
+            }
 
-                // Directorize by band type class...
-                case option_long_directorize_band_class: { Options::GetInstance().SetDirectorizeBandTypeClass(); break; }
+#ifdef USE_DBUS_INTERFACE
+            // Daemon, which a job cannot ask for...
+            case option_long_daemon:
+            {
+                // Sanity check...
+                if(Job)
+                    throw string(_("--daemon cannot be used by a job"));
 
-                // Directorize by location...
-                case option_long_directorize_location: { Options::GetInstance().SetDirectorizeLocation(); break; }
+                // Stay resident...
+                CommandLineOptions.SetDaemon();
+                break;
+            }
+#endif
 
-                // Directorize by month...
-                case option_long_directorize_month: { Options::GetInstance().SetDirectorizeMonth(); break; }
+            // Directorize by band type class...
+            case option_long_directorize_band_class: { CommandLineOptions.SetDirectorizeBandTypeClass(); break; }
 
-                // Directorize by solar day...
-                case option_long_directorize_sol: { Options::GetInstance().SetDirectorizeSol(); break; }
+            // Directorize by location...
+            case option_long_directorize_location: { CommandLineOptions.SetDirectorizeLocation(); break; }
 
-                // Dry run...
-                case option_long_dry_run: { Options::GetInstance().SetDryRun(); break; }
+            // Directorize by month...
+            case option_long_directorize_month: { CommandLineOptions.SetDirectorizeMonth(); break; }
 
-                // Filter by camera event ID...
-                case option_long_filter_camera_event:
-                { assert(optarg); Options::GetInstance().SetFilterCameraEvent(optarg); break; }
+            // Directorize by solar day...
+            case option_long_directorize_sol: { CommandLineOptions.SetDirectorizeSol(); break; }
 
-                // Filter by diode class...
-                case option_long_filter_diode_class:
-                { assert(optarg); Options::GetInstance().SetFilterDiodeClass(optarg); break; }
+            // Dry run...
+            case option_long_dry_run: { CommandLineOptions.SetDryRun(); break; }
 
-                // Filter by lander number...
-                case option_long_filter_lander:
-                { assert(optarg); Options::GetInstance().SetFilterLander(atoi(optarg)); break; }
+            // Emulated input media, shared by every job of a daemon...
+            case option_long_emulate_media:
+            {
+                // Sanity check...
+                assert(optarg);
+                if(Job)
+                    throw string(_("--emulate-media cannot be used by a job"));
+
+                // Remember...
+                CommandLineOptions.SetEmulateMedia(optarg);
+                break;
+            }
 
-                // Filter by solar day...
-                case option_long_filter_solar_day:
-                { assert(optarg); Options::GetInstance().SetFilterSolarDay(atoi(optarg)); break; }
+            // Filter by camera event ID...
+            case option_long_filter_camera_event:
+            { assert(optarg); CommandLineOptions.SetFilterCameraEvent(optarg); break; }
 
-                // Generate metadata...
-                case option_long_generate_metadata: { Options::GetInstance().SetGenerateMetadata(); break; }
+            // Filter by diode class...
+            case option_long_filter_diode_class:
+            { assert(optarg); CommandLineOptions.SetFilterDiodeClass(optarg); break; }
 
-                // Help...
-                case option_long_help:
-                {
-                    // Show help...
-                    ShowHelp();
+            // Filter by lander number...
+            case option_long_filter_lander:
+            { assert(optarg); CommandLineOptions.SetFilterLander(atoi(optarg)); break; }
 
-                    // Exit...
-                    exit(EXIT_SUCCESS);
-                }
+            // Filter by solar day...
+            case option_long_filter_solar_day:
+            { assert(optarg); CommandLineOptions.SetFilterSolarDay(atoi(optarg)); break; }
 
-                // Ignore bad files...
-                case option_long_ignore_bad_files: { Options::GetInstance().SetIgnoreBadFiles(); break; }
+            // Fsync policy...
+            case option_long_fsync:
+            { assert(optarg); CommandLineOptions.SetFsyncPolicy(optarg); break; }
 
-                // Interlace with Adam7...
-                case option_long_interlace: { Options::GetInstance().SetInterlace(); break; }
+            // Generate metadata...
+            case option_long_generate_metadata: { CommandLineOptions.SetGenerateMetadata(); break; }
 
-                // Jobs...
-                case 'j':
-                case option_long_jobs:
-                {
-                    // Issue a non-implemented warning...
-                    Message(Console::Warning)
-                        << _("parallelization is not implemented yet, using single thread")
-                        << endl;
+            // Help...
+            case option_long_help:
+            {
+                // Nowhere to show it for a job...
+                if(Job)
+                    throw string(_("--help cannot be used by a job"));
 
-                    size_t Jobs = 0;
+                // Show help...
+                ShowHelp();
 
-                    // Number of threads provided...
-                    if(optarg)
-                        Jobs = atoi(optarg);
+                // Exit...
+                exit(EXIT_SUCCESS);
+            }
 
-                    // Number of threads not provided...
-                    else
-                        Jobs = 0;
+            // Ignore bad files...
+            case option_long_ignore_bad_files: { CommandLineOptions.SetIgnoreBadFiles(); break; }
 
-                    // Automatic number of jobs explicitly or implicitly
-                    //  requested, query number of cpus online...
-                    if(Jobs == 0)
-                        Jobs = sysconf(_SC_NPROCESSORS_ONLN);
+            // Band index...
+            case option_long_index:
+            { assert(optarg); CommandLineOptions.SetIndexFile(optarg); break; }
 
-                    // Done...
-                    Options::GetInstance().SetJobs(Jobs);
-                    break;
-                }
+            // Interlace with Adam7...
+            case option_long_interlace: { CommandLineOptions.SetInterlace(); break; }
+
+            // Output file I/O threads...
+            case option_long_io_threads:
+            { assert(optarg); CommandLineOptions.SetIoThreads(atoi(optarg)); break; }
+
+            // Jobs...
+            case 'j':
+            case option_long_jobs:
+            {
+                size_t Jobs = 0;
 
-                // No ANSI VT/100 terminal colour...
-                case option_long_no_ansi_colours: { Console::GetInstance().SetUseColours(false); break; }
+                // Number of threads provided...
+                if(optarg)
+                    Jobs = atoi(optarg);
 
-                // No automatic image rotation correction...
-                case option_long_no_auto_rotate: { Options::GetInstance().SetAutoRotate(false); break; }
+                // Number of threads not provided...
+                else
+                    Jobs = 0;
 
-                // No reconstruct...
-                case option_long_no_reconstruct: { Options::GetInstance().SetNoReconstruct(); break; }
+                // Automatic number of jobs explicitly or implicitly
+                //  requested, query number of cpus online...
+                if(Jobs == 0)
+                    Jobs = sysconf(_SC_NPROCESSORS_ONLN);
 
-                // Overwrite output files...
-                case option_long_overwrite: { Options::GetInstance().SetOverwrite(); break; }
+                // Done...
+                CommandLineOptions.SetJobs(Jobs);
+                break;
+            }
+
+            // Memory limit...
+            case option_long_memory_limit:
+            { assert(optarg); CommandLineOptions.SetMemoryLimit(optarg); break; }
 
-                // Recursive scan of subfolders if input is a directory...
-                case 'r':
-                case option_long_recursive: { Options::GetInstance().SetRecursive(); break; }
+            // Metadata format...
+            case option_long_metadata_format:
+            { assert(optarg); CommandLineOptions.SetMetadataFormat(optarg); break; }
 
-    #ifdef USE_DBUS_INTERFACE
-                // Remote start. Recovery process pauses until DBus signal received...
-                case option_long_remote_start: { Options::GetInstance().SetRemoteStart(); break; }
-    #endif
+            // Metrics textfile, shared by every job of a daemon...
+            case option_long_metrics:
+            {
+                // Sanity check...
+                assert(optarg);
+                if(Job)
+                    throw string(_("--metrics cannot be used by a job"));
+
+                // Remember...
+                CommandLineOptions.SetMetricsFile(optarg);
+                break;
+            }
+
+            // Metrics socket, shared by every job of a daemon...
+            case option_long_metrics_socket:
+            {
+                // Sanity check...
+                assert(optarg);
+                if(Job)
+                    throw string(_("--metrics-socket cannot be used by a job"));
+
+                // Remember...
+                CommandLineOptions.SetMetricsSocket(optarg);
+                break;
+            }
 
-                // Show summary of progress and final results only...
-                case option_long_summarize_only: { Options::GetInstance().SetSummarizeOnly(); break; }
+            // No ANSI VT/100 terminal colour...
+            case option_long_no_ansi_colours: { ProcessConsole::GetInstance().SetUseColours(false); break; }
 
-                // Suppress all warnings and errors...
-                case option_long_suppress: { Options::GetInstance().SetSuppress(); break; }
+            // No automatic image rotation correction...
+            case option_long_no_auto_rotate: { CommandLineOptions.SetAutoRotate(false); break; }
 
-                // Verbose...
-                case 'V':
-                case option_long_verbose: { VerboseConsole = true; break; }
+            // No reconstruct...
+            case option_long_no_reconstruct: { CommandLineOptions.SetNoReconstruct(); break; }
 
-                // Version...
-                case 'v':
-                case option_long_version:
-                {
-                    // Dump version information...
-                    ShowVersion();
+            // Output archive...
+            case option_long_output_archive:
+            { assert(optarg); CommandLineOptions.SetOutputArchive(optarg); break; }
 
-                    // Exit...
-                    exit(EXIT_SUCCESS);
-                }
+            // Output image file format...
+            case option_long_output_format:
+            { assert(optarg); CommandLineOptions.SetOutputFormat(optarg); break; }
 
-                // Unknown option...
-                case '?':
-                {
-                    // get_opt_long already dumped an error message...
-                    exit(EXIT_FAILURE);
-                }
+            // Overwrite output files...
+            case option_long_overwrite: { CommandLineOptions.SetOverwrite(); break; }
 
-                // Unknown option...
-                default:
-                {
-                    //cout << "Exiting on option " << (int) OptionCharacter << endl;
+            // Deflate PNG image data in parallel...
+            case option_long_parallel_deflate: { CommandLineOptions.SetParallelDeflate(); break; }
 
-                    // Exit...
-                    exit(EXIT_FAILURE);
-                }
+            // Only plan from headers, which implies a dry run...
+            case option_long_plan: { CommandLineOptions.SetPlan(); CommandLineOptions.SetDryRun(); break; }
+
+            // PNG encoding profile...
+            case option_long_png_profile:
+            { assert(optarg); CommandLineOptions.SetPngProfile(optarg); break; }
+
+            // Stage timing profile...
+            case option_long_profile:
+            { assert(optarg); CommandLineOptions.SetProfileFile(optarg); break; }
+
+            // Recursive scan of subfolders if input is a directory...
+            case 'r':
+            case option_long_recursive: { CommandLineOptions.SetRecursive(); break; }
+
+#ifdef USE_DBUS_INTERFACE
+            // Remote start. Recovery process pauses until DBus signal received...
+            case option_long_remote_start:
+            {
+                // A job is already started...
+                if(Job)
+                    throw string(_("--remote-start cannot be used by a job"));
+
+                // Wait for the start method...
+                CommandLineOptions.SetRemoteStart();
+                break;
             }
+#endif
+
+            // Resume from the run journal...
+            case option_long_resume: { CommandLineOptions.SetResume(); break; }
+
+#ifdef USE_DBUS_INTERFACE
+            // Most number of times per second to emit D-Bus signals...
+            case option_long_signal_rate:
+            { assert(optarg); CommandLineOptions.SetSignalRate(atoi(optarg)); break; }
+#endif
+
+            // Show summary of progress and final results only...
+            case option_long_summarize_only: { CommandLineOptions.SetSummarizeOnly(); break; }
+
+            // Suppress all warnings and errors...
+            case option_long_suppress: { CommandLineOptions.SetSuppress(); break; }
+
+            // Timeline trace...
+            case option_long_trace:
+            { assert(optarg); CommandLineOptions.SetTraceFile(optarg); break; }
+
+            // Verbose...
+            case 'V':
+            case option_long_verbose: { VerboseConsole = true; break; }
+
+            // Version...
+            case 'v':
+            case option_long_version:
+            {
+                // Nowhere to show it for a job...
+                if(Job)
+                    throw string(_("--version cannot be used by a job"));
+
+                // Dump version information...
+                ShowVersion();
+
+                // Exit...
+                exit(EXIT_SUCCESS);
+            }
+
+            // Unknown option...
+            case '?':
+            {
+                // A job's client needs to know which one...
+                if(Job)
+                    throw string(_("unrecognized or incomplete option ")) + Arguments[optind - 1];
+
+                // get_opt_long already dumped an error message...
+                exit(EXIT_FAILURE);
+            }
+
+            // Unknown option...
+            default:
+            {
+                //cout << "Exiting on option " << (int) OptionCharacter << endl;
+
+                // A job's client needs to know...
+                if(Job)
+                    throw string(_("unrecognized or incomplete option"));
+
+                // Exit...
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+}
+
+// Count how an extraction turned out and write the metrics textfile, if
+//  asked for, alerting but otherwise carrying on if it can't be...
+static void FinishMetrics(
+    const Options &CommandLineOptions,
+    Metrics *Registry,
+    const bool Succeeded)
+{
+    // Not keeping metrics...
+    if(!Registry)
+        return;
+
+    // Count it...
+    Registry->Increment(
+        "viking_extractor_jobs_total",
+        Metrics::Label("outcome", Succeeded ? "succeeded" : "failed"));
+
+    // Write it out, if asked to...
+    try
+    {
+        if(!CommandLineOptions.GetMetricsFile().empty())
+            Registry->WriteTextfile(CommandLineOptions.GetMetricsFile());
+    }
+
+        // Failed...
+        catch(const string &Reason)
+        {
+            Message(Console::Error) << Reason << endl;
         }
+}
+
+#ifdef USE_DBUS_INTERFACE
+// Stay resident recovering whatever jobs are submitted over D-Bus until told
+//  to quit. The options of each job are those the daemon was started with,
+//  followed by the job's own, and the archives, OCR descriptors, and band
+//  indices it touches stay warm for the next. Every job counts in the same
+//  metrics registry, if any...
+static void RunDaemon(
+    int ArgumentCount,
+    char *Arguments[],
+    const Options &DaemonOptions,
+    Metrics *Registry)
+{
+    // Variables...
+    DBusInterface::JobType Job;
+
+    // Keep resources warm between jobs...
+    ResidentCache::CreateSingleton();
+
+    // Start serving method calls...
+    DBusInterface::GetInstance().StartDaemon();
+    Message(Console::Info) << _("daemon waiting for jobs...") << endl;
+
+    // Recover each job as it arrives until told to quit...
+    while(DBusInterface::GetInstance().WaitJob(Job))
+    {
+        // Variables...
+        string                  ErrorMessage;
+        vector<char *>          JobArguments;
+        Options                 JobOptions;
+        bool                    VerboseConsole  = false;
+
+        // Try to recover the job...
+        try
+        {
+            // Restore console state a previous job might have changed...
+            ProcessConsole::GetInstance().SetChannelEnabled(Console::Error, true);
+            ProcessConsole::GetInstance().SetChannelEnabled(Console::Info, true);
+            ProcessConsole::GetInstance().SetChannelEnabled(Console::Warning, true);
+            ProcessConsole::GetInstance().SetCurrentFileName("");
+            ProcessConsole::GetInstance().SetUseColours(true);
+            ProcessConsole::GetInstance().SetUseCurrentFileName(true);
+
+            // Start from fresh options with the daemon's own switches...
+            optind = 0;
+            ParseOptions(JobOptions, ArgumentCount, Arguments, VerboseConsole, false);
+
+            // Then apply the job's...
+            JobArguments.push_back(Arguments[0]);
+            for(size_t Index = 0; Index < Job.m_Arguments.size(); ++Index)
+                JobArguments.push_back(const_cast<char *>(Job.m_Arguments[Index].c_str()));
+            JobArguments.push_back(NULL);
+            optind = 0;
+            ParseOptions(JobOptions, JobArguments.size() - 1, &JobArguments.front(), VerboseConsole, true);
+
+                // Input and output come with the job, not its switches...
+                if(optind + 1 < static_cast<int>(JobArguments.size()))
+                    throw string(_("unknown parameter ")) + JobArguments[optind];
+
+            // Toggle verbose console and apply the job's signal rate...
+            ProcessConsole::GetInstance().SetChannelEnabled(Console::Verbose, VerboseConsole);
+            DBusInterface::GetInstance().SetSignalRate(JobOptions.GetSignalRate());
+
+            // Alert user...
+            Message(Console::Info)
+                << _("starting job ") << Job.m_ID << " (" << Job.m_Input << ")" << endl;
+
+            // Recover, reporting progress over D-Bus...
+            ExtractionContext Context(
+                JobOptions, ProcessConsole::GetInstance(), &DBusInterface::GetInstance(), Registry);
+            VicarImageAssembler Assembler(Context, Job.m_Input, Job.m_Output);
+            Assembler.Reconstruct();
+        }
+
+            // Failed...
+            catch(const string &Reason)
+            {
+                // Alert user, but keep serving...
+                Message(Console::Error) << Reason << endl;
+                ErrorMessage = Reason;
+            }
+
+        // Close archives that changed on disk since they were opened...
+        ResidentCache::GetInstance().Trim();
+
+        // Count the job and update the metrics textfile, if any...
+        FinishMetrics(DaemonOptions, Registry, ErrorMessage.empty());
+
+        // Let the client know...
+        DBusInterface::GetInstance().EmitJobFinishedSignal(
+            Job.m_ID, ErrorMessage.empty(), ErrorMessage);
+    }
+
+    // Alert user...
+    Message(Console::Info) << _("daemon quitting...") << endl;
+
+    // Release everything that was kept warm...
+    ResidentCache::DestroySingleton();
+}
+#endif
+
+// Some cleanup code to run on termination...
+static void AtExitCleanup()
+{
+    // Explicit instantiation of several subsystem singletons need to now be
+    //  explicitly deconstructed. Order matters...
+    if(MediaEmulator::IsInstantiated())
+        MediaEmulator::DestroySingleton();
+#ifdef USE_DBUS_INTERFACE
+    DBusInterface::DestroySingleton();
+#endif
+    ProcessConsole::DestroySingleton();
+}
+
+// Entry point...
+int main(int ArgumentCount, char *Arguments[])
+{
+    // Variables...
+    Options     CommandLineOptions;
+    string      InputFileOrRootDirectory;
+    string      OutputRootDirectory;
+    ProgressSink *Progress                  = NULL;
+    Metrics    *Registry                    = NULL;
+
+    // Some user options...
+    bool        VerboseConsole              = false;
+
+    // Explicit instantiation of several subsystem singletons. Order matters...
+    ProcessConsole::CreateSingleton();
+#ifdef USE_DBUS_INTERFACE
+    DBusInterface::CreateSingleton();
+#endif
+
+    // Cleanup code to run on termination...
+    atexit(AtExitCleanup);
+
+    // Try to process the user's switches, looking for errors...
+    try
+    {
+        // Parse them...
+        ParseOptions(CommandLineOptions, ArgumentCount, Arguments, VerboseConsole, false);
     }
 
         // Failed...
@@ -435,11 +853,19 @@ int main(int ArgumentCount, char *Arguments[])
             exit(EXIT_FAILURE);
         }
 
-    // Toggle verbose console...
-    Console::GetInstance().SetChannelEnabled(Console::Verbose, VerboseConsole);
+    // Toggle verbose console, writing it out on a thread of its own so
+    //  recovery never waits on the terminal...
+    ProcessConsole::GetInstance().SetChannelEnabled(Console::Verbose, VerboseConsole);
+    ProcessConsole::GetInstance().SetAsynchronous(VerboseConsole);
+
+    // Only PNG compression can use more than one thread so far...
+    if(CommandLineOptions.GetJobs() > 1 && !CommandLineOptions.GetParallelDeflate())
+        Message(Console::Warning)
+            << _("parallelization is only implemented for --parallel-deflate, using single thread")
+            << endl;
 
     // Summarize only and verbose mode are mutually exclusive...
-    if(VerboseConsole && Options::GetInstance().GetSummarizeOnly())
+    if(VerboseConsole && CommandLineOptions.GetSummarizeOnly())
     {
         // Alert, abort...
         Message(Console::Error)
@@ -472,6 +898,61 @@ int main(int ArgumentCount, char *Arguments[])
             exit(EXIT_FAILURE);
         }
 
+    // Keep metrics, if asked to, serving them for as long as we run...
+    if(!CommandLineOptions.GetMetricsFile().empty() ||
+       !CommandLineOptions.GetMetricsSocket().empty())
+    {
+        // Create the registry...
+        Registry = new Metrics;
+
+        // Start serving...
+        try
+        {
+            if(!CommandLineOptions.GetMetricsSocket().empty())
+                Registry->Serve(CommandLineOptions.GetMetricsSocket());
+        }
+
+            // Failed...
+            catch(const string &Reason)
+            {
+                // Alert, abort...
+                Message(Console::Error) << Reason << endl;
+                delete Registry;
+                exit(EXIT_FAILURE);
+            }
+    }
+
+    // Read the input through emulated media, if asked to, counting its seeks
+    //  in the metrics registry, if any...
+    if(CommandLineOptions.GetEmulateMedia())
+        MediaEmulator::CreateSingleton().Configure(
+            CommandLineOptions.GetEmulatedSeekLatency(),
+            CommandLineOptions.GetEmulatedThroughput(),
+            Registry);
+
+#ifdef USE_DBUS_INTERFACE
+    // A daemon takes its input and output from each job instead...
+    if(CommandLineOptions.GetDaemon())
+    {
+        // Check for extraneous arguments...
+        if(optind + 1 <= ArgumentCount)
+        {
+            // Alert, abort...
+            Message(Console::Error)
+                << _("a daemon takes its input and output from each job, see --help")
+                << endl;
+            exit(EXIT_FAILURE);
+        }
+
+        // Serve jobs until told to quit...
+        RunDaemon(ArgumentCount, Arguments, CommandLineOptions, Registry);
+
+        // Done...
+        delete Registry;
+        return EXIT_SUCCESS;
+    }
+#endif
+
     // We need at least one additional parameter, the input...
 
         // Fetch...
@@ -505,13 +986,38 @@ int main(int ArgumentCount, char *Arguments[])
     // Extract from a set of VICAR images...
     try
     {
+#ifdef USE_DBUS_INTERFACE
+        // Progress is reported over D-Bus to drive the Viking Lander
+        //  Remastered Launcher, at no more than the requested rate...
+        DBusInterface::GetInstance().SetSignalRate(CommandLineOptions.GetSignalRate());
+        Progress = &DBusInterface::GetInstance();
+
+        // If remote start was enabled, block until D-Bus Ready signal received
+        //  or throws an exception...
+        if(CommandLineOptions.GetRemoteStart())
+            DBusInterface::GetInstance().WaitRemoteStart();
+#endif
+
+        // Everything the extraction needs to know about how it was asked to
+        //  run...
+        ExtractionContext Context(
+            CommandLineOptions, ProcessConsole::GetInstance(), Progress, Registry);
+
         // Create image assembler where input and output "files" are just
         //  the input directory and the root output directory respectively...
-        VicarImageAssembler Assembler(InputFileOrRootDirectory, OutputRootDirectory);
+        VicarImageAssembler Assembler(Context, InputFileOrRootDirectory, OutputRootDirectory);
 
         // Reconstruct all possible images found of either the input
         //  file or a directory into the output directory...
         Assembler.Reconstruct();
+
+        // Summarize how the emulated media was used, if any...
+        if(MediaEmulator::IsInstantiated())
+            Message(Console::Info)
+                << _("emulated media made ") << MediaEmulator::GetInstance().GetSeeks()
+                << _(" seeks reading ") << MediaEmulator::GetInstance().GetBytesRead()
+                << _(" bytes, busy for ") << MediaEmulator::GetInstance().GetBusySeconds()
+                << _(" seconds") << endl;
     }
 
         // Failed...
@@ -520,10 +1026,18 @@ int main(int ArgumentCount, char *Arguments[])
             // Alert...
             Message(Console::Error) << ErrorMessage << endl;
 
+            // Count the failure too...
+            FinishMetrics(CommandLineOptions, Registry, false);
+            delete Registry;
+
             // Terminate...
             exit(EXIT_FAILURE);
         }
 
+    // Count it and write out the metrics, if keeping them...
+    FinishMetrics(CommandLineOptions, Registry, true);
+    delete Registry;
+
     // Done...
     return EXIT_SUCCESS;
 }
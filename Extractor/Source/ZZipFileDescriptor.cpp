@@ -26,6 +26,8 @@
 
     // Our headers...    
     #include "ZZipFileDescriptor.h"
+    #include "MediaEmulator.h"
+    #include "ResidentCache.h"
 
     // zziplib...
     #include <zzip/zzip.h>
@@ -37,10 +39,12 @@ using namespace std;
 ZZipFileDescriptor::ZZipFileDescriptor(const std::string &RealFileName)
     : m_RealFileName(RealFileName),
       m_ArchiveDescriptor(NULL),
-      m_FileDescriptor(NULL)
+      m_FileDescriptor(NULL),
+      m_ResidentArchive(false)
 {
-    // Open the real file...
-    m_FileDescriptor = zzip_fopen(RealFileName.c_str(), O_RDONLY);
+    // Open the real file, through emulated media if asked to...
+    m_FileDescriptor = zzip_open_ext_io(
+        RealFileName.c_str(), O_RDONLY, 0664, NULL, MediaEmulator::GetHandlers());
 }
 
 // Construct around a compressed file within an archive...
@@ -49,10 +53,16 @@ ZZipFileDescriptor::ZZipFileDescriptor(
     : m_ArchiveFileName(ArchiveFileName),
       m_CompressedFileName(CompressedFileName),
       m_ArchiveDescriptor(NULL),
-      m_FileDescriptor(NULL)
+      m_FileDescriptor(NULL),
+      m_ResidentArchive(false)
 {
-    // Open archive...
-    m_ArchiveDescriptor = zzip_dir_open(m_ArchiveFileName.c_str(), NULL);
+    // Open archive, through emulated media if asked to, or reuse the one a
+    //  daemon keeps open...
+    m_ResidentArchive = ResidentCache::IsInstantiated();
+    m_ArchiveDescriptor = m_ResidentArchive ?
+        ResidentCache::GetInstance().AcquireArchive(m_ArchiveFileName) :
+        zzip_dir_open_ext_io(
+            m_ArchiveFileName.c_str(), NULL, NULL, MediaEmulator::GetHandlers());
 
         // Failed...
         if(!m_ArchiveDescriptor)
@@ -65,7 +75,9 @@ ZZipFileDescriptor::ZZipFileDescriptor(
         if(!m_FileDescriptor)
         {
             // Cleanup, abort...
-            zzip_closedir(m_ArchiveDescriptor);
+            if(!m_ResidentArchive)
+                zzip_closedir(m_ArchiveDescriptor);
+            m_ArchiveDescriptor = NULL;
             return;
         }
 }
@@ -76,17 +88,23 @@ ZZipFileDescriptor::ZZipFileDescriptor(const ZZipFileDescriptor &Source)
       m_ArchiveFileName(Source.m_ArchiveFileName),
       m_CompressedFileName(Source.m_CompressedFileName),
       m_ArchiveDescriptor(NULL),
-      m_FileDescriptor(NULL)
+      m_FileDescriptor(NULL),
+      m_ResidentArchive(false)
 {
     // The source wraps a real file...
     if(zzip_file_real(Source.m_FileDescriptor))
-        m_FileDescriptor = zzip_fopen(m_RealFileName.c_str(), O_RDONLY);
+        m_FileDescriptor = zzip_open_ext_io(
+            m_RealFileName.c_str(), O_RDONLY, 0664, NULL, MediaEmulator::GetHandlers());
 
     // The source wraps a compressed file within an archive...
     else
     {
-        // Open archive...
-        m_ArchiveDescriptor = zzip_dir_open(m_ArchiveFileName.c_str(), NULL);
+        // Open archive, or share the one a daemon keeps open...
+        m_ResidentArchive = Source.m_ResidentArchive;
+        m_ArchiveDescriptor = m_ResidentArchive ?
+            Source.m_ArchiveDescriptor :
+            zzip_dir_open_ext_io(
+                m_ArchiveFileName.c_str(), NULL, NULL, MediaEmulator::GetHandlers());
 
             // Failed...
             if(!m_ArchiveDescriptor)
@@ -100,15 +118,20 @@ ZZipFileDescriptor::ZZipFileDescriptor(const ZZipFileDescriptor &Source)
             if(!m_FileDescriptor)
             {
                 // Cleanup, abort...
-                zzip_closedir(m_ArchiveDescriptor);
+                if(!m_ResidentArchive)
+                    zzip_closedir(m_ArchiveDescriptor);
                 m_ArchiveDescriptor = NULL;
                 return;
             }
     }
     
-    // Restore the archive descriptor pointer...
-    const zzip_off_t ArchiveReadPointer = zzip_telldir(Source.m_ArchiveDescriptor);
-    zzip_seekdir(m_ArchiveDescriptor, ArchiveReadPointer);
+    // Restore the archive descriptor pointer, unless shared with the
+    //  source...
+    if(!m_ResidentArchive)
+    {
+        const zzip_off_t ArchiveReadPointer = zzip_telldir(Source.m_ArchiveDescriptor);
+        zzip_seekdir(m_ArchiveDescriptor, ArchiveReadPointer);
+    }
 
     // Restore the file descriptor pointer...
     const zzip_off_t CompressedFileReadPointer = 
@@ -116,6 +139,21 @@ ZZipFileDescriptor::ZZipFileDescriptor(const ZZipFileDescriptor &Source)
     zzip_seek(m_FileDescriptor, CompressedFileReadPointer, SEEK_SET);
 }
 
+// Get the fraction of its inflated size the file occupies as stored, being one
+//  for a real file or a member stored uncompressed...
+double ZZipFileDescriptor::GetStoredFraction() const
+{
+    // A real file is stored as is...
+    if(!m_FileDescriptor || zzip_file_real(m_FileDescriptor))
+        return 1.0;
+
+    // Otherwise compare its compressed size within the archive...
+    ZZIP_STAT FileStatus;
+    if(zzip_fstat(m_FileDescriptor, &FileStatus) == -1 || FileStatus.st_size <= 0)
+        return 1.0;
+    return static_cast<double>(FileStatus.d_csize) / FileStatus.st_size;
+}
+
 // Check if the handle is valid and not EOF...
 bool ZZipFileDescriptor::IsGood() const
 {
@@ -143,8 +181,9 @@ ZZipFileDescriptor::~ZZipFileDescriptor()
     if(m_FileDescriptor)
         zzip_close(m_FileDescriptor);
 
-    // Close the containing archive, if it was within one...
-    if(m_ArchiveDescriptor)
+    // Close the containing archive, if it was within one that isn't kept
+    //  open between daemon jobs...
+    if(m_ArchiveDescriptor && !m_ResidentArchive)
     {
         zzip_closedir(m_ArchiveDescriptor);
     }
@@ -55,6 +55,10 @@ class ZZipFileDescriptor
         // Copy constructor...
         ZZipFileDescriptor(const ZZipFileDescriptor &Source);
 
+        // Get the fraction of its inflated size the file occupies as stored,
+        //  being one for a real file or a member stored uncompressed...
+        double GetStoredFraction() const;
+
         // Check if the handle is valid, not EOF, etc...
         bool IsGood() const;
         
@@ -78,6 +82,10 @@ class ZZipFileDescriptor
         // Archive and file descriptors...
         ZZIP_DIR           *m_ArchiveDescriptor;
         ZZIP_FILE          *m_FileDescriptor;
+
+        // The archive descriptor is kept open by the resident cache between
+        //  daemon jobs, so isn't ours to close...
+        bool                m_ResidentArchive;
 };
 
 // Multiple include protection...
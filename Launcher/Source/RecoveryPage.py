@@ -49,6 +49,7 @@ class RecoveryPageProxy(PageProxyBase):
         self._confirmPageProxy      = launcherApp.confirmPageProxy
         self._recoveryProgressText  = ""
         self.processID              = 0
+        self.reconstructedImages    = []
 
         # Add recovery page to assistant...
         self.registerPage(
@@ -108,6 +109,7 @@ class RecoveryPageProxy(PageProxyBase):
         VE_DBUS_SERVICE_NAME        = "com.cartesiantheatre.VikingExtractorService"
         VE_DBUS_OBJECT_PATH         = "/com/cartesiantheatre/VikingExtractorObject"
         VE_DBUS_INTERFACE           = "com.cartesiantheatre.VikingExtractorInterface"
+        VE_DBUS_SIGNAL_IMAGE_RECONSTRUCTED = "ImageReconstructed"
         VE_DBUS_SIGNAL_NOTIFICATION = "Notification"
         VE_DBUS_SIGNAL_PROGRESS     = "Progress"
         VE_DBUS_METHOD_START        = "Start"
@@ -191,6 +193,17 @@ class RecoveryPageProxy(PageProxyBase):
                     self.onVikingExtractorProgressSignal,
                     None)
 
+                # Connect to VikingExtractor's image reconstructed signal...
+                sessionConnection.signal_subscribe(
+                    VE_DBUS_SERVICE_NAME,
+                    VE_DBUS_INTERFACE,
+                    VE_DBUS_SIGNAL_IMAGE_RECONSTRUCTED,
+                    VE_DBUS_OBJECT_PATH,
+                    None,
+                    Gio.DBusSignalFlags.NONE,
+                    self.onVikingExtractorImageReconstructedSignal,
+                    None)
+
                 # Show some progress on the console...
                 sys.stdout.write(".")
                 sys.stdout.flush()
@@ -230,6 +243,22 @@ class RecoveryPageProxy(PageProxyBase):
         # Terminate...
         sys.exit(1)
 
+    # Set the progress bar caption from the extractor's state, the given
+    #  percentage complete, and how many images have been recovered so far...
+    def _setProgressCaption(self, currentProgress):
+
+        # State and percentage...
+        caption = "{0} ({1:.1f}%)".format(
+            self._recoveryProgressText, currentProgress)
+
+        # Images recovered so far, if any...
+        if self.reconstructedImages:
+            caption += _(", {0} images recovered").format(
+                len(self.reconstructedImages))
+
+        # Set it...
+        self._recoveryProgressBar.set_text(caption)
+
     # Abort recovery button clicked...
     def onAbortClicked(self, button, *junk):
 
@@ -299,6 +328,28 @@ class RecoveryPageProxy(PageProxyBase):
     #def onExposeEvent(self, event, *dummy):
     #    print("onExposeEvent")
 
+    # VikingExtractor has reconstructed an image and written it out, so it can
+    #  be shown without waiting for the whole recovery to finish...
+    def onVikingExtractorImageReconstructedSignal(
+        self, connection, senderName, objectPath, interfaceName, signalName, 
+        parameters, userData):
+
+        # Unpack the output file, camera event, solar day, band type class,
+        #  and dimensions from the signal's arguments...
+        (outputFile, cameraEvent, solarDay, bandTypeClass, width, height) = \
+            parameters.unpack()
+
+        # Remember it...
+        self.reconstructedImages.append(outputFile)
+
+        # Show it on the console...
+        print(_("Recovered {0} on sol {1} ({2}, {3}x{4})...").
+            format(cameraEvent, solarDay, bandTypeClass, width, height))
+
+        # Update the count of images recovered so far on the page...
+        self._setProgressCaption(
+            self._recoveryProgressBar.get_fraction() * 100.0)
+
     # VikingExtractor is trying to tell us something in a human readable string...
     def onVikingExtractorNotificationSignal(
         self, connection, senderName, objectPath, interfaceName, signalName, 
@@ -326,8 +377,7 @@ class RecoveryPageProxy(PageProxyBase):
         currentProgress = parameters.unpack()[0]
     
         # Format and set the progress bar caption...
-        self._recoveryProgressBar.set_text("{0} ({1:.1f}%)".
-            format(self._recoveryProgressText, currentProgress))
+        self._setProgressCaption(currentProgress)
         
         # Move the progress bar's fraction...
         self._recoveryProgressBar.set_fraction(currentProgress / 100.0)